@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1992-1994, 1997-1999, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1992-1994, 1997-1999, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,20 +17,48 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <common/ac/errno.h>
 #include <common/ac/fcntl.h>
 #include <common/ac/stdio.h>
 #include <common/ac/string.h>
+#include <common/ac/unistd.h>
 
 #include <c_incl/cache.h>
+#include <c_incl/dircache.h>
 #include <common/error_intl.h>
 #include <common/mem.h>
-#include <c_incl/os_interface.h>
 #include <common/progname.h>
 #include <common/symtab.h>
 #include <common/trace.h>
+#include <common/whole_file.h>
 
+/*
+ * The cache file is an append-only log of records.  Each c_incl
+ * process reads the whole log without locking, and at exit appends
+ * just the entries it changed, using a single write to a file opened
+ * for appending.  When the same name appears in several records, the
+ * last one wins.
+ *
+ * Each record is framed by its length and a checksum, so that a
+ * record torn by a crash, or by a concurrent writer on a file system
+ * which does not honour O_APPEND, is detected and the rest of the log
+ * ignored.  This only ever loses cache entries, which will simply be
+ * worked out again next time.
+ *
+ * The transitive closure of a file's ingredients goes in a record of
+ * its own, which follows the file's record.  Closures are large, and
+ * most are not needed by any one process, so their checksums are only
+ * checked when they are used.
+ *
+ * When the log has grown to several times the number of live entries,
+ * it is compacted: a complete new log is written to a temporary file,
+ * which is then renamed over the old one.  Appends made by other
+ * processes to the old file in the meantime are lost, which is
+ * harmless.
+ */
 
-static int      need_to_write;
+static char     magic[] = "c_incl cache v2\n";
+static int      need_to_compact;
 static symtab_ty *symtab;
 
 
@@ -41,6 +69,7 @@ reap(void *p)
 
     cp = p;
     string_list_destructor(&cp->ingredients);
+    string_list_destructor(&cp->closure);
     mem_free(cp);
 }
 
@@ -107,6 +136,15 @@ cache_search(string_ty *filename)
         cp = mem_alloc(sizeof(cache_ty));
         memset(&cp->st, 0, sizeof(cp->st));
         string_list_constructor(&cp->ingredients);
+        string_list_constructor(&cp->closure);
+        cp->closure_stamp = 0;
+        cp->closed = 0;
+        cp->closure_record = 0;
+        cp->closure_len = 0;
+        cp->closure_sum = 0;
+        cp->dirty = 0;
+        cp->closure_dirty = 0;
+        cp->checked = 0;
         symtab_assign(symtab, filename, cp);
     }
     return cp;
@@ -144,89 +182,94 @@ build_filename(void)
 
 /*
  * NAME
- *      fread_sane - a saner version of fread
+ *      cache_get_string - read a string from a record
  *
  * SYNOPSIS
- *      int fread_sane(FILE *fp, void *buf, size_t buflen);
+ *      string_ty *cache_get_string(record_reader_ty *rp);
  *
  * DESCRIPTION
- *      The fread_sane function is used to read from a standard stream.
- *
- * ARGUMENTS
- *      fp      - the stream to read from
- *      buf     - where to place the bytes read
- *      buflen  - number of bytes to read
+ *      The cache_get_string function is used to read a string
+ *      from the contents of a record.
  *
  * RETURNS
- *      0 on no error, -1 on any error
+ *      pointer to string if successful, 0 if not.
  *
  * CAVEATS
- *      This version considers it to be an error if end-of-file is reached.
+ *      Must be symmetric with cache_put_string below.
  */
 
-static int
-fread_sane(FILE *fp, void *buf, size_t buflen)
+string_ty *
+cache_get_string(record_reader_ty *rp)
 {
-    if (fread(buf, 1, buflen, fp) != buflen)
-        return -1;
-    return 0;
+    size_t          len;
+    string_ty       *s;
+
+    if (record_get(rp, &len, sizeof(len)))
+        return 0;
+    if (len > rp->len - rp->pos)
+        return 0;
+    s = str_n_from_c(rp->buf + rp->pos, len);
+    rp->pos += len;
+    return s;
 }
 
 
 /*
  * NAME
- *      cache_read_string - read a string from a file
+ *      cache_put - append bytes to a record
  *
  * SYNOPSIS
- *      string_ty *cache_read_string(FILE *fp));
+ *      void cache_put(stracc *sap, const void *buf, size_t buflen);
  *
  * DESCRIPTION
- *      The cache_read_string function is used to read a string
- *      from a file.
+ *      The cache_put function is used to append bytes to the record
+ *      being built.
+ */
+
+void
+cache_put(stracc *sap, const void *buf, size_t buflen)
+{
+    sa_chars(sap, buf, buflen);
+}
+
+
+/*
+ * NAME
+ *      cache_put_string - append a string to a record
  *
- * ARGUMENTS
- *      fp      - file to read string from
+ * SYNOPSIS
+ *      void cache_put_string(stracc *sap, string_ty *s);
  *
- * RETURNS
- *      pointer to string if successful, 0 if not.
+ * DESCRIPTION
+ *      The cache_put_string function is used to append a string to
+ *      the record being built.
  *
  * CAVEATS
- *      Must be symmetric with cache_write string below.
+ *      Must be symmetric with cache_get_string above.
  */
 
-static string_ty *
-cache_read_string(FILE *fp)
+void
+cache_put_string(stracc *sap, string_ty *s)
 {
-    static size_t   buflen;
-    static char     *buf;
-    size_t          len;
-
-    if (fread_sane(fp, &len, sizeof(len)))
-        return 0;
-    if (len > buflen)
-    {
-        buflen = (len + 0xFF) & ~0xFF;
-        buf = mem_change_size(buf, buflen);
-    }
-    if (fread_sane(fp, buf, len))
-        return 0;
-    return str_n_from_c(buf, len);
+    cache_put(sap, &s->str_length, sizeof(s->str_length));
+    cache_put(sap, s->str_text, s->str_length);
 }
 
 
 /*
  * NAME
- *      cache_read_item - read a cache item from a file
+ *      cache_read_item - read a cache item from a record
  *
  * SYNOPSIS
- *      int cache_read_item(FILE *fp);
+ *      int cache_read_item(record_reader_ty *rp);
  *
  * DESCRIPTION
  *      The cache_read_item function is used to read an item from
- *      the cache file and installit into the cache.
+ *      a record and install it into the cache, replacing any earlier
+ *      record for the same file.
  *
  * ARGUMENTS
- *      fp      - the file to read the item from
+ *      rp      - the record to read the item from
  *
  * RETURNS
  *      0 in success, -1 on any error
@@ -236,25 +279,28 @@ cache_read_string(FILE *fp)
  */
 
 static int
-cache_read_item(FILE *fp)
+cache_read_item(record_reader_ty *rp)
 {
     string_ty       *s;
     cache_ty        *cp;
     size_t          nitems;
     size_t          j;
 
-    s = cache_read_string(fp);
+    s = cache_get_string(rp);
     if (!s)
         return -1;
     cp = cache_search(s);
+    str_free(s);
     assert(cp);
-    if (fread_sane(fp, &cp->st, sizeof(cp->st)))
+    string_list_destructor(&cp->ingredients);
+    cp->size = rp->len;
+    if (record_get(rp, &cp->st, sizeof(cp->st)))
         return -1;
-    if (fread_sane(fp, &nitems, sizeof(nitems)))
+    if (record_get(rp, &nitems, sizeof(nitems)))
         return -1;
     for (j = 0; j < nitems; ++j)
     {
-        s = cache_read_string(fp);
+        s = cache_get_string(rp);
         if (!s)
             return -1;
         string_list_append_unique(&cp->ingredients, s);
@@ -264,72 +310,137 @@ cache_read_item(FILE *fp)
 }
 
 
+/*
+ * NAME
+ *      cache_read_closure - note a closure record
+ *
+ * SYNOPSIS
+ *      void cache_read_closure(record_reader_ty *rp, unsigned long sum);
+ *
+ * DESCRIPTION
+ *      The cache_read_closure function is used to note where the
+ *      closure record for a cache item is, replacing any earlier
+ *      record for the same file.  Closures are large, and a process
+ *      only needs a few of them, so they are neither checked nor
+ *      decoded until the cache_closure function is asked for them.
+ *      A record for a file with no other entry is ignored, so that
+ *      an unchecked record can't add anything to the cache.
+ *
+ * CAVEATS
+ *      Must be symmetric with cache_write_closure below.
+ */
+
 static void
-flock_shared(int fd, char *fn)
+cache_read_closure(record_reader_ty *rp, unsigned long sum)
 {
-    struct flock    p;
-
-    memset(&p, 0, sizeof(p));
-    p.l_type = F_RDLCK;
-    p.l_whence = SEEK_SET;
-    p.l_start = 0;
-    p.l_len = 1;
-    if (fcntl(fd, F_SETLKW, &p))
-    {
-        sub_context_ty *scp;
+    string_ty       *s;
+    cache_ty        *cp;
 
-        scp = sub_context_new();
-        sub_errno_set(scp);
-        sub_var_set(scp, "File_Name", "%s", fn);
-        fatal_intl(scp, i18n("lock \"$filename\" shared: $errno"));
-        /* NOTREACHED */
-    }
+    s = cache_get_string(rp);
+    if (!s)
+        return;
+    cp = symtab_query(symtab, s);
+    str_free(s);
+    if (!cp)
+        return;
+    string_list_destructor(&cp->closure);
+    cp->closed = 0;
+    cp->closure_record = rp->buf;
+    cp->closure_len = rp->len;
+    cp->closure_sum = sum;
 }
 
 
-static void
-flock_exclusive(int fd, char *fn)
+/*
+ * NAME
+ *      cache_closure - get the closure of a cache item
+ *
+ * SYNOPSIS
+ *      string_list_ty *cache_closure(cache_ty *cp);
+ *
+ * DESCRIPTION
+ *      The cache_closure function is used to obtain the transitive
+ *      ingredients remembered for a cache item, and the stamp of the
+ *      stat information they were worked out from.  The closure record
+ *      is checked and decoded on first use.
+ *
+ * RETURNS
+ *      string_list_ty *; the closure.  The closed field is zero if
+ *      there isn't one.
+ */
+
+string_list_ty *
+cache_closure(cache_ty *cp)
 {
-    struct flock    p;
-
-    memset(&p, 0, sizeof(p));
-    p.l_type = F_WRLCK;
-    p.l_whence = SEEK_SET;
-    p.l_start = 0;
-    p.l_len = 1;
-    if (fcntl(fd, F_SETLKW, &p))
+    record_reader_ty r;
+    string_ty       *s;
+    string_ty       *prev;
+    stracc          sa;
+
+    if (!cp->closure_record)
+        return &cp->closure;
+    stracc_constructor(&sa);
+    r.buf = cp->closure_record;
+    r.pos = 1;
+    r.len = cp->closure_len;
+    cp->closure_record = 0;
+    if (cp->closure_sum != record_checksum(r.buf, r.len))
+        goto damaged;
+    s = cache_get_string(&r);
+    if (!s)
+        goto damaged;
+    str_free(s);
+    if (record_get(&r, &cp->closure_stamp, sizeof(cp->closure_stamp)))
+        goto damaged;
+    cp->closed = 1;
+    prev = 0;
+    while (r.pos < r.len)
     {
-        sub_context_ty *scp;
-
-        scp = sub_context_new();
-        sub_errno_set(scp);
-        sub_var_set(scp, "File_Name", "%s", fn);
-        fatal_intl(scp, i18n("lock \"$filename\" exclusive: $errno"));
-        /* NOTREACHED */
+        size_t          keep;
+        size_t          more;
+
+        /*
+         * Each name is stored as the length of the prefix it shares
+         * with the name before it, followed by the rest of the name.
+         */
+        if (record_get_number(&r, &keep) || record_get_number(&r, &more))
+            goto damaged;
+        if (keep > (prev ? prev->str_length : 0) || more > r.len - r.pos)
+            goto damaged;
+        sa_open(&sa);
+        if (keep)
+            sa_chars(&sa, prev->str_text, keep);
+        sa_chars(&sa, r.buf + r.pos, more);
+        r.pos += more;
+        s = sa_close(&sa);
+        string_list_append(&cp->closure, s);
+        str_free(s);
+        prev = cp->closure.string[cp->closure.nstrings - 1];
     }
+    stracc_destructor(&sa);
+    return &cp->closure;
+
+    damaged:
+    trace(("damaged closure record\n"));
+    stracc_destructor(&sa);
+    string_list_destructor(&cp->closure);
+    cp->closed = 0;
+    need_to_compact = 1;
+    return &cp->closure;
 }
 
 
 static void
-flock_release(int fd, char *fn)
+add_size(symtab_ty *stp, string_ty *key, void *data, void *arg)
 {
-    struct flock    p;
-
-    memset(&p, 0, sizeof(p));
-    p.l_type = F_UNLCK;
-    p.l_whence = SEEK_SET;
-    p.l_start = 0;
-    p.l_len = 1;
-    if (fcntl(fd, F_SETLKW, &p))
-    {
-        sub_context_ty *scp;
+    cache_ty        *cp;
 
-        scp = sub_context_new();
-        sub_errno_set(scp);
-        sub_var_set(scp, "File_Name", "%s", fn);
-        fatal_intl(scp, i18n("unlock \"$filename\": $errno"));
-        /* NOTREACHED */
-    }
+    (void)stp;
+    (void)key;
+    cp = data;
+    *(size_t *)arg += cp->size;
+    if (cp->closure_record)
+        *(size_t *)arg += cp->closure_len;
 }
 
 
@@ -346,176 +457,299 @@ flock_release(int fd, char *fn)
  * CAVEATS
  *      If the cache file is not there, it is as iff the cache file
  *      contained an image of an empty cache.  I.e. nothing happens,
- *      but it is not an error.
+ *      but it is not an error.  The same applies to cache files
+ *      written by older versions, and to damaged records.
  */
 
 void
 cache_read(void)
 {
-    str_hash_ty     nitems;
-    str_hash_ty     j;
-    FILE            *fp;
     char            *filename;
+    char            *buf;
+    size_t          buflen;
+    record_reader_ty f;
+    size_t          nrecords;
+    size_t          nlive;
+    size_t          live;
 
-    /*
-     * open the cache file.
-     * if it's not there, quietly slink away
-     */
     filename = build_filename();
-    if (!os_exists(filename))
+    buf = read_whole_file(filename, &buflen);
+    if (!buf)
+    {
+        need_to_compact = 1;
         return;
-    fp = fopen_and_check(filename, "rb");
-
-    /*
-     * Take a shared lock: many processes may read simultaneously.
-     */
-    flock_shared(fileno(fp), filename);
+    }
+    if (buflen < sizeof(magic) - 1 || memcmp(buf, magic, sizeof(magic) - 1))
+    {
+        need_to_compact = 1;
+        mem_free(buf);
+        return;
+    }
 
     /*
-     * get the number of entries in the file
+     * read each record in the file
      */
-    if (fread_sane(fp, &nitems, sizeof(nitems)))
-        fatal_intl_read(filename);
+    nrecords = 0;
+    f.buf = buf;
+    f.pos = sizeof(magic) - 1;
+    f.len = buflen;
+    for (;;)
+    {
+        size_t          pos;
+        unsigned long   sum;
+        record_reader_ty r;
+        char            kind;
+        int             err;
+
+        pos = f.pos;
+        if (record_next(&f, &r, &sum))
+            break;
+        kind = r.buf[0];
+        if (kind != 'C' && sum != record_checksum(r.buf, r.len))
+        {
+            f.pos = pos;
+            break;
+        }
+        ++nrecords;
+        switch (kind)
+        {
+        case 'F':
+            err = cache_read_item(&r);
+            break;
+
+        case 'C':
+            cache_read_closure(&r, sum);
+            err = 0;
+            break;
+
+        case 'D':
+            err = dircache_read(&r);
+            break;
+
+        default:
+            /* from a later version, perhaps */
+            err = 0;
+            break;
+        }
+        if (err)
+            break;
+    }
+    if (f.pos < buflen)
+    {
+        trace(("damaged record at %ld\n", (long)f.pos));
+        need_to_compact = 1;
+    }
 
     /*
-     * read each entry in the file
+     * If most of the records have been superseded by later ones,
+     * it is time to compact the file.
      */
-    for (j = 0; j < nitems; ++j)
-    {
-        if (cache_read_item(fp))
-            fatal_intl_read(filename);
-    }
+    nlive = symtab->hash_load + dircache_count();
+    if (nrecords > 64 && nrecords > 3 * nlive)
+        need_to_compact = 1;
 
     /*
-     * Release the file lock.
+     * The same goes for the bytes: a few large records, such as
+     * closures or big directories, rewritten many times.
      */
-    flock_release(fileno(fp), filename);
+    live = dircache_size();
+    symtab_walk(symtab, add_size, &live);
+    if (buflen > (1 << 16) && buflen > 3 * live)
+        need_to_compact = 1;
 
     /*
-     * all done
+     * The buffer is not released, because the closures are left in
+     * it until they are needed, and most of them never will be.
      */
-    fclose_and_check(fp, filename);
 }
 
 
 /*
  * NAME
- *      fwrite_sane - a saner version of fwrite
+ *      cache_write_item - write cache item to a record
  *
  * SYNOPSIS
- *      int fwrite_sane(FILE *fp, void *buf, size_t buflen);
+ *      void cache_write_item(stracc *sap, string_ty *key, cache_ty *cp);
  *
  * DESCRIPTION
- *      The fwrite_sane function is used to write data to a file.
+ *      The cache_write_item function is used to append a record for
+ *      a cache item.
  *
- * ARGUMENTS
- *      fp      - file to write to
- *      buf     - pointer to data to write
- *      buflen  - number of bytes in data
- *
- * RETURNS
- *      0 on success, -1 on any error
+ * CAVEATS
+ *      Must be symmetric with cache_read_item above.
  */
 
-static int
-fwrite_sane(FILE *fp, void *buf, size_t buflen)
+static void
+cache_write_item(stracc *sap, string_ty *key, cache_ty *cp)
 {
-    if (fwrite(buf, 1, buflen, fp) != buflen)
-        return -1;
-    return 0;
+    size_t          mark;
+    size_t          j;
+
+    mark = record_begin(sap, 'F');
+    cache_put_string(sap, key);
+    cache_put(sap, &cp->st, sizeof(cp->st));
+    cache_put
+    (
+        sap,
+        &cp->ingredients.nstrings,
+        sizeof(cp->ingredients.nstrings)
+    );
+    for (j = 0; j < cp->ingredients.nstrings; ++j)
+        cache_put_string(sap, cp->ingredients.string[j]);
+    record_end(sap, mark);
 }
 
 
 /*
  * NAME
- *      cache_write_string - write a string to a file
+ *      cache_write_closure - write closure to a record
  *
  * SYNOPSIS
- *      int cache_write_string(FILE *fp, string_ty *s);
+ *      void cache_write_closure(stracc *sap, string_ty *key,
+ *              cache_ty *cp);
  *
  * DESCRIPTION
- *      The cache_write_string function is used to write a string to a file.
- *
- * ARGUMENTS
- *      fp      - file to write
- *      s       - string to be written
- *
- * RETURNS
- *      0 on success, -1 on any error
+ *      The cache_write_closure function is used to append a record for
+ *      the closure of a cache item.  It must follow the item's own
+ *      record.
  *
  * CAVEATS
- *      Must be symmetric with cache_read_string above.
+ *      Must be symmetric with cache_read_closure above.
  */
 
-static int
-cache_write_string(FILE *fp, string_ty *s)
+static void
+cache_write_closure(stracc *sap, string_ty *key, cache_ty *cp)
 {
-    if (fwrite_sane(fp, &s->str_length, sizeof(s->str_length)))
-        return -1;
-    if (fwrite_sane(fp, s->str_text, s->str_length))
-        return -1;
-    return 0;
+    size_t          mark;
+    size_t          j;
+    string_ty       *prev;
+
+    mark = record_begin(sap, 'C');
+    cache_put_string(sap, key);
+    cache_put(sap, &cp->closure_stamp, sizeof(cp->closure_stamp));
+    prev = 0;
+    for (j = 0; j < cp->closure.nstrings; ++j)
+    {
+        string_ty       *s;
+        size_t          keep;
+
+        s = cp->closure.string[j];
+        keep = 0;
+        if (prev)
+        {
+            while
+            (
+                keep < prev->str_length
+            &&
+                keep < s->str_length
+            &&
+                prev->str_text[keep] == s->str_text[keep]
+            )
+                ++keep;
+        }
+        record_put_number(sap, keep);
+        record_put_number(sap, s->str_length - keep);
+        cache_put(sap, s->str_text + keep, s->str_length - keep);
+        prev = s;
+    }
+    record_end(sap, mark);
+}
+
+
+static void
+walk_all(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    cache_ty        *cp;
+
+    (void)stp;
+    cp = data;
+    cache_write_item(arg, key, cp);
+    cache_closure(cp);
+    if (cp->closed)
+        cache_write_closure(arg, key, cp);
+}
+
+
+static void
+walk_dirty(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    cache_ty        *cp;
+
+    (void)stp;
+    cp = data;
+    if (cp->dirty)
+        cache_write_item(arg, key, cp);
+    if (cp->closure_dirty)
+        cache_write_closure(arg, key, cp);
 }
 
 
 /*
  * NAME
- *      cache_write_item - write cache item to cache file
+ *      cache_append - append changes to the cache file
  *
  * SYNOPSIS
- *      int cache_write_item(FILE *fp, cache_ty *cp);
+ *      int cache_append(char *filename, stracc *sap);
  *
  * DESCRIPTION
- *      The cache_write_item function is used to write a cache
- *      item to a cache  file.
- *
- * ARGUMENTS
- *      fp      - file to write
- *      cp      - pointer to cache item to write
+ *      The cache_append function is used to append records to the
+ *      cache file.  The file is opened for appending, and written
+ *      with a single write, so that the records of concurrent
+ *      processes do not overwrite each other.
  *
  * RETURNS
- *      0 on success, -1 on any error
- *
- * CAVEATS
- *      Must be symmetric with cache_read_item above.
+ *      int; 0 on success, -1 if the file no longer exists
  */
 
 static int
-cache_write_item(FILE *fp, string_ty *key, cache_ty *cp)
+cache_append(char *filename, stracc *sap)
 {
-    size_t          j;
+    int             fd;
 
-    if (cache_write_string(fp, key))
-        return -1;
-    if (fwrite_sane(fp, &cp->st, sizeof(cp->st)))
-        return -1;
-    if
-    (
-        fwrite_sane
-        (
-            fp,
-            &cp->ingredients.nstrings,
-            sizeof(cp->ingredients.nstrings)
-        )
-    )
-        return -1;
-    for (j = 0; j < cp->ingredients.nstrings; ++j)
-        if (cache_write_string(fp, cp->ingredients.string[j]))
+    fd = open(filename, O_WRONLY | O_APPEND, 0666);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
             return -1;
+        fatal_intl_open(filename);
+    }
+    if (write_all(fd, sap->sa_buf, sap->sa_len))
+        fatal_intl_write(filename);
+    if (close(fd))
+        fatal_intl_close(filename);
     return 0;
 }
 
 
+/*
+ * NAME
+ *      cache_replace - rewrite the whole cache file
+ *
+ * SYNOPSIS
+ *      void cache_replace(char *filename);
+ *
+ * DESCRIPTION
+ *      The cache_replace function is used to write a complete, compact
+ *      cache file.  It is written to a temporary file first, and then
+ *      renamed into place, so that readers always see either the old
+ *      file or the new one.
+ */
+
 static void
-walk(symtab_ty *stp, string_ty *key, void *data, void *arg)
+cache_replace(char *filename)
 {
-    cache_ty        *cp;
-    FILE            *fp;
-
-    (void)stp;
-    cp = data;
-    fp = arg;
-    cache_write_item(fp, key, cp);
+    stracc          sa;
+
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    cache_put(&sa, magic, sizeof(magic) - 1);
+    symtab_walk(symtab, walk_all, &sa);
+    dircache_write(&sa, 1);
+
+    write_whole_file(filename, sa.sa_buf, sa.sa_len);
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
 }
 
 
@@ -527,8 +761,10 @@ walk(symtab_ty *stp, string_ty *key, void *data, void *arg)
  *      void cache_write(void);
  *
  * DESCRIPTION
- *      The cache_write function is used to write the memory image
- *      of the cache into a disk file.
+ *      The cache_write function is used to publish the changes made to
+ *      the cache by this process, by appending them to the cache file.
+ *      If the file does not exist yet, or needs compacting, it is
+ *      rewritten instead.
  *
  * CAVEATS
  *      The cache file is in the current directory.
@@ -537,69 +773,64 @@ walk(symtab_ty *stp, string_ty *key, void *data, void *arg)
 void
 cache_write(void)
 {
-    FILE            *fp;
+    stracc          sa;
     char            *filename;
+    int             changed;
 
     /*
+     * collect the records which have changed;
      * don't change the file if we don't have to
      */
-    if (!need_to_write)
-        return;
-    need_to_write = 0;
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    symtab_walk(symtab, walk_dirty, &sa);
+    dircache_write(&sa, 0);
+    changed = (sa.sa_len != 0);
 
-    /*
-     * open the cache file
-     */
     filename = build_filename();
-    fp = fopen_and_check(filename, "wb");
-
-    /*
-     * Take an exclusive lock: only one process may take the lock at
-     * a time.  (Potentially, we can miss updates if there are
-     * several parallel updates.  We will simply do them again, next
-     * time.)
-     */
-    flock_exclusive(fileno(fp), filename);
-
-    /*
-     * write the number of entries to the file
-     */
-    if (fwrite_sane(fp, &symtab->hash_load, sizeof(symtab->hash_load)))
-        fatal_intl_write(filename);
+    if (changed && (need_to_compact || cache_append(filename, &sa)))
+        cache_replace(filename);
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+}
 
-    /*
-     * write each cache entry to the file
-     */
-    symtab_walk(symtab, walk, fp);
-    fflush_and_check(fp, filename);
 
-    /*
-     * Release the file lock.
-     */
-    flock_release(fileno(fp), filename);
+/*
+ * NAME
+ *      cache_update_notify - cache has changed
+ *
+ * SYNOPSIS
+ *      void cache_update_notify(cache_ty *cp);
+ *
+ * DESCRIPTION
+ *      The cache_update_notify function is called whenever the contents
+ *      of a cache entry is changed.  This notifies the cache_write
+ *      function that it needs to write the entry to the cache file.
+ */
 
-    /*
-     * close the cache file
-     */
-    fclose_and_check(fp, filename);
+void
+cache_update_notify(cache_ty *cp)
+{
+    cp->dirty = 1;
 }
 
 
 /*
  * NAME
- *      cache_update_notify - cache has changed
+ *      cache_closure_notify - closure has changed
  *
  * SYNOPSIS
- *      void cache_update_nitify(void);
+ *      void cache_closure_notify(cache_ty *cp);
  *
  * DESCRIPTION
- *      The cache_update_notify function is called whenever the contents
- *      of the cache is changed.  This notifies the cache_write function
- *      that it needs to rewrite the cache file.
+ *      The cache_closure_notify function is called whenever the closure
+ *      of a cache entry is changed, so that cache_write will write it
+ *      to the cache file.
  */
 
 void
-cache_update_notify(void)
+cache_closure_notify(cache_ty *cp)
 {
-    need_to_write = 1;
+    cp->closure_dirty = 1;
 }
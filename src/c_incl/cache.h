@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1991-1994, 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1991-1994, 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -20,23 +20,44 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include <common/ac/stddef.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #include <common/main.h>
+#include <common/record.h>
 #include <common/str_list.h>
+#include <common/stracc.h>
 
 typedef struct cache_ty cache_ty;
 struct cache_ty
 {
         struct stat     st;
         string_list_ty  ingredients;
+        size_t          size;           /* of record in cache file      */
+        string_list_ty  closure;        /* transitive ingredients       */
+        unsigned long   closure_stamp;  /* of the members' stat info    */
+        int             closed;         /* closure is known             */
+        const char      *closure_record; /* closure not yet decoded     */
+        size_t          closure_len;
+        unsigned long   closure_sum;
+        int             dirty;
+        int             closure_dirty;
+
+        /* these are not saved in the cache file */
+        int             checked;        /* stat checked during this run */
 };
 
 void cache_initialize(void);
 cache_ty *cache_search(string_ty *filename);
 void cache_read(void);
 void cache_write(void);
-void cache_update_notify(void);
+void cache_update_notify(cache_ty *);
+string_list_ty *cache_closure(cache_ty *);
+void cache_closure_notify(cache_ty *);
+
+string_ty *cache_get_string(record_reader_ty *);
+void cache_put(stracc *, const void *, size_t);
+void cache_put_string(stracc *, string_ty *);
 
 #endif /* CACHE_H */
@@ -0,0 +1,477 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * The directory cache remembers which names are present and which are
+ * absent in each directory consulted while resolving include files.
+ * Most include directories are searched for most include files, and
+ * most of those searches fail, so this saves a great many stat calls.
+ *
+ * A directory's modification time changes whenever a name is added to
+ * or removed from it, so the remembered names are only trusted for as
+ * long as the directory's stat information is unchanged.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/string.h>
+#include <common/ac/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <c_incl/cache.h>
+#include <c_incl/dircache.h>
+#include <c_incl/os_interface.h>
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+
+typedef struct dircache_ty dircache_ty;
+struct dircache_ty
+{
+    struct stat     st;
+    time_t          when;
+    symtab_ty       *names;
+    size_t          size;
+    int             dirty;
+};
+
+static symtab_ty *dirs;
+static char     present;
+static char     absent;
+
+
+static void
+reap(void *p)
+{
+    dircache_ty     *dp;
+
+    dp = p;
+    symtab_free(dp->names);
+    mem_free(dp);
+}
+
+
+/*
+ * NAME
+ *      dir_find - find directory cache entry
+ *
+ * SYNOPSIS
+ *      dircache_ty *dir_find(string_ty *dirname);
+ *
+ * DESCRIPTION
+ *      The dir_find function is used to find the cache entry for the
+ *      named directory.  An empty entry is created if there is not one
+ *      already.
+ *
+ * RETURNS
+ *      dircache_ty *; pointer to the entry
+ */
+
+static dircache_ty *
+dir_find(string_ty *dirname)
+{
+    dircache_ty     *dp;
+
+    if (!dirs)
+    {
+        dirs = symtab_alloc(100);
+        dirs->reap = reap;
+    }
+    dp = symtab_query(dirs, dirname);
+    if (!dp)
+    {
+        dp = mem_alloc(sizeof(dircache_ty));
+        memset(&dp->st, 0, sizeof(dp->st));
+        dp->when = 0;
+        dp->names = symtab_alloc(10);
+        dp->size = 0;
+        dp->dirty = 0;
+        symtab_assign(dirs, dirname, dp);
+    }
+    return dp;
+}
+
+
+/*
+ * NAME
+ *      stat_same - compare directory stat structures
+ *
+ * SYNOPSIS
+ *      int stat_same(struct stat *, struct stat *);
+ *
+ * DESCRIPTION
+ *      The stat_same function is used to compare two stat structures
+ *      of a directory.  Only those fields which change when a name is
+ *      added to or removed from the directory are examined.
+ */
+
+static int
+stat_same(struct stat *st1, struct stat *st2)
+{
+    return
+    (
+        st1->st_mode == st2->st_mode
+    &&
+        st1->st_dev == st2->st_dev
+    &&
+        st1->st_ino == st2->st_ino
+    &&
+        st1->st_mtime == st2->st_mtime
+    &&
+        st1->st_ctime == st2->st_ctime
+    );
+}
+
+
+/*
+ * NAME
+ *      dir_validate - check directory cache entry
+ *
+ * SYNOPSIS
+ *      void dir_validate(string_ty *dirname, dircache_ty *dp);
+ *
+ * DESCRIPTION
+ *      The dir_validate function is used to check a directory cache
+ *      entry against the file system, the first time it is used in
+ *      this run.  If the directory has changed, the names remembered
+ *      for it are discarded.
+ */
+
+static void
+dir_validate(string_ty *dirname, dircache_ty *dp)
+{
+    struct stat     st;
+
+    if (dp->when)
+        return;
+    dp->when = time((time_t *)0);
+    if (stat(dirname->str_text, &st))
+    {
+        switch (errno)
+        {
+        case ENOENT:
+        case ENOTDIR:
+            break;
+
+        default:
+            fatal_intl_stat(dirname->str_text);
+            /* NOTREACHED */
+        }
+        memset(&st, 0, sizeof(st));
+    }
+    if (!stat_same(&st, &dp->st))
+    {
+        trace(("directory \"%s\" changed\n", dirname->str_text));
+        dp->st = st;
+        symtab_free(dp->names);
+        dp->names = symtab_alloc(10);
+        dp->dirty = 1;
+    }
+}
+
+
+/*
+ * NAME
+ *      dircache_exists - tests for the existence of a file
+ *
+ * SYNOPSIS
+ *      int dircache_exists(string_ty *path);
+ *
+ * DESCRIPTION
+ *      The dircache_exists function is used to test for the existence
+ *      of a file, in the same way as os_exists, but the answer is
+ *      remembered against the file's directory.
+ *
+ * RETURNS
+ *      int; 1 if the file exists, 0 if it does not.
+ */
+
+int
+dircache_exists(string_ty *path)
+{
+    char            *slash;
+    string_ty       *dirname;
+    string_ty       *basename;
+    dircache_ty     *dp;
+    char            *flag;
+    int             result;
+
+    trace(("dircache_exists(path = \"%s\")\n{\n", path->str_text));
+    slash = strrchr(path->str_text, '/');
+    if (!slash)
+    {
+        dirname = str_from_c(".");
+        basename = str_copy(path);
+    }
+    else
+    {
+        if (slash == path->str_text)
+            dirname = str_from_c("/");
+        else
+            dirname = str_n_from_c(path->str_text, slash - path->str_text);
+        basename = str_from_c(slash + 1);
+    }
+
+    dp = dir_find(dirname);
+    dir_validate(dirname, dp);
+    if (!basename->str_length)
+        result = os_exists(path->str_text);
+    else if (!S_ISDIR(dp->st.st_mode))
+        result = 0;
+    else
+    {
+        flag = symtab_query(dp->names, basename);
+        if (flag)
+            result = (flag == &present);
+        else
+        {
+            result = os_exists(path->str_text);
+            symtab_assign(dp->names, basename, result ? &present : &absent);
+            dp->dirty = 1;
+        }
+    }
+    str_free(dirname);
+    str_free(basename);
+    trace(("return %d;\n", result));
+    trace(("}\n"));
+    return result;
+}
+
+
+/*
+ * NAME
+ *      dircache_count - number of directories
+ *
+ * SYNOPSIS
+ *      size_t dircache_count(void);
+ *
+ * DESCRIPTION
+ *      The dircache_count function is used to obtain the number of
+ *      directories in the directory cache.
+ */
+
+size_t
+dircache_count(void)
+{
+    return (dirs ? dirs->hash_load : 0);
+}
+
+
+static void
+add_size(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    dircache_ty     *dp;
+
+    (void)stp;
+    (void)key;
+    dp = data;
+    *(size_t *)arg += dp->size;
+}
+
+
+/*
+ * NAME
+ *      dircache_size - size of directory records
+ *
+ * SYNOPSIS
+ *      size_t dircache_size(void);
+ *
+ * DESCRIPTION
+ *      The dircache_size function is used to obtain the total size of
+ *      the latest cache file record read for each directory, so that
+ *      the cache file can tell how much of it is still live.
+ */
+
+size_t
+dircache_size(void)
+{
+    size_t          size;
+
+    size = 0;
+    if (dirs)
+        symtab_walk(dirs, add_size, &size);
+    return size;
+}
+
+
+/*
+ * NAME
+ *      dircache_read - read a directory cache record
+ *
+ * SYNOPSIS
+ *      int dircache_read(record_reader_ty *rp);
+ *
+ * DESCRIPTION
+ *      The dircache_read function is used to read a directory from a
+ *      cache file record, replacing anything already known about it.
+ *
+ * RETURNS
+ *      0 on success, -1 on any error
+ *
+ * CAVEATS
+ *      Must be symmetric with dircache_write_item below.
+ */
+
+int
+dircache_read(record_reader_ty *rp)
+{
+    size_t          nnames;
+    size_t          k;
+    string_ty       *s;
+    dircache_ty     *dp;
+    char            c;
+
+    s = cache_get_string(rp);
+    if (!s)
+        return -1;
+    dp = dir_find(s);
+    str_free(s);
+    symtab_free(dp->names);
+    dp->names = symtab_alloc(10);
+    dp->size = rp->len;
+    if (record_get(rp, &dp->st, sizeof(dp->st)))
+        return -1;
+    if (record_get(rp, &nnames, sizeof(nnames)))
+        return -1;
+    for (k = 0; k < nnames; ++k)
+    {
+        s = cache_get_string(rp);
+        if (!s)
+            return -1;
+        if (record_get(rp, &c, 1))
+        {
+            str_free(s);
+            return -1;
+        }
+        symtab_assign(dp->names, s, c ? &present : &absent);
+        str_free(s);
+    }
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      trustworthy - check directory may be written
+ *
+ * SYNOPSIS
+ *      int trustworthy(dircache_ty *dp);
+ *
+ * DESCRIPTION
+ *      The trustworthy function is used to decide whether a directory
+ *      cache entry may be written to the cache file.  A directory
+ *      changed in the same second as it was examined could change
+ *      again without its modification time changing, so such entries
+ *      are only believed for the current run.
+ */
+
+static int
+trustworthy(dircache_ty *dp)
+{
+    if (!dp->when)
+        return 1;
+    return (dp->st.st_mtime < dp->when && dp->st.st_ctime < dp->when);
+}
+
+
+static void
+walk_name(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    stracc          *sap;
+    char            c;
+
+    (void)stp;
+    sap = arg;
+    c = (data == &present);
+    cache_put_string(sap, key);
+    cache_put(sap, &c, 1);
+}
+
+
+/*
+ * NAME
+ *      dircache_write_item - write a directory cache record
+ *
+ * SYNOPSIS
+ *      void dircache_write_item(stracc *sap, string_ty *dirname,
+ *              dircache_ty *dp);
+ *
+ * DESCRIPTION
+ *      The dircache_write_item function is used to append a record
+ *      for a directory.
+ *
+ * CAVEATS
+ *      Must be symmetric with dircache_read above.
+ */
+
+static void
+dircache_write_item(stracc *sap, string_ty *dirname, dircache_ty *dp)
+{
+    size_t          mark;
+    size_t          nnames;
+
+    mark = record_begin(sap, 'D');
+    cache_put_string(sap, dirname);
+    cache_put(sap, &dp->st, sizeof(dp->st));
+    nnames = dp->names->hash_load;
+    cache_put(sap, &nnames, sizeof(nnames));
+    symtab_walk(dp->names, walk_name, sap);
+    record_end(sap, mark);
+}
+
+
+static void
+walk_all(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    (void)stp;
+    if (trustworthy(data))
+        dircache_write_item(arg, key, data);
+}
+
+
+static void
+walk_dirty(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    dircache_ty     *dp;
+
+    (void)stp;
+    dp = data;
+    if (dp->dirty && trustworthy(dp))
+        dircache_write_item(arg, key, dp);
+}
+
+
+/*
+ * NAME
+ *      dircache_write - write the directory cache
+ *
+ * SYNOPSIS
+ *      void dircache_write(stracc *sap, int all);
+ *
+ * DESCRIPTION
+ *      The dircache_write function is used to append records for the
+ *      directory cache.  If all is false, only those directories which
+ *      have changed are written.
+ */
+
+void
+dircache_write(stracc *sap, int all)
+{
+    if (dirs)
+        symtab_walk(dirs, (all ? walk_all : walk_dirty), sap);
+}
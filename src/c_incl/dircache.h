@@ -0,0 +1,31 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef C_INCL_DIRCACHE_H
+#define C_INCL_DIRCACHE_H
+
+#include <c_incl/cache.h>
+
+int dircache_exists(string_ty *path);
+size_t dircache_count(void);
+size_t dircache_size(void);
+int dircache_read(record_reader_ty *);
+void dircache_write(stracc *, int);
+
+#endif /* C_INCL_DIRCACHE_H */
@@ -20,9 +20,8 @@
 #include <common/ac/ctype.h>
 #include <common/ac/string.h>
 
-#include <common/input.h>
+#include <common/input/lines.h>
 #include <c_incl/lang_c.h>
-#include <common/mem.h>
 #include <common/str_list.h>
 #include <common/trace.h>
 
@@ -157,57 +156,18 @@ directive(char *s, string_list_ty * type1, string_list_ty * type2)
 static int
 lang_c_scan(input_ty *fp, string_list_ty *type1, string_list_ty *type2)
 {
-    size_t          pos;
-    size_t          max;
+    input_lines_ty  *ilp;
     char            *line;
-    int             result;
-    int             c;
-    char            *cp;
 
     trace(("lang_c_scan(fp = %p, type1 = %p, type2 = %p)\n{\n", fp, type1,
         type2));
-    pos = 0;
-    max = 100;
-    line = mem_alloc(max);
-    result = 0;
-    for (;;)
-    {
-        if (pos >= max)
-        {
-            max += 80;
-            line = mem_change_size(line, max);
-        }
-        c = input_getc(fp);
-        switch (c)
-        {
-        case INPUT_EOF:
-            if (!pos)
-                break;
-            /* fall through... */
-
-        case '\n':
-            line[pos] = 0;
-            pos = 0;
-
-            /*
-             * see if it is a hash line
-             */
-            for (cp = line; isspace(*cp); ++cp)
-                ;
-            if (*cp == '#')
-                directive(cp, type1, type2);
-            continue;
-
-        default:
-            line[pos++] = c;
-            continue;
-        }
-        break;
-    }
-    mem_free(line);
-    trace(("return %d;\n", result));
+    ilp = input_lines_new(fp, "#", 1);
+    while ((line = input_lines_next(ilp)) != 0)
+        directive(line, type1, type2);
+    input_lines_delete(ilp);
+    trace(("return 0;\n"));
     trace(("}\n"));
-    return result;
+    return 0;
 }
 
 
@@ -29,8 +29,10 @@
 #include <common/mem.h>
 #include <common/os_path_cat.h>
 #include <common/str_list.h>
+#include <common/symtab.h>
 #include <common/trace.h>
 #include <c_incl/cache.h>
+#include <c_incl/dircache.h>
 #include <c_incl/flatten.h>
 #include <c_incl/os_interface.h>
 #include <c_incl/sniff.h>
@@ -50,7 +52,10 @@ static  long            pcount;
 static  string_list_ty  srl1;
 static  string_list_ty  srl2;
 static  string_list_ty  use_these;
-static  string_list_ty  visited;
+static  symtab_ty       *use_these_stp;
+static  symtab_ty       *resolved;
+static  symtab_ty       *visited;
+static  string_list_ty  *walked;
 static  string_list_ty  remove_path;
 static  string_list_ty  exclude;
 static  sniff_ty        *lang;
@@ -69,6 +74,72 @@ interrupt(int n)
 }
 
 
+/*
+ * NAME
+ *      use_this - check the use-these list
+ *
+ * SYNOPSIS
+ *      int use_this(string_ty *path);
+ *
+ * DESCRIPTION
+ *      The use_this function is used to test whether a path was named
+ *      by a -Include_Is_Here option.  The list is indexed on first
+ *      use, rather than being scanned for every candidate path.
+ */
+
+static int
+use_this(string_ty *path)
+{
+    size_t          j;
+
+    if (!use_these.nstrings)
+        return 0;
+    if (!use_these_stp)
+    {
+        use_these_stp = symtab_alloc(use_these.nstrings);
+        for (j = 0; j < use_these.nstrings; ++j)
+        {
+            symtab_assign
+            (
+                use_these_stp,
+                use_these.string[j],
+                use_these.string[j]
+            );
+        }
+    }
+    return (symtab_query(use_these_stp, path) != 0);
+}
+
+
+/*
+ * NAME
+ *      resolve_forget - discard resolutions
+ *
+ * SYNOPSIS
+ *      void resolve_forget(void);
+ *
+ * DESCRIPTION
+ *      The resolve_forget function is used to discard remembered
+ *      include file resolutions, and the use-these index, when the
+ *      options they depend on change.
+ */
+
+static void
+resolve_forget(void)
+{
+    if (use_these_stp)
+    {
+        symtab_free(use_these_stp);
+        use_these_stp = 0;
+    }
+    if (resolved)
+    {
+        symtab_free(resolved);
+        resolved = 0;
+    }
+}
+
+
 void
 sniff_language(sniff_ty *lp)
 {
@@ -101,6 +172,7 @@ sniff_include(char *path)
 
     assert(path);
     trace(("sniff_include(path = \"%s\")\n{\n", path));
+    resolve_forget();
     s = str_from_c(path);
     string_list_append_unique(&srl1, s);
     string_list_append_unique(&srl2, s);
@@ -113,6 +185,7 @@ void
 sniff_include_cut(void)
 {
     trace(("sniff_include_cut()\n{\n"));
+    resolve_forget();
     string_list_destructor(&srl2);
     trace(("}\n"));
 }
@@ -150,6 +223,7 @@ sniff_use_this(char *path)
 
     assert(path);
     trace(("sniff_use_this(path = \"%s\")\n{\n", path));
+    resolve_forget();
     s = str_from_c(path);
     string_list_append_unique(&use_these, s);
     str_free(s);
@@ -161,6 +235,7 @@ void
 sniff_use_this_cut(void)
 {
     trace(("sniff_use_this_cut()\n{\n"));
+    resolve_forget();
     string_list_destructor(&use_these);
     trace(("}\n"));
 }
@@ -200,15 +275,15 @@ sniff_prepare(void)
 
 /*
  * NAME
- *      resolve
+ *      resolve_search
  *
  * SYNOPSIS
- *      string_ty *resolve(string_ty *filename, string_ty *extra,
+ *      string_ty *resolve_search(string_ty *filename, string_ty *extra,
  *              string_list_ty *srl);
  *
  * DESCRIPTION
- *      The resolve function is used to resolve an include
- *      filename into the path of an existing file.
+ *      The resolve_search function is used to search for an include
+ *      filename along a search list.
  *
  * ARGUMENTS
  *      filename - name to be resolved
@@ -216,12 +291,11 @@ sniff_prepare(void)
  *      srl     - search list
  *
  * RETURNS
- *      string_ty *; name of path, or NULL if unmentionable
+ *      string_ty *; name of path, or NULL if not found
  */
 
-
 static string_ty *
-resolve(string_ty *filename, string_ty *extra, string_list_ty *srl, int flags)
+resolve_search(string_ty *filename, string_ty *extra, string_list_ty *srl)
 {
     string_ty       *s;
     size_t          j;
@@ -232,16 +306,15 @@ resolve(string_ty *filename, string_ty *extra, string_list_ty *srl, int flags)
      * If the name is absolute, irrespecitive of
      * which style, we need look no further.
      */
-    trace(("resolve(filename = \"%s\", extra = \"%s\")\n{\n",
-        filename->str_text, extra ? extra->str_text : "NULL"));
     if (filename->str_text[0] == '/')
     {
         result = flatten(filename);
-        if (os_exists(result->str_text))
-            goto done;
-        if (string_list_member(&use_these, result))
-            goto done;
-        goto dilema;
+        if (dircache_exists(result))
+            return result;
+        if (use_this(result))
+            return result;
+        str_free(result);
+        return 0;
     }
 
     /*
@@ -257,10 +330,10 @@ resolve(string_ty *filename, string_ty *extra, string_list_ty *srl, int flags)
         sub_var_set_string(scp, "File_Name", result);
         verbose_intl(scp, i18n("may need to look at \"$filename\" file"));
         sub_context_delete(scp);
-        if (os_exists(result->str_text))
-            goto done;
-        if (string_list_member(&use_these, result))
-            goto done;
+        if (dircache_exists(result))
+            return result;
+        if (use_this(result))
+            return result;
         str_free(result);
     }
 
@@ -276,18 +349,99 @@ resolve(string_ty *filename, string_ty *extra, string_list_ty *srl, int flags)
         sub_var_set_string(scp, "File_Name", result);
         verbose_intl(scp, i18n("may need to look at \"$filename\" file"));
         sub_context_delete(scp);
-        if (os_exists(result->str_text))
-                goto done;
-        if (string_list_member(&use_these, result))
-                goto done;
+        if (dircache_exists(result))
+            return result;
+        if (use_this(result))
+            return result;
         str_free(result);
     }
+    return 0;
+}
+
+
+static void
+reap_resolved(void *p)
+{
+    str_free(p);
+}
+
+
+/*
+ * NAME
+ *      resolve
+ *
+ * SYNOPSIS
+ *      string_ty *resolve(string_ty *filename, string_ty *extra,
+ *              string_list_ty *srl);
+ *
+ * DESCRIPTION
+ *      The resolve function is used to resolve an include
+ *      filename into the path of an existing file.
+ *
+ *      The same include file is usually named by many files, so each
+ *      search is remembered, keyed by search list, extra directory
+ *      and filename.  Searches which failed are remembered too.
+ *
+ * ARGUMENTS
+ *      filename - name to be resolved
+ *      extra   - extra first search element, if not NULL
+ *      srl     - search list
+ *
+ * RETURNS
+ *      string_ty *; name of path, or NULL if unmentionable
+ */
+
+static string_ty *
+resolve(string_ty *filename, string_ty *extra, string_list_ty *srl, int flags)
+{
+    string_ty       *s;
+    string_ty       *key;
+    string_ty       *result;
+    sub_context_ty  *scp;
+
+    trace(("resolve(filename = \"%s\", extra = \"%s\")\n{\n",
+        filename->str_text, extra ? extra->str_text : "NULL"));
+    if (!resolved)
+    {
+        resolved = symtab_alloc(100);
+        resolved->reap = reap_resolved;
+    }
+
+    /*
+     * The key must distinguish the search lists, and must not be
+     * ambiguous where the extra directory ends and the filename
+     * starts.  A failed search is remembered as the empty string.
+     */
+    key =
+        str_format
+        (
+            "%d %ld %s%s",
+            (srl == &srl1),
+            extra ? (long)extra->str_length : -1L,
+            extra ? extra->str_text : "",
+            filename->str_text
+        );
+    result = symtab_query(resolved, key);
+    if (result)
+        result = result->str_length ? str_copy(result) : 0;
+    else
+    {
+        result = resolve_search(filename, extra, srl);
+        symtab_assign
+        (
+            resolved,
+            key,
+            result ? str_copy(result) : str_from_c("")
+        );
+    }
+    str_free(key);
+    if (result)
+        goto done;
 
     /*
      * not found, must have been ifdef'ed out
      * or needs to be built
      */
-    dilema:
     switch (flags)
     {
     default:
@@ -447,26 +601,23 @@ exclude_error(string_ty *includer, string_ty *includee)
 
 /*
  * NAME
- *      sniffer - search file for include dependencies
+ *      refresh - bring a cache entry up to date
  *
  * SYNOPSIS
- *      void sniffer(string_ty *pathname);
+ *      cache_ty *refresh(string_ty *filename);
  *
  * DESCRIPTION
- *      The sniffer function is used to walk a file looking
- *      for any files which it includes, and walking then also.
- *      The names of any include files encountered are printed onto
- *      the standard output.
- *
- * ARGUMENTS
- *      pathname        - pathname to read
+ *      The refresh function is used to find the cache entry for a
+ *      file, and to rescan the file for its direct ingredients if its
+ *      stat information has changed since the entry was made.  Each
+ *      file is only checked once per run.
  *
- * CAVEATS
- *      Uses the cache where possible to speed things up.
+ * RETURNS
+ *      cache_ty *; the up-to-date cache entry.
  */
 
-static void
-sniffer(string_ty *filename, int prnam, string_list_ty *result)
+static cache_ty *
+refresh(string_ty *filename)
 {
     input_ty        *fp;
     cache_ty        *cp;
@@ -475,14 +626,9 @@ sniffer(string_ty *filename, int prnam, string_list_ty *result)
     sub_context_ty  *scp;
     static string_ty *dash;
 
-    trace(("sniffer(filename = \"%s\")\n{\n", filename->str_text));
+    trace(("refresh(filename = \"%s\")\n{\n", filename->str_text));
     if (!dash)
         dash = str_from_c("-");
-    if (prnam)
-    {
-        print_without_prefix(filename, result);
-        ++pcount;
-    }
 
     /*
      * find the file in the cache
@@ -490,6 +636,12 @@ sniffer(string_ty *filename, int prnam, string_list_ty *result)
      */
     cp = cache_search(filename);
     assert(cp);
+    if (cp->checked)
+    {
+        trace(("}\n"));
+        return cp;
+    }
+    cp->checked = 1;
     if (str_equal(filename, dash))
         memset(&st, -1, sizeof(st));
     else if (stat(filename->str_text, &st) < 0)
@@ -524,12 +676,13 @@ sniffer(string_ty *filename, int prnam, string_list_ty *result)
          */
         memset(&cp->st, 0, sizeof(cp->st));
         string_list_destructor(&cp->ingredients);
-        cache_update_notify();
+        cache_update_notify(cp);
         scp = sub_context_new();
         sub_var_set_string(scp, "File_Name", filename);
         verbose_intl(scp, i18n("bogus empty \"$filename\" file"));
         sub_context_delete(scp);
-        goto done;
+        trace(("}\n"));
+        return cp;
     }
 
     /*
@@ -543,7 +696,7 @@ sniffer(string_ty *filename, int prnam, string_list_ty *result)
 
         cp->st = st;
         string_list_destructor(&cp->ingredients);
-        cache_update_notify();
+        cache_update_notify(cp);
         scp = sub_context_new();
         sub_var_set_string(scp, "File_Name", filename);
         verbose_intl(scp, i18n("cache miss for \"$filename\" file"));
@@ -644,32 +797,219 @@ sniffer(string_ty *filename, int prnam, string_list_ty *result)
         string_list_destructor(&type2);
     }
 
+    trace(("}\n"));
+    return cp;
+}
+
+
+/*
+ * NAME
+ *      closure_stamp - summarize stat information
+ *
+ * SYNOPSIS
+ *      unsigned long closure_stamp(cache_ty *cp, string_list_ty *slp);
+ *
+ * DESCRIPTION
+ *      The closure_stamp function is used to combine the stat
+ *      information of a file and of each member of its closure into a
+ *      single number.  Only the fields examined by stat_equal are used.
+ *      Every member must already have been refreshed.
+ *
+ *      Since a file is only rescanned when its stat information
+ *      changes, a closure remains correct for as long as the stamp
+ *      worked out for it still matches.
+ */
+
+static unsigned long
+closure_stamp(cache_ty *cp, string_list_ty *slp)
+{
+    unsigned long   h;
+    size_t          j;
+
+    h = 2166136261uL;
+    for (j = 0; ; ++j)
+    {
+        unsigned long   fields[5];
+        size_t          k;
+
+        fields[0] = cp->st.st_dev;
+        fields[1] = cp->st.st_ino;
+        fields[2] = cp->st.st_size;
+        fields[3] = cp->st.st_mtime;
+        fields[4] = cp->st.st_ctime;
+        for (k = 0; k < SIZEOF(fields); ++k)
+            h = (h ^ fields[k]) * 16777619uL;
+        if (j >= slp->nstrings)
+            break;
+        cp = refresh(slp->string[j]);
+    }
+    return h;
+}
+
+
+/*
+ * NAME
+ *      closure_valid - check a remembered closure
+ *
+ * SYNOPSIS
+ *      int closure_valid(cache_ty *cp);
+ *
+ * DESCRIPTION
+ *      The closure_valid function is used to test whether the closure
+ *      remembered for a file may still be used.  This is the case when
+ *      neither the file itself nor any member of its closure has
+ *      changed since the closure was worked out.  Each member is
+ *      checked, but none are walked.
+ */
+
+static int
+closure_valid(cache_ty *cp)
+{
+    string_list_ty  *slp;
+
+    slp = cache_closure(cp);
+    if (!cp->closed)
+        return 0;
+    return (closure_stamp(cp, slp) == cp->closure_stamp);
+}
+
+
+/*
+ * NAME
+ *      mark_visited - remember a file has been seen
+ *
+ * SYNOPSIS
+ *      void mark_visited(string_ty *filename);
+ *
+ * DESCRIPTION
+ *      The mark_visited function is used to remember that a file has
+ *      been seen, so that it will not be walked or printed again.
+ */
+
+static void
+mark_visited(string_ty *filename)
+{
+    if (!visited)
+        visited = symtab_alloc(100);
+    symtab_assign(visited, filename, filename);
+}
+
+
+static int
+was_visited(string_ty *filename)
+{
+    return (visited && symtab_query(visited, filename));
+}
+
+
+static void
+visit(string_ty *filename, string_list_ty *result)
+{
+    print_without_prefix(filename, result);
+    ++pcount;
+    if (walked)
+        string_list_append(walked, filename);
+}
+
+
+/*
+ * NAME
+ *      sniffer - search file for include dependencies
+ *
+ * SYNOPSIS
+ *      void sniffer(string_ty *pathname);
+ *
+ * DESCRIPTION
+ *      The sniffer function is used to walk a file looking
+ *      for any files which it includes, and walking then also.
+ *      The names of any include files encountered are printed onto
+ *      the standard output.
+ *
+ * ARGUMENTS
+ *      pathname        - pathname to read
+ *
+ * CAVEATS
+ *      Uses the cache where possible to speed things up.
+ */
+
+static void
+sniffer(string_ty *filename, int prnam, string_list_ty *result)
+{
+    cache_ty        *cp;
+    size_t          j;
+
+    trace(("sniffer(filename = \"%s\")\n{\n", filename->str_text));
+    if (prnam)
+        visit(filename, result);
+    cp = refresh(filename);
+
     /*
      * work down the ingredients list
      * to see if there are more dependencies
      */
-    string_list_append_unique(&visited, filename);
+    mark_visited(filename);
     for (j = 0; j < cp->ingredients.nstrings && !interrupted; ++j)
     {
         string_ty       *s;
 
         s = cp->ingredients.string[j];
-        if (!string_list_member(&visited, s))
+        if (!was_visited(s))
         {
             if (option.recursive)
                 sniffer(s, 1, result);
             else
-            {
-                print_without_prefix(s, result);
-                ++pcount;
-            }
+                visit(s, result);
         }
     }
+    trace(("}\n"));
+}
 
-    /*
-     * here for all exits
-     */
-    done:
+
+/*
+ * NAME
+ *      sniff_closure - recursive search, using the cache
+ *
+ * SYNOPSIS
+ *      void sniff_closure(string_ty *pathname, string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The sniff_closure function is used to find all of the files a
+ *      file includes, directly or indirectly.  The answer is remembered
+ *      in the cache, and while none of its members has changed, it is
+ *      used as is: each member is only checked, not walked.
+ */
+
+static void
+sniff_closure(string_ty *filename, string_list_ty *result)
+{
+    cache_ty        *cp;
+    string_list_ty  order;
+    size_t          j;
+
+    trace(("sniff_closure(filename = \"%s\")\n{\n", filename->str_text));
+    cp = refresh(filename);
+    if (closure_valid(cp))
+    {
+        for (j = 0; j < cp->closure.nstrings; ++j)
+            visit(cp->closure.string[j], result);
+        trace(("}\n"));
+        return;
+    }
+
+    string_list_constructor(&order);
+    walked = &order;
+    sniffer(filename, 0, result);
+    walked = 0;
+    if (!interrupted)
+    {
+        string_list_destructor(cache_closure(cp));
+        cp->closure = order;
+        cp->closure_stamp = closure_stamp(cp, &cp->closure);
+        cp->closed = 1;
+        cache_closure_notify(cp);
+    }
+    else
+        string_list_destructor(&order);
     trace(("}\n"));
 }
 
@@ -853,7 +1193,10 @@ sniff(char *filename)
     }
 
     string_list_constructor(&result);
-    sniffer(s, 0, &result);
+    if (option.recursive && strcmp(s->str_text, "-"))
+        sniff_closure(s, &result);
+    else
+        sniffer(s, 0, &result);
     str_free(s);
     if (result.nstrings)
     {
@@ -0,0 +1,292 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * An arena (or region) is a pool of memory from which many small
+ * objects are allocated, and which is released all at once.  There is
+ * no way to free an individual object.  This suits data structures,
+ * such as the dependency graph, which are built up piece by piece and
+ * then discarded as a whole.
+ */
+
+#include <common/ac/string.h>
+
+#include <common/arena.h>
+#include <common/mem.h>
+#include <common/trace.h>
+
+
+/*
+ * Every allocation is rounded up to a multiple of this type's size,
+ * so that any object may be placed in the arena.
+ */
+typedef union arena_align_ty arena_align_ty;
+union arena_align_ty
+{
+    long            l;
+    double          d;
+    void            *p;
+};
+
+#define ALIGN sizeof(arena_align_ty)
+#define ROUND_UP(n) (((n) + ALIGN - 1) / ALIGN * ALIGN)
+
+struct arena_chunk_ty
+{
+    arena_chunk_ty  *next;
+    size_t          size;
+    size_t          used;
+    arena_align_ty  data[1];
+};
+
+#define CHUNK_DATA(cp) ((char *)(cp)->data)
+
+
+/*
+ * NAME
+ *      arena_new
+ *
+ * SYNOPSIS
+ *      arena_ty *arena_new(size_t chunk_size);
+ *
+ * DESCRIPTION
+ *      The arena_new function is used to allocate a new, empty arena
+ *      in dynamic memory.  Memory is obtained from the system in
+ *      chunks of (at least) the given size.  Zero means use a sensible
+ *      default.
+ *
+ *      It is a macro, which calls arena_new_tag with the name of the
+ *      calling file, so that the chunks are charged to the caller.
+ *
+ * RETURNS
+ *      arena_ty *
+ *
+ * CAVEAT
+ *      Use arena_delete when you are done with it.
+ */
+
+arena_ty *
+arena_new_tag(size_t chunk_size, const char *site)
+{
+    arena_ty        *ap;
+
+    trace(("arena_new(chunk_size = %ld)\n{\n", (long)chunk_size));
+    if (chunk_size < 1024)
+        chunk_size = 64 * 1024;
+    ap = mem_alloc_tag(sizeof(arena_ty), site);
+    ap->chunk = 0;
+    ap->chunk_size = ROUND_UP(chunk_size);
+    ap->nbytes = 0;
+    ap->nallocs = 0;
+    ap->site = site;
+    trace(("return %p;\n", ap));
+    trace(("}\n"));
+    return ap;
+}
+
+
+/*
+ * NAME
+ *      arena_delete
+ *
+ * SYNOPSIS
+ *      void arena_delete(arena_ty *);
+ *
+ * DESCRIPTION
+ *      The arena_delete function is used to release an arena, and all
+ *      of the objects allocated from it.
+ */
+
+void
+arena_delete(arena_ty *ap)
+{
+    trace(("arena_delete(ap = %p)\n{\n", ap));
+    while (ap->chunk)
+    {
+        arena_chunk_ty  *cp;
+
+        cp = ap->chunk;
+        ap->chunk = cp->next;
+        mem_free(cp);
+    }
+    mem_free(ap);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      chunk_new
+ *
+ * SYNOPSIS
+ *      arena_chunk_ty *chunk_new(arena_ty *ap, size_t size);
+ *
+ * DESCRIPTION
+ *      The chunk_new function is used to obtain another chunk of memory
+ *      from the system, with room for at least size bytes of objects.
+ */
+
+static arena_chunk_ty *
+chunk_new(arena_ty *ap, size_t size)
+{
+    arena_chunk_ty  *cp;
+
+    cp = mem_alloc_tag(offsetof(arena_chunk_ty, data) + size, ap->site);
+    cp->next = 0;
+    cp->size = size;
+    cp->used = 0;
+    return cp;
+}
+
+
+/*
+ * NAME
+ *      arena_alloc
+ *
+ * SYNOPSIS
+ *      void *arena_alloc(arena_ty *, size_t nbytes);
+ *
+ * DESCRIPTION
+ *      The arena_alloc function is used to allocate memory from an
+ *      arena.  The memory is not initialized.
+ *
+ * RETURNS
+ *      void *; suitably aligned for any object.
+ *
+ * CAVEAT
+ *      Do not mem_free the result; it is released by arena_delete.
+ */
+
+void *
+arena_alloc(arena_ty *ap, size_t nbytes)
+{
+    arena_chunk_ty  *cp;
+    void            *p;
+
+    if (nbytes < 1)
+        nbytes = 1;
+    nbytes = ROUND_UP(nbytes);
+    ap->nbytes += nbytes;
+    ap->nallocs++;
+
+    cp = ap->chunk;
+    if (cp && cp->size - cp->used >= nbytes)
+    {
+        p = CHUNK_DATA(cp) + cp->used;
+        cp->used += nbytes;
+        return p;
+    }
+
+    if (cp && nbytes > ap->chunk_size / 4)
+    {
+        /*
+         * Large objects get a chunk of their own.  It goes behind the
+         * current chunk, so that the space remaining in the current
+         * chunk is not wasted.
+         */
+        arena_chunk_ty  *big;
+
+        big = chunk_new(ap, nbytes);
+        big->used = nbytes;
+        big->next = cp->next;
+        cp->next = big;
+        return CHUNK_DATA(big);
+    }
+
+    cp = chunk_new(ap, nbytes > ap->chunk_size ? nbytes : ap->chunk_size);
+    cp->next = ap->chunk;
+    ap->chunk = cp;
+    cp->used = nbytes;
+    return CHUNK_DATA(cp);
+}
+
+
+/*
+ * NAME
+ *      arena_alloc_clear
+ *
+ * SYNOPSIS
+ *      void *arena_alloc_clear(arena_ty *, size_t nbytes);
+ *
+ * DESCRIPTION
+ *      The arena_alloc_clear function is used to allocate memory from
+ *      an arena.  The memory is zeroed before it is returned.
+ */
+
+void *
+arena_alloc_clear(arena_ty *ap, size_t nbytes)
+{
+    void            *p;
+
+    p = arena_alloc(ap, nbytes);
+    memset(p, 0, nbytes);
+    return p;
+}
+
+
+/*
+ * NAME
+ *      arena_change_size
+ *
+ * SYNOPSIS
+ *      void *arena_change_size(arena_ty *, void *p, size_t old_size,
+ *              size_t new_size);
+ *
+ * DESCRIPTION
+ *      The arena_change_size function is used to grow an object
+ *      previously allocated from the arena.  The caller must supply
+ *      the old size, because the arena does not remember it.  If the
+ *      object was the most recent allocation it is grown in place,
+ *      otherwise a new object is allocated and the contents copied.
+ *      The old space is not reclaimed until the arena is deleted.
+ *
+ * RETURNS
+ *      void *; pointer to the resized object.
+ */
+
+void *
+arena_change_size(arena_ty *ap, void *p, size_t old_size, size_t new_size)
+{
+    arena_chunk_ty  *cp;
+    void            *p2;
+
+    if (!p)
+        return arena_alloc(ap, new_size);
+    old_size = ROUND_UP(old_size);
+    if (new_size <= old_size)
+        return p;
+    new_size = ROUND_UP(new_size);
+
+    cp = ap->chunk;
+    if
+    (
+        cp
+    &&
+        (char *)p + old_size == CHUNK_DATA(cp) + cp->used
+    &&
+        cp->size - cp->used >= new_size - old_size
+    )
+    {
+        cp->used += new_size - old_size;
+        ap->nbytes += new_size - old_size;
+        return p;
+    }
+
+    p2 = arena_alloc(ap, new_size);
+    memcpy(p2, p, old_size);
+    return p2;
+}
@@ -0,0 +1,49 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include <common/ac/stddef.h>
+#include <common/main.h>
+
+typedef struct arena_chunk_ty arena_chunk_ty;
+
+typedef struct arena_ty arena_ty;
+struct arena_ty
+{
+        arena_chunk_ty  *chunk;         /* most recent chunk first      */
+        size_t          chunk_size;     /* default chunk size           */
+        size_t          nbytes;         /* bytes handed out             */
+        long            nallocs;        /* number of allocations        */
+        const char      *site;          /* charged for the chunks       */
+};
+
+/*
+ * The chunks are charged to the file which created the arena, for the
+ * memory accounting done by common/mem.c, rather than to the arena.
+ */
+arena_ty *arena_new_tag(size_t chunk_size, const char *site);
+#define arena_new(chunk_size) arena_new_tag((chunk_size), __FILE__)
+void arena_delete(arena_ty *);
+void *arena_alloc(arena_ty *, size_t);
+void *arena_alloc_clear(arena_ty *, size_t);
+void *arena_change_size(arena_ty *, void *, size_t, size_t);
+
+#endif /* COMMON_ARENA_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2003, 2007, 2008, 2010 Peter Miller
+ *      Copyright (C) 1999, 2003, 2007, 2008, 2010, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
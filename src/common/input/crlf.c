@@ -78,6 +78,58 @@ get(input_ty *p)
 }
 
 
+static long
+iread(input_ty *p, void *data, long len)
+{
+    input_crlf_ty   *this;
+    char            *buf;
+    long            n;
+    long            j;
+    long            k;
+    int             c;
+
+    /*
+     * Read a block from the deeper stream, and then squeeze out the
+     * CR of each CR LF pair in place.  This is much faster than
+     * reading it a character at a time.
+     */
+    trace(("input_crlf::read()\n{\n"));
+    this = (input_crlf_ty *)p;
+    buf = data;
+    n = input_read(this->fp, buf, len);
+    k = 0;
+    for (j = 0; j < n; ++j)
+    {
+        if (buf[j] == '\r')
+        {
+            if (j + 1 < n)
+            {
+                if (buf[j + 1] == '\n')
+                    continue;
+            }
+            else
+            {
+                /*
+                 * The CR is the last byte of the block, so peek at
+                 * the next character of the deeper stream.
+                 */
+                c = input_getc(this->fp);
+                if (c == '\n')
+                {
+                    buf[k++] = '\n';
+                    continue;
+                }
+                input_ungetc(this->fp, c);
+            }
+        }
+        buf[k++] = buf[j];
+    }
+    trace(("return %ld;\n", k));
+    trace(("}\n"));
+    return k;
+}
+
+
 static string_ty *
 filename(input_ty *p)
 {
@@ -93,7 +145,7 @@ static input_vtbl_ty vtbl =
 {
     sizeof(input_crlf_ty),
     destruct,
-    input_generic_read,
+    iread,
     get,
     filename,
 };
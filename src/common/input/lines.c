@@ -0,0 +1,308 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * Many scanners are only interested in lines which start with a
+ * particular character, such as the '#' of a C preprocessor directive.
+ * Reading such input a character at a time, and collecting every line
+ * just to look at its first character, spends almost all of the time
+ * on lines which are of no interest.  The functions in this file read
+ * the input in large blocks, and use memchr to hop from one candidate
+ * line to the next.
+ */
+
+#include <common/ac/ctype.h>
+#include <common/ac/string.h>
+
+#include <common/input/lines.h>
+#include <common/mem.h>
+#include <common/trace.h>
+
+#define BLOCK_SIZE (1L << 16)
+
+
+/*
+ * NAME
+ *      input_lines_new
+ *
+ * SYNOPSIS
+ *      input_lines_ty *input_lines_new(input_ty *fp,
+ *              const char *introducers, int indented);
+ *
+ * DESCRIPTION
+ *      The input_lines_new function is used to start reading the lines
+ *      of an input stream.  Only lines whose first character is one of
+ *      the introducers are returned.  If indented is true, white space
+ *      before the introducer is permitted.  If introducers is NULL,
+ *      every line is returned.
+ *
+ * RETURNS
+ *      input_lines_ty *; use input_lines_delete when you are done.
+ *
+ * CAVEAT
+ *      The input stream is not deleted by input_lines_delete.
+ */
+
+input_lines_ty *
+input_lines_new(input_ty *fp, const char *introducers, int indented)
+{
+    input_lines_ty  *ilp;
+
+    trace(("input_lines_new(fp = %p)\n{\n", fp));
+    ilp = mem_alloc(sizeof(input_lines_ty));
+    ilp->fp = fp;
+    ilp->introducers = introducers;
+    ilp->indented = indented;
+    ilp->size = BLOCK_SIZE;
+    ilp->buf = mem_alloc(ilp->size + 1);
+    ilp->start = 0;
+    ilp->end = 0;
+    ilp->eof = 0;
+    trace(("return %p;\n", ilp));
+    trace(("}\n"));
+    return ilp;
+}
+
+
+void
+input_lines_delete(input_lines_ty *ilp)
+{
+    trace(("input_lines_delete(ilp = %p)\n{\n", ilp));
+    mem_free(ilp->buf);
+    mem_free(ilp);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      refill
+ *
+ * SYNOPSIS
+ *      void refill(input_lines_ty *);
+ *
+ * DESCRIPTION
+ *      The refill function is used to move the unscanned (partial)
+ *      line to the front of the buffer, and read more input after it.
+ *      The buffer is doubled in size if a single line fills it.
+ */
+
+static void
+refill(input_lines_ty *ilp)
+{
+    long            n;
+
+    if (ilp->start > 0)
+    {
+        memmove(ilp->buf, ilp->buf + ilp->start, ilp->end - ilp->start);
+        ilp->end -= ilp->start;
+        ilp->start = 0;
+    }
+    if (ilp->end >= ilp->size)
+    {
+        ilp->size *= 2;
+        ilp->buf = mem_change_size(ilp->buf, ilp->size + 1);
+    }
+    n = input_read(ilp->fp, ilp->buf + ilp->end, ilp->size - ilp->end);
+    if (n <= 0)
+        ilp->eof = 1;
+    else
+        ilp->end += n;
+}
+
+
+/*
+ * NAME
+ *      next_by_introducer
+ *
+ * SYNOPSIS
+ *      char *next_by_introducer(input_lines_ty *);
+ *
+ * DESCRIPTION
+ *      The next_by_introducer function is used to find the next
+ *      candidate line in the buffer, when there is only one introducer
+ *      character.  The buffer is searched for the introducer, and the
+ *      line around it is only examined when it is found.
+ *
+ * RETURNS
+ *      char *; the candidate line, or NULL if more input is needed
+ *      (or there is no more input).
+ */
+
+static char *
+next_by_introducer(input_lines_ty *ilp)
+{
+    char            *buf;
+    char            *ep;
+    char            *lp;
+    char            *ip;
+    char            *nl;
+
+    buf = ilp->buf;
+    ep = buf + ilp->end;
+    for (;;)
+    {
+        lp = buf + ilp->start;
+        ip = memchr(lp, ilp->introducers[0], ep - lp);
+        if (!ip)
+        {
+            /*
+             * No candidates in the rest of the buffer.  Keep only
+             * the last, partial, line.
+             */
+            if (ilp->eof)
+            {
+                ilp->start = ilp->end;
+                return 0;
+            }
+            for (nl = ep; nl > lp && nl[-1] != '\n'; --nl)
+                ;
+            ilp->start = nl - buf;
+            return 0;
+        }
+
+        /*
+         * Find the start of the line containing the introducer.
+         */
+        for (lp = ip; lp > buf + ilp->start && lp[-1] != '\n'; --lp)
+            ;
+
+        /*
+         * Find the end of the line.
+         */
+        nl = memchr(ip, '\n', ep - ip);
+        if (!nl)
+        {
+            if (!ilp->eof)
+            {
+                ilp->start = lp - buf;
+                return 0;
+            }
+            nl = ep;
+        }
+        ilp->start = (nl < ep ? nl + 1 : nl) - buf;
+
+        /*
+         * It is only a candidate if nothing but white space
+         * precedes the introducer.
+         */
+        if (lp < ip)
+        {
+            if (!ilp->indented)
+                continue;
+            while (lp < ip && isspace((unsigned char)*lp))
+                ++lp;
+            if (lp < ip)
+                continue;
+        }
+        *nl = 0;
+        return ip;
+    }
+}
+
+
+/*
+ * NAME
+ *      next_by_line
+ *
+ * SYNOPSIS
+ *      char *next_by_line(input_lines_ty *);
+ *
+ * DESCRIPTION
+ *      The next_by_line function is used to find the next candidate
+ *      line in the buffer, one line at a time.
+ *
+ * RETURNS
+ *      char *; the candidate line, or NULL if more input is needed
+ *      (or there is no more input).
+ */
+
+static char *
+next_by_line(input_lines_ty *ilp)
+{
+    char            *buf;
+    char            *ep;
+    char            *lp;
+    char            *cp;
+    char            *nl;
+
+    buf = ilp->buf;
+    ep = buf + ilp->end;
+    for (;;)
+    {
+        lp = buf + ilp->start;
+        if (lp >= ep)
+            return 0;
+        nl = memchr(lp, '\n', ep - lp);
+        if (!nl)
+        {
+            if (!ilp->eof)
+                return 0;
+            nl = ep;
+        }
+        ilp->start = (nl < ep ? nl + 1 : nl) - buf;
+        *nl = 0;
+        if (!ilp->introducers)
+            return lp;
+        cp = lp;
+        if (ilp->indented)
+        {
+            while (isspace((unsigned char)*cp))
+                ++cp;
+        }
+        if (*cp && strchr(ilp->introducers, *cp))
+            return cp;
+    }
+}
+
+
+/*
+ * NAME
+ *      input_lines_next
+ *
+ * SYNOPSIS
+ *      char *input_lines_next(input_lines_ty *);
+ *
+ * DESCRIPTION
+ *      The input_lines_next function is used to obtain the next
+ *      candidate line.  The newline is removed.  If the introducers
+ *      were given, the result points at the introducer character,
+ *      after any leading white space.
+ *
+ * RETURNS
+ *      char *; the line, or NULL at end of input.
+ *
+ * CAVEAT
+ *      The line is only valid until the next call.
+ */
+
+char *
+input_lines_next(input_lines_ty *ilp)
+{
+    char            *result;
+
+    for (;;)
+    {
+        if (ilp->introducers && !ilp->introducers[1])
+            result = next_by_introducer(ilp);
+        else
+            result = next_by_line(ilp);
+        if (result || ilp->eof)
+            return result;
+        refill(ilp);
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_INPUT_LINES_H
+#define COMMON_INPUT_LINES_H
+
+#include <common/ac/stddef.h>
+#include <common/input.h>
+
+typedef struct input_lines_ty input_lines_ty;
+struct input_lines_ty
+{
+        input_ty        *fp;
+        const char      *introducers;
+        int             indented;
+        char            *buf;
+        size_t          size;
+        size_t          start;
+        size_t          end;
+        int             eof;
+};
+
+input_lines_ty *input_lines_new(input_ty *fp, const char *introducers,
+        int indented);
+char *input_lines_next(input_lines_ty *);
+void input_lines_delete(input_lines_ty *);
+
+#endif /* COMMON_INPUT_LINES_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1991-1994, 1997, 1999, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1991-1994, 1997, 1999, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
  */
 
 #include <common/ac/stddef.h>
+#include <common/ac/stdio.h>
 #include <common/ac/string.h>
 #include <common/ac/stdlib.h>
 #include <common/ac/errno.h>
@@ -26,6 +27,63 @@
 #include <common/mem.h>
 
 
+/*
+ * When memory accounting is enabled, every block is preceeded by this
+ * header, which remembers the size of the block and the subsystem it
+ * was charged to.  The union makes sure the block which follows is
+ * suitably aligned for any object.
+ */
+typedef union mem_header_ty mem_header_ty;
+union mem_header_ty
+{
+    struct
+    {
+        size_t          size;
+        size_t          subsystem;
+    }
+                    h;
+    long            l;
+    double          d;
+    void            *p;
+};
+
+/*
+ * The running totals for each subsystem.
+ */
+typedef struct mem_subsystem_ty mem_subsystem_ty;
+struct mem_subsystem_ty
+{
+    char            name[40];
+    size_t          live;
+    size_t          peak;
+    long            nallocs;
+    long            nfrees;
+};
+
+/*
+ * The allocation sites are the __FILE__ strings of the callers.  This
+ * table maps them to subsystems, by pointer, so that the name need
+ * only be taken apart once per file.
+ */
+typedef struct mem_site_ty mem_site_ty;
+struct mem_site_ty
+{
+    const char      *file;
+    size_t          subsystem;
+};
+
+#define MAX_SUBSYSTEMS 128
+#define MAX_SITES 1024
+
+static int      accounting;
+static mem_subsystem_ty subsystem[MAX_SUBSYSTEMS];
+static size_t   nsubsystems;
+static mem_site_ty site[MAX_SITES];
+static size_t   nsites;
+static size_t   total_live;
+static size_t   total_peak;
+
+
 /*
  * NAME
  *      memory_error - diagnostic
@@ -55,7 +113,143 @@ memory_error(void)
 
 /*
  * NAME
- *      mem_alloc - allocate and clear memory
+ *      subsystem_find
+ *
+ * SYNOPSIS
+ *      size_t subsystem_find(const char *file);
+ *
+ * DESCRIPTION
+ *      The subsystem_find function is used to map an allocation site
+ *      to a subsystem.  Files in a subdirectory, such as
+ *      "cook/graph/walk.c", are grouped by the subdirectory, giving
+ *      "cook/graph".  Other files, such as "common/str.c", are a
+ *      subsystem of their own, named without the ".c".  This means
+ *      "cook/graph.c" is grouped with the files in "cook/graph/".
+ *
+ * RETURNS
+ *      size_t; index into the subsystem table.
+ */
+
+static size_t
+subsystem_find(const char *file)
+{
+    size_t          idx;
+    char            name[sizeof(subsystem[0].name)];
+    const char      *cp;
+    const char      *end;
+    size_t          len;
+    size_t          j;
+
+    idx = ((size_t)file >> 3) % MAX_SITES;
+    while (site[idx].file)
+    {
+        if (site[idx].file == file)
+            return site[idx].subsystem;
+        idx = (idx + 1) % MAX_SITES;
+    }
+
+    if (file[0] == '.' && file[1] == '/')
+        file += 2;
+    cp = strchr(file, '/');
+    end = cp ? strchr(cp + 1, '/') : 0;
+    if (!end)
+    {
+        end = strrchr(file, '.');
+        if (!end || (cp && end < cp))
+            end = file + strlen(file);
+    }
+    len = end - file;
+    if (len >= sizeof(name))
+        len = sizeof(name) - 1;
+    memcpy(name, file, len);
+    name[len] = 0;
+
+    for (j = 0; j < nsubsystems; ++j)
+        if (!strcmp(subsystem[j].name, name))
+            break;
+    if (j >= nsubsystems)
+    {
+        /*
+         * The last slot collects everything once the table is full.
+         */
+        if (nsubsystems < MAX_SUBSYSTEMS)
+            ++nsubsystems;
+        j = nsubsystems - 1;
+        if (!subsystem[j].name[0])
+            memcpy(subsystem[j].name, name, len + 1);
+    }
+
+    /*
+     * Remember the site, unless the table is half full, in which
+     * case it will be looked up by name every time.
+     */
+    if (nsites < MAX_SITES / 2)
+    {
+        site[idx].file = file;
+        site[idx].subsystem = j;
+        ++nsites;
+    }
+    return j;
+}
+
+
+/*
+ * NAME
+ *      account_alloc
+ *
+ * SYNOPSIS
+ *      void account_alloc(mem_header_ty *hp, size_t n, size_t which);
+ *
+ * DESCRIPTION
+ *      The account_alloc function is used to charge a new block to
+ *      the given subsystem.
+ */
+
+static void
+account_alloc(mem_header_ty *hp, size_t n, size_t which)
+{
+    mem_subsystem_ty *sp;
+
+    hp->h.size = n;
+    hp->h.subsystem = which;
+    sp = &subsystem[hp->h.subsystem];
+    sp->live += n;
+    if (sp->live > sp->peak)
+        sp->peak = sp->live;
+    sp->nallocs++;
+    total_live += n;
+    if (total_live > total_peak)
+        total_peak = total_live;
+}
+
+
+/*
+ * NAME
+ *      account_free
+ *
+ * SYNOPSIS
+ *      void account_free(mem_header_ty *hp);
+ *
+ * DESCRIPTION
+ *      The account_free function is used to credit a block back to
+ *      the subsystem it was charged to.
+ */
+
+static void
+account_free(mem_header_ty *hp)
+{
+    mem_subsystem_ty *sp;
+
+    sp = &subsystem[hp->h.subsystem];
+    sp->live -= hp->h.size;
+    sp->nfrees++;
+    total_live -= hp->h.size;
+}
+
+
+/*
+ * NAME
+ *      mem_alloc - allocate memory
  *
  * SYNOPSIS
  *      char *mem_alloc(size_t n);
@@ -63,21 +257,33 @@ memory_error(void)
  * DESCRIPTION
  *      Mem_alloc uses malloc to allocate the required sized chunk of memory.
  *      If any error is returned from malloc() an fatal diagnostic is issued.
- *      The memory is zeroed befor it is returned.
+ *
+ *      It is a macro, which calls mem_alloc_tag with the name of the
+ *      calling file, for memory accounting.
  *
  * CAVEAT
  *      It is the responsibility of the caller to ensure that the space is
- *      freed when finished with, by a call to free().
+ *      freed when finished with, by a call to mem_free().
  */
 
 void *
-mem_alloc(size_t n)
+mem_alloc_tag(size_t n, const char *file)
 {
     void            *p;
 
     if (n < 1)
         n = 1;
     errno = ENOMEM;
+    if (accounting)
+    {
+        mem_header_ty   *hp;
+
+        hp = malloc(sizeof(mem_header_ty) + n);
+        if (!hp)
+            memory_error();
+        account_alloc(hp, n, subsystem_find(file));
+        return (hp + 1);
+    }
     p = malloc(n);
     if (!p)
         memory_error();
@@ -99,51 +305,190 @@ mem_alloc(size_t n)
  *
  * CAVEAT
  *      It is the responsibility of the caller to ensure that the space is
- *      freed when finished with, by a call to free().
+ *      freed when finished with, by a call to mem_free().
  */
 
 void *
-mem_alloc_clear(size_t n)
+mem_alloc_clear_tag(size_t n, const char *file)
 {
     void            *p;
 
-    p = mem_alloc(n);
+    p = mem_alloc_tag(n, file);
     memset(p, 0, n);
     return p;
 }
 
 
 void *
-mem_change_size(void *p, size_t n)
+mem_change_size_tag(void *p, size_t n, const char *file)
 {
+    mem_header_ty   *hp;
+    size_t          which;
+
+    if (!p)
+        return mem_alloc_tag(n, file);
     if (n < 1)
         n = 1;
     errno = ENOMEM;
-    if (!p)
-        p = malloc(n);
-    else
+    if (!accounting)
+    {
         p = realloc(p, n);
-    if (!p)
+        if (!p)
+            memory_error();
+        return p;
+    }
+
+    /*
+     * The block stays charged to the subsystem which first
+     * allocated it.
+     */
+    hp = (mem_header_ty *)p - 1;
+    which = hp->h.subsystem;
+    account_free(hp);
+    subsystem[which].nfrees--;
+    hp = realloc(hp, sizeof(mem_header_ty) + n);
+    if (!hp)
         memory_error();
-    return p;
+    account_alloc(hp, n, which);
+    subsystem[which].nallocs--;
+    return (hp + 1);
 }
 
 
 void
 mem_free(void *p)
 {
+    if (accounting && p)
+    {
+        mem_header_ty   *hp;
+
+        hp = (mem_header_ty *)p - 1;
+        account_free(hp);
+        free(hp);
+        return;
+    }
     free(p);
 }
 
 
 char *
-mem_copy_string(char *s)
+mem_copy_string_tag(char *s, const char *file)
 {
     char            *cp;
     size_t          len;
 
     len = strlen(s) + 1;
-    cp = mem_alloc(len);
+    cp = mem_alloc_tag(len, file);
     memcpy(cp, s, len);
     return cp;
 }
+
+
+/*
+ * NAME
+ *      mem_report_enable
+ *
+ * SYNOPSIS
+ *      void mem_report_enable(void);
+ *
+ * DESCRIPTION
+ *      The mem_report_enable function is used to turn on memory
+ *      accounting.  When it is off, which is the default, the
+ *      allocator costs one flag test more than malloc does.
+ *
+ * CAVEAT
+ *      This must be called before any memory is allocated, because
+ *      blocks allocated without the accounting header cannot be freed
+ *      once it is on.
+ */
+
+void
+mem_report_enable(void)
+{
+    accounting = 1;
+}
+
+
+static int
+cmp_peak(const void *va, const void *vb)
+{
+    const mem_subsystem_ty *a;
+    const mem_subsystem_ty *b;
+
+    a = va;
+    b = vb;
+    if (a->peak != b->peak)
+        return (a->peak < b->peak ? 1 : -1);
+    return strcmp(a->name, b->name);
+}
+
+
+/*
+ * NAME
+ *      mem_report
+ *
+ * SYNOPSIS
+ *      void mem_report(void);
+ *
+ * DESCRIPTION
+ *      The mem_report function is used to print the live bytes, peak
+ *      bytes, and numbers of allocations and frees of each subsystem,
+ *      largest peak first, on the standard error.  It does nothing
+ *      unless mem_report_enable was called.
+ *
+ *      The subsystem peaks are each subsystem's own high water mark;
+ *      they need not have happened at the same time, so they can add
+ *      up to more than the total peak.
+ */
+
+void
+mem_report(void)
+{
+    mem_subsystem_ty copy[MAX_SUBSYSTEMS];
+    size_t          j;
+    long            nallocs;
+    long            nfrees;
+
+    if (!accounting)
+        return;
+    memcpy(copy, subsystem, nsubsystems * sizeof(copy[0]));
+    qsort(copy, nsubsystems, sizeof(copy[0]), cmp_peak);
+    fflush(stdout);
+    fprintf
+    (
+        stderr,
+        "%-24s %14s %14s %10s %10s\n",
+        "subsystem",
+        "live bytes",
+        "peak bytes",
+        "allocs",
+        "frees"
+    );
+    nallocs = 0;
+    nfrees = 0;
+    for (j = 0; j < nsubsystems; ++j)
+    {
+        fprintf
+        (
+            stderr,
+            "%-24s %14lu %14lu %10ld %10ld\n",
+            copy[j].name,
+            (unsigned long)copy[j].live,
+            (unsigned long)copy[j].peak,
+            copy[j].nallocs,
+            copy[j].nfrees
+        );
+        nallocs += copy[j].nallocs;
+        nfrees += copy[j].nfrees;
+    }
+    fprintf
+    (
+        stderr,
+        "%-24s %14lu %14lu %10ld %10ld\n",
+        "total",
+        (unsigned long)total_live,
+        (unsigned long)total_peak,
+        nallocs,
+        nfrees
+    );
+}
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1991-1994, 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1991-1994, 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -23,10 +23,23 @@
 #include <common/ac/stddef.h>
 #include <common/main.h>
 
-void *mem_alloc(size_t);
-void *mem_alloc_clear(size_t);
-void *mem_change_size(void *, size_t);
+/*
+ * Every allocation is tagged with the source file it was made from, so
+ * that the -MEMory_Report option can say which subsystem is using the
+ * memory.  See common/mem.c for how files are grouped.
+ */
+void *mem_alloc_tag(size_t, const char *);
+void *mem_alloc_clear_tag(size_t, const char *);
+void *mem_change_size_tag(void *, size_t, const char *);
+char *mem_copy_string_tag(char *, const char *);
 void mem_free(void *);
-char *mem_copy_string(char *);
+
+#define mem_alloc(n) mem_alloc_tag((n), __FILE__)
+#define mem_alloc_clear(n) mem_alloc_clear_tag((n), __FILE__)
+#define mem_change_size(p, n) mem_change_size_tag((p), (n), __FILE__)
+#define mem_copy_string(s) mem_copy_string_tag((s), __FILE__)
+
+void mem_report_enable(void);
+void mem_report(void);
 
 #endif /* MEM_H */
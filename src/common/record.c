@@ -0,0 +1,258 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains the functions shared by the binary cache files
+ * (the c_incl cache, and cook's dependency log and collect cache) for
+ * framing, checking and numbering their records.
+ *
+ * Each record is the length of its contents, the contents (starting
+ * with a byte saying what kind of record it is), and a checksum of the
+ * contents.  A record torn by a crash, or by a concurrent writer on a
+ * file system which does not honour O_APPEND, is detected and the rest
+ * of the file ignored.
+ */
+
+#include <common/ac/string.h>
+
+#include <common/record.h>
+
+
+/*
+ * NAME
+ *      record_checksum - of a record
+ *
+ * SYNOPSIS
+ *      unsigned long record_checksum(const char *data, size_t len);
+ *
+ * DESCRIPTION
+ *      The record_checksum function is used to calculate the checksum
+ *      of a record's contents (32 bit FNV-1a).  It only has to catch
+ *      torn and interleaved writes, not malice.
+ */
+
+unsigned long
+record_checksum(const char *data, size_t len)
+{
+    unsigned long   h;
+
+    h = 2166136261uL;
+    while (len > 0)
+    {
+        h ^= (unsigned char)*data++;
+        h = (h * 16777619uL) & 0xFFFFFFFFuL;
+        --len;
+    }
+    return h;
+}
+
+
+/*
+ * NAME
+ *      record_put_number - append a number to a record
+ *
+ * SYNOPSIS
+ *      void record_put_number(stracc *sap, size_t n);
+ *
+ * DESCRIPTION
+ *      The record_put_number function is used to append a number to
+ *      the record being built, seven bits per byte, least significant
+ *      first, with the top bit set on all but the last byte.  Most
+ *      numbers fit in one byte.
+ *
+ * CAVEATS
+ *      Must be symmetric with record_get_number below.
+ */
+
+void
+record_put_number(stracc *sap, size_t n)
+{
+    while (n >= 0x80)
+    {
+        sa_char(sap, (n & 0x7F) | 0x80);
+        n >>= 7;
+    }
+    sa_char(sap, n);
+}
+
+
+/*
+ * NAME
+ *      record_get_number - read a number from a record
+ *
+ * SYNOPSIS
+ *      int record_get_number(record_reader_ty *rp, size_t *np);
+ *
+ * DESCRIPTION
+ *      The record_get_number function is used to read a number written
+ *      by the record_put_number function.
+ *
+ * RETURNS
+ *      0 on no error, -1 if the record is too short
+ */
+
+int
+record_get_number(record_reader_ty *rp, size_t *np)
+{
+    size_t          n;
+    int             shift;
+    int             c;
+
+    n = 0;
+    shift = 0;
+    do
+    {
+        if (rp->pos >= rp->len || shift >= (int)(8 * sizeof(n)))
+            return -1;
+        c = (unsigned char)rp->buf[rp->pos++];
+        n |= (size_t)(c & 0x7F) << shift;
+        shift += 7;
+    }
+    while (c & 0x80);
+    *np = n;
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      record_begin - start a record
+ *
+ * SYNOPSIS
+ *      size_t record_begin(stracc *sap, int kind);
+ *
+ * DESCRIPTION
+ *      The record_begin function is used to start a new record of the
+ *      given kind.  Room is left for the length, which is filled in by
+ *      record_end.
+ *
+ * RETURNS
+ *      size_t; the mark to pass to record_end
+ */
+
+size_t
+record_begin(stracc *sap, int kind)
+{
+    size_t          mark;
+    size_t          len;
+
+    mark = sa_mark(sap);
+    len = 0;
+    sa_chars(sap, (char *)&len, sizeof(len));
+    sa_char(sap, kind);
+    return mark;
+}
+
+
+/*
+ * NAME
+ *      record_end - finish a record
+ *
+ * SYNOPSIS
+ *      void record_end(stracc *sap, size_t mark);
+ *
+ * DESCRIPTION
+ *      The record_end function is used to finish a record: the length
+ *      is filled in, and the checksum appended.
+ */
+
+void
+record_end(stracc *sap, size_t mark)
+{
+    size_t          len;
+    unsigned long   sum;
+
+    len = sa_mark(sap) - mark - sizeof(len);
+    memcpy(sap->sa_buf + mark, &len, sizeof(len));
+    sum = record_checksum(sap->sa_buf + mark + sizeof(len), len);
+    sa_chars(sap, (char *)&sum, sizeof(sum));
+}
+
+
+/*
+ * NAME
+ *      record_next - find the next record of a file
+ *
+ * SYNOPSIS
+ *      int record_next(record_reader_ty *fp, record_reader_ty *rp,
+ *              unsigned long *sum_p);
+ *
+ * DESCRIPTION
+ *      The record_next function is used to find the next record of a
+ *      file, which has been read into memory.  The file reader is
+ *      moved past the record, and the record reader is set up to read
+ *      its contents, following the kind byte (which is rp->buf[0]).
+ *
+ *      If sum_p is NULL the checksum is checked here; otherwise it is
+ *      returned, for the caller to check if and when the record is
+ *      used.
+ *
+ * RETURNS
+ *      int; 0 on success, -1 at the end of the file or if the record
+ *      is damaged, in which case the file reader is not moved.
+ */
+
+int
+record_next(record_reader_ty *fp, record_reader_ty *rp, unsigned long *sum_p)
+{
+    size_t          len;
+    unsigned long   sum;
+
+    if (fp->pos >= fp->len || fp->len - fp->pos < sizeof(len))
+        return -1;
+    memcpy(&len, fp->buf + fp->pos, sizeof(len));
+    if (len < 1 || len > fp->len)
+        return -1;
+    if (fp->len - fp->pos - sizeof(len) < len + sizeof(sum))
+        return -1;
+    rp->buf = fp->buf + fp->pos + sizeof(len);
+    rp->pos = 1;
+    rp->len = len;
+    memcpy(&sum, rp->buf + len, sizeof(sum));
+    if (sum_p)
+        *sum_p = sum;
+    else if (sum != record_checksum(rp->buf, len))
+        return -1;
+    fp->pos += sizeof(len) + len + sizeof(sum);
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      record_get - read bytes from a record
+ *
+ * SYNOPSIS
+ *      int record_get(record_reader_ty *rp, void *buf, size_t buflen);
+ *
+ * DESCRIPTION
+ *      The record_get function is used to read bytes from the contents
+ *      of a record.
+ *
+ * RETURNS
+ *      0 on no error, -1 if the record is too short
+ */
+
+int
+record_get(record_reader_ty *rp, void *buf, size_t buflen)
+{
+    if (buflen > rp->len - rp->pos)
+        return -1;
+    memcpy(buf, rp->buf + rp->pos, buflen);
+    rp->pos += buflen;
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_RECORD_H
+#define COMMON_RECORD_H
+
+#include <common/stracc.h>
+
+/*
+ * This structure is used to read the contents of one record of a
+ * binary cache file, or the records of a whole file.
+ */
+typedef struct record_reader_ty record_reader_ty;
+struct record_reader_ty
+{
+        const char      *buf;
+        size_t          pos;
+        size_t          len;
+};
+
+unsigned long record_checksum(const char *, size_t);
+void record_put_number(stracc *, size_t);
+int record_get_number(record_reader_ty *, size_t *);
+size_t record_begin(stracc *, int);
+void record_end(stracc *, size_t);
+int record_next(record_reader_ty *, record_reader_ty *, unsigned long *);
+int record_get(record_reader_ty *, void *, size_t);
+
+#endif /* COMMON_RECORD_H */
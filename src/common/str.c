@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-1995, 1997-1999, 2001, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1993-1995, 1997-1999, 2001, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -23,12 +23,19 @@
  * A literal pool is maintained.  Each string has a reference count.  The
  * string stays in the literal pool for as long as it hash a positive
  * reference count.  To determine if a string is already in the literal pool,
- * linear dynamic hashing is used to guarantee an O(1) search.  That all equal
- * strings are the same item in the literal pool means that string equality is
- * a pointer test, and thus very fast.
+ * an open addressing hash table is used to give an O(1) search.  That all
+ * equal strings are the same item in the literal pool means that string
+ * equality is a pointer test, and thus very fast.
+ *
+ * The hash table uses linear probing.  Each slot caches the hash of the
+ * string it points to, so that probing past a non-matching slot does
+ * not need to touch the string itself.  This pool hash is not the
+ * str_hash of the string, which symbol tables use, and whose value must
+ * not change; see hash_generate.
  */
 
 #include <common/ac/ctype.h>
+#include <common/ac/limits.h>
 #include <common/ac/stddef.h>
 #include <common/ac/stdio.h>
 #include <common/ac/stdlib.h>
@@ -49,12 +56,36 @@
 string_ty *str_true;
 string_ty *str_false;
 static string_ty **hash_table;
+static str_hash_ty *hash_cache;
 static str_hash_ty hash_modulus;
 static str_hash_ty hash_mask;
 static str_hash_ty hash_load;
 
 #define MAX_HASH_LEN 20
 
+/*
+ * The pool hash mixes a word at a time.  The multiplier is the golden
+ * ratio in fixed point; when str_hash_ty is only 32 bits the truncated
+ * value is still odd, and still mixes well.
+ */
+#define HASH_MULTIPLIER ((str_hash_ty)0x9E3779B97F4A7C15uLL)
+#define HASH_BITS (sizeof(str_hash_ty) * 8)
+#define HASH_ROTATE(h, n) (((h) << (n)) | ((h) >> (HASH_BITS - (n))))
+
+/*
+ * Words are read least significant byte first, whatever the byte order
+ * of the host.  Compilers turn this into a single load where they can.
+ */
+#define LOAD_BYTE(p, n) ((str_hash_ty)(p)[n] << ((n) * 8))
+#if ULONG_MAX > 0xFFFFFFFFUL
+#define LOAD_WORD(p) \
+    (LOAD_BYTE(p, 0) | LOAD_BYTE(p, 1) | LOAD_BYTE(p, 2) | LOAD_BYTE(p, 3) | \
+    LOAD_BYTE(p, 4) | LOAD_BYTE(p, 5) | LOAD_BYTE(p, 6) | LOAD_BYTE(p, 7))
+#else
+#define LOAD_WORD(p) \
+    (LOAD_BYTE(p, 0) | LOAD_BYTE(p, 1) | LOAD_BYTE(p, 2) | LOAD_BYTE(p, 3))
+#endif
+
 
 /*
  * NAME
@@ -64,7 +95,11 @@ static str_hash_ty hash_load;
  *      str_hash_ty hash_generate(char *s, size_t n);
  *
  * DESCRIPTION
- *      The hash_generate function is used to make a number from a string.
+ *      The hash_generate function is used to make a number from a
+ *      string.  This is the str_hash of the string, which symbol tables
+ *      use to place their entries, so it also decides the order of
+ *      symtab_walk, and through it the order of [interior_files],
+ *      [leaf_files] and the like.
  *
  * RETURNS
  *      str_hash_ty - the magic number
@@ -72,6 +107,9 @@ static str_hash_ty hash_load;
  * CAVEAT
  *      Only the last MAX_HASH_LEN characters are used.
  *      It is important that str_hash_ty be unsigned (int or long).
+ *      The low bits do not depend on the byte order or word size of
+ *      the host, so walk orders are the same everywhere.  Do not change
+ *      this function, or they will all change.
  */
 
 static str_hash_ty
@@ -95,6 +133,69 @@ hash_generate(const char *s, size_t n)
 }
 
 
+/*
+ * NAME
+ *      pool_hash - hash string for the literal pool
+ *
+ * SYNOPSIS
+ *      str_hash_ty pool_hash(char *s, size_t n);
+ *
+ * DESCRIPTION
+ *      The pool_hash function is used to make the number which places
+ *      a string in the literal pool.  The whole string is used, a word
+ *      at a time, so that file names which differ only in the middle
+ *      (a long common directory prefix, and a common suffix such as
+ *      ".o") still hash differently.  The bytes of each word are taken
+ *      in the same order on every host.
+ *
+ * RETURNS
+ *      str_hash_ty - the magic number
+ *
+ * CAVEAT
+ *      The value depends on the size of str_hash_ty.  Nothing walks
+ *      the pool, so this is never visible, but it must never be
+ *      written to a file.
+ */
+
+static str_hash_ty
+pool_hash(const char *s, size_t n)
+{
+    const unsigned char *p;
+    str_hash_ty     retval;
+    str_hash_ty     word;
+    size_t          len;
+    size_t          j;
+
+    p = (const unsigned char *)s;
+    retval = n * HASH_MULTIPLIER;
+    while (n > 0)
+    {
+        if (n >= sizeof(word))
+        {
+            len = sizeof(word);
+            word = LOAD_WORD(p);
+        }
+        else
+        {
+            len = n;
+            word = 0;
+            for (j = n; j > 0; --j)
+                word = (word << 8) | p[j - 1];
+        }
+        retval = (HASH_ROTATE(retval, 5) ^ word) * HASH_MULTIPLIER;
+        p += len;
+        n -= len;
+    }
+
+    /*
+     * The table index is taken from the low bits, so fold the well
+     * mixed high bits down into them.
+     */
+    retval ^= retval >> (HASH_BITS / 2);
+    return retval;
+}
+
+
 /*
  * NAME
  *      str_valid - test a string
@@ -125,6 +226,8 @@ str_valid(string_ty *s)
         strlen(s->str_text) == s->str_length
     &&
         s->str_hash == hash_generate(s->str_text, s->str_length)
+    &&
+        s->str_pool_hash == pool_hash(s->str_text, s->str_length)
     );
 }
 
@@ -158,8 +261,12 @@ str_initialize(void)
     hash_mask = hash_modulus - 1;
     hash_load = 0;
     hash_table = mem_alloc(hash_modulus * sizeof(string_ty *));
+    hash_cache = mem_alloc(hash_modulus * sizeof(str_hash_ty));
     for (j = 0; j < hash_modulus; ++j)
-            hash_table[j] = 0;
+    {
+        hash_table[j] = 0;
+        hash_cache[j] = 0;
+    }
 
     str_true = str_from_c("1");
     str_false = str_from_c("");
@@ -180,63 +287,60 @@ str_initialize(void)
  *      void
  *
  * CAVEAT
- *      A load factor of about 80% is suggested.
+ *      Linear probing needs plenty of empty slots; a load factor of
+ *      no more than 70% is suggested.
  */
 
 static void
 split(void)
 {
-    string_ty       **new_hash_table;
-    str_hash_ty     new_hash_modulus;
-    str_hash_ty     new_hash_mask;
+    string_ty       **old_hash_table;
+    str_hash_ty     *old_hash_cache;
+    str_hash_ty     old_hash_modulus;
     str_hash_ty     j;
 
     /*
      * double the modulus
      *
      * This is subtle.  If we only increase the modulus by one, the
-     * load always hovers around 80%, so we have to do a split for
+     * load always hovers around the limit, so we have to do a split for
      * every insert.  I.e. the malloc burden is O(n) for the lifetime of
      * the program.  BUT if we double the modulus, the length of time
      * until the next split also doubles, making the probablity of a
      * split halve, and sigma(2**-n)=1, so the malloc burden becomes O(1)
      * for the lifetime of the program.
      */
-    new_hash_modulus = hash_modulus << 1;
-    new_hash_mask = new_hash_modulus - 1;
-    new_hash_table = mem_alloc(new_hash_modulus * sizeof(string_ty *));
-
-    /*
-     * now redistribute the list elements
-     */
+    old_hash_table = hash_table;
+    old_hash_cache = hash_cache;
+    old_hash_modulus = hash_modulus;
+    hash_modulus = old_hash_modulus << 1;
+    hash_mask = hash_modulus - 1;
+    hash_table = mem_alloc(hash_modulus * sizeof(string_ty *));
+    hash_cache = mem_alloc(hash_modulus * sizeof(str_hash_ty));
     for (j = 0; j < hash_modulus; ++j)
     {
-        string_ty       *p;
-
-        p = hash_table[j];
-        new_hash_table[j] = 0;
-        new_hash_table[hash_modulus + j] = 0;
-        while (p)
-        {
-            string_ty       *p2;
-            str_hash_ty     idx;
-
-            p2 = p;
-            p = p->str_next;
-
-            idx = p2->str_hash & new_hash_mask;
-            p2->str_next = new_hash_table[idx];
-            new_hash_table[idx] = p2;
-        }
+        hash_table[j] = 0;
+        hash_cache[j] = 0;
     }
 
     /*
-     * swap it over
+     * now redistribute the strings
      */
-    mem_free(hash_table);
-    hash_table = new_hash_table;
-    hash_modulus = new_hash_modulus;
-    hash_mask = new_hash_mask;
+    for (j = 0; j < old_hash_modulus; ++j)
+    {
+        str_hash_ty     idx;
+
+        if (!old_hash_table[j])
+            continue;
+        idx = old_hash_cache[j] & hash_mask;
+        while (hash_table[idx])
+            idx = (idx + 1) & hash_mask;
+        hash_table[idx] = old_hash_table[j];
+        hash_cache[idx] = old_hash_cache[j];
+    }
+
+    mem_free(old_hash_table);
+    mem_free(old_hash_cache);
 }
 
 
@@ -292,7 +396,7 @@ str_n_from_c(const char *s, size_t length)
     str_hash_ty     idx;
     string_ty       *p;
 
-    hash = hash_generate(s, length);
+    hash = pool_hash(s, length);
 
 #ifdef DEBUG
     if (!hash_table)
@@ -301,16 +405,12 @@ str_n_from_c(const char *s, size_t length)
     idx = hash & hash_mask;
     assert(idx < hash_modulus);
 
-    for (p = hash_table[idx]; p; p = p->str_next)
+    for (; hash_table[idx]; idx = (idx + 1) & hash_mask)
     {
-        if
-        (
-            p->str_hash == hash
-        &&
-            p->str_length == length
-        &&
-            0 == memcmp(p->str_text, s, length)
-        )
+        if (hash_cache[idx] != hash)
+            continue;
+        p = hash_table[idx];
+        if (p->str_length == length && 0 == memcmp(p->str_text, s, length))
         {
             p->str_references++;
             return p;
@@ -318,27 +418,17 @@ str_n_from_c(const char *s, size_t length)
     }
 
     p = mem_alloc(sizeof(string_ty) + length);
-    p->str_hash = hash;
+    p->str_hash = hash_generate(s, length);
+    p->str_pool_hash = hash;
     p->str_length = length;
     p->str_references = 1;
-    p->str_next = hash_table[idx];
-    hash_table[idx] = p;
-#if 0
-    /* silence purify */
-    {
-            /*
-             * probably sizeof(int) bytes,
-             * but is compiler dependent
-             */
-            size_t n = sizeof(string_ty) - offsetof(string_ty, str_text);
-            memset(p->str_text, 0, n);
-    }
-#endif
     memcpy(p->str_text, s, length);
     p->str_text[length] = 0;
+    hash_table[idx] = p;
+    hash_cache[idx] = hash;
 
     hash_load++;
-    if (hash_load * 10 > hash_modulus * 8)
+    if (hash_load * 10 > hash_modulus * 7)
         split();
     return p;
 }
@@ -392,7 +482,7 @@ void
 str_free(string_ty *s)
 {
     str_hash_ty     idx;
-    string_ty       **spp;
+    str_hash_ty     j;
 
     assert(str_valid(s));
     if (s->str_references > 1)
@@ -403,23 +493,44 @@ str_free(string_ty *s)
     assert(s->str_references == 1);
 
     /*
-     * find the hash bucket it was in,
-     * and remove it
+     * find the slot it was in
      */
-    idx = s->str_hash & hash_mask;
+    idx = s->str_pool_hash & hash_mask;
     assert(idx < hash_modulus);
-    for (spp = &hash_table[idx]; *spp; spp = &(*spp)->str_next)
+    while (hash_table[idx] != s)
     {
-        if (*spp == s)
+        if (!hash_table[idx])
         {
-            *spp = s->str_next;
-            free(s);
-            --hash_load;
-            return;
+            /* should never reach here! */
+            fatal_raw("attempted to free non-existent string (bug)");
         }
+        idx = (idx + 1) & hash_mask;
+    }
+    mem_free(s);
+    --hash_load;
+
+    /*
+     * Remove it without leaving a tombstone: slide back any later
+     * strings in the same run which would no longer be reachable
+     * from their home slot.
+     */
+    j = idx;
+    for (;;)
+    {
+        str_hash_ty     home;
+
+        j = (j + 1) & hash_mask;
+        if (!hash_table[j])
+            break;
+        home = hash_cache[j] & hash_mask;
+        if (idx <= j ? (idx < home && home <= j) : (idx < home || home <= j))
+            continue;
+        hash_table[idx] = hash_table[j];
+        hash_cache[idx] = hash_cache[j];
+        idx = j;
     }
-    /* should never reach here! */
-    fatal_raw("attempted to free non-existent string (bug)");
+    hash_table[idx] = 0;
+    hash_cache[idx] = 0;
 }
 
 
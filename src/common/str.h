@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 199, 1992-1995, 1997, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 199, 1992-1995, 1997, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -31,7 +31,7 @@ typedef struct string_ty string_ty;
 struct string_ty
 {
         str_hash_ty     str_hash;
-        string_ty       *str_next;
+        str_hash_ty     str_pool_hash;
         long            str_references;
         size_t          str_length;
         char            str_text[1];
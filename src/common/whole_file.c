@@ -0,0 +1,169 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains functions for reading a whole file into memory,
+ * and for writing a whole buffer, as the cache files need.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/stdio.h>
+#include <common/ac/unistd.h>
+
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/str.h>
+#include <common/whole_file.h>
+
+
+/*
+ * NAME
+ *      read_whole_file
+ *
+ * SYNOPSIS
+ *      char *read_whole_file(const char *filename, size_t *len_p);
+ *
+ * DESCRIPTION
+ *      The read_whole_file function is used to read the whole of a
+ *      file into memory.  Errors are fatal, except that the file not
+ *      existing is not an error.
+ *
+ * RETURNS
+ *      char *; the contents, or NULL if the file does not exist.
+ *      Use mem_free when you are done with it.
+ */
+
+char *
+read_whole_file(const char *filename, size_t *len_p)
+{
+    FILE            *fp;
+    char            *buf;
+    size_t          len;
+    size_t          max;
+    size_t          n;
+
+    fp = fopen(filename, "rb");
+    if (!fp)
+    {
+        if (errno == ENOENT)
+            return 0;
+        fatal_intl_open(filename);
+    }
+    len = 0;
+    max = 1 << 16;
+    buf = mem_alloc(max);
+    for (;;)
+    {
+        n = fread(buf + len, 1, max - len, fp);
+        if (!n)
+            break;
+        len += n;
+        if (len >= max)
+        {
+            max *= 2;
+            buf = mem_change_size(buf, max);
+        }
+    }
+    if (ferror(fp))
+        fatal_intl_read(filename);
+    fclose_and_check(fp, filename);
+    *len_p = len;
+    return buf;
+}
+
+
+/*
+ * NAME
+ *      write_all
+ *
+ * SYNOPSIS
+ *      int write_all(int fd, const char *buf, size_t len);
+ *
+ * DESCRIPTION
+ *      The write_all function is used to write a whole buffer to a
+ *      file descriptor, coping with short writes and interrupts.  A
+ *      buffer written to a file opened for appending goes in a single
+ *      write if at all possible.
+ *
+ * RETURNS
+ *      int; 0 on success, -1 on error (with errno set).
+ */
+
+int
+write_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        long            n;
+
+        n = write(fd, buf, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      write_whole_file
+ *
+ * SYNOPSIS
+ *      void write_whole_file(const char *filename, const char *buf,
+ *              size_t len);
+ *
+ * DESCRIPTION
+ *      The write_whole_file function is used to replace the contents
+ *      of a file.  The buffer is written to a temporary file first,
+ *      and then renamed into place, so that readers always see either
+ *      the old file or the new one.  Errors are fatal.
+ */
+
+void
+write_whole_file(const char *filename, const char *buf, size_t len)
+{
+    string_ty       *tmp;
+    int             fd;
+
+    tmp = str_format("%s.%ld", filename, (long)getpid());
+    fd = open(tmp->str_text, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+        fatal_intl_open(tmp->str_text);
+    if (write_all(fd, buf, len))
+        fatal_intl_write(tmp->str_text);
+    if (close(fd))
+        fatal_intl_close(tmp->str_text);
+    if (rename(tmp->str_text, filename))
+    {
+        sub_context_ty  *scp;
+
+        scp = sub_context_new();
+        sub_errno_set(scp);
+        sub_var_set_string(scp, "File_Name1", tmp);
+        sub_var_set_charstar(scp, "File_Name2", filename);
+        fatal_intl(scp, i18n("rename \"$filename1\" to \"$filename2\": $errno"));
+        /* NOTREACHED */
+    }
+    str_free(tmp);
+}
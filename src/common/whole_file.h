@@ -0,0 +1,30 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMON_WHOLE_FILE_H
+#define COMMON_WHOLE_FILE_H
+
+#include <common/ac/stddef.h>
+#include <common/main.h>
+
+char *read_whole_file(const char *filename, size_t *len_p);
+int write_all(int fd, const char *buf, size_t len);
+void write_whole_file(const char *filename, const char *buf, size_t len);
+
+#endif /* COMMON_WHOLE_FILE_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 1999, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -631,7 +631,7 @@ wstr_free(wstring_ty *s)
         if (*spp == s)
         {
             *spp = s->wstr_next;
-            free(s);
+            mem_free(s);
             --hash_load;
             return;
         }
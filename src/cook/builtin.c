@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-2008 Peter Miller
+ *      Copyright (C) 1993-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -115,6 +115,8 @@ static builtin_ty *func[] = {
     &builtin_catenate,
     &builtin_collect,
     &builtin_collect_lines,
+    &builtin_collect_cached,
+    &builtin_collect_lines_cached,
     &builtin_cook,
     &builtin_count,
     &builtin_defined,
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1991-1994, 1997-1999, 2006-2009 Peter Miller
+ *      Copyright (C) 1991-1994, 1997-1999, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -26,6 +26,7 @@
 #include <common/ac/stdio.h>
 #include <common/ac/string.h>
 #include <common/ac/errno.h>
+#include <common/ac/stdlib.h>
 
 #include <common/error.h>
 #include <common/error_intl.h>
@@ -33,9 +34,11 @@
 #include <common/stracc.h>
 #include <common/trace.h>
 #include <cook/builtin/collect.h>
+#include <cook/collect_cache.h>
 #include <cook/expr/position.h>
 #include <cook/option.h>
 #include <cook/os_interface.h>
+#include <cook/stat.cache.h>
 
 
 /*
@@ -47,7 +50,8 @@
  *
  * DESCRIPTION
  *      Collect is a built-in function of cook, described as follows:
- *      This function requires one or more arguments.
+ *      This function requires one or more arguments.  The output is
+ *      split into words, or into lines for collect_lines.
  *
  * RETURNS
  *      A word list containing the values of the output lines of the
@@ -60,8 +64,8 @@
  */
 
 static int
-interpret(string_list_ty *result, const string_list_ty *args,
-    const expr_position_ty *pp, const struct opcode_context_ty *ocp)
+collect(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, int lines)
 {
     FILE            *fp;
     string_ty       *s;
@@ -72,7 +76,6 @@ interpret(string_list_ty *result, const string_list_ty *args,
     stracc          lbuf;
 
     trace(("collect\n"));
-    (void)ocp;
     assert(result);
     assert(args);
     assert(args->nstrings);
@@ -103,6 +106,7 @@ interpret(string_list_ty *result, const string_list_ty *args,
         star_sync();
         error_raw("%s", s->str_text);
     }
+    stat_cache_prefetch_discard();
     fp = popen(s->str_text, "r");
     str_free(s);
     if (!fp)
@@ -116,7 +120,7 @@ interpret(string_list_ty *result, const string_list_ty *args,
         sub_context_delete(scp);
         return -1;
     }
-    delim = strchr(args->string[0]->str_text, '_') ? "\n" : "\n \t\f";
+    delim = lines ? "\n" : "\n \t\f";
     stracc_constructor(&lbuf);
     for (;;)
     {
@@ -158,6 +162,12 @@ interpret(string_list_ty *result, const string_list_ty *args,
         return -1;
     }
     status = pclose(fp);
+
+    /*
+     * The command did not go through os_wait4, but it may have
+     * created symbolic links all the same.
+     */
+    os_pathname_cache_clear();
     status = exit_status(args->string[1]->str_text, status, errok);
     option_undo_level(OPTION_LEVEL_EXECUTE);
     if (status)
@@ -166,6 +176,24 @@ interpret(string_list_ty *result, const string_list_ty *args,
 }
 
 
+static int
+interpret(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, const struct opcode_context_ty *ocp)
+{
+    (void)ocp;
+    return collect(result, args, pp, 0);
+}
+
+
+static int
+interpret_lines(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, const struct opcode_context_ty *ocp)
+{
+    (void)ocp;
+    return collect(result, args, pp, 1);
+}
+
+
 builtin_ty builtin_collect =
 {
     "collect",
@@ -177,8 +205,170 @@ builtin_ty builtin_collect =
 builtin_ty builtin_collect_lines =
 {
     "collect_lines",
-    interpret,
-    interpret,                  /* script */
+    interpret_lines,
+    interpret_lines,            /* script */
+};
+
+
+/*
+ * NAME
+ *      builtin_collect_cached - get output of a command, remembered
+ *
+ * SYNOPSIS
+ *      int builtin_collect_cached(string_list_ty *result,
+ *              string_list_ty *args);
+ *
+ * DESCRIPTION
+ *      The collect_cached function is like the collect function, except
+ *      that its output is remembered between runs.  The arguments are
+ *      a list of inputs, a "--" separator, and the command.  Each input
+ *      is a file or directory name, or an environment variable name
+ *      with a leading dollar sign.  The command is only run again when
+ *      one of the inputs, or the command itself, has changed.
+ *
+ * RETURNS
+ *      A word list containing the values of the output lines of the
+ *      program given in the arguments.
+ *
+ * CAVEAT
+ *      Anything else the command depends on must be listed as an
+ *      input, or stale output will be used.
+ */
+
+static int
+collect_cached(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, int lines)
+{
+    size_t          sep;
+    size_t          j;
+    string_list_ty  inputs;
+    string_list_ty  command;
+    string_list_ty  output;
+    stracc          key;
+    string_ty       *s;
+    int             status;
+
+    trace(("collect_cached\n"));
+    assert(result);
+    assert(args);
+    assert(args->nstrings);
+    for (sep = 1; sep < args->nstrings; ++sep)
+        if (!strcmp(args->string[sep]->str_text, "--"))
+            break;
+    if (sep + 1 >= args->nstrings)
+    {
+        sub_context_ty  *scp;
+
+        scp = sub_context_new();
+        sub_var_set_string(scp, "Name", args->string[0]);
+        error_with_position
+        (
+            pp,
+            scp,
+            i18n("$name: requires inputs, a \"--\" separator, and a command")
+        );
+        sub_context_delete(scp);
+        return -1;
+    }
+
+    /*
+     * The key is everything the output depends on, apart from the
+     * contents of the input files.  Environment variables are
+     * included by value, so that a change is seen.
+     */
+    string_list_constructor(&inputs);
+    stracc_constructor(&key);
+    sa_open(&key);
+    sa_chars(&key, args->string[0]->str_text, args->string[0]->str_length);
+    for (j = 1; j < sep; ++j)
+    {
+        s = args->string[j];
+        if (s->str_text[0] == '$')
+        {
+            char            *cp;
+            string_ty       *v;
+
+            cp = getenv(s->str_text + 1);
+            if (cp)
+                v = str_format("%s=%ld:%s", s->str_text, (long)strlen(cp), cp);
+            else
+                v = str_format("%s-", s->str_text);
+            s = str_format("%ld:%s", (long)v->str_length, v->str_text);
+            str_free(v);
+        }
+        else
+        {
+            string_list_append(&inputs, s);
+            s = str_format("%ld:%s", (long)s->str_length, s->str_text);
+        }
+        sa_char(&key, ' ');
+        sa_chars(&key, s->str_text, s->str_length);
+        str_free(s);
+    }
+    string_list_constructor(&command);
+    string_list_append(&command, args->string[0]);
+    sa_chars(&key, " --", 3);
+    for (j = sep + 1; j < args->nstrings; ++j)
+    {
+        s = args->string[j];
+        string_list_append(&command, s);
+        s = str_format(" %ld:%s", (long)s->str_length, s->str_text);
+        sa_chars(&key, s->str_text, s->str_length);
+        str_free(s);
+    }
+    s = sa_close(&key);
+    stracc_destructor(&key);
+
+    status = 0;
+    if (!collect_cache_query(s, &inputs, result))
+    {
+        string_list_constructor(&output);
+        status = collect(&output, &command, pp, lines);
+        if (!status)
+        {
+            collect_cache_remember(s, &output);
+            string_list_append_list(result, &output);
+        }
+        string_list_destructor(&output);
+    }
+    str_free(s);
+    string_list_destructor(&command);
+    string_list_destructor(&inputs);
+    return status;
+}
+
+
+static int
+interpret_cached(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, const struct opcode_context_ty *ocp)
+{
+    (void)ocp;
+    return collect_cached(result, args, pp, 0);
+}
+
+
+static int
+interpret_lines_cached(string_list_ty *result, const string_list_ty *args,
+    const expr_position_ty *pp, const struct opcode_context_ty *ocp)
+{
+    (void)ocp;
+    return collect_cached(result, args, pp, 1);
+}
+
+
+builtin_ty builtin_collect_cached =
+{
+    "collect_cached",
+    interpret_cached,
+    interpret_cached,           /* script */
+};
+
+
+builtin_ty builtin_collect_lines_cached =
+{
+    "collect_lines_cached",
+    interpret_lines_cached,
+    interpret_lines_cached,     /* script */
 };
 
 
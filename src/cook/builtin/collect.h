@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -25,5 +25,7 @@
 extern builtin_ty builtin_collect;
 extern builtin_ty builtin_shell;
 extern builtin_ty builtin_collect_lines;
+extern builtin_ty builtin_collect_cached;
+extern builtin_ty builtin_collect_lines_cached;
 
 #endif /* COOK_BUILTIN_COLLECT_H */
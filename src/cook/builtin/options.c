@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1996-1999, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1996-1999, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -75,12 +75,15 @@ static table_ty table[] =
     { OPTION_ERROK, "-errok", "-noerrok" },
     { OPTION_FINGERPRINT, "-fingerprint", "-nofingerprint" },
     { OPTION_FORCE, "-force", "-noforce" },
+    { OPTION_GROUP_OUTPUT, "-group-output", "-no-group-output" },
     { OPTION_INCLUDE_COOKED, "-include-cooked", "-no-include-cooked" },
     { OPTION_INCLUDE_COOKED_WARNING, "-include-cooked-warning",
         "-no-include-cooked-warning" },
     { OPTION_METER, "-meter", "-nometer" },
     { OPTION_PERSEVERE, "-continue", "-nocontinue" },
+    { OPTION_PIPELINE, "-pipeline", "-nopipeline" },
     { OPTION_PRECIOUS, "-precious", "-noprecious" },
+    { OPTION_PROFILE, "-profile", "-noprofile" },
     { OPTION_REASON, "-reason", "-noreason" },
     { OPTION_SHALLOW, "-shallow", "-noshallow" },
     { OPTION_SILENT, "-silent", "-nosilent" },
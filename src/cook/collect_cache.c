@@ -0,0 +1,608 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * The collect cache remembers the output of the [collect_cached] and
+ * [collect_lines_cached] functions between runs, so that the commands
+ * need not be run again until one of their declared inputs changes.
+ *
+ * Each entry is found by a key made from the command and anything
+ * else its output depends on (see cook/builtin/collect.c).  It holds
+ * the state of each input when the command was run, and the words the
+ * command wrote.  A file input is compared by its fingerprint, but the
+ * fingerprint is only recalculated when the file's inode details have
+ * changed.  A directory input is compared by its modification time, so
+ * adding or removing entries is seen, but changes further down are
+ * not.  A missing input must still be missing.
+ *
+ * The cache is a file of records, one per entry, each framed by its
+ * length and a checksum (see common/record.c).  It is read the first
+ * time it is needed and rewritten when cook exits, if anything was
+ * added.  Anything that cannot be understood is silently ignored; it
+ * is only a cache.
+ */
+
+#include <common/ac/string.h>
+#include <common/ac/time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <common/mem.h>
+#include <common/progname.h>
+#include <common/quit.h>
+#include <common/record.h>
+#include <common/str_list.h>
+#include <common/stracc.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <common/whole_file.h>
+#include <cook/collect_cache.h>
+#include <cook/fingerprint.h>
+
+typedef struct input_ty input_ty;
+struct input_ty
+{
+    string_ty       *path;
+    int             kind;       /* 'f' file, 'd' directory, '-' missing */
+    long            mtime;
+    long            ctime;
+    long            size;
+    long            ino;
+    string_ty       *fingerprint;
+};
+
+typedef struct entry_ty entry_ty;
+struct entry_ty
+{
+    size_t          ninputs;
+    input_ty        *input;
+    string_list_ty  result;
+    int             valid;
+};
+
+static char     magic[] = "cook collect v2\n";
+static symtab_ty *entries;
+static int      dirty;
+
+
+static char *
+collect_cache_filename(void)
+{
+    static string_ty *s;
+
+    if (!s)
+        s = str_format(".%.10s.collect", progname_get());
+    return s->str_text;
+}
+
+
+static entry_ty *
+entry_new(size_t ninputs)
+{
+    entry_ty        *ep;
+
+    ep = mem_alloc(sizeof(entry_ty));
+    ep->ninputs = ninputs;
+    ep->input = mem_alloc((ninputs + 1) * sizeof(ep->input[0]));
+    memset(ep->input, 0, (ninputs + 1) * sizeof(ep->input[0]));
+    string_list_constructor(&ep->result);
+    ep->valid = 0;
+    return ep;
+}
+
+
+static void
+reap(void *p)
+{
+    entry_ty        *ep;
+    size_t          j;
+
+    ep = p;
+    for (j = 0; j < ep->ninputs; ++j)
+    {
+        if (ep->input[j].path)
+            str_free(ep->input[j].path);
+        if (ep->input[j].fingerprint)
+            str_free(ep->input[j].fingerprint);
+    }
+    mem_free(ep->input);
+    string_list_destructor(&ep->result);
+    mem_free(ep);
+}
+
+
+/*
+ * NAME
+ *      input_state
+ *
+ * SYNOPSIS
+ *      void input_state(input_ty *ip, string_ty *path,
+ *              const input_ty *old);
+ *
+ * DESCRIPTION
+ *      The input_state function is used to find the present state of
+ *      an input.  If the old state of the input is known, and the
+ *      file's inode details have not changed, its old fingerprint is
+ *      used rather than reading the file again.
+ */
+
+static void
+input_state(input_ty *ip, string_ty *path, const input_ty *old)
+{
+    struct stat     st;
+
+    ip->path = str_copy(path);
+    ip->kind = '-';
+    ip->mtime = 0;
+    ip->ctime = 0;
+    ip->size = 0;
+    ip->ino = 0;
+    ip->fingerprint = 0;
+    if (stat(path->str_text, &st))
+        return;
+    ip->mtime = st.st_mtime;
+    ip->ctime = st.st_ctime;
+    ip->ino = st.st_ino;
+    if (S_ISDIR(st.st_mode))
+        ip->kind = 'd';
+    else
+    {
+        ip->size = st.st_size;
+        if
+        (
+            old
+        &&
+            old->kind == 'f'
+        &&
+            old->mtime == ip->mtime
+        &&
+            old->ctime == ip->ctime
+        &&
+            old->size == ip->size
+        &&
+            old->ino == ip->ino
+        )
+        {
+            ip->kind = 'f';
+            ip->fingerprint = str_copy(old->fingerprint);
+        }
+        else
+        {
+            ip->fingerprint = fp_fingerprint(path);
+            if (!ip->fingerprint)
+                return;
+            ip->kind = 'f';
+        }
+    }
+
+    /*
+     * The times only have a resolution of one second.  If the input
+     * changed this second, it could change again without the times
+     * changing, so make sure they will not match next time.
+     */
+    if (ip->mtime >= time((time_t *)0) || ip->ctime >= time((time_t *)0))
+        ip->mtime = -1;
+}
+
+
+static int
+input_same(const input_ty *a, const input_ty *b)
+{
+    if (a->kind != b->kind)
+        return 0;
+    switch (a->kind)
+    {
+    case 'f':
+        return str_equal(a->fingerprint, b->fingerprint);
+
+    case 'd':
+        return (a->mtime == b->mtime && a->ino == b->ino);
+    }
+    return 1;
+}
+
+
+static int
+get_long(record_reader_ty *rp, long *np)
+{
+    return record_get(rp, np, sizeof(*np));
+}
+
+
+static string_ty *
+get_string(record_reader_ty *rp)
+{
+    size_t          len;
+    string_ty       *s;
+
+    if (record_get_number(rp, &len) || len > rp->len - rp->pos)
+        return 0;
+    s = str_n_from_c(rp->buf + rp->pos, len);
+    rp->pos += len;
+    return s;
+}
+
+
+/*
+ * NAME
+ *      read_entry
+ *
+ * SYNOPSIS
+ *      int read_entry(record_reader_ty *rp);
+ *
+ * DESCRIPTION
+ *      The read_entry function is used to read one entry of the cache
+ *      file, and remember it.
+ *
+ * RETURNS
+ *      int; 0 on success, -1 if the entry is damaged.
+ *
+ * CAVEAT
+ *      Must be symmetric with write_entry, below.
+ */
+
+static int
+read_entry(record_reader_ty *rp)
+{
+    string_ty       *key;
+    string_ty       *s;
+    size_t          ninputs;
+    size_t          nwords;
+    size_t          j;
+    entry_ty        *ep;
+
+    key = get_string(rp);
+    if (!key)
+        return -1;
+    if
+    (
+        record_get_number(rp, &ninputs)
+    ||
+        record_get_number(rp, &nwords)
+    ||
+        ninputs > rp->len
+    )
+    {
+        str_free(key);
+        return -1;
+    }
+    ep = entry_new(ninputs);
+    for (j = 0; j < ninputs; ++j)
+    {
+        input_ty        *ip;
+
+        ip = &ep->input[j];
+        if (rp->pos >= rp->len)
+            goto damaged;
+        ip->kind = rp->buf[rp->pos++];
+        if
+        (
+            (ip->kind != 'f' && ip->kind != 'd' && ip->kind != '-')
+        ||
+            get_long(rp, &ip->mtime)
+        ||
+            get_long(rp, &ip->ctime)
+        ||
+            get_long(rp, &ip->size)
+        ||
+            get_long(rp, &ip->ino)
+        )
+            goto damaged;
+        ip->path = get_string(rp);
+        if (!ip->path)
+            goto damaged;
+        ip->fingerprint = get_string(rp);
+        if (!ip->fingerprint)
+            goto damaged;
+    }
+    for (j = 0; j < nwords; ++j)
+    {
+        s = get_string(rp);
+        if (!s)
+            goto damaged;
+        string_list_append(&ep->result, s);
+        str_free(s);
+    }
+    ep->valid = 1;
+    symtab_assign(entries, key, ep);
+    str_free(key);
+    return 0;
+
+  damaged:
+    reap(ep);
+    str_free(key);
+    return -1;
+}
+
+
+/*
+ * NAME
+ *      collect_cache_read
+ *
+ * SYNOPSIS
+ *      void collect_cache_read(void);
+ *
+ * DESCRIPTION
+ *      The collect_cache_read function is used to read the cache file,
+ *      the first time it is needed.
+ */
+
+static void
+collect_cache_read(void)
+{
+    char            *filename;
+    char            *buf;
+    size_t          len;
+    record_reader_ty f;
+    record_reader_ty r;
+
+    if (entries)
+        return;
+    trace(("collect_cache_read()\n{\n"));
+    entries = symtab_alloc(100);
+    entries->reap = reap;
+
+    filename = collect_cache_filename();
+    buf = read_whole_file(filename, &len);
+    if (!buf)
+    {
+        trace(("}\n"));
+        return;
+    }
+
+    f.buf = buf;
+    f.len = len;
+    f.pos = sizeof(magic) - 1;
+    if (len >= f.pos && !memcmp(buf, magic, f.pos))
+    {
+        while (!record_next(&f, &r, (unsigned long *)0))
+        {
+            if (r.buf[0] == 'K' && read_entry(&r))
+            {
+                trace(("damaged entry at %ld\n", (long)f.pos));
+                break;
+            }
+        }
+    }
+    mem_free(buf);
+    trace(("}\n"));
+}
+
+
+static void
+put_long(stracc *sap, long n)
+{
+    sa_chars(sap, (char *)&n, sizeof(n));
+}
+
+
+static void
+put_string(stracc *sap, string_ty *s)
+{
+    record_put_number(sap, s->str_length);
+    sa_chars(sap, s->str_text, s->str_length);
+}
+
+
+static void
+write_entry(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    entry_ty        *ep;
+    stracc          *sap;
+    size_t          mark;
+    size_t          j;
+
+    (void)stp;
+    ep = data;
+    sap = arg;
+    if (!ep->valid)
+        return;
+    mark = record_begin(sap, 'K');
+    put_string(sap, key);
+    record_put_number(sap, ep->ninputs);
+    record_put_number(sap, ep->result.nstrings);
+    for (j = 0; j < ep->ninputs; ++j)
+    {
+        input_ty        *ip;
+
+        ip = &ep->input[j];
+        sa_char(sap, ip->kind);
+        put_long(sap, ip->mtime);
+        put_long(sap, ip->ctime);
+        put_long(sap, ip->size);
+        put_long(sap, ip->ino);
+        put_string(sap, ip->path);
+        if (ip->fingerprint)
+            put_string(sap, ip->fingerprint);
+        else
+            record_put_number(sap, 0);
+    }
+    for (j = 0; j < ep->result.nstrings; ++j)
+        put_string(sap, ep->result.string[j]);
+    record_end(sap, mark);
+}
+
+
+/*
+ * NAME
+ *      collect_cache_write
+ *
+ * SYNOPSIS
+ *      void collect_cache_write(void);
+ *
+ * DESCRIPTION
+ *      The collect_cache_write function is used to write the cache file
+ *      when cook exits, if anything has been added to it.  It is written
+ *      to a temporary file first, and then renamed into place.
+ */
+
+static void
+collect_cache_write(void)
+{
+    stracc          sa;
+
+    if (!dirty)
+        return;
+    dirty = 0;
+    trace(("collect_cache_write()\n{\n"));
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    sa_chars(&sa, magic, sizeof(magic) - 1);
+    symtab_walk(entries, write_entry, &sa);
+    write_whole_file(collect_cache_filename(), sa.sa_buf, sa.sa_len);
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+    trace(("}\n"));
+}
+
+
+
+/*
+ * NAME
+ *      write_on_quit
+ *
+ * SYNOPSIS
+ *      void write_on_quit(void);
+ *
+ * DESCRIPTION
+ *      The write_on_quit function is used to arrange for the cache file
+ *      to be written when cook exits.  There is room for only a few
+ *      quit handlers, so it is only registered once.
+ */
+
+static void
+write_on_quit(void)
+{
+    static int      registered;
+
+    if (registered)
+        return;
+    registered = 1;
+    quit_handler(collect_cache_write);
+}
+
+/*
+ * NAME
+ *      collect_cache_query
+ *
+ * SYNOPSIS
+ *      int collect_cache_query(string_ty *key,
+ *              const string_list_ty *inputs, string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The collect_cache_query function is used to look for the output
+ *      of a command in the cache.  It is only used if none of the
+ *      inputs have changed since it was remembered.
+ *
+ *      If it can not be used, the present state of the inputs is
+ *      noted, ready for collect_cache_remember.  (The inputs are looked
+ *      at before the command is run, so that a change made while it
+ *      runs will be seen next time.)
+ *
+ * RETURNS
+ *      int; 1 if the output was found (and has been appended to the
+ *      result), 0 if the command must be run.
+ */
+
+int
+collect_cache_query(string_ty *key, const string_list_ty *inputs,
+    string_list_ty *result)
+{
+    entry_ty        *old;
+    entry_ty        *ep;
+    size_t          j;
+    int             same;
+
+    trace(("collect_cache_query(key = \"%s\")\n{\n", key->str_text));
+    collect_cache_read();
+    old = symtab_query(entries, key);
+    if (old && old->ninputs != inputs->nstrings)
+        old = 0;
+    ep = entry_new(inputs->nstrings);
+    same = (old && old->valid);
+    for (j = 0; j < inputs->nstrings; ++j)
+    {
+        input_state
+        (
+            &ep->input[j],
+            inputs->string[j],
+            (old ? &old->input[j] : (input_ty *)0)
+        );
+        if (same && !input_same(&ep->input[j], &old->input[j]))
+            same = 0;
+    }
+    if (same)
+    {
+        /*
+         * Keep the newer inode details, so that the files need not
+         * be read again next time.
+         */
+        for (j = 0; j < ep->ninputs; ++j)
+        {
+            if
+            (
+                ep->input[j].mtime != old->input[j].mtime
+            ||
+                ep->input[j].ctime != old->input[j].ctime
+            ||
+                ep->input[j].ino != old->input[j].ino
+            )
+                dirty = 1;
+        }
+        string_list_append_list(result, &old->result);
+        string_list_copy_constructor(&ep->result, &old->result);
+        ep->valid = 1;
+    }
+    symtab_assign(entries, key, ep);
+    if (dirty)
+        write_on_quit();
+    trace(("return %d;\n", same));
+    trace(("}\n"));
+    return same;
+}
+
+
+/*
+ * NAME
+ *      collect_cache_remember
+ *
+ * SYNOPSIS
+ *      void collect_cache_remember(string_ty *key,
+ *              const string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The collect_cache_remember function is used to remember the
+ *      output of a command which ran successfully, after a call to
+ *      collect_cache_query did not find it.
+ */
+
+void
+collect_cache_remember(string_ty *key, const string_list_ty *result)
+{
+    entry_ty        *ep;
+
+    trace(("collect_cache_remember(key = \"%s\")\n{\n", key->str_text));
+    ep = symtab_query(entries, key);
+    assert(ep);
+    string_list_destructor(&ep->result);
+    string_list_copy_constructor(&ep->result, result);
+    ep->valid = 1;
+    dirty = 1;
+    write_on_quit();
+    trace(("}\n"));
+}
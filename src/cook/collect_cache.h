@@ -0,0 +1,33 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_COLLECT_CACHE_H
+#define COOK_COLLECT_CACHE_H
+
+#include <common/main.h>
+
+struct string_ty; /* existence */
+struct string_list_ty; /* existence */
+
+int collect_cache_query(struct string_ty *key,
+        const struct string_list_ty *inputs, struct string_list_ty *result);
+void collect_cache_remember(struct string_ty *key,
+        const struct string_list_ty *result);
+
+#endif /* COOK_COLLECT_CACHE_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994-1999, 2001, 2002, 2006-2009 Peter Miller
+ *      Copyright (C) 1994-1999, 2001, 2002, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -97,7 +97,9 @@
 #include <cook/graph/build.h>
 #include <cook/graph/file_pair.h>
 #include <cook/graph/leaf.h>
+#include <cook/graph/ninja.h>
 #include <cook/graph/stats.h>
+#include <cook/graph/stream.h>
 #include <cook/graph/walk.h>
 #include <cook/graph/web.h>
 #include <cook/id.h>
@@ -624,6 +626,8 @@ cook(string_list_ty *wlp)
         gp->file_pair = graph_file_pair_new((string_list_ty *) 0);
         graph_file_pair_foreign_derived(gp->file_pair, &cook_auto_list_nonleaf);
     }
+    if (option_test(OPTION_PIPELINE))
+        graph_stream_begin(gp);
     gb_status = graph_build_list(gp, wlp, graph_build_preference_error, 1);
     if (option_test(OPTION_REASON))
         graph_print_statistics(gp);
@@ -641,6 +645,8 @@ cook(string_list_ty *wlp)
     case graph_build_status_success:
         break;
     }
+    if (retval)
+        graph_stream_end(gp);
 
     /*
      * Walk the dependency graph.
@@ -872,6 +878,104 @@ cook_script(string_list_ty *wlp)
 }
 
 
+/*
+ * NAME
+ *      cook_ninja
+ *
+ * SYNOPSIS
+ *      int cook_ninja(string_list_ty *);
+ *
+ * DESCRIPTION
+ *      The cook_ninja function is used to print a ninja build file to
+ *      build the given targets.  Every recipe instance of the graph is
+ *      written with its expanded commands, so that the build may be
+ *      replayed by a parallel executor without cook.  Like the shell
+ *      script, it's only an approximation of the full cook semantics.
+ *
+ * RETURNS
+ *      int; 0 on success, 1 on failure (exit statii)
+ */
+
+int
+cook_ninja(string_list_ty *wlp)
+{
+    int             retval;
+    graph_ty        *gp;
+    graph_build_status_ty gb_status;
+    graph_walk_status_ty gw_status;
+    size_t          j;
+
+    trace(("cook_ninja(wlp = %p)\n{\n", wlp));
+    desist_enable();
+
+    /*
+     * Build the dependency graph.
+     */
+    retval = 0;
+    gp = graph_new();
+    gb_status = graph_build_list(gp, wlp, graph_build_preference_error, 0);
+    if (option_test(OPTION_REASON))
+        graph_print_statistics(gp);
+    switch (gb_status)
+    {
+    case graph_build_status_error:
+    case graph_build_status_backtrack:
+        retval = 1;
+        break;
+
+    case graph_build_status_success:
+        break;
+    }
+
+    /*
+     * Walk the dependency graph.
+     */
+    if (retval == 0)
+    {
+        gw_status = graph_walk_ninja(gp);
+        switch (gw_status)
+        {
+        case graph_walk_status_uptodate:
+        case graph_walk_status_uptodate_done:
+        case graph_walk_status_done:
+            break;
+
+        case graph_walk_status_done_stop:
+        case graph_walk_status_wait:
+            assert(0);
+            /* fall through... */
+
+        case graph_walk_status_error:
+            retval = 1;
+            break;
+        }
+    }
+
+    /*
+     * The targets asked for are the default.
+     */
+    if (retval == 0)
+    {
+        printf("\ndefault");
+        for (j = 0; j < wlp->nstrings; ++j)
+        {
+            printf(" ");
+            graph_ninja_path(wlp->string[j]);
+        }
+        printf("\n");
+    }
+
+    /*
+     * Release any resources held by the graph.
+     */
+    graph_delete(gp);
+
+    trace(("return %d;\n", retval));
+    trace(("}\n"));
+    return retval;
+}
+
+
 /*
  * NAME
  *      cook_web
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-1997, 1999, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1993-1997, 1999, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -32,6 +32,7 @@ struct string_list_ty; /* existence */
 int cook(struct string_list_ty *);
 int cook_pairs(struct string_list_ty *);
 int cook_script(struct string_list_ty *);
+int cook_ninja(struct string_list_ty *);
 int cook_web(struct string_list_ty *);
 
 time_t cook_mtime_oldest(const struct opcode_context_ty *,
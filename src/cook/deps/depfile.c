@@ -0,0 +1,282 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/stdio.h>
+#include <common/ac/string.h>
+
+#include <common/error_intl.h>
+#include <common/str_list.h>
+#include <common/stracc.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <cook/deps/depfile.h>
+#include <cook/deps/log.h>
+#include <cook/strip_dot.h>
+
+
+/*
+ * NAME
+ *      depfile_name - where the compiler put it
+ *
+ * SYNOPSIS
+ *      string_ty *depfile_name(string_ty *target);
+ *
+ * DESCRIPTION
+ *      The depfile_name function is used to work out the name of the
+ *      dependency file written alongside the given target.  This is
+ *      the target with its suffix replaced by ".d", which is what gcc
+ *      and clang do for -MD and -MMD when given -o.
+ *
+ * RETURNS
+ *      string_ty *; use str_free when you are done with it.
+ */
+
+string_ty *
+depfile_name(string_ty *target)
+{
+    const char      *base;
+    const char      *dot;
+
+    base = strrchr(target->str_text, '/');
+    base = (base ? base + 1 : target->str_text);
+    dot = strrchr(base, '.');
+    if (!dot || dot == base)
+        return str_format("%s.d", target->str_text);
+    return
+        str_format("%.*s.d", (int)(dot - target->str_text), target->str_text);
+}
+
+
+/*
+ * NAME
+ *      add_word - remember a file name
+ *
+ * SYNOPSIS
+ *      void add_word(stracc *sap, symtab_ty *seen,
+ *              string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The add_word function is used to add the word accumulated so
+ *      far to the results, unless it is already there.
+ */
+
+static void
+add_word(stracc *sap, symtab_ty *seen, string_list_ty *result)
+{
+    string_ty       *s;
+    string_ty       *s2;
+
+    s = sa_close(sap);
+    s2 = strip_dot(s);
+    str_free(s);
+    if (!symtab_query(seen, s2))
+    {
+        symtab_assign(seen, s2, s2);
+        string_list_append(result, s2);
+    }
+    str_free(s2);
+}
+
+
+/*
+ * NAME
+ *      depfile_read - read a dependency file
+ *
+ * SYNOPSIS
+ *      int depfile_read(string_ty *filename, string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The depfile_read function is used to read a make(1) style
+ *      dependency file, as written by a compiler, and append the
+ *      ingredients of all of its rules to the result.  The targets
+ *      are not included.
+ *
+ *      Rules may be continued with backslash-newline, a backslash
+ *      escapes a space or a hash in a file name, and "$$" stands for
+ *      a dollar.  Comments run from a hash to the end of the line.
+ *
+ * RETURNS
+ *      int; 0 on success, -1 if the file could not be read.  It is not
+ *      an error for the file not to exist, but -1 is still returned.
+ */
+
+int
+depfile_read(string_ty *filename, string_list_ty *result)
+{
+    FILE            *fp;
+    stracc          sa;
+    symtab_ty       *seen;
+    int             in_word;
+    int             after_colon;
+    int             c;
+
+    trace(("depfile_read(filename = \"%s\")\n{\n", filename->str_text));
+    fp = fopen(filename->str_text, "r");
+    if (!fp)
+    {
+        if (errno != ENOENT)
+            error_intl_open(filename->str_text);
+        trace(("return -1;\n"));
+        trace(("}\n"));
+        return -1;
+    }
+
+    seen = symtab_alloc(100);
+    stracc_constructor(&sa);
+    in_word = 0;
+    after_colon = 0;
+    for (;;)
+    {
+        c = getc(fp);
+        switch (c)
+        {
+        case '\\':
+            c = getc(fp);
+            if (c == '\n')
+            {
+                /* a continuation does not end the rule */
+                c = ' ';
+                goto end_of_word;
+            }
+            if (c == '\r')
+            {
+                c = getc(fp);
+                if (c == '\n')
+                {
+                    c = ' ';
+                    goto end_of_word;
+                }
+                if (c != EOF)
+                    ungetc(c, fp);
+                c = '\r';
+            }
+            if (c != ' ' && c != '#' && c != '\\')
+            {
+                if (c != EOF)
+                    ungetc(c, fp);
+                c = '\\';
+            }
+            goto normal;
+
+        case '$':
+            c = getc(fp);
+            if (c != '$')
+            {
+                if (c != EOF)
+                    ungetc(c, fp);
+                c = '$';
+            }
+            goto normal;
+
+        case '#':
+            while (c != '\n' && c != EOF)
+                c = getc(fp);
+            /* fall through... */
+
+        case EOF:
+        case '\n':
+        case ' ':
+        case '\t':
+        case '\r':
+          end_of_word:
+            if (in_word)
+            {
+                if (after_colon)
+                    add_word(&sa, seen, result);
+                else
+                    str_free(sa_close(&sa));
+                in_word = 0;
+            }
+            if (c == '\n')
+                after_colon = 0;
+            break;
+
+        case ':':
+            if (!after_colon)
+            {
+                if (in_word)
+                {
+                    str_free(sa_close(&sa));
+                    in_word = 0;
+                }
+                after_colon = 1;
+                break;
+            }
+            /* fall through... */
+
+        default:
+          normal:
+            if (!in_word)
+            {
+                sa_open(&sa);
+                in_word = 1;
+            }
+            sa_char(&sa, c);
+            break;
+        }
+        if (c == EOF)
+            break;
+    }
+    stracc_destructor(&sa);
+    symtab_free(seen);
+    if (ferror(fp))
+    {
+        error_intl_read(filename->str_text);
+        fclose(fp);
+        trace(("return -1;\n"));
+        trace(("}\n"));
+        return -1;
+    }
+    fclose(fp);
+    trace(("return 0;\n"));
+    trace(("}\n"));
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      depfile_ingest - record discovered ingredients
+ *
+ * SYNOPSIS
+ *      void depfile_ingest(string_ty *target);
+ *
+ * DESCRIPTION
+ *      The depfile_ingest function is used, after a recipe with the
+ *      depfile flag has run, to read the dependency file the compiler
+ *      wrote alongside the target and record its ingredients in the
+ *      dependency log.  Nothing is recorded if there is no such file.
+ */
+
+void
+depfile_ingest(string_ty *target)
+{
+    string_ty       *filename;
+    string_list_ty  ingredients;
+
+    trace(("depfile_ingest(target = \"%s\")\n{\n", target->str_text));
+    filename = depfile_name(target);
+    string_list_constructor(&ingredients);
+    if (!depfile_read(filename, &ingredients))
+        deps_log_record(target, &ingredients);
+    string_list_destructor(&ingredients);
+    str_free(filename);
+    trace(("}\n"));
+}
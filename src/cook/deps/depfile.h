@@ -0,0 +1,32 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_DEPS_DEPFILE_H
+#define COOK_DEPS_DEPFILE_H
+
+#include <common/main.h>
+
+struct string_ty; /* existence */
+struct string_list_ty; /* existence */
+
+struct string_ty *depfile_name(struct string_ty *);
+int depfile_read(struct string_ty *, struct string_list_ty *);
+void depfile_ingest(struct string_ty *);
+
+#endif /* COOK_DEPS_DEPFILE_H */
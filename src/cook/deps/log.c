@@ -0,0 +1,605 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * The dependency log remembers the ingredients each target's recipe
+ * discovered the last time it ran (typically from a compiler-written
+ * .d file), so that they can be added to the graph on later runs
+ * without any cookbook parsing.  This is like ninja's .ninja_deps file.
+ *
+ * The log is a binary file of records, each framed by its length and
+ * a checksum, so that a record torn by a crash is detected and the
+ * rest of the log ignored.  There are two kinds of record:
+ *
+ *      'P'     a batch of path names; each is given the next number,
+ *              starting from zero at the top of the file.
+ *      'D'     a target's path number, followed by the path numbers
+ *              of its ingredients.
+ *
+ * New records are appended as each recipe finishes, so that nothing is
+ * lost if cook is interrupted.  When the same target appears in several
+ * records, the last one wins.  When most of the records have been
+ * superseded, the whole log is written again from scratch.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/progname.h>
+#include <common/record.h>
+#include <common/str_list.h>
+#include <common/stracc.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <common/whole_file.h>
+#include <cook/deps/log.h>
+
+typedef struct path_ty path_ty;
+struct path_ty
+{
+    size_t          number;
+};
+
+static char     magic[] = "cook deps v1\n";
+static symtab_ty *targets;
+static symtab_ty *paths;
+static size_t   npaths;
+static long     log_size;
+static int      need_to_compact;
+
+
+static void
+reap_target(void *p)
+{
+    string_list_delete(p);
+}
+
+
+static void
+reap_path(void *p)
+{
+    mem_free(p);
+}
+
+
+static char *
+deps_log_filename(void)
+{
+    static string_ty *s;
+
+    if (!s)
+        s = str_format(".%.10s.deps", progname_get());
+    return s->str_text;
+}
+
+
+/*
+ * NAME
+ *      read_paths - read a 'P' record
+ *
+ * SYNOPSIS
+ *      int read_paths(record_reader_ty *rp, string_list_ty *number);
+ *
+ * DESCRIPTION
+ *      The read_paths function is used to read a batch of path names,
+ *      and number them.
+ *
+ * RETURNS
+ *      0 on success, -1 if the record is damaged
+ */
+
+static int
+read_paths(record_reader_ty *rp, string_list_ty *number)
+{
+    size_t          count;
+
+    if (record_get_number(rp, &count))
+        return -1;
+    while (count > 0)
+    {
+        size_t          len;
+        string_ty       *s;
+
+        if (record_get_number(rp, &len) || len > rp->len - rp->pos)
+            return -1;
+        s = str_n_from_c(rp->buf + rp->pos, len);
+        rp->pos += len;
+        string_list_append(number, s);
+        str_free(s);
+        --count;
+    }
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      read_deps - read a 'D' record
+ *
+ * SYNOPSIS
+ *      int read_deps(record_reader_ty *rp, string_list_ty *number);
+ *
+ * DESCRIPTION
+ *      The read_deps function is used to read a target's ingredients,
+ *      replacing any earlier record for the same target.
+ *
+ * RETURNS
+ *      0 on success, -1 if the record is damaged
+ */
+
+static int
+read_deps(record_reader_ty *rp, string_list_ty *number)
+{
+    size_t          n;
+    size_t          count;
+    string_ty       *target;
+    string_list_ty  *slp;
+
+    if (record_get_number(rp, &n) || n >= number->nstrings)
+        return -1;
+    target = number->string[n];
+    if (record_get_number(rp, &count))
+        return -1;
+    slp = string_list_new();
+    while (count > 0)
+    {
+        if (record_get_number(rp, &n) || n >= number->nstrings)
+        {
+            string_list_delete(slp);
+            return -1;
+        }
+        string_list_append(slp, number->string[n]);
+        --count;
+    }
+    symtab_assign(targets, target, slp);
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      deps_log_read - read the log
+ *
+ * SYNOPSIS
+ *      void deps_log_read(void);
+ *
+ * DESCRIPTION
+ *      The deps_log_read function is used to read the dependency log,
+ *      the first time it is needed.
+ *
+ * CAVEATS
+ *      A missing log, one written by a different version, or a damaged
+ *      one, is not an error.  Whatever could be read is used, and the
+ *      log is rewritten the next time anything is recorded.
+ */
+
+static void
+deps_log_read(void)
+{
+    char            *filename;
+    char            *buf;
+    size_t          buflen;
+    record_reader_ty f;
+    size_t          pos;
+    size_t          nrecords;
+    string_list_ty  number;
+
+    if (targets)
+        return;
+    trace(("deps_log_read()\n{\n"));
+    targets = symtab_alloc(100);
+    targets->reap = reap_target;
+    paths = symtab_alloc(100);
+    paths->reap = reap_path;
+    npaths = 0;
+    log_size = 0;
+
+    filename = deps_log_filename();
+    buf = read_whole_file(filename, &buflen);
+    if (!buf)
+    {
+        need_to_compact = 1;
+        trace(("}\n"));
+        return;
+    }
+    if (buflen < sizeof(magic) - 1 || memcmp(buf, magic, sizeof(magic) - 1))
+    {
+        need_to_compact = 1;
+        mem_free(buf);
+        trace(("}\n"));
+        return;
+    }
+
+    string_list_constructor(&number);
+    nrecords = 0;
+    f.buf = buf;
+    f.pos = sizeof(magic) - 1;
+    f.len = buflen;
+    for (;;)
+    {
+        record_reader_ty r;
+        int             err;
+
+        pos = f.pos;
+        if (record_next(&f, &r, (unsigned long *)0))
+            break;
+        switch (r.buf[0])
+        {
+        case 'P':
+            err = read_paths(&r, &number);
+            break;
+
+        case 'D':
+            err = read_deps(&r, &number);
+            ++nrecords;
+            break;
+
+        default:
+            err = -1;
+            break;
+        }
+        if (err)
+            break;
+    }
+    if (pos < buflen)
+    {
+        trace(("damaged record at %ld\n", (long)pos));
+        need_to_compact = 1;
+    }
+    log_size = pos;
+
+    /*
+     * Appended records number their paths following on from the
+     * ones already in the file.  (A path may be in the file more
+     * than once, if it has been compacted; the last one will do.)
+     */
+    for (npaths = 0; npaths < number.nstrings; ++npaths)
+    {
+        path_ty         *pp;
+
+        pp = mem_alloc(sizeof(path_ty));
+        pp->number = npaths;
+        symtab_assign(paths, number.string[npaths], pp);
+    }
+    string_list_destructor(&number);
+    mem_free(buf);
+
+    /*
+     * If most of the records have been superseded by later ones,
+     * it is time to compact the file.
+     */
+    if (nrecords > 64 && nrecords > 3 * targets->hash_load)
+        need_to_compact = 1;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      deps_log_query - recorded ingredients
+ *
+ * SYNOPSIS
+ *      const string_list_ty *deps_log_query(string_ty *target);
+ *
+ * DESCRIPTION
+ *      The deps_log_query function is used to find the ingredients
+ *      recorded for the given target.
+ *
+ * RETURNS
+ *      pointer to list, or NULL if nothing has been recorded.
+ *      Do not free.
+ */
+
+const string_list_ty *
+deps_log_query(string_ty *target)
+{
+    deps_log_read();
+    return symtab_query(targets, target);
+}
+
+
+/*
+ * NAME
+ *      put_path - add a path to a 'P' record
+ *
+ * SYNOPSIS
+ *      void put_path(stracc *sap, string_ty *path, size_t *count);
+ *
+ * DESCRIPTION
+ *      The put_path function is used to give a path the next number,
+ *      and add it to the 'P' record being built, unless it already has
+ *      a number.
+ */
+
+static void
+put_path(stracc *sap, string_ty *path, size_t *count)
+{
+    path_ty         *pp;
+
+    if (symtab_query(paths, path))
+        return;
+    pp = mem_alloc(sizeof(path_ty));
+    pp->number = npaths++;
+    symtab_assign(paths, path, pp);
+    record_put_number(sap, path->str_length);
+    sa_chars(sap, path->str_text, path->str_length);
+    ++*count;
+}
+
+
+static void
+put_path_number(stracc *sap, string_ty *path)
+{
+    path_ty         *pp;
+
+    pp = symtab_query(paths, path);
+    assert(pp);
+    record_put_number(sap, pp->number);
+}
+
+
+/*
+ * NAME
+ *      put_paths - write the new paths of a batch of targets
+ *
+ * SYNOPSIS
+ *      void put_paths(stracc *sap, string_list_ty *tl);
+ *
+ * DESCRIPTION
+ *      The put_paths function is used to write a 'P' record containing
+ *      any paths used by the given targets (and their ingredients)
+ *      which have not been numbered yet.
+ *
+ * CAVEATS
+ *      The count at the start of the record is written last, so the
+ *      paths are built in a separate buffer.
+ */
+
+static void
+put_paths(stracc *sap, string_list_ty *tl)
+{
+    stracc          body;
+    size_t          count;
+    size_t          j;
+    size_t          k;
+    size_t          mark;
+
+    stracc_constructor(&body);
+    sa_open(&body);
+    count = 0;
+    for (j = 0; j < tl->nstrings; ++j)
+    {
+        const string_list_ty *ingredients;
+
+        put_path(&body, tl->string[j], &count);
+        ingredients = symtab_query(targets, tl->string[j]);
+        for (k = 0; k < ingredients->nstrings; ++k)
+            put_path(&body, ingredients->string[k], &count);
+    }
+    if (count)
+    {
+        mark = record_begin(sap, 'P');
+        record_put_number(sap, count);
+        sa_chars(sap, body.sa_buf, body.sa_len);
+        record_end(sap, mark);
+    }
+    sa_goto(&body, 0);
+    str_free(sa_close(&body));
+    stracc_destructor(&body);
+}
+
+
+/*
+ * NAME
+ *      put_deps - write a 'D' record
+ *
+ * SYNOPSIS
+ *      void put_deps(stracc *sap, string_ty *target);
+ *
+ * DESCRIPTION
+ *      The put_deps function is used to write a record of a target's
+ *      ingredients.  All of the paths must be numbered already.
+ *
+ * CAVEATS
+ *      Must be symmetric with read_deps above.
+ */
+
+static void
+put_deps(stracc *sap, string_ty *target)
+{
+    const string_list_ty *ingredients;
+    size_t          mark;
+    size_t          j;
+
+    ingredients = symtab_query(targets, target);
+    mark = record_begin(sap, 'D');
+    put_path_number(sap, target);
+    record_put_number(sap, ingredients->nstrings);
+    for (j = 0; j < ingredients->nstrings; ++j)
+        put_path_number(sap, ingredients->string[j]);
+    record_end(sap, mark);
+}
+
+
+/*
+ * NAME
+ *      deps_log_append - append records to the log
+ *
+ * SYNOPSIS
+ *      int deps_log_append(stracc *sap);
+ *
+ * DESCRIPTION
+ *      The deps_log_append function is used to append records to the
+ *      log file, with a single write.
+ *
+ * RETURNS
+ *      int; 0 on success, -1 if the file is not as it was last seen
+ *      (it has gone, or another process has written to it), in which
+ *      case the numbering of the paths can no longer be trusted.
+ */
+
+static int
+deps_log_append(stracc *sap)
+{
+    char            *filename;
+    int             fd;
+    struct stat     st;
+
+    filename = deps_log_filename();
+    fd = open(filename, O_WRONLY | O_APPEND, 0666);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            return -1;
+        fatal_intl_open(filename);
+    }
+    if (fstat(fd, &st) || st.st_size != log_size)
+    {
+        close(fd);
+        return -1;
+    }
+    if (write_all(fd, sap->sa_buf, sap->sa_len))
+        fatal_intl_write(filename);
+    if (close(fd))
+        fatal_intl_close(filename);
+    log_size += sap->sa_len;
+    return 0;
+}
+
+
+static void
+collect(symtab_ty *stp, string_ty *key, void *data, void *arg)
+{
+    (void)stp;
+    (void)data;
+    string_list_append(arg, key);
+}
+
+
+/*
+ * NAME
+ *      deps_log_replace - rewrite the whole log
+ *
+ * SYNOPSIS
+ *      void deps_log_replace(void);
+ *
+ * DESCRIPTION
+ *      The deps_log_replace function is used to write a complete,
+ *      compact log.  It is written to a temporary file first, and then
+ *      renamed into place.  The paths are numbered afresh.
+ */
+
+static void
+deps_log_replace(void)
+{
+    string_list_ty  tl;
+    stracc          sa;
+    size_t          j;
+
+    trace(("deps_log_replace()\n{\n"));
+    symtab_free(paths);
+    paths = symtab_alloc(targets->hash_load + 100);
+    paths->reap = reap_path;
+    npaths = 0;
+
+    string_list_constructor(&tl);
+    symtab_walk(targets, collect, &tl);
+    string_list_sort(&tl);
+
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    sa_chars(&sa, magic, sizeof(magic) - 1);
+    put_paths(&sa, &tl);
+    for (j = 0; j < tl.nstrings; ++j)
+        put_deps(&sa, tl.string[j]);
+    string_list_destructor(&tl);
+
+    write_whole_file(deps_log_filename(), sa.sa_buf, sa.sa_len);
+    log_size = sa.sa_len;
+    need_to_compact = 0;
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      deps_log_record - remember a target's ingredients
+ *
+ * SYNOPSIS
+ *      void deps_log_record(string_ty *target,
+ *              const string_list_ty *ingredients);
+ *
+ * DESCRIPTION
+ *      The deps_log_record function is used to remember the ingredients
+ *      discovered when a target's recipe ran.  They replace any
+ *      recorded earlier.  The log file is updated immediately.
+ */
+
+void
+deps_log_record(string_ty *target, const string_list_ty *ingredients)
+{
+    const string_list_ty *old;
+    string_list_ty  tl;
+    stracc          sa;
+    size_t          j;
+
+    trace(("deps_log_record(target = \"%s\")\n{\n", target->str_text));
+    deps_log_read();
+    old = symtab_query(targets, target);
+    if (old && old->nstrings == ingredients->nstrings)
+    {
+        for (j = 0; j < old->nstrings; ++j)
+            if (!str_equal(old->string[j], ingredients->string[j]))
+                break;
+        if (j >= old->nstrings)
+        {
+            trace(("unchanged\n"));
+            trace(("}\n"));
+            return;
+        }
+    }
+    symtab_assign(targets, target, string_list_new_copy(ingredients));
+
+    if (need_to_compact)
+    {
+        deps_log_replace();
+        trace(("}\n"));
+        return;
+    }
+    string_list_constructor(&tl);
+    string_list_append(&tl, target);
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    put_paths(&sa, &tl);
+    put_deps(&sa, target);
+    string_list_destructor(&tl);
+    if (deps_log_append(&sa))
+        deps_log_replace();
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+    trace(("}\n"));
+}
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -113,6 +113,54 @@ fp_delete(string_ty *path)
 }
 
 
+/*
+ * NAME
+ *      fp_memory
+ *
+ * SYNOPSIS
+ *      long fp_memory(string_ty *path);
+ *
+ * DESCRIPTION
+ *      The fp_memory function is used to find the peak memory used by
+ *      the recipe which last made the given file.
+ *
+ * RETURNS
+ *      long; kilobytes, or zero if not known.
+ */
+
+long
+fp_memory(string_ty *path)
+{
+    fp_record_ty    *p;
+
+    p = fp_find_record(path);
+    return p->value.memory;
+}
+
+
+/*
+ * NAME
+ *      fp_memory_set
+ *
+ * SYNOPSIS
+ *      void fp_memory_set(string_ty *path, long memory);
+ *
+ * DESCRIPTION
+ *      The fp_memory_set function is used to remember the peak memory,
+ *      in kilobytes, used by the recipe which made the given file.  It
+ *      is kept in the fingerprint cache, for use by later Cook runs.
+ */
+
+void
+fp_memory_set(string_ty *path, long memory)
+{
+    trace(("fp_memory_set(path = \"%s\", memory = %ld)\n{\n",
+        path->str_text, memory));
+    fp_record_memory(fp_find_record(path), memory);
+    trace(("}\n"));
+}
+
+
 /*
  * NAME
  *      fp_tweak
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1999, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 1999, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -24,11 +24,16 @@
 
 struct string_ty; /* existence */
 struct fp_value_ty; /* existence */
+struct stat; /* existence */
 
 struct fp_value_ty *fp_search(struct string_ty *path);
 void fp_assign(struct string_ty *, struct fp_value_ty *);
 void fp_delete(struct string_ty *);
+long fp_memory(struct string_ty *);
+void fp_memory_set(struct string_ty *, long);
 struct string_ty *fp_fingerprint(struct string_ty *path);
+void fp_fingerprint_precomputed(struct string_ty *, const struct stat *,
+        struct string_ty *);
 struct string_ty *fp_fingerprint_string(struct string_ty *value);
 void fp_tweak(void);
 
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,13 +18,136 @@
  */
 
 #include <common/ac/errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include <cook/archive.h>
 #include <common/error_intl.h>
 #include <cook/fingerprint.h>
 #include <common/fp/combined.h>
+#include <common/mem.h>
 #include <common/str.h>
+#include <common/symtab.h>
 #include <common/trace.h>
+#include <cook/option.h>
+
+
+/*
+ * Fingerprints calculated ahead of time (by another process) are
+ * held here, with the identity of the file they were calculated from,
+ * until fp_fingerprint asks for them.
+ */
+typedef struct precomputed_ty precomputed_ty;
+struct precomputed_ty
+{
+    dev_t           dev;
+    ino_t           ino;
+    off_t           size;
+    time_t          mtime;
+    time_t          ctime;
+    string_ty       *fingerprint;
+};
+
+static symtab_ty *precomputed;
+
+
+static void
+precomputed_reap(void *p)
+{
+    precomputed_ty  *pp;
+
+    pp = p;
+    str_free(pp->fingerprint);
+    mem_free(pp);
+}
+
+
+/*
+ * NAME
+ *      fp_fingerprint_precomputed
+ *
+ * SYNOPSIS
+ *      void fp_fingerprint_precomputed(string_ty *path,
+ *              const struct stat *st, string_ty *value);
+ *
+ * DESCRIPTION
+ *      The fp_fingerprint_precomputed function is used to remember a
+ *      fingerprint which was calculated elsewhere, together with the
+ *      stat() results of the file at that time.  The next
+ *      fp_fingerprint call for the path uses it, provided the file
+ *      has not changed since.
+ */
+
+void
+fp_fingerprint_precomputed(string_ty *path, const struct stat *st,
+    string_ty *value)
+{
+    precomputed_ty  *pp;
+
+    trace(("fp_fingerprint_precomputed(path = \"%s\")\n", path->str_text));
+    if (!precomputed)
+    {
+        precomputed = symtab_alloc(5);
+        precomputed->reap = precomputed_reap;
+    }
+    pp = mem_alloc(sizeof(precomputed_ty));
+    pp->dev = st->st_dev;
+    pp->ino = st->st_ino;
+    pp->size = st->st_size;
+    pp->mtime = st->st_mtime;
+    pp->ctime = st->st_ctime;
+    pp->fingerprint = str_copy(value);
+    symtab_assign(precomputed, path, pp);
+}
+
+
+/*
+ * NAME
+ *      precomputed_take
+ *
+ * SYNOPSIS
+ *      string_ty *precomputed_take(string_ty *path);
+ *
+ * DESCRIPTION
+ *      The precomputed_take function is used to claim a precomputed
+ *      fingerprint.  It is only good once; any change to the file
+ *      since (including to its times) means it is discarded.
+ *
+ * RETURNS
+ *      string_ty *; or NULL if there is no usable fingerprint.
+ */
+
+static string_ty *
+precomputed_take(string_ty *path)
+{
+    precomputed_ty  *pp;
+    struct stat     st;
+    string_ty       *result;
+
+    if (!precomputed)
+        return 0;
+    pp = symtab_query(precomputed, path);
+    if (!pp)
+        return 0;
+    result = 0;
+    if
+    (
+        stat(path->str_text, &st) == 0
+    &&
+        st.st_dev == pp->dev
+    &&
+        st.st_ino == pp->ino
+    &&
+        st.st_size == pp->size
+    &&
+        st.st_mtime == pp->mtime
+    &&
+        st.st_ctime == pp->ctime
+    )
+        result = str_copy(pp->fingerprint);
+    symtab_delete(precomputed, path);
+    return result;
+}
 
 
 /*
@@ -51,6 +174,25 @@ fp_fingerprint(string_ty *path)
     string_ty       *result;
 
     trace(("fp_fingerprint(path = \"%s\")\n{\n", path->str_text));
+    result = precomputed_take(path);
+    if (result)
+    {
+        if (option_test(OPTION_REASON))
+        {
+            scp = sub_context_new();
+            sub_var_set_string(scp, "File_Name", path);
+            error_intl
+            (
+                scp,
+                i18n("$filename fingerprinted in the background (reason)")
+            );
+            sub_context_delete(scp);
+        }
+        trace(("precomputed\n"));
+        trace(("return \"%s\";\n", result->str_text));
+        trace(("}\n"));
+        return result;
+    }
     fp = fingerprint_new(&fp_combined);
     err = fingerprint_file_sum(fp, path->str_text, buffer, sizeof(buffer));
     if (err && errno == ENOENT)
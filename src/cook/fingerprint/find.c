@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2002, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2001, 2002, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,17 +17,25 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
 #include <common/ac/string.h>
+#include <common/ac/unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
+#include <common/mem.h>
 #include <common/os_path_cat.h>
 #include <common/quit.h>
 #include <common/symtab.h>
 #include <common/trace.h>
 #include <cook/fingerprint/find.h>
+#include <cook/fingerprint/journal.h>
 #include <cook/fingerprint/record.h>
 #include <cook/fingerprint/subdir.h>
 #include <cook/option.h>
 #include <cook/os/rel_if_poss.h>
+#include <cook/os/wait.h>
 #include <cook/os_interface.h>
 
 
@@ -41,6 +49,18 @@ static symtab_ty *main_stp;
  */
 static symtab_ty *subdir_stp;
 
+/*
+ * The background flush, if there is one running: its process, the
+ * pipe it replies on, and the sub-directories it is writing.
+ */
+static int      flush_pid;
+static int      flush_fd = -1;
+static fp_subdir_ty **flush_subdir;
+static size_t   flush_nsubdirs;
+static size_t   flush_nsubdirs_max;
+static char     *flush_reply;
+static size_t   flush_nreply;
+
 
 /*
  * NAME
@@ -106,6 +126,12 @@ fp_find_subdir(string_ty *dirname, int ok_to_read)
         sdp = fp_subdir_new(dot);
         symtab_assign(subdir_stp, dot, sdp);
         fp_subdir_read(sdp);
+
+        /*
+         * Apply any changes which did not reach the cache files
+         * the last time, because cook was killed.
+         */
+        fp_journal_replay();
     }
     sdp = symtab_query(subdir_stp, dirname);
     if (!sdp)
@@ -321,6 +347,52 @@ fp_find_update(fp_subdir_ty *sdp, string_ty *file, fp_value_ty *fp)
 }
 
 
+/*
+ * NAME
+ *      fp_find_update_memory
+ *
+ * SYNOPSIS
+ *      void fp_find_update_memory(fp_subdir_ty *sdp, string_ty *file,
+ *              long memory);
+ *
+ * DESCRIPTION
+ *      The fp_find_update_memory function is used by the fp_gram
+ *      parser to add an entry which only remembers the peak memory of
+ *      the recipe which made the file; the file itself has not been
+ *      fingerprinted yet.
+ */
+
+void
+fp_find_update_memory(fp_subdir_ty *sdp, string_ty *file, long memory)
+{
+    fp_value_ty     data;
+    string_ty       *filename;
+    fp_record_ty    *p;
+
+    fp_value_constructor(&data);
+    data.memory = memory;
+    fp_find_update(sdp, file, &data);
+    fp_value_destructor(&data);
+
+    /*
+     * Unless the file was already known, the new record must not
+     * appear to exist.
+     */
+    filename = os_path_cat(sdp->path, file);
+    p = symtab_query(get_main_stp(), filename);
+    str_free(filename);
+    if
+    (
+        p
+    &&
+        !p->value.contents_fingerprint
+    &&
+        !p->value.ingredients_fingerprint
+    )
+        p->exists = 0;
+}
+
+
 /*
  * NAME
  *      subdir_walk
@@ -356,32 +428,26 @@ subdir_walk(symtab_ty *stp, string_ty *key, void *data, void *aux)
 
 /*
  * NAME
- *      fp_find_flush
+ *      flush
  *
  * SYNOPSIS
- *      void fp_find_flush(void);
+ *      void flush(void);
  *
  * DESCRIPTION
- *      The fp_find_flush function is used to flush the fingerprint
- *      cache files to disk.  Only files which changed are written out.
+ *      The flush function is used to write the fingerprint cache files
+ *      of every sub-directory which changed.
  */
 
-void
-fp_find_flush(void)
+static void
+flush(void)
 {
     static string_ty *dot;
     fp_subdir_ty    *sdp;
 
-    if (!option_test(OPTION_FINGERPRINT_WRITE))
-    {
-        trace(("no fp write\n"));
-        return;
-    }
-
     /*
      * Write out all of the known subdirectories, except dot.
      */
-    trace(("fp_find_flush()\n{\n"));
+    trace(("flush()\n{\n"));
     need_to_write_dot = 0;
     if (subdir_stp)
         symtab_walk(subdir_stp, subdir_walk, 0);
@@ -399,6 +465,274 @@ fp_find_flush(void)
 }
 
 
+/*
+ * NAME
+ *      fp_find_flush
+ *
+ * SYNOPSIS
+ *      void fp_find_flush(void);
+ *
+ * DESCRIPTION
+ *      The fp_find_flush function is used to flush the fingerprint
+ *      cache files to disk.  Only files which changed are written out.
+ *      Any background flush is finished first.  The journal is no
+ *      longer needed afterwards.
+ */
+
+void
+fp_find_flush(void)
+{
+    if (!option_test(OPTION_FINGERPRINT_WRITE))
+    {
+        trace(("no fp write\n"));
+        return;
+    }
+    trace(("fp_find_flush()\n{\n"));
+    fp_find_flush_wait(1);
+    flush();
+    fp_journal_remove();
+    trace(("}\n"));
+}
+
+
+static void
+flush_collect(symtab_ty *stp, string_ty *key, void *data, void *aux)
+{
+    fp_subdir_ty    *sdp;
+
+    (void)stp;
+    (void)key;
+    (void)aux;
+    sdp = data;
+    if (!sdp->dirty)
+        return;
+    if (flush_nsubdirs >= flush_nsubdirs_max)
+    {
+        flush_nsubdirs_max = flush_nsubdirs_max * 2 + 16;
+        flush_subdir =
+            mem_change_size
+            (
+                flush_subdir,
+                flush_nsubdirs_max * sizeof(flush_subdir[0])
+            );
+    }
+    flush_subdir[flush_nsubdirs++] = sdp;
+}
+
+
+static void
+flush_abandon(void)
+{
+    _exit(1);
+}
+
+
+/*
+ * NAME
+ *      flush_worker
+ *
+ * SYNOPSIS
+ *      void flush_worker(int fd);
+ *
+ * DESCRIPTION
+ *      The flush_worker function is run in a child process.  It writes
+ *      the cache files, and then replies with one byte for each of the
+ *      sub-directories being written, saying whether its fingerprints
+ *      ended up in the cache file of the current directory, followed
+ *      by a full stop.
+ *
+ *      Should anything go wrong, the child exits immediately without
+ *      the full stop, and the parent does the flush itself.
+ */
+
+static void
+flush_worker(int fd)
+{
+    size_t          j;
+    size_t          pos;
+
+    quit_handler_prio(flush_abandon);
+    flush();
+    for (j = 0; j < flush_nsubdirs; ++j)
+        flush_reply[j] = (flush_subdir[j]->cache_in_dot ? '1' : '0');
+    flush_reply[flush_nsubdirs] = '.';
+    pos = 0;
+    while (pos < flush_nsubdirs + 1)
+    {
+        ssize_t         n;
+
+        n = write(fd, flush_reply + pos, flush_nsubdirs + 1 - pos);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        pos += n;
+    }
+    _exit(0);
+}
+
+
+/*
+ * NAME
+ *      fp_find_flush_background
+ *
+ * SYNOPSIS
+ *      void fp_find_flush_background(void);
+ *
+ * DESCRIPTION
+ *      The fp_find_flush_background function is used to write the
+ *      fingerprint cache files to disk without waiting for them.
+ *      Cook is not threaded, so the writing is given to a child
+ *      process, which works from a snapshot of the cache.  The
+ *      sub-directories are considered clean from now on; changes made
+ *      meanwhile make them dirty again, and go to a new journal.
+ *
+ *      Only one background flush is run at a time.  If a child process
+ *      cannot be started, the cache files are written immediately.
+ */
+
+void
+fp_find_flush_background(void)
+{
+    int             fd[2];
+    int             pid;
+    size_t          j;
+
+    if (!option_test(OPTION_FINGERPRINT_WRITE))
+        return;
+    if (flush_pid)
+        return;
+    trace(("fp_find_flush_background()\n{\n"));
+    flush_nsubdirs = 0;
+    if (subdir_stp)
+        symtab_walk(subdir_stp, flush_collect, 0);
+    if (!flush_nsubdirs)
+    {
+        trace(("}\n"));
+        return;
+    }
+    fp_journal_sync();
+    fp_journal_rotate();
+    flush_reply = mem_change_size(flush_reply, flush_nsubdirs + 1);
+    flush_nreply = 0;
+
+    if (pipe(fd))
+    {
+        flush();
+        fp_journal_remove();
+        trace(("}\n"));
+        return;
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        close(fd[0]);
+        close(fd[1]);
+        flush();
+        fp_journal_remove();
+        trace(("}\n"));
+        return;
+    }
+    if (pid == 0)
+    {
+        close(fd[0]);
+        flush_worker(fd[1]);
+    }
+    close(fd[1]);
+    fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fd[0], F_SETFL, O_NONBLOCK);
+    flush_pid = pid;
+    flush_fd = fd[0];
+    for (j = 0; j < flush_nsubdirs; ++j)
+        flush_subdir[j]->dirty = 0;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      fp_find_flush_wait
+ *
+ * SYNOPSIS
+ *      void fp_find_flush_wait(int block);
+ *
+ * DESCRIPTION
+ *      The fp_find_flush_wait function is used to see whether the
+ *      background flush, if any, has finished, waiting for it if
+ *      block is true.  When it has succeeded, the old journal is
+ *      removed.  When it has failed, the sub-directories it was
+ *      writing are dirty again, and are written immediately.
+ */
+
+void
+fp_find_flush_wait(int block)
+{
+    size_t          j;
+    int             status;
+
+    if (!flush_pid)
+        return;
+    if (block)
+        fcntl(flush_fd, F_SETFL, 0);
+    while (flush_nreply < flush_nsubdirs + 1)
+    {
+        ssize_t         n;
+
+        n = read
+            (
+                flush_fd,
+                flush_reply + flush_nreply,
+                flush_nsubdirs + 1 - flush_nreply
+            );
+        if (n > 0)
+        {
+            flush_nreply += n;
+            continue;
+        }
+        if (n == 0)
+            break;
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+        break;
+    }
+    trace(("fp_find_flush_wait()\n{\n"));
+    close(flush_fd);
+    flush_fd = -1;
+
+    /*
+     * The graph walk may already have collected it, and will ignore
+     * it if not.
+     */
+    os_wait4(flush_pid, &status, WNOHANG, 0);
+    flush_pid = 0;
+
+    if
+    (
+        flush_nreply == flush_nsubdirs + 1
+    &&
+        flush_reply[flush_nsubdirs] == '.'
+    )
+    {
+        for (j = 0; j < flush_nsubdirs; ++j)
+            flush_subdir[j]->cache_in_dot = (flush_reply[j] == '1');
+        fp_journal_remove_old();
+    }
+    else
+    {
+        trace(("background flush failed\n"));
+        for (j = 0; j < flush_nsubdirs; ++j)
+            flush_subdir[j]->dirty = 1;
+        flush();
+        fp_journal_remove();
+    }
+    trace(("}\n"));
+}
+
+
 static void
 fp_find_main_writer(symtab_ty *stp, string_ty *key, void *data, void *aux)
 {
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -29,7 +29,10 @@ struct fp_value_ty; /* existence */
 struct fp_record_ty *fp_find_record(struct string_ty *);
 void fp_find_update(struct fp_subdir_ty *, struct string_ty *,
         struct fp_value_ty *);
+void fp_find_update_memory(struct fp_subdir_ty *, struct string_ty *, long);
 void fp_find_flush(void);
+void fp_find_flush_background(void);
+void fp_find_flush_wait(int);
 struct fp_subdir_ty *fp_find_subdir(struct string_ty *, int);
 
 void fp_find_main_write(void *);
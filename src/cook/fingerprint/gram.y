@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994-2007, 2009 Peter Miller
+ *      Copyright (C) 1994-2007, 2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -47,6 +47,7 @@
         long            lhs;
         long            rhs;
         long            stat_mod_time;
+        long            memory;
     }
         lv_number_set;
     struct
@@ -128,6 +129,7 @@ entry
                 $5.lhs,
                 $5.rhs
             );
+            data.memory = $4.memory;
 
             str_free($5.lhs);
             if ($5.rhs)
@@ -137,6 +139,11 @@ entry
             str_free($1);
             fp_value_destructor(&data);
         }
+    | STRING EQ LB NUMBER RB
+        {
+            fp_find_update_memory(subdir, $1, $4);
+            str_free($1);
+        }
     | error
     ;
 
@@ -146,18 +153,28 @@ number_set
             $$.lhs = $1;
             $$.rhs = $1;
             $$.stat_mod_time = $1;
+            $$.memory = 0;
         }
     | NUMBER NUMBER
         {
             $$.lhs = $1;
             $$.rhs = $2;
             $$.stat_mod_time = $2;
+            $$.memory = 0;
         }
     | NUMBER NUMBER NUMBER
         {
             $$.lhs = $1;
             $$.rhs = $2;
             $$.stat_mod_time = $3;
+            $$.memory = 0;
+        }
+    | NUMBER NUMBER NUMBER NUMBER
+        {
+            $$.lhs = $1;
+            $$.rhs = $2;
+            $$.stat_mod_time = $3;
+            $$.memory = $4;
         }
     ;
 
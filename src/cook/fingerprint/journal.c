@@ -0,0 +1,488 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * Changes to the fingerprint cache are appended to a journal in the
+ * current directory as they are made, so that the cache files
+ * themselves need only be rewritten now and then (in the background;
+ * see fp_find_flush_background) without losing fingerprints should
+ * cook be killed in the mean time.  The journal is replayed the next
+ * time the cache is read, and removed once every change it records
+ * has been written to the cache files.
+ *
+ * While a background flush is running, new changes go to the journal,
+ * and the changes which the flush is writing are in the ``old''
+ * journal, which is removed when the flush succeeds.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+
+#include <common/os_path_cat.h>
+#include <common/stracc.h>
+#include <common/trace.h>
+#include <cook/fingerprint.h>
+#include <cook/fingerprint/filename.h>
+#include <cook/fingerprint/journal.h>
+#include <cook/fingerprint/record.h>
+#include <cook/fingerprint/subdir.h>
+#include <cook/option.h>
+
+static FILE     *journal;
+static int      journal_broken;
+static int      replaying;
+
+
+static string_ty *
+journal_filename(void)
+{
+    static string_ty *s;
+
+    if (!s)
+        s = str_format("%s.journal", fp_filename()->str_text);
+    return s;
+}
+
+
+static string_ty *
+journal_old_filename(void)
+{
+    static string_ty *s;
+
+    if (!s)
+        s = str_format("%s.journal.old", fp_filename()->str_text);
+    return s;
+}
+
+
+/*
+ * NAME
+ *      fp_journal_filename_p
+ *
+ * SYNOPSIS
+ *      int fp_journal_filename_p(string_ty *);
+ *
+ * DESCRIPTION
+ *      The fp_journal_filename_p function is used to determine whether
+ *      the given directory entry is one of the journal files, which
+ *      (like the cache files) are not themselves fingerprinted.
+ */
+
+int
+fp_journal_filename_p(string_ty *entryname)
+{
+    return
+        (
+            str_equal(entryname, journal_filename())
+        ||
+            str_equal(entryname, journal_old_filename())
+        );
+}
+
+
+static void
+write_string(string_ty *s)
+{
+    if (!s)
+    {
+        fputs(" -1", journal);
+        return;
+    }
+    fprintf(journal, " %ld ", (long)s->str_length);
+    fwrite(s->str_text, 1, s->str_length, journal);
+}
+
+
+/*
+ * NAME
+ *      fp_journal_record
+ *
+ * SYNOPSIS
+ *      void fp_journal_record(fp_record_ty *);
+ *
+ * DESCRIPTION
+ *      The fp_journal_record function is used to append the current
+ *      value of a fingerprint record to the journal.  It is called
+ *      each time a record changes.
+ *
+ *      The journal is not written if fingerprints are not being
+ *      preserved, or if it cannot be; the cache files are still
+ *      written, it is only the protection from being killed which is
+ *      lost.
+ */
+
+void
+fp_journal_record(fp_record_ty *rp)
+{
+    string_ty       *path;
+
+    if (replaying || journal_broken)
+        return;
+    if (!option_test(OPTION_FINGERPRINT_WRITE))
+        return;
+    if (!journal)
+    {
+        journal = fopen(journal_filename()->str_text, "a");
+        if (!journal)
+        {
+            journal_broken = 1;
+            return;
+        }
+    }
+    path = os_path_cat(rp->parent->path, rp->filename);
+    if (strchr(path->str_text, '\n'))
+    {
+        /*
+         * Can't be represented.  It will still get to the cache
+         * file, eventually.
+         */
+        str_free(path);
+        return;
+    }
+    trace(("fp_journal_record(path = \"%s\")\n", path->str_text));
+    if (rp->exists)
+    {
+        fprintf
+        (
+            journal,
+            "= %ld %ld %ld",
+            (long)rp->value.oldest,
+            (long)rp->value.newest,
+            (long)rp->value.stat_mod_time
+        );
+        write_string(rp->value.contents_fingerprint);
+        write_string(rp->value.ingredients_fingerprint);
+    }
+    else
+        fputs("-", journal);
+    fprintf(journal, " %s\n", path->str_text);
+
+    /*
+     * The peak memory of the recipe which made the file is a separate
+     * entry, so that journals written before it was remembered can
+     * still be read.
+     */
+    if (rp->value.memory)
+        fprintf(journal, "M %ld %s\n", rp->value.memory, path->str_text);
+    str_free(path);
+}
+
+
+/*
+ * NAME
+ *      fp_journal_sync
+ *
+ * SYNOPSIS
+ *      void fp_journal_sync(void);
+ *
+ * DESCRIPTION
+ *      The fp_journal_sync function is used to push the journal
+ *      entries written so far out to the file.  If this fails, the
+ *      journal is abandoned.
+ */
+
+void
+fp_journal_sync(void)
+{
+    if (!journal)
+        return;
+    if (fflush(journal) == 0)
+        return;
+    fclose(journal);
+    journal = 0;
+    journal_broken = 1;
+}
+
+
+/*
+ * NAME
+ *      fp_journal_rotate
+ *
+ * SYNOPSIS
+ *      void fp_journal_rotate(void);
+ *
+ * DESCRIPTION
+ *      The fp_journal_rotate function is used when a background flush
+ *      starts.  The journal so far becomes the old journal, covering
+ *      the changes the flush will write, and new changes start a new
+ *      journal.
+ *
+ *      Any previous old journal is replaced.  Its changes were either
+ *      written by an earlier flush, or are still dirty and so are
+ *      written by this one.
+ */
+
+void
+fp_journal_rotate(void)
+{
+    if (journal)
+    {
+        fclose(journal);
+        journal = 0;
+    }
+    if (journal_broken)
+        return;
+    if
+    (
+        rename
+        (
+            journal_filename()->str_text,
+            journal_old_filename()->str_text
+        )
+    &&
+        errno != ENOENT
+    )
+        journal_broken = 1;
+}
+
+
+/*
+ * NAME
+ *      fp_journal_remove_old
+ *
+ * SYNOPSIS
+ *      void fp_journal_remove_old(void);
+ *
+ * DESCRIPTION
+ *      The fp_journal_remove_old function is used to remove the old
+ *      journal once a background flush has written its changes.
+ */
+
+void
+fp_journal_remove_old(void)
+{
+    unlink(journal_old_filename()->str_text);
+}
+
+
+/*
+ * NAME
+ *      fp_journal_remove
+ *
+ * SYNOPSIS
+ *      void fp_journal_remove(void);
+ *
+ * DESCRIPTION
+ *      The fp_journal_remove function is used to remove both journals,
+ *      once every change has been written to the cache files.
+ */
+
+void
+fp_journal_remove(void)
+{
+    if (journal)
+    {
+        fclose(journal);
+        journal = 0;
+    }
+    unlink(journal_filename()->str_text);
+    unlink(journal_old_filename()->str_text);
+}
+
+
+/*
+ * NAME
+ *      read_string
+ *
+ * SYNOPSIS
+ *      char *read_string(char *cp, char *end, string_ty **result);
+ *
+ * DESCRIPTION
+ *      The read_string function is used to read a length-prefixed
+ *      string, as written by write_string, from a journal entry.
+ *
+ * RETURNS
+ *      char *; the rest of the entry, or NULL if it is malformed.
+ */
+
+static char *
+read_string(char *cp, char *end, string_ty **result)
+{
+    long            len;
+    char            *ep;
+
+    *result = 0;
+    len = strtol(cp, &ep, 10);
+    if (ep == cp || *ep != ' ')
+        return 0;
+    if (len < 0)
+        return ep;
+    cp = ep + 1;
+    if (len > end - cp)
+        return 0;
+    *result = str_n_from_c(cp, len);
+    return (cp + len);
+}
+
+
+/*
+ * NAME
+ *      replay_entry
+ *
+ * SYNOPSIS
+ *      void replay_entry(char *line, size_t len);
+ *
+ * DESCRIPTION
+ *      The replay_entry function is used to apply one journal entry to
+ *      the fingerprint cache.  Malformed entries are ignored.
+ */
+
+static void
+replay_entry(char *line, size_t len)
+{
+    char            *cp;
+    char            *end;
+    string_ty       *path;
+
+    end = line + len;
+    if (len > 2 && line[0] == '-' && line[1] == ' ')
+    {
+        path = str_n_from_c(line + 2, len - 2);
+        fp_delete(path);
+        str_free(path);
+        return;
+    }
+    if (len > 2 && line[0] == 'M' && line[1] == ' ')
+    {
+        long            memory;
+
+        memory = strtol(line + 2, &cp, 10);
+        if (*cp != ' ' || cp + 1 >= end)
+            return;
+        path = str_n_from_c(cp + 1, end - cp - 1);
+        fp_memory_set(path, memory);
+        str_free(path);
+        return;
+    }
+    if (len > 2 && line[0] == '=' && line[1] == ' ')
+    {
+        long            oldest;
+        long            newest;
+        long            stat_mod_time;
+        string_ty       *contents;
+        string_ty       *ingredients;
+        fp_value_ty     value;
+
+        cp = line + 2;
+        oldest = strtol(cp, &cp, 10);
+        newest = strtol(cp, &cp, 10);
+        stat_mod_time = strtol(cp, &cp, 10);
+        if (*cp != ' ')
+            return;
+        cp = read_string(cp + 1, end, &contents);
+        if (!cp || *cp != ' ')
+        {
+            if (contents)
+                str_free(contents);
+            return;
+        }
+        cp = read_string(cp + 1, end, &ingredients);
+        if (!cp || *cp != ' ' || cp + 1 >= end)
+        {
+            if (contents)
+                str_free(contents);
+            if (ingredients)
+                str_free(ingredients);
+            return;
+        }
+        path = str_n_from_c(cp + 1, end - cp - 1);
+        fp_value_constructor5
+        (
+            &value,
+            oldest,
+            newest,
+            stat_mod_time,
+            contents,
+            ingredients
+        );
+        fp_assign(path, &value);
+        fp_value_destructor(&value);
+        str_free(path);
+        if (contents)
+            str_free(contents);
+        if (ingredients)
+            str_free(ingredients);
+    }
+}
+
+
+static void
+replay_file(string_ty *fn)
+{
+    FILE            *fp;
+    stracc          sa;
+    int             c;
+
+    fp = fopen(fn->str_text, "r");
+    if (!fp)
+        return;
+    trace(("replay_file(fn = \"%s\")\n{\n", fn->str_text));
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    for (;;)
+    {
+        c = getc(fp);
+        if (c == EOF)
+        {
+            /*
+             * An unterminated last entry was being written when
+             * cook was killed.  Ignore it.
+             */
+            break;
+        }
+        if (c != '\n')
+        {
+            sa_char(&sa, c);
+            continue;
+        }
+        replay_entry(sa.sa_buf, sa.sa_len);
+        sa_goto(&sa, 0);
+    }
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+    fclose(fp);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      fp_journal_replay
+ *
+ * SYNOPSIS
+ *      void fp_journal_replay(void);
+ *
+ * DESCRIPTION
+ *      The fp_journal_replay function is used to apply the changes
+ *      recorded in the journals, if any, to the fingerprint cache.
+ *      It is called once the cache file for the current directory
+ *      has been read.  The changes are marked for writing to the cache
+ *      files in the usual way; the journals are left alone until they
+ *      have been.
+ */
+
+void
+fp_journal_replay(void)
+{
+    replaying = 1;
+    replay_file(journal_old_filename());
+    replay_file(journal_filename());
+    replaying = 0;
+}
@@ -0,0 +1,36 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_FINGERPRINT_JOURNAL_H
+#define COOK_FINGERPRINT_JOURNAL_H
+
+#include <common/main.h>
+
+struct fp_record_ty; /* existence */
+struct string_ty; /* existence */
+
+void fp_journal_record(struct fp_record_ty *);
+void fp_journal_sync(void);
+void fp_journal_rotate(void);
+void fp_journal_remove_old(void);
+void fp_journal_remove(void);
+void fp_journal_replay(void);
+int fp_journal_filename_p(struct string_ty *);
+
+#endif /* COOK_FINGERPRINT_JOURNAL_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,6 +17,7 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <cook/fingerprint/journal.h>
 #include <cook/fingerprint/record.h>
 #include <cook/fingerprint/subdir.h>
 #include <cook/fingerprint/value.h>
@@ -124,16 +125,21 @@ fp_record_delete(fp_record_ty *this)
  * DESCRIPTION
  *      The fp_record_write function is used to write a fp_record_ty
  *      structure to the fingerprint cache file on disk.  the value is
- *      only written if it exists.
+ *      only written if it exists.  Otherwise, only the peak memory of
+ *      the recipe which made the file is written, if known.
  */
 
 void
 fp_record_write(fp_record_ty *this, string_ty *key, FILE *fp)
 {
+    if (!key)
+        key = this->filename;
     trace(("fp_record_write(this = %p, key = \"%s\", fp = %p)\n{\n", this,
         key->str_text, fp));
     if (this->exists)
-        fp_value_write(&this->value, (key ? key : this->filename), fp);
+        fp_value_write(&this->value, key, fp);
+    else if (this->value.memory)
+        fprintf(fp, "\"%s\" = { %ld }\n", key->str_text, this->value.memory);
     trace(("}\n"));
 }
 
@@ -150,23 +156,57 @@ fp_record_write(fp_record_ty *this, string_ty *key, FILE *fp)
  *      a fingerprint held in a fp_record_ty structure.  The existence
  *      attributes is updated if necessary.  The parent's dirty flag is
  *      set if necessary.
+ *
+ *      A value which does not know the memory used by the recipe which
+ *      made the file keeps the figure already recorded.
  */
 
 void
 fp_record_update(fp_record_ty *this, fp_value_ty *fp)
 {
+    long            memory;
+
     trace(("fp_record_update(this = %p, fp = %p)\n{\n", this, fp));
+    memory = fp->memory;
+    if (!memory)
+        fp->memory = this->value.memory;
     if (!this->exists || !fp_value_equal_all(&this->value, fp))
     {
         trace(("need to update\n"));
         this->exists = 1;
         fp_subdir_dirty_notify(this->parent, this->filename);
         fp_value_copy(&this->value, fp);
+        fp_journal_record(this);
     }
+    fp->memory = memory;
     trace(("}\n"));
 }
 
 
+/*
+ * NAME
+ *      fp_record_memory
+ *
+ * SYNOPSIS
+ *      void fp_record_memory(fp_record_ty *this, long memory);
+ *
+ * DESCRIPTION
+ *      The fp_record_memory function is used to set the peak memory,
+ *      in kilobytes, used by the recipe which made the file.  The
+ *      figure is kept even if the file has not been fingerprinted.
+ */
+
+void
+fp_record_memory(fp_record_ty *this, long memory)
+{
+    if (this->value.memory == memory)
+        return;
+    this->value.memory = memory;
+    fp_subdir_dirty_notify(this->parent, this->filename);
+    fp_journal_record(this);
+}
+
+
 /*
  * NAME
  *      fp_record_clear
@@ -189,6 +229,7 @@ fp_record_clear(fp_record_ty *this)
     {
         this->exists = 0;
         fp_subdir_dirty_notify(this->parent, this->filename);
+        fp_journal_record(this);
     }
     trace(("}\n"));
 }
@@ -223,9 +264,11 @@ fp_record_tweak(fp_record_ty *this, time_t when, string_ty *crypto)
 
         fp_subdir_dirty_notify(this->parent, this->filename);
         fp_value_constructor3(&value, when, when, crypto);
+        value.memory = this->value.memory;
         fp_value_copy(&this->value, &value);
         fp_value_destructor(&value);
         this->exists = 1;
+        fp_journal_record(this);
     }
     else if (this->value.newest != when)
     {
@@ -239,5 +282,6 @@ fp_record_tweak(fp_record_ty *this, time_t when, string_ty *crypto)
         this->value.newest = when;
         if (this->value.oldest >= when)
             this->value.oldest = when;
+        fp_journal_record(this);
     }
 }
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -41,5 +41,6 @@ void fp_record_write(fp_record_ty *, string_ty *, FILE *);
 void fp_record_update(fp_record_ty *, fp_value_ty *);
 void fp_record_clear(fp_record_ty *);
 void fp_record_tweak(fp_record_ty *, time_t, string_ty *);
+void fp_record_memory(fp_record_ty *, long);
 
 #endif /* COOK_FINGERPRINT_RECORD_H */
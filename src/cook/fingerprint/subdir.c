@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2006-2010 Peter Miller
+ *      Copyright (C) 1999, 2001, 2006-2010, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -34,6 +34,7 @@
 #include <cook/fingerprint/filename.h>
 #include <cook/fingerprint/find.h>
 #include <cook/fingerprint/gram.h>
+#include <cook/fingerprint/journal.h>
 #include <cook/fingerprint/record.h>
 #include <cook/fingerprint/subdir.h>
 #include <cook/os_interface.h>
@@ -358,6 +359,8 @@ fp_subdir_tweak(fp_subdir_ty *this)
         if
         (
             !str_equal(filename, avoid)
+        &&
+            !fp_journal_filename_p(filename)
         &&
             !str_equal(filename, dot)
         &&
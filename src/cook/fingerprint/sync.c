@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -20,6 +20,7 @@
 #include <common/ac/time.h>
 
 #include <cook/fingerprint/find.h>
+#include <cook/fingerprint/journal.h>
 #include <cook/fingerprint/sync.h>
 
 
@@ -33,8 +34,9 @@
  * DESCRIPTION
  *      The fp_sync function is used to write the fingerprint cache
  *      out to disk periodically.  No matter how often it it called,
- *      the fingerprint cache will only be written out once a minute.
- *      This should be called reasonably often.
+ *      the fingerprint cache will only be written out once a minute,
+ *      in the background.  The journal of changes since is kept up to
+ *      date on every call.  This should be called reasonably often.
  */
 
 void
@@ -43,12 +45,14 @@ fp_sync(void)
     static time_t   next_time;
     time_t          now;
 
+    fp_journal_sync();
+    fp_find_flush_wait(0);
     time(&now);
     if (!next_time)
         next_time = now + 60;
     else if (now >= next_time)
     {
         next_time = now + 60;
-        fp_find_flush();
+        fp_find_flush_background();
     }
 }
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2002, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2001, 2002, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -44,6 +44,7 @@ fp_value_constructor(fp_value_ty *this)
     this->stat_mod_time = 0;
     this->contents_fingerprint = 0;
     this->ingredients_fingerprint = 0;
+    this->memory = 0;
     trace(("}\n"));
 }
 
@@ -78,6 +79,7 @@ fp_value_constructor_copy(fp_value_ty *this, const fp_value_ty *fp)
         :
             0
         );
+    this->memory = fp->memory;
     trace(("}\n"));
 }
 
@@ -106,6 +108,7 @@ fp_value_constructor3(fp_value_ty *this, time_t a1, time_t a2, string_ty *a3)
     this->stat_mod_time = a2;
     this->contents_fingerprint = (a3 ? str_copy(a3) : 0);
     this->ingredients_fingerprint = 0;
+    this->memory = 0;
     trace(("}\n"));
 }
 
@@ -137,6 +140,7 @@ fp_value_constructor4(fp_value_ty *this, time_t a1, time_t a2, string_ty *a3,
     this->stat_mod_time = a2;
     this->contents_fingerprint = (a3 ? str_copy(a3) : 0);
     this->ingredients_fingerprint = (a4 ? str_copy(a4) : 0);
+    this->memory = 0;
     trace(("}\n"));
 }
 
@@ -168,6 +172,7 @@ fp_value_constructor5(fp_value_ty *this, time_t a1, time_t a2, time_t a3,
     this->stat_mod_time = a3;
     this->contents_fingerprint = (a4 ? str_copy(a4) : 0);
     this->ingredients_fingerprint = (a5 ? str_copy(a5) : 0);
+    this->memory = 0;
     trace(("}\n"));
 }
 
@@ -197,6 +202,7 @@ fp_value_destructor(fp_value_ty *this)
     if (this->ingredients_fingerprint)
         str_free(this->ingredients_fingerprint);
     this->ingredients_fingerprint = 0;
+    this->memory = 0;
     trace(("}\n"));
 }
 
@@ -276,6 +282,7 @@ fp_value_copy(fp_value_ty *to, const fp_value_ty *from)
     to->stat_mod_time = from->stat_mod_time;
     to->newest = from->newest;
     to->oldest = from->oldest;
+    to->memory = from->memory;
 
     if (to->contents_fingerprint)
         str_free(to->contents_fingerprint);
@@ -316,7 +323,23 @@ fp_value_write(fp_value_ty *this, string_ty *key, FILE *fp)
     trace(("fp_value_write(this = %p, key = \"%s\", fp = %p)\n{\n", this,
         key->str_text, fp));
     fprintf(fp, "\"%s\" = { %ld", key->str_text, (long)this->oldest);
-    if (this->oldest != this->newest || this->newest != this->stat_mod_time)
+    if (this->memory)
+    {
+        fprintf
+        (
+            fp,
+            " %ld %ld %ld",
+            (long)this->newest,
+            (long)this->stat_mod_time,
+            this->memory
+        );
+    }
+    else if
+    (
+        this->oldest != this->newest
+    ||
+        this->newest != this->stat_mod_time
+    )
     {
         fprintf(fp, " %ld", (long)this->newest);
         if (this->newest != this->stat_mod_time)
@@ -401,5 +424,7 @@ fp_value_equal_all(const fp_value_ty *v1, const fp_value_ty *v2)
             v1->oldest == v2->oldest
         &&
             v1->stat_mod_time == v2->stat_mod_time
+        &&
+            v1->memory == v2->memory
         );
 }
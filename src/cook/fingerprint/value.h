@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2002, 2006-2008 Peter Miller
+ *      Copyright (C) 1999, 2001, 2002, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -32,6 +32,7 @@ struct fp_value_ty
     time_t          stat_mod_time;
     string_ty       *contents_fingerprint;
     string_ty       *ingredients_fingerprint;
+    long            memory;     /* peak kilobytes of the recipe, 0 unknown */
 };
 
 void fp_value_constructor(fp_value_ty *);
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2001-2003, 2005-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2001-2003, 2005-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -93,6 +93,9 @@ static table_ty table[] =
     { "default", RF_DEFAULT, RF_DEFAULT_OFF },
     { "no-default", RF_DEFAULT_OFF, RF_DEFAULT },
     { "nodefault", RF_DEFAULT_OFF, RF_DEFAULT },
+    { "depfile", RF_DEPFILE, RF_DEPFILE_OFF },
+    { "no-depfile", RF_DEPFILE_OFF, RF_DEPFILE },
+    { "nodepfile", RF_DEPFILE_OFF, RF_DEPFILE },
     { "ignore-error", RF_ERROK, RF_ERROK_OFF },
     { "errok", RF_ERROK, RF_ERROK_OFF },
     { "no-ignore-error", RF_ERROK_OFF, RF_ERROK },
@@ -376,6 +379,11 @@ flag_set_options(const flag_ty *fp, int level)
     if (fp->flag[RF_CLEARSTAT_OFF])
         option_set(OPTION_INVALIDATE_STAT_CACHE, level, 0);
 
+    if (fp->flag[RF_DEPFILE])
+        option_set(OPTION_DEPFILE, level, 1);
+    if (fp->flag[RF_DEPFILE_OFF])
+        option_set(OPTION_DEPFILE, level, 0);
+
     if (fp->flag[RF_ERROK])
         option_set(OPTION_ERROK, level, 1);
     if (fp->flag[RF_ERROK_OFF])
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2001, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2001, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -67,6 +67,8 @@ enum flag_value_ty
         RF_CLEARSTAT_OFF,
         RF_CTIME,
         RF_CTIME_OFF,
+        RF_DEPFILE,
+        RF_DEPFILE_OFF,
         RF_DEFAULT,
         RF_DEFAULT_OFF,
         RF_ERROK,
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,11 +17,16 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <cook/cook.h>
 #include <cook/graph.h>
 #include <cook/graph/file.h>
 #include <cook/graph/file_pair.h>
 #include <cook/graph/recipe_list.h>
+#include <cook/opcode/context.h>
+#include <cook/stat.cache.h>
+#include <common/arena.h>
 #include <common/mem.h>
+#include <common/os_path_cat.h>
 #include <common/str_list.h>
 #include <common/symtab.h>
 
@@ -101,6 +106,9 @@ graph_new(void)
     gp->already->reap = already_reap;
     gp->already_recipe = graph_recipe_list_new();
     gp->file_pair = 0;
+    gp->arena = arena_new(0);
+    gp->parallel_jobs = 1;
+    gp->stream = 0;
     return gp;
 }
 
@@ -115,6 +123,11 @@ graph_new(void)
  * DESCRIPTION
  *      The graph_delete function is used to release resources held by a
  *      file dependency graph.
+ *
+ * CAVEAT
+ *      The arena must be released last, because the symbol table reap
+ *      function and the recipe list destructor still look inside the
+ *      nodes.
  */
 
 void
@@ -126,6 +139,7 @@ graph_delete(graph_ty *gp)
     graph_recipe_list_delete(gp->already_recipe);
     if (gp->file_pair)
         graph_file_pair_delete(gp->file_pair);
+    arena_delete(gp->arena);
     mem_free(gp);
 }
 
@@ -182,3 +196,86 @@ graph_leaf_files(graph_ty *gp, string_list_ty *result)
 {
     symtab_walk(gp->already, walk_leaf_files, result);
 }
+
+
+/*
+ * NAME
+ *      graph_prefetch_list
+ *
+ * SYNOPSIS
+ *      void graph_prefetch_list(const string_list_ty *file);
+ *
+ * DESCRIPTION
+ *      The graph_prefetch_list function is used to fill the stat cache
+ *      for the given files, and each of their candidates on the search
+ *      list, all at once.  See stat_cache_prefetch for how.
+ */
+
+void
+graph_prefetch_list(const string_list_ty *file)
+{
+    string_list_ty  search;
+    string_list_ty  candidate;
+    opcode_context_ty *ocp;
+    size_t          j;
+    size_t          k;
+
+    ocp = opcode_context_new(0, 0);
+    cook_search_list(ocp, &search);
+    opcode_context_delete(ocp);
+
+    string_list_constructor(&candidate);
+    for (j = 0; j < file->nstrings; ++j)
+    {
+        string_ty       *s;
+
+        s = file->string[j];
+        if (s->str_text[0] == '/')
+        {
+            string_list_append(&candidate, s);
+            continue;
+        }
+        for (k = 0; k < search.nstrings; ++k)
+        {
+            string_ty       *s2;
+
+            s2 = os_path_cat(search.string[k], s);
+            string_list_append(&candidate, s2);
+            str_free(s2);
+        }
+    }
+    stat_cache_prefetch(&candidate, 1);
+    string_list_destructor(&candidate);
+    string_list_destructor(&search);
+}
+
+
+/*
+ * NAME
+ *      graph_prefetch
+ *
+ * SYNOPSIS
+ *      void graph_prefetch(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_prefetch function is used to fill the stat cache for
+ *      the files of the graph, and each of their candidates on the
+ *      search list, before the graph is walked.  The walk would
+ *      otherwise stat them one at a time, as it reached them.
+ *
+ *      Most leaves have already been looked at while the graph was
+ *      being built, to decide their leaf-ness, so the targets are
+ *      included as well; a no-op build must look at all of them.
+ */
+
+void
+graph_prefetch(graph_ty *gp)
+{
+    string_list_ty  file;
+
+    string_list_constructor(&file);
+    graph_leaf_files(gp, &file);
+    graph_interior_files(gp, &file);
+    graph_prefetch_list(&file);
+    string_list_destructor(&file);
+}
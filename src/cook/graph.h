@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -81,6 +81,24 @@ struct graph_ty
          * information residing only in dependency files.
          */
         struct graph_file_pair_ty *file_pair;
+
+        /*
+         * The graph file nodes, the graph recipe nodes, and the edge
+         * lists joining them, are all allocated from this arena.  They
+         * are all released at once when the graph is deleted.
+         */
+        struct arena_ty *arena;
+
+        /*
+         * The number of recipes graph_walk may run at once.
+         */
+        int             parallel_jobs;
+
+        /*
+         * The recipes queued while the graph is still being built,
+         * when the pipeline option is set.  See cook/graph/stream.c
+         */
+        struct graph_stream_ty *stream;
 };
 
 graph_ty *graph_new(void);
@@ -92,5 +110,7 @@ int graph_file_leaf_p(graph_ty *, struct string_ty *);
 struct string_list_ty; /* existence */
 void graph_interior_files(graph_ty *, struct string_list_ty *);
 void graph_leaf_files(graph_ty *, struct string_list_ty *);
+void graph_prefetch(graph_ty *);
+void graph_prefetch_list(const struct string_list_ty *);
 
 #endif /* COOK_GRAPH_H */
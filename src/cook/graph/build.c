@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2001-2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2001-2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -25,6 +25,7 @@
 #include <common/trace.h>
 #include <cook/cascade.h>
 #include <cook/cook.h>
+#include <cook/deps/log.h>
 #include <cook/desist.h>
 #include <cook/expr.h>
 #include <cook/fingerprint/sync.h>
@@ -36,6 +37,8 @@
 #include <cook/graph/leaf.h>
 #include <cook/graph/recipe.h>
 #include <cook/graph/recipe_list.h>
+#include <cook/graph/stats.h>
+#include <cook/graph/stream.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
 #include <cook/match/new_by_recip.h>
@@ -103,6 +106,51 @@ graph_build_status_name(graph_build_status_ty n)
 static void graph_build_file(graph_ty *, string_ty *,
     graph_build_preference_ty, graph_build_result_ty *, int);
 
+/*
+ * Sibling lists shorter than this are not worth prefetching.
+ */
+#define SIBLING_PREFETCH_MIN 128
+
+
+/*
+ * NAME
+ *      prefetch_siblings
+ *
+ * SYNOPSIS
+ *      void prefetch_siblings(const string_list_ty *wlp);
+ *
+ * DESCRIPTION
+ *      The prefetch_siblings function is used to look at all of a
+ *      long list of files at once, before each is derived in turn.
+ *      The derivation of each sibling is independent of the others,
+ *      but cook derives them one at a time, and each starts by asking
+ *      the stat cache about the file.  On a cold or network file
+ *      system, doing those stat()s concurrently, rather than one per
+ *      sibling, is most of the available speed-up.
+ */
+
+static void
+prefetch_siblings(const string_list_ty *wlp)
+{
+    string_list_ty  file;
+    size_t          j;
+
+    if (wlp->nstrings < SIBLING_PREFETCH_MIN)
+        return;
+    string_list_constructor(&file);
+    for (j = 0; j < wlp->nstrings; ++j)
+    {
+        string_ty       *s;
+        edge_type_ty    type;
+
+        edge_type_extract(wlp->string[j], &s, &type);
+        string_list_append(&file, s);
+        str_free(s);
+    }
+    graph_prefetch_list(&file);
+    string_list_destructor(&file);
+}
+
 
 /*
  * NAME
@@ -241,6 +289,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
     {
         int             flag;
 
+        rp->profile.precondition++;
         flag = opcode_context_run_bool(ocp, rp->precondition);
 
         switch (flag)
@@ -264,6 +313,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
                 sub_context_delete(scp);
             }
             gp->statistic.precondition_rejection++;
+            rp->profile.precondition_rejection++;
             status = graph_build_status_backtrack;
             trace(("failed\n"));
             goto done;
@@ -290,6 +340,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
      * so that more recipes apply
      */
     strip_dot_list(wlp1);
+    prefetch_siblings(wlp1);
 
     for (k = 0; k < wlp1->nstrings; ++k)
     {
@@ -420,6 +471,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
      * so that more recipes apply
      */
     strip_dot_list(wlp2);
+    prefetch_siblings(wlp2);
 
     for (k = 0; k < wlp2->nstrings; ++k)
     {
@@ -657,6 +709,87 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
         }
     }
 
+    /*
+     * Add the ingredients discovered the last time the recipe ran
+     * (see the depfile flag).  These come from the dependency log,
+     * not the cookbook.  Ingredients which have since gone away, and
+     * which cook does not know how to make, are quietly dropped; the
+     * file which used them must have changed for them to go.
+     */
+    trace(("mark\n"));
+    if (option_test(OPTION_DEPFILE) && rp->out_of_date)
+    {
+        const string_list_ty *found;
+
+        found = deps_log_query(target1);
+        for (k = 0; found && k < found->nstrings; ++k)
+        {
+            string_ty      *target2;
+            graph_build_result_ty result2;
+
+            target2 = found->string[k];
+            if (string_list_member(&need, target2))
+                continue;
+            if (option_test(OPTION_REASON))
+            {
+                scp = sub_context_new();
+                sub_var_set_string(scp, "File_Name1", target1);
+                sub_var_set_string(scp, "File_Name2", target2);
+                error_with_position
+                (
+                    &rp->pos,
+                    scp,
+                    i18n("\"$filename1\" may require \"$filename2\" (reason)")
+                );
+                sub_context_delete(scp);
+            }
+            option_undo_level(OPTION_LEVEL_RECIPE);
+
+            graph_build_file
+            (
+                gp,
+                target2,
+                graph_build_preference_backtrack,
+                &result2,
+                implicit_allowed
+            );
+
+            recipe_flags_set(rp);
+            switch (result2.status)
+            {
+            case graph_build_status_backtrack:
+                continue;
+
+            case graph_build_status_error:
+                string_list_delete(wlp1);
+                string_list_delete(wlp2);
+                scp = sub_context_new();
+                sub_var_set_string(scp, "File_Name1", target1);
+                sub_var_set_string(scp, "File_Name2", target2);
+                error_with_position
+                (
+                    &rp->pos,
+                    scp,
+        i18n("\"$filename1\" not derived due to errors deriving \"$filename2\"")
+                );
+                sub_context_delete(scp);
+                gp->statistic.error_by_ingredient++;
+                goto gci_error;
+
+            case graph_build_status_success:
+                string_list_append(&need, target2);
+                string_list_append_unique(wlp2, target2);
+                graph_file_list_nrc_append
+                (
+                    need_gfl,
+                    result2.gfp,
+                    edge_type_default
+                );
+                break;
+            }
+        }
+    }
+
     /*
      * If there is a precondition and if the gatefirst option is
      * not set then check the precondition, now that we have evaluated
@@ -678,6 +811,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
         /*
          * evaluate the predicate
          */
+        rp->profile.precondition++;
         flag = opcode_context_run_bool(ocp, rp->precondition);
 
         /*
@@ -707,6 +841,7 @@ graph_check_ingredients(graph_ty *gp, recipe_ty *rp,
             string_list_delete(wlp1);
             string_list_delete(wlp2);
             gp->statistic.precondition_rejection++;
+            rp->profile.precondition_rejection++;
             goto backtrack;
         }
     }
@@ -870,7 +1005,7 @@ graph_check_recipe(graph_ty *gp, recipe_ty *rp,
      * remember this one
      */
     trace(("remember this one\n"));
-    grp = graph_recipe_new(rp);
+    grp = graph_recipe_new(gp->arena, rp);
     grp->mp = mp;
     graph_recipe_list_append(gp->already_recipe, grp);
     /* that append bumped it by one */
@@ -922,7 +1057,7 @@ graph_check_recipe(graph_ty *gp, recipe_ty *rp,
         gfp = symtab_query(gp->already, fn);
         if (!gfp)
         {
-            gfp = graph_file_new(fn);
+            gfp = graph_file_new(gp->arena, fn);
             symtab_assign(gp->already, fn, gfp);
         }
         graph_file_list_nrc_append(grp->output, gfp, edge_type_default);
@@ -1197,7 +1332,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
     /*
      * allocate a new graph file node
      */
-    gfp = graph_file_new(target);
+    gfp = graph_file_new(gp->arena, target);
     gfp->pending++;
     result->status = graph_build_status_success;
     result->gfp = gfp;
@@ -1267,6 +1402,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
     {
         recipe_ty       *rp;
         graph_build_status_ty status2;
+        graph_profile_ty profile;
         graph_file_list_nrc_ty need2_gfl;
         string_list_ty  target2;
 
@@ -1279,6 +1415,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
         if (rp->out_of_date)
             continue;
 
+        graph_profile_begin(&profile, rp);
         status2 =
             graph_check_ingredients
             (
@@ -1291,6 +1428,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 implicit_allowed,
                 (match_ty *)0
             );
+        graph_profile_end(&profile, status2);
 
         switch (status2)
         {
@@ -1334,6 +1472,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
         {
             recipe_ty       *rp;
             graph_build_status_ty status2;
+            graph_profile_ty profile;
             match_ty        *mp;
             string_list_ty  target2;
             graph_file_list_nrc_ty need2_gfl;
@@ -1345,6 +1484,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
             if (rp->out_of_date)
                 continue;
             gp->statistic.pattern_match_query++;
+            graph_profile_match_attempt(rp);
 
             /*
              * new matcher per recipe, since each one can
@@ -1365,6 +1505,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 continue;
             }
 
+            graph_profile_begin(&profile, rp);
             status2 =
                 graph_check_ingredients
                 (
@@ -1377,6 +1518,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                     implicit_allowed,
                     mp
                 );
+            graph_profile_end(&profile, status2);
             match_delete(mp);
             mp = 0;
 
@@ -1414,6 +1556,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
         {
             recipe_ty       *rp;
             graph_build_status_ty status2;
+            graph_profile_ty profile;
             match_ty        *mp;
             string_list_ty  target2;
             graph_file_list_nrc_ty need2_gfl;
@@ -1425,6 +1568,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
             if (rp->out_of_date)
                 continue;
             gp->statistic.pattern_match_query++;
+            graph_profile_match_attempt(rp);
 
             /*
              * new matcher per recipe, since each one can
@@ -1445,6 +1589,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 continue;
             }
 
+            graph_profile_begin(&profile, rp);
             status2 =
                 graph_check_ingredients
                 (
@@ -1457,6 +1602,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                     implicit_allowed,
                     mp
                 );
+            graph_profile_end(&profile, status2);
             match_delete(mp);
             mp = 0;
 
@@ -1501,6 +1647,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
     {
         recipe_ty       *rp;
         graph_build_status_ty status2;
+        graph_profile_ty profile;
 
         /*
          * Ignore this recipe if it does not have an out-of-date
@@ -1513,6 +1660,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
             continue;
 
         trace(("mark\n"));
+        graph_profile_begin(&profile, rp);
         status2 =
             graph_check_recipe
             (
@@ -1523,6 +1671,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 implicit_allowed,
                 (match_ty *)0
             );
+        graph_profile_end(&profile, status2);
 
         trace(("mark\n"));
         switch (status2)
@@ -1582,6 +1731,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
             recipe_ty       *rp;
             match_ty        *mp;
             graph_build_status_ty status2;
+            graph_profile_ty profile;
             size_t          k;
             int             used;
 
@@ -1605,6 +1755,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 mp = match_new_by_recipe(rp);
 
                 target_pattern = rp->target->string[k];
+                graph_profile_match_attempt(rp);
                 ok = match_attempt(mp, target_pattern, target, &rp->pos);
                 if (ok < 0)
                 {
@@ -1617,6 +1768,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                     continue;
                 }
 
+                graph_profile_begin(&profile, rp);
                 status2 =
                     graph_check_recipe
                     (
@@ -1627,6 +1779,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                         implicit_allowed,
                         mp
                     );
+                graph_profile_end(&profile, status2);
                 mp = 0;
 
                 switch (status2)
@@ -1676,6 +1829,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
             recipe_ty       *rp;
             match_ty        *mp;
             graph_build_status_ty status2;
+            graph_profile_ty profile;
             size_t          k;
             int             used;
 
@@ -1699,6 +1853,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                 mp = match_new_by_recipe(rp);
 
                 target_pattern = rp->target->string[k];
+                graph_profile_match_attempt(rp);
                 ok = match_attempt(mp, target_pattern, target, &rp->pos);
                 if (ok < 0)
                 {
@@ -1711,6 +1866,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                     continue;
                 }
 
+                graph_profile_begin(&profile, rp);
                 status2 =
                     graph_check_recipe
                     (
@@ -1721,6 +1877,7 @@ graph_build_file(graph_ty *gp, string_ty *target,
                         implicit_allowed,
                         mp
                     );
+                graph_profile_end(&profile, status2);
                 mp = 0;
 
                 switch (status2)
@@ -2050,6 +2207,12 @@ graph_build_file(graph_ty *gp, string_ty *target,
     if (gfp)
         gfp->pending--;
 
+    /*
+     * When pipelined, see if any recipes can be queued now.
+     */
+    if (gfp && gp->stream && result->status == graph_build_status_success)
+        graph_stream_release(gp, gfp);
+
     /*
      * release any common ingredients
      */
@@ -2132,6 +2295,7 @@ graph_build_status_ty graph_build_list(graph_ty *gp, string_list_ty *target,
     size_t          j;
     graph_build_status_ty status;
 
+    prefetch_siblings(target);
     for (j = 0; j < target->nstrings; ++j)
     {
         status = graph_build(gp, target->string[j], preference, waffle);
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -19,7 +19,7 @@
 
 #include <cook/graph/file.h>
 #include <cook/graph/recipe_list.h>
-#include <common/mem.h>
+#include <common/arena.h>
 #include <common/str.h>
 #include <common/trace.h>
 
@@ -29,34 +29,38 @@
  *      graph_file_new
  *
  * SYNOPSIS
- *      graph_file_ty *graph_file_new(string_ty *);
+ *      graph_file_ty *graph_file_new(arena_ty *, string_ty *);
  *
  * DESCRIPTION
  *      The graph_file_new function is used to allocate a new graph file
- *      instance in dynamic memory.
+ *      instance from the graph's arena.  Its edge lists are allocated
+ *      from the same arena.
  *
  * RETURNS
  *      graph_file_ty *
  *
  * CAVEAT
- *      Use graph_file_delete when you are done with it.
+ *      Use graph_file_delete when you are done with it.  The memory is
+ *      not released until the arena is deleted.
  */
 
 graph_file_ty  *
-graph_file_new(string_ty *fn)
+graph_file_new(arena_ty *ap, string_ty *fn)
 {
     graph_file_ty   *gfp;
 
     trace(("graph_file_new(fn = \"%s\")\n{\n", fn->str_text));
-    gfp = mem_alloc(sizeof(graph_file_ty));
+    gfp = arena_alloc(ap, sizeof(graph_file_ty));
     gfp->reference_count = 1;
     gfp->filename = str_copy(fn);
-    gfp->input = graph_recipe_list_nrc_new();
-    gfp->output = graph_recipe_list_nrc_new();
+    gfp->input = graph_recipe_list_nrc_new(ap);
+    gfp->output = graph_recipe_list_nrc_new(ap);
     gfp->pending = 0;
     gfp->previous_backtrack = 0;
     gfp->previous_error = 0;
     gfp->primary_target = 0;
+    gfp->stream_released = 0;
+    gfp->stream_ready = 0;
     trace(("return %p;\n", gfp));
     trace(("}\n"));
     return gfp;
@@ -72,7 +76,8 @@ graph_file_new(string_ty *fn)
  *
  * DESCRIPTION
  *      The graph_file_delete function is used to release the resources
- *      held by a grapg file instance in dynamic memory.
+ *      held by a grapg file instance.  The node itself belongs to the
+ *      graph's arena.
  */
 
 void
@@ -94,7 +99,6 @@ graph_file_delete(graph_file_ty *gfp)
     gfp->input = 0;
     graph_recipe_list_nrc_delete(gfp->output);
     gfp->output = 0;
-    mem_free(gfp);
     trace(("}\n"));
 }
 
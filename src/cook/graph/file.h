@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -38,9 +38,12 @@ struct graph_file_ty
         long            done;           /* used by graph_walk */
         size_t          input_uptodate; /* used by graph_walk */
         int             primary_target;
+        int             stream_released; /* used by graph_stream */
+        int             stream_ready;   /* used by graph_stream */
 };
 
-graph_file_ty *graph_file_new(struct string_ty *);
+struct arena_ty; /* existence */
+graph_file_ty *graph_file_new(struct arena_ty *, struct string_ty *);
 void graph_file_delete(graph_file_ty *);
 graph_file_ty *graph_file_copy(graph_file_ty *);
 
@@ -19,6 +19,7 @@
 
 #include <cook/graph/file.h>
 #include <cook/graph/file_list.h>
+#include <common/arena.h>
 #include <common/mem.h>
 #include <common/trace.h>
 
@@ -248,6 +249,7 @@ graph_file_list_nrc_constructor(graph_file_list_nrc_ty *gflp)
     gflp->nfiles = 0;
     gflp->nfiles_max = 0;
     gflp->item = 0;
+    gflp->arena = 0;
     trace(("}\n"));
 }
 
@@ -299,7 +301,7 @@ graph_file_list_nrc_destructor(graph_file_list_nrc_ty *gflp)
 {
     trace(("graph_file_list_nrc_destructor(gflp = %p)\n{\n", gflp));
     /* do not delete references */
-    if (gflp->item)
+    if (gflp->item && !gflp->arena)
         mem_free(gflp->item);
     gflp->nfiles = 0;
     gflp->nfiles_max = 0;
@@ -344,11 +346,19 @@ graph_file_list_nrc_append(graph_file_list_nrc_ty *gflp, graph_file_ty *gfp,
     }
     if (gflp->nfiles >= gflp->nfiles_max)
     {
+        size_t          old_nbytes;
         size_t          nbytes;
 
+        old_nbytes = gflp->nfiles_max * sizeof(gflp->item[0]);
         gflp->nfiles_max = gflp->nfiles_max * 2 + 4;
         nbytes = gflp->nfiles_max * sizeof(gflp->item[0]);
-        gflp->item = mem_change_size(gflp->item, nbytes);
+        if (gflp->arena)
+        {
+            gflp->item =
+                arena_change_size(gflp->arena, gflp->item, old_nbytes, nbytes);
+        }
+        else
+            gflp->item = mem_change_size(gflp->item, nbytes);
     }
     /* do not bump reference count */
     fat = gflp->item + gflp->nfiles++;
@@ -399,11 +409,12 @@ graph_file_list_nrc_append_list(graph_file_list_nrc_ty *to,
  *      graph_file_list_nrc_new
  *
  * SYNOPSIS
- *      graph_file_list_nrc_ty *graph_file_list_nrc_new(void);
+ *      graph_file_list_nrc_ty *graph_file_list_nrc_new(arena_ty *);
  *
  * DESCRIPTION
  *      The graph_file_list_nrc_new function is used to allocate a new empty
- *      graph file list in dynamic memory.
+ *      graph file list in dynamic memory.  If an arena is given, the
+ *      list and its items are allocated from the arena.
  *
  * RETURNS
  *      graph_file_list_nrc_ty *
@@ -413,13 +424,17 @@ graph_file_list_nrc_append_list(graph_file_list_nrc_ty *to,
  */
 
 graph_file_list_nrc_ty *
-graph_file_list_nrc_new(void)
+graph_file_list_nrc_new(arena_ty *ap)
 {
     graph_file_list_nrc_ty *gflp;
 
     trace(("graph_file_list_nrc_new()\n{\n"));
-    gflp = mem_alloc(sizeof(graph_file_list_nrc_ty));
+    if (ap)
+        gflp = arena_alloc(ap, sizeof(graph_file_list_nrc_ty));
+    else
+        gflp = mem_alloc(sizeof(graph_file_list_nrc_ty));
     graph_file_list_nrc_constructor(gflp);
+    gflp->arena = ap;
     trace(("return %p;\n", gflp));
     trace(("}\n"));
     return gflp;
@@ -446,6 +461,7 @@ graph_file_list_nrc_delete(graph_file_list_nrc_ty *gflp)
 {
     trace(("graph_file_list_nrc_delete(gflp = %p)\n{\n", gflp));
     graph_file_list_nrc_destructor(gflp);
-    mem_free(gflp);
+    if (!gflp->arena)
+        mem_free(gflp);
     trace(("}\n"));
 }
@@ -55,6 +55,7 @@ void graph_file_list_delete(graph_file_list_ty *);
 
 /*
  * again, this time without touching the reference counts...
+ * When the arena is set, the list lives in the graph's arena.
  */
 typedef struct graph_file_list_nrc_ty graph_file_list_nrc_ty;
 struct graph_file_list_nrc_ty
@@ -62,6 +63,7 @@ struct graph_file_list_nrc_ty
         size_t          nfiles;
         size_t          nfiles_max;
         graph_file_and_type_ty *item;
+        struct arena_ty *arena;
 };
 
 void graph_file_list_nrc_constructor(graph_file_list_nrc_ty *);
@@ -74,7 +76,8 @@ void graph_file_list_nrc_append(graph_file_list_nrc_ty *,
 void graph_file_list_nrc_append_list(graph_file_list_nrc_ty *,
         struct graph_file_list_nrc_ty *);
 
-graph_file_list_nrc_ty *graph_file_list_nrc_new(void);
+struct arena_ty; /* existence */
+graph_file_list_nrc_ty *graph_file_list_nrc_new(struct arena_ty *);
 void graph_file_list_nrc_delete(graph_file_list_nrc_ty *);
 
 #endif /* COOK_GRAPH_FILE_LIST_H */
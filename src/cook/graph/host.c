@@ -0,0 +1,492 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * Remote hosts are chosen by load, rather than in strict rotation.
+ * Each host of a host binding (or of the parallel_hosts variable) may
+ * say how many jobs it can run at once, as "name:slots", and the host
+ * with the most free capacity is chosen for each recipe.  The time
+ * each recipe takes on each host is remembered, so that hosts which
+ * are slow for a particular recipe are given less of its work.
+ */
+
+#include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
+#include <common/ac/time.h>
+#include <common/ac/unistd.h>
+
+#include <common/error.h> /* for assert */
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <cook/graph/host.h>
+#include <cook/id.h>
+#include <cook/id/variable.h>
+#include <cook/opcode/context.h>
+#include <cook/recipe.h>
+
+/*
+ * The time taken by one recipe on one host, so far.
+ */
+typedef struct host_kind_ty host_kind_ty;
+struct host_kind_ty
+{
+    double          total;
+    long            count;
+};
+
+struct graph_host_ty
+{
+    string_ty       *name;      /* as given to the remote shell */
+    long            slots;
+    long            running;
+    long            jobs;
+    double          busy;
+    symtab_ty       *kind;      /* recipe position -> host_kind_ty */
+};
+
+static symtab_ty *host_table;
+static graph_host_ty **host_list;
+static size_t   host_list_length;
+static size_t   host_list_max;
+static double   host_epoch;
+
+
+double
+graph_host_now(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+    struct timeval  tv;
+
+    gettimeofday(&tv, 0);
+    return (tv.tv_sec + tv.tv_usec * 1.0e-6);
+#else
+    return time((time_t *)0);
+#endif
+}
+
+
+static void
+kind_reap(void *p)
+{
+    mem_free(p);
+}
+
+
+/*
+ * NAME
+ *      slot_count
+ *
+ * SYNOPSIS
+ *      long slot_count(const char *cp);
+ *
+ * DESCRIPTION
+ *      The slot_count function is used to read the number of slots
+ *      following the colon of a host binding word.
+ *
+ * RETURNS
+ *      long; the number, or zero if the text is not a positive number.
+ */
+
+static long
+slot_count(const char *cp)
+{
+    const char      *ep;
+
+    for (ep = cp; *ep >= '0' && *ep <= '9'; ++ep)
+        ;
+    if (ep == cp || *ep)
+        return 0;
+    return atol(cp);
+}
+
+
+/*
+ * NAME
+ *      host_find
+ *
+ * SYNOPSIS
+ *      graph_host_ty *host_find(string_ty *spec);
+ *
+ * DESCRIPTION
+ *      The host_find function is used to find the host named by a
+ *      host binding word, creating it the first time.  A word of the
+ *      form "name:N", where N is a positive number, means the host can
+ *      run N jobs at once; otherwise it runs one.  A host named more
+ *      than once is the same host, with the largest number of slots
+ *      given.
+ *
+ *      IPv6 addresses contain colons of their own, so the number is
+ *      only split off when the name has no other colon.  An address
+ *      may be given in brackets, "[addr]" or "[addr]:N", to give it a
+ *      number of slots; the brackets are not part of the name.
+ */
+
+static graph_host_ty *
+host_find(string_ty *spec)
+{
+    const char      *text;
+    const char      *colon;
+    long            slots;
+    string_ty       *name;
+    graph_host_ty   *hp;
+
+    slots = 1;
+    name = 0;
+    text = spec->str_text;
+    if (text[0] == '[')
+    {
+        colon = strchr(text, ']');
+        if (colon && colon > text + 1)
+        {
+            if (!colon[1])
+                name = str_n_from_c(text + 1, colon - text - 1);
+            else if (colon[1] == ':' && slot_count(colon + 2) > 0)
+            {
+                slots = slot_count(colon + 2);
+                name = str_n_from_c(text + 1, colon - text - 1);
+            }
+        }
+    }
+    else
+    {
+        colon = strchr(text, ':');
+        if
+        (
+            colon
+        &&
+            colon > text
+        &&
+            !strchr(colon + 1, ':')
+        &&
+            slot_count(colon + 1) > 0
+        )
+        {
+            slots = slot_count(colon + 1);
+            name = str_n_from_c(text, colon - text);
+        }
+    }
+    if (!name)
+        name = str_copy(spec);
+
+    if (!host_table)
+        host_table = symtab_alloc(5);
+    hp = symtab_query(host_table, name);
+    if (hp)
+    {
+        if (hp->slots < slots)
+            hp->slots = slots;
+        str_free(name);
+        return hp;
+    }
+
+    hp = mem_alloc(sizeof(graph_host_ty));
+    hp->name = name;
+    hp->slots = slots;
+    hp->running = 0;
+    hp->jobs = 0;
+    hp->busy = 0;
+    hp->kind = symtab_alloc(5);
+    hp->kind->reap = kind_reap;
+    symtab_assign(host_table, name, hp);
+    if (host_list_length >= host_list_max)
+    {
+        host_list_max = host_list_max * 2 + 4;
+        host_list =
+            mem_change_size(host_list, host_list_max * sizeof(host_list[0]));
+    }
+    host_list[host_list_length++] = hp;
+    return hp;
+}
+
+
+static string_ty *
+kind_name(recipe_ty *rp)
+{
+    return
+        str_format
+        (
+            "%s:%d",
+            (rp->pos.pos_name ? rp->pos.pos_name->str_text : ""),
+            rp->pos.pos_line
+        );
+}
+
+
+/*
+ * NAME
+ *      estimate
+ *
+ * SYNOPSIS
+ *      double estimate(graph_host_ty *hp, string_ty *kind,
+ *              graph_host_ty **candidate, size_t ncandidates);
+ *
+ * DESCRIPTION
+ *      The estimate function is used to guess how long the recipe will
+ *      take on the given host.  This is the average of its previous
+ *      runs there, if any; failing that, the average of its runs on
+ *      the other candidates, so that an untried host is neither
+ *      favoured nor avoided.  With no history at all, every host is
+ *      assumed to be equally fast.
+ */
+
+static double
+estimate(graph_host_ty *hp, string_ty *kind, graph_host_ty **candidate,
+    size_t ncandidates)
+{
+    host_kind_ty    *hkp;
+    double          total;
+    long            count;
+    size_t          j;
+
+    hkp = symtab_query(hp->kind, kind);
+    if (hkp && hkp->count)
+        return (hkp->total / hkp->count);
+    total = 0;
+    count = 0;
+    for (j = 0; j < ncandidates; ++j)
+    {
+        hkp = symtab_query(candidate[j]->kind, kind);
+        if (hkp && hkp->count)
+        {
+            total += hkp->total / hkp->count;
+            ++count;
+        }
+    }
+    if (!count)
+        return 1;
+    return (total / count);
+}
+
+
+/*
+ * NAME
+ *      graph_host_acquire
+ *
+ * SYNOPSIS
+ *      graph_host_ty *graph_host_acquire(opcode_context_ty *ocp,
+ *              string_list_ty *slp, recipe_ty *rp);
+ *
+ * DESCRIPTION
+ *      The graph_host_acquire function is used to choose the host to
+ *      run a recipe body on, from the recipe's host binding or, if it
+ *      has none, the parallel_hosts variable.
+ *
+ *      Each host is scored by the expected time for the recipe,
+ *      multiplied by the load the host would have, as a fraction of
+ *      its slots.  The lowest score wins, with ties going to each host
+ *      in turn.  The parallel_jobs limit still governs how many
+ *      recipes run at once, so a host may be given more jobs than it
+ *      has slots if the other hosts are even busier.
+ *
+ * RETURNS
+ *      graph_host_ty *; or NULL if there are no hosts to choose from.
+ *
+ * CAVEAT
+ *      Use graph_host_release when the recipe body has finished.
+ */
+
+graph_host_ty *
+graph_host_acquire(opcode_context_ty *ocp, string_list_ty *slp,
+    recipe_ty *rp)
+{
+    static int      turn;
+    graph_host_ty   **candidate;
+    graph_host_ty   *best;
+    double          best_score;
+    string_ty       *kind;
+    size_t          j;
+
+    trace(("graph_host_acquire()\n{\n"));
+    if (!turn)
+        turn = getpid();
+    if (!slp || !slp->nstrings)
+    {
+        static string_ty *key;
+        id_ty           *idp;
+
+        if (!key)
+            key = str_from_c("parallel_hosts");
+        idp = opcode_context_id_search(ocp, key);
+        if (!idp)
+        {
+            trace(("}\n"));
+            return 0;
+        }
+        slp = id_variable_query2(idp);
+        if (!slp || !slp->nstrings)
+        {
+            trace(("}\n"));
+            return 0;
+        }
+    }
+
+    candidate = mem_alloc(slp->nstrings * sizeof(candidate[0]));
+    for (j = 0; j < slp->nstrings; ++j)
+        candidate[j] = host_find(slp->string[j]);
+
+    kind = kind_name(rp);
+    best = 0;
+    best_score = 0;
+    for (j = 0; j < slp->nstrings; ++j)
+    {
+        graph_host_ty   *hp;
+        double          score;
+
+        hp = candidate[(j + turn) % slp->nstrings];
+        score =
+            (
+                estimate(hp, kind, candidate, slp->nstrings)
+            *
+                (hp->running + 1)
+            /
+                hp->slots
+            );
+        if (!best || score < best_score)
+        {
+            best = hp;
+            best_score = score;
+        }
+    }
+    ++turn;
+    str_free(kind);
+    mem_free(candidate);
+
+    if (!host_epoch)
+        host_epoch = graph_host_now();
+    best->running++;
+    trace(("return %s;\n", best->name->str_text));
+    trace(("}\n"));
+    return best;
+}
+
+
+/*
+ * NAME
+ *      graph_host_release
+ *
+ * SYNOPSIS
+ *      void graph_host_release(graph_host_ty *hp, recipe_ty *rp,
+ *              double elapsed);
+ *
+ * DESCRIPTION
+ *      The graph_host_release function is used to give back the slot
+ *      taken by graph_host_acquire, once the recipe body has finished,
+ *      and to remember how long it took.
+ */
+
+void
+graph_host_release(graph_host_ty *hp, recipe_ty *rp, double elapsed)
+{
+    string_ty       *kind;
+    host_kind_ty    *hkp;
+
+    assert(hp);
+    assert(hp->running > 0);
+    if (elapsed < 0)
+        elapsed = 0;
+    hp->running--;
+    hp->jobs++;
+    hp->busy += elapsed;
+
+    kind = kind_name(rp);
+    hkp = symtab_query(hp->kind, kind);
+    if (!hkp)
+    {
+        hkp = mem_alloc(sizeof(host_kind_ty));
+        hkp->total = 0;
+        hkp->count = 0;
+        symtab_assign(hp->kind, kind, hkp);
+    }
+    hkp->total += elapsed;
+    hkp->count++;
+    str_free(kind);
+}
+
+
+string_ty *
+graph_host_name(graph_host_ty *hp)
+{
+    assert(hp);
+    return hp->name;
+}
+
+
+/*
+ * NAME
+ *      graph_host_report
+ *
+ * SYNOPSIS
+ *      void graph_host_report(void);
+ *
+ * DESCRIPTION
+ *      The graph_host_report function is used to print, for each host
+ *      which ran recipes since the last report, the number of jobs,
+ *      the time it was busy, and that time as a fraction of its slots
+ *      over the elapsed time.  The counts are then reset; the recipe
+ *      timings are kept.
+ */
+
+void
+graph_host_report(void)
+{
+    double          elapsed;
+    size_t          j;
+
+    if (!host_epoch)
+        return;
+    elapsed = graph_host_now() - host_epoch;
+    for (j = 0; j < host_list_length; ++j)
+    {
+        graph_host_ty   *hp;
+        long            frac;
+        long            sec;
+        long            min;
+        long            hour;
+
+        hp = host_list[j];
+        if (!hp->jobs)
+            continue;
+        frac = hp->busy * 1000 + 0.5;
+        sec = frac / 1000;
+        frac %= 1000;
+        min = sec / 60;
+        sec %= 60;
+        hour = min / 60;
+        min %= 60;
+        fprintf
+        (
+            stderr,
+            "%2ld:%02ld:%02ld.%03ld host %s, %ld job%s, %ld slot%s %5.1f%%\n",
+            hour,
+            min,
+            sec,
+            frac,
+            hp->name->str_text,
+            hp->jobs,
+            (hp->jobs == 1 ? "" : "s"),
+            hp->slots,
+            (hp->slots == 1 ? "" : "s"),
+            (elapsed > 0 ? 100. * hp->busy / (hp->slots * elapsed) : 0.)
+        );
+        hp->jobs = 0;
+        hp->busy = 0;
+    }
+    host_epoch = 0;
+}
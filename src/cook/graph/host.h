@@ -0,0 +1,38 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_GRAPH_HOST_H
+#define COOK_GRAPH_HOST_H
+
+#include <common/main.h>
+
+typedef struct graph_host_ty graph_host_ty;
+
+struct opcode_context_ty; /* existence */
+struct recipe_ty; /* existence */
+struct string_list_ty; /* existence */
+struct string_ty; /* existence */
+graph_host_ty *graph_host_acquire(struct opcode_context_ty *,
+        struct string_list_ty *, struct recipe_ty *);
+void graph_host_release(graph_host_ty *, struct recipe_ty *, double);
+struct string_ty *graph_host_name(graph_host_ty *);
+double graph_host_now(void);
+void graph_host_report(void);
+
+#endif /* COOK_GRAPH_HOST_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1998, 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1998, 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -21,6 +21,7 @@
 #include <cook/graph/leaf.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
+#include <cook/match/list.h>
 #include <cook/match/new_by_recip.h>
 #include <cook/id/global.h>
 #include <cook/opcode/context.h>
@@ -30,11 +31,11 @@
 
 static symtab_ty *stp;
 static string_list_ty *leaf_file;       /* leaf of graph */
-static string_list_ty *leaf_pattern;
+static match_list_ty *leaf_pattern;
 static string_list_ty *exterior_file;   /* exterior of graph */
-static string_list_ty *exterior_pattern;
+static match_list_ty *exterior_pattern;
 static string_list_ty *interior_file;   /* interior of graph */
-static string_list_ty *interior_pattern;
+static match_list_ty *interior_pattern;
 static leaf_ness_ty leaf_exists = leaf_ness_leaf_exists;
 static leaf_ness_ty leaf_explicit = leaf_ness_leaf_explicit;
 static leaf_ness_ty exterior_explicit = leaf_ness_exterior_explicit;
@@ -48,11 +49,11 @@ leaf_reset(void)
     if (stp)
         symtab_free(stp);
     if (leaf_pattern)
-        string_list_delete(leaf_pattern);
+        match_list_delete(leaf_pattern);
     if (interior_pattern)
-        string_list_delete(interior_pattern);
+        match_list_delete(interior_pattern);
     if (exterior_pattern)
-        string_list_delete(exterior_pattern);
+        match_list_delete(exterior_pattern);
     if (leaf_file)
         string_list_delete(leaf_file);
     if (interior_file)
@@ -89,13 +90,29 @@ find_variable(char *name)
 }
 
 
-static int
-matches_list(string_ty *actual, string_list_ty *formal)
+/*
+ * NAME
+ *      find_patterns
+ *
+ * SYNOPSIS
+ *      match_list_ty *find_patterns(char *name);
+ *
+ * DESCRIPTION
+ *      The find_patterns function is used to read a pattern list
+ *      variable, and index it so that each file name is classified in
+ *      one pass, rather than one pattern at a time.
+ *
+ * RETURNS
+ *      match_list_ty *; or NULL if the variable is not set, or empty.
+ */
+
+static match_list_ty *
+find_patterns(char *name)
 {
-    size_t          j;
-    match_ty        *mp;
-    int             result;
+    string_list_ty  *formal;
+    match_list_ty   *result;
 
+    formal = find_variable(name);
     if (!formal)
         return 0;
 
@@ -103,21 +120,23 @@ matches_list(string_ty *actual, string_list_ty *formal)
      * Do we need to *clear* the recipe-level flags before evaluating
      * this.  Otherwise the pattern match mode is ambiguous.
      */
-    mp = match_new_by_recipe(0);
-
-    result = 0;
-    for (j = 0; j < formal->nstrings; ++j)
-    {
-        /* result can be -1 (error), 0 (false), or 1 (true) */
-        result = match_attempt(mp, formal->string[j], actual, 0);
-        if (result)
-            break;
-    }
-    match_delete(mp);
+    result = match_list_new(match_new_by_recipe(0), formal);
+    string_list_delete(formal);
     return result;
 }
 
 
+static int
+matches_list(string_ty *actual, match_list_ty *formal)
+{
+    if (!formal)
+        return 0;
+
+    /* result can be -1 (error), 0 (false), or 1 (true) */
+    return match_list_execute(formal, actual, 0, 0);
+}
+
+
 static int
 initialize(void)
 {
@@ -129,11 +148,11 @@ initialize(void)
         return 0;
     stp = symtab_alloc(5);
     leaf_file = find_variable("graph_leaf_file");
-    leaf_pattern = find_variable("graph_leaf_pattern");
+    leaf_pattern = find_patterns("graph_leaf_pattern");
     interior_file = find_variable("graph_interior_file");
-    interior_pattern = find_variable("graph_interior_pattern");
+    interior_pattern = find_patterns("graph_interior_pattern");
     exterior_file = find_variable("graph_exterior_file");
-    exterior_pattern = find_variable("graph_exterior_pattern");
+    exterior_pattern = find_patterns("graph_exterior_pattern");
 
     if (leaf_file)
     {
@@ -0,0 +1,634 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/stdio.h>
+#include <common/ac/unistd.h>
+
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/stracc.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <cook/deps/depfile.h>
+#include <cook/graph.h>
+#include <cook/graph/file.h>
+#include <cook/graph/file_list.h>
+#include <cook/graph/ninja.h>
+#include <cook/graph/pool.h>
+#include <cook/graph/recipe.h>
+#include <cook/graph/recipe_list.h>
+#include <cook/graph/script.h>
+#include <cook/opcode/context.h>
+#include <cook/option.h>
+#include <cook/recipe.h>
+#include <cook/tempfilename.h>
+
+/*
+ * Recipes sharing a single-thread name share a pool (see graph_pool).
+ * Ninja can only put a build statement in one pool, so names which
+ * appear together on any recipe are merged into the one pool.  This
+ * maps each name to its parent name; a root maps to its pool number,
+ * and to the depth of its pool.
+ */
+static symtab_ty *pool_parent;
+static symtab_ty *pool_number;
+static symtab_ty *pool_depth;
+
+/*
+ * Recipes without a body become phony statements.  Cook allows several
+ * recipes to name the same target, but ninja does not, so their
+ * ingredients are merged and printed at the end.
+ */
+static string_list_ty phony_target;
+static symtab_ty *phony_need;
+
+
+static void
+pool_reap(void *p)
+{
+    str_free(p);
+}
+
+
+static void
+pool_depth_reap(void *p)
+{
+    mem_free(p);
+}
+
+
+static void
+phony_need_reap(void *p)
+{
+    string_list_delete(p);
+}
+
+
+/*
+ * NAME
+ *      pool_root
+ *
+ * SYNOPSIS
+ *      string_ty *pool_root(string_ty *name);
+ *
+ * DESCRIPTION
+ *      The pool_root function is used to find the name which stands for
+ *      all of the single-thread names merged with the given one.
+ */
+
+static string_ty *
+pool_root(string_ty *name)
+{
+    for (;;)
+    {
+        string_ty       *parent;
+
+        parent = symtab_query(pool_parent, name);
+        if (!parent || str_equal(parent, name))
+            return name;
+        name = parent;
+    }
+}
+
+
+static void
+pool_join(string_ty *name1, string_ty *name2)
+{
+    string_ty       *root1;
+    string_ty       *root2;
+
+    if (!symtab_query(pool_parent, name1))
+        symtab_assign(pool_parent, name1, str_copy(name1));
+    if (!symtab_query(pool_parent, name2))
+        symtab_assign(pool_parent, name2, str_copy(name2));
+    root1 = pool_root(name1);
+    root2 = pool_root(name2);
+    if (!str_equal(root1, root2))
+        symtab_assign(pool_parent, root2, str_copy(root1));
+}
+
+
+/*
+ * NAME
+ *      graph_ninja_path
+ *
+ * SYNOPSIS
+ *      void graph_ninja_path(string_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_ninja_path function is used to print a file name on
+ *      the standard output, escaped for use in a ninja build or default
+ *      statement.
+ *
+ * CAVEAT
+ *      Ninja has no way to escape a newline in a file name (a dollar
+ *      before a newline continues the line), so such names are a fatal
+ *      error.
+ */
+
+void
+graph_ninja_path(string_ty *s)
+{
+    const char      *cp;
+
+    for (cp = s->str_text; *cp; ++cp)
+    {
+        switch (*cp)
+        {
+        case '$':
+        case ' ':
+        case ':':
+            putchar('$');
+            break;
+
+        case '\n':
+            {
+                sub_context_ty  *scp;
+
+                scp = sub_context_new();
+                sub_var_set_string(scp, "File_Name", s);
+                fatal_intl(scp, i18n("$filename: newline not allowed in "
+                    "ninja file"));
+                /* NOTREACHED */
+            }
+        }
+        putchar(*cp);
+    }
+}
+
+
+/*
+ * NAME
+ *      ninja_command
+ *
+ * SYNOPSIS
+ *      void ninja_command(string_ty *script);
+ *
+ * DESCRIPTION
+ *      The ninja_command function is used to print a shell script
+ *      fragment as a ninja variable value.  Ninja variables may not
+ *      contain newlines, so the fragment is encoded for printf(1) and
+ *      given to eval, which keeps here documents and multi-line
+ *      conditionals intact.
+ */
+
+static void
+ninja_command(string_ty *script)
+{
+    const char      *cp;
+
+    printf("eval \"$$(printf '%%b' '");
+    for (cp = script->str_text; *cp; ++cp)
+    {
+        switch (*cp)
+        {
+        case '\n':
+            fputs("\\n", stdout);
+            break;
+
+        case '\\':
+            fputs("\\\\", stdout);
+            break;
+
+        case '\'':
+            fputs("'\\''", stdout);
+            break;
+
+        case '$':
+            fputs("$$", stdout);
+            break;
+
+        default:
+            putchar(*cp);
+            break;
+        }
+    }
+    printf("')\"");
+}
+
+
+/*
+ * NAME
+ *      capture_body
+ *
+ * SYNOPSIS
+ *      string_ty *capture_body(graph_recipe_ty *grp,
+ *              graph_walk_status_ty *status_p);
+ *
+ * DESCRIPTION
+ *      The capture_body function is used to obtain the shell script
+ *      for the recipe body, as graph_recipe_script_body would print it.
+ *      The standard output is temporarily redirected to an unlinked
+ *      temporary file while the body is scripted.
+ *
+ * RETURNS
+ *      string_ty *; use str_free when you are done with it.
+ */
+
+static string_ty *
+capture_body(graph_recipe_ty *grp, graph_walk_status_ty *status_p)
+{
+    string_ty       *fn;
+    int             fd;
+    int             saved;
+    stracc          buffer;
+    char            buf[1 << 12];
+    string_ty       *result;
+
+    fn = temporary_filename();
+    fd = open(fn->str_text, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        fatal_intl_open(fn->str_text);
+    unlink(fn->str_text);
+
+    fflush(stdout);
+    saved = dup(fileno(stdout));
+    if (saved < 0 || dup2(fd, fileno(stdout)) < 0)
+    {
+        sub_context_ty  *scp;
+
+        scp = sub_context_new();
+        sub_errno_set(scp);
+        fatal_intl(scp, i18n("dup(): $errno"));
+        /* NOTREACHED */
+    }
+    *status_p = graph_recipe_script_body(grp);
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    stracc_constructor(&buffer);
+    sa_open(&buffer);
+    if (lseek(fd, (off_t)0, SEEK_SET) != 0)
+        fatal_intl_read(fn->str_text);
+    for (;;)
+    {
+        ssize_t         n;
+
+        n = read(fd, buf, sizeof(buf));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fatal_intl_read(fn->str_text);
+        }
+        if (n == 0)
+            break;
+        sa_chars(&buffer, buf, n);
+    }
+    close(fd);
+    str_free(fn);
+    result = sa_close(&buffer);
+    stracc_destructor(&buffer);
+    return result;
+}
+
+
+/*
+ * NAME
+ *      graph_ninja_begin
+ *
+ * SYNOPSIS
+ *      void graph_ninja_begin(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_ninja_begin function is used to print the start of a
+ *      ninja build file on the standard output: the one rule every
+ *      build statement uses, and a pool for each group of single-thread
+ *      names used by the recipes of the graph.
+ *
+ *      Ninja has each build statement take one place in its pool, so
+ *      the depth is the smallest number of recipes which can run at
+ *      once given the capacity of each name in the group and the
+ *      amount each recipe claims, and never less than one.
+ */
+
+void
+graph_ninja_begin(graph_ty *gp)
+{
+    size_t          j;
+    size_t          k;
+    long            npools;
+    graph_pool_ty   *gpp;
+
+    trace(("graph_ninja_begin(gp = %p)\n{\n", gp));
+    printf("# Generated by cook -ninja.  Do not edit.\n");
+    printf("ninja_required_version = 1.3\n\n");
+    printf("rule cook\n");
+    printf("  command = $cmd\n");
+    printf("  description = $out\n");
+
+    pool_parent = symtab_alloc(10);
+    pool_parent->reap = pool_reap;
+    pool_number = symtab_alloc(10);
+    pool_number->reap = pool_reap;
+    pool_depth = symtab_alloc(10);
+    pool_depth->reap = pool_depth_reap;
+    for (j = 0; j < gp->already_recipe->nrecipes; ++j)
+    {
+        string_list_ty  *slp;
+        string_ty       *name0;
+        long            amount;
+
+        slp = gp->already_recipe->recipe[j]->single_thread;
+        if (!slp)
+            continue;
+        name0 = graph_pool_word(slp->string[0], &amount);
+        for (k = 0; k < slp->nstrings; ++k)
+        {
+            string_ty       *name;
+
+            name = graph_pool_word(slp->string[k], &amount);
+            pool_join(name0, name);
+            str_free(name);
+        }
+        str_free(name0);
+    }
+
+    gpp = graph_pool_new();
+    for (j = 0; j < gp->already_recipe->nrecipes; ++j)
+    {
+        string_list_ty  *slp;
+        string_ty       *root;
+        long            *depth;
+
+        slp = gp->already_recipe->recipe[j]->single_thread;
+        if (!slp)
+            continue;
+        for (k = 0; k < slp->nstrings; ++k)
+        {
+            string_ty       *name;
+            long            amount;
+            long            n;
+
+            name = graph_pool_word(slp->string[k], &amount);
+            root = pool_root(name);
+            n = graph_pool_capacity(gpp, name) / amount;
+            if (n < 1)
+                n = 1;
+            depth = symtab_query(pool_depth, root);
+            if (!depth)
+            {
+                depth = mem_alloc(sizeof(long));
+                *depth = n;
+                symtab_assign(pool_depth, root, depth);
+            }
+            else if (*depth > n)
+                *depth = n;
+            str_free(name);
+        }
+    }
+    graph_pool_delete(gpp);
+
+    npools = 0;
+    for (j = 0; j < gp->already_recipe->nrecipes; ++j)
+    {
+        string_list_ty  *slp;
+        string_ty       *root;
+        string_ty       *name;
+        long            amount;
+        long            *depth;
+
+        slp = gp->already_recipe->recipe[j]->single_thread;
+        if (!slp)
+            continue;
+        name = graph_pool_word(slp->string[0], &amount);
+        root = pool_root(name);
+        str_free(name);
+        if (symtab_query(pool_number, root))
+            continue;
+        name = str_format("single_thread_%ld", ++npools);
+        symtab_assign(pool_number, root, name);
+        depth = symtab_query(pool_depth, root);
+        assert(depth);
+        printf
+        (
+            "\npool %s\n  depth = %ld\n",
+            name->str_text,
+            (depth ? *depth : 1L)
+        );
+    }
+
+    string_list_constructor(&phony_target);
+    phony_need = symtab_alloc(10);
+    phony_need->reap = phony_need_reap;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      graph_recipe_ninja
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_recipe_ninja(graph_recipe_ty *,
+ *              graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_ninja function is used to print a ninja build
+ *      statement on the standard output for this recipe instance, with
+ *      its expanded commands.
+ *
+ *      Ingredients with the ``exists'' edge type are only ordering
+ *      constraints, and become order-only dependencies.
+ *
+ * RETURNS
+ *      graph_walk_status_ty
+ *              error           something went wrong
+ *              done            success
+ */
+
+graph_walk_status_ty
+graph_recipe_ninja(graph_recipe_ty *grp, graph_ty *gp)
+{
+    graph_walk_status_ty status;
+    size_t          j;
+    string_ty       *body;
+    int             order_only;
+
+    trace(("graph_recipe_ninja(grp = %p)\n{\n", grp));
+    status = graph_walk_status_done;
+    assert(grp->output->nfiles > 0);
+
+    /*
+     * A recipe with no body is a phony statement, which may need
+     * to be merged with others for the same targets.
+     */
+    if (!grp->rp->out_of_date)
+    {
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            string_ty       *target;
+            string_list_ty  *need;
+            size_t          k;
+
+            target = grp->output->item[j].file->filename;
+            need = symtab_query(phony_need, target);
+            if (!need)
+            {
+                need = string_list_new();
+                symtab_assign(phony_need, target, need);
+                string_list_append(&phony_target, target);
+            }
+            for (k = 0; k < grp->input->nfiles; ++k)
+            {
+                string_list_append_unique
+                (
+                    need,
+                    grp->input->item[k].file->filename
+                );
+            }
+        }
+        trace(("return %s;\n", graph_walk_status_name(status)));
+        trace(("}\n"));
+        return status;
+    }
+
+    graph_recipe_script_context(grp, gp);
+    recipe_flags_set(grp->rp);
+    body = capture_body(grp, &status);
+
+    if (grp->rp->pos.pos_line)
+    {
+        printf
+        (
+            "\n# %s: %d\n",
+            grp->rp->pos.pos_name->str_text,
+            grp->rp->pos.pos_line
+        );
+    }
+    else
+        printf("\n");
+    printf("build");
+    for (j = 0; j < grp->output->nfiles; ++j)
+    {
+        printf(" ");
+        graph_ninja_path(grp->output->item[j].file->filename);
+    }
+    printf(": cook");
+    for (j = 0; j < grp->input->nfiles; ++j)
+    {
+        if (grp->input->item[j].edge_type & edge_type_exists)
+            continue;
+        printf(" ");
+        graph_ninja_path(grp->input->item[j].file->filename);
+    }
+    order_only = 0;
+    for (j = 0; j < grp->input->nfiles; ++j)
+    {
+        if (!(grp->input->item[j].edge_type & edge_type_exists))
+            continue;
+        if (!order_only)
+        {
+            printf(" ||");
+            order_only = 1;
+        }
+        printf(" ");
+        graph_ninja_path(grp->input->item[j].file->filename);
+    }
+    printf("\n  cmd = ");
+    ninja_command(body);
+    printf("\n");
+    str_free(body);
+
+    if (option_test(OPTION_DEPFILE))
+    {
+        string_ty       *dfn;
+
+        dfn = depfile_name(grp->output->item[0].file->filename);
+        printf("  depfile = ");
+        graph_ninja_path(dfn);
+        printf("\n");
+        str_free(dfn);
+    }
+    if (grp->single_thread)
+    {
+        string_ty       *name0;
+        string_ty       *name;
+        long            amount;
+
+        name0 = graph_pool_word(grp->single_thread->string[0], &amount);
+        name = symtab_query(pool_number, pool_root(name0));
+        str_free(name0);
+        assert(name);
+        if (name)
+            printf("  pool = %s\n", name->str_text);
+    }
+
+    option_undo_level(OPTION_LEVEL_RECIPE);
+    opcode_context_delete(grp->ocp);
+    grp->ocp = 0;
+    trace(("return %s;\n", graph_walk_status_name(status)));
+    trace(("}\n"));
+    return status;
+}
+
+
+/*
+ * NAME
+ *      graph_ninja_end
+ *
+ * SYNOPSIS
+ *      void graph_ninja_end(void);
+ *
+ * DESCRIPTION
+ *      The graph_ninja_end function is used to print the merged phony
+ *      statements, and release the resources used while printing a
+ *      ninja build file.
+ */
+
+void
+graph_ninja_end(void)
+{
+    size_t          j;
+
+    trace(("graph_ninja_end()\n{\n"));
+    for (j = 0; j < phony_target.nstrings; ++j)
+    {
+        string_ty       *target;
+        string_list_ty  *need;
+        size_t          k;
+
+        target = phony_target.string[j];
+        need = symtab_query(phony_need, target);
+        assert(need);
+        printf("\nbuild ");
+        graph_ninja_path(target);
+        printf(": phony");
+        for (k = 0; k < need->nstrings; ++k)
+        {
+            printf(" ");
+            graph_ninja_path(need->string[k]);
+        }
+        printf("\n");
+    }
+    string_list_destructor(&phony_target);
+    symtab_free(phony_need);
+    phony_need = 0;
+    symtab_free(pool_parent);
+    pool_parent = 0;
+    symtab_free(pool_number);
+    pool_number = 0;
+    symtab_free(pool_depth);
+    pool_depth = 0;
+    trace(("}\n"));
+}
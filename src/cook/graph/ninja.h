@@ -0,0 +1,35 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_GRAPH_NINJA_H
+#define COOK_GRAPH_NINJA_H
+
+#include <cook/graph/walk.h>
+
+struct graph_ty; /* existence */
+struct graph_recipe_ty; /* existence */
+struct string_ty; /* existence */
+
+void graph_ninja_begin(struct graph_ty *);
+graph_walk_status_ty graph_recipe_ninja(struct graph_recipe_ty *,
+        struct graph_ty *);
+void graph_ninja_end(void);
+void graph_ninja_path(struct string_ty *);
+
+#endif /* COOK_GRAPH_NINJA_H */
@@ -0,0 +1,554 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * Recipes which share a single-thread name may not all run at once.
+ * Each name is a pool holding one unit, unless the parallel_pools
+ * variable gives it more, and a recipe claims one unit of each pool it
+ * names, or N units if the name is written "name:N".  A recipe is only
+ * started when every pool it names can meet its claim.
+ *
+ * Recipes may also be held back to stay within the memory budget given
+ * by the parallel_memory variable.  The peak memory of each recipe is
+ * measured when it runs, and kept with the fingerprints of its
+ * targets; it is this figure which is claimed from the budget the next
+ * time the recipe runs.  It is only kept while there is a budget.
+ */
+
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+
+#include <common/error.h> /* for assert */
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <cook/fingerprint.h>
+#include <cook/graph/file.h>
+#include <cook/graph/file_list.h>
+#include <cook/graph/pool.h>
+#include <cook/graph/recipe.h>
+#include <cook/id.h>
+#include <cook/id/variable.h>
+#include <cook/opcode/context.h>
+#include <cook/option.h>
+
+typedef struct pool_ty pool_ty;
+struct pool_ty
+{
+    long            capacity;
+    long            used;
+};
+
+struct graph_pool_ty
+{
+    symtab_ty       *pool;
+    long            memory;         /* kilobytes, or 0 for no budget */
+    long            memory_used;
+};
+
+
+static void
+pool_reap(void *p)
+{
+    mem_free(p);
+}
+
+
+/*
+ * NAME
+ *      graph_pool_word
+ *
+ * SYNOPSIS
+ *      string_ty *graph_pool_word(string_ty *word, long *amount);
+ *
+ * DESCRIPTION
+ *      The graph_pool_word function is used to split a single-thread
+ *      word into the name of a pool and an amount.  A word of the form
+ *      "name:N", where N is a positive number, means N units of the
+ *      named pool; otherwise it means one unit of the pool named by
+ *      the whole word.
+ *
+ * RETURNS
+ *      string_ty *; the pool name.  Use str_free when you are done
+ *      with it.
+ */
+
+string_ty *
+graph_pool_word(string_ty *word, long *amount)
+{
+    const char      *colon;
+    const char      *cp;
+
+    *amount = 1;
+    colon = strrchr(word->str_text, ':');
+    if (colon && colon > word->str_text && colon[1])
+    {
+        for (cp = colon + 1; *cp >= '0' && *cp <= '9'; ++cp)
+            ;
+        if (!*cp && atol(colon + 1) > 0)
+        {
+            *amount = atol(colon + 1);
+            return str_n_from_c(word->str_text, colon - word->str_text);
+        }
+    }
+    return str_copy(word);
+}
+
+
+static pool_ty *
+pool_find(graph_pool_ty *gpp, string_ty *name)
+{
+    pool_ty         *pp;
+
+    pp = symtab_query(gpp->pool, name);
+    if (!pp)
+    {
+        pp = mem_alloc(sizeof(pool_ty));
+        pp->capacity = 1;
+        pp->used = 0;
+        symtab_assign(gpp->pool, name, pp);
+    }
+    return pp;
+}
+
+
+/*
+ * NAME
+ *      memory_budget
+ *
+ * SYNOPSIS
+ *      long memory_budget(string_ty *s);
+ *
+ * DESCRIPTION
+ *      The memory_budget function is used to read the value of the
+ *      parallel_memory variable.  This is a number of bytes, which may
+ *      be followed by K, M, G or T for the usual multiples of 1024, or
+ *      by % for a percentage of the physical memory.
+ *
+ * RETURNS
+ *      long; kilobytes, or zero if the value is not understood.
+ */
+
+static long
+memory_budget(string_ty *s)
+{
+    double          n;
+    char            *ep;
+
+    n = strtod(s->str_text, &ep);
+    if (ep == s->str_text || n <= 0)
+        return 0;
+    switch (*ep)
+    {
+    case '%':
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+        if (ep[1])
+            return 0;
+        n *= (double)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) / 100;
+        return (long)(n / 1024);
+#else
+        return 0;
+#endif
+
+    case 't':
+    case 'T':
+        n *= 1024;
+        /* fall through... */
+
+    case 'g':
+    case 'G':
+        n *= 1024;
+        /* fall through... */
+
+    case 'm':
+    case 'M':
+        n *= 1024;
+        /* fall through... */
+
+    case 'k':
+    case 'K':
+        n *= 1024;
+        ++ep;
+        if (*ep == 'b' || *ep == 'B')
+            ++ep;
+        break;
+    }
+    if (*ep)
+        return 0;
+    return (long)(n / 1024);
+}
+
+
+static string_list_ty *
+variable(opcode_context_ty *ocp, const char *name)
+{
+    string_ty       *key;
+    id_ty           *idp;
+
+    key = str_from_c(name);
+    idp = opcode_context_id_search(ocp, key);
+    str_free(key);
+    if (!idp)
+        return 0;
+    return id_variable_query2(idp);
+}
+
+
+/*
+ * NAME
+ *      graph_pool_new
+ *
+ * SYNOPSIS
+ *      graph_pool_ty *graph_pool_new(void);
+ *
+ * DESCRIPTION
+ *      The graph_pool_new function is used to create the pools for a
+ *      graph walk, with the capacities given by the parallel_pools
+ *      variable, and the budget given by the parallel_memory variable.
+ *
+ * RETURNS
+ *      graph_pool_ty *
+ *
+ * CAVEAT
+ *      Use graph_pool_delete when you are done with it.
+ */
+
+graph_pool_ty *
+graph_pool_new(void)
+{
+    graph_pool_ty   *gpp;
+    opcode_context_ty *ocp;
+    string_list_ty  *slp;
+    size_t          j;
+
+    trace(("graph_pool_new()\n{\n"));
+    gpp = mem_alloc(sizeof(graph_pool_ty));
+    gpp->pool = symtab_alloc(5);
+    gpp->pool->reap = pool_reap;
+    gpp->memory = 0;
+    gpp->memory_used = 0;
+
+    ocp = opcode_context_new(0, 0);
+    slp = variable(ocp, "parallel_pools");
+    for (j = 0; slp && j < slp->nstrings; ++j)
+    {
+        string_ty       *name;
+        long            capacity;
+        pool_ty         *pp;
+
+        name = graph_pool_word(slp->string[j], &capacity);
+        pp = pool_find(gpp, name);
+        if (pp->capacity < capacity)
+            pp->capacity = capacity;
+        trace(("%s = %ld\n", name->str_text, pp->capacity));
+        str_free(name);
+    }
+    slp = variable(ocp, "parallel_memory");
+    if (slp && slp->nstrings == 1)
+        gpp->memory = memory_budget(slp->string[0]);
+    opcode_context_delete(ocp);
+    trace(("memory = %ldk\n", gpp->memory));
+    trace(("return %p;\n", gpp));
+    trace(("}\n"));
+    return gpp;
+}
+
+
+/*
+ * NAME
+ *      graph_pool_delete
+ *
+ * SYNOPSIS
+ *      void graph_pool_delete(graph_pool_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_pool_delete function is used to release the resources
+ *      held by a set of pools.
+ */
+
+void
+graph_pool_delete(graph_pool_ty *gpp)
+{
+    symtab_free(gpp->pool);
+    mem_free(gpp);
+}
+
+
+/*
+ * NAME
+ *      graph_pool_capacity
+ *
+ * SYNOPSIS
+ *      long graph_pool_capacity(graph_pool_ty *gpp, string_ty *name);
+ *
+ * DESCRIPTION
+ *      The graph_pool_capacity function is used to find how many units
+ *      the named pool holds.
+ */
+
+long
+graph_pool_capacity(graph_pool_ty *gpp, string_ty *name)
+{
+    return pool_find(gpp, name)->capacity;
+}
+
+
+/*
+ * NAME
+ *      claim
+ *
+ * SYNOPSIS
+ *      long claim(graph_pool_ty *gpp, string_list_ty *slp, size_t j,
+ *              pool_ty **pp);
+ *
+ * DESCRIPTION
+ *      The claim function is used to find how much of a pool a recipe
+ *      claims, from the j'th of its single-thread words.  A pool named
+ *      more than once is claimed by its first word, for the total of
+ *      all of them.  No claim is allowed to exceed the capacity of the
+ *      pool, so that every recipe can run when the pool is idle.
+ *
+ * RETURNS
+ *      long; the amount claimed, or zero if this word is not the first
+ *      to name its pool.
+ */
+
+static long
+claim(graph_pool_ty *gpp, string_list_ty *slp, size_t j, pool_ty **pp)
+{
+    string_ty       *name;
+    long            total;
+    size_t          k;
+
+    name = graph_pool_word(slp->string[j], &total);
+    for (k = 0; k < slp->nstrings; ++k)
+    {
+        string_ty       *name2;
+        long            amount;
+        int             same;
+
+        if (k == j)
+            continue;
+        name2 = graph_pool_word(slp->string[k], &amount);
+        same = str_equal(name, name2);
+        str_free(name2);
+        if (!same)
+            continue;
+        if (k < j)
+        {
+            total = 0;
+            break;
+        }
+        total += amount;
+    }
+    *pp = pool_find(gpp, name);
+    str_free(name);
+    if (total > (*pp)->capacity)
+        total = (*pp)->capacity;
+    return total;
+}
+
+
+/*
+ * NAME
+ *      estimate
+ *
+ * SYNOPSIS
+ *      long estimate(graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The estimate function is used to find how much memory a recipe
+ *      is expected to use: the largest figure recorded against any of
+ *      its targets.  Nothing is recorded unless fingerprints are in use.
+ *
+ * RETURNS
+ *      long; kilobytes, or zero if not known.
+ */
+
+static long
+estimate(graph_recipe_ty *grp)
+{
+    size_t          j;
+
+    if (grp->memory >= 0)
+        return grp->memory;
+    grp->memory = 0;
+    if (!option_test(OPTION_FINGERPRINT))
+        return 0;
+    for (j = 0; j < grp->output->nfiles; ++j)
+    {
+        long            n;
+
+        n = fp_memory(grp->output->item[j].file->filename);
+        if (grp->memory < n)
+            grp->memory = n;
+    }
+    trace(("estimate %ldk\n", grp->memory));
+    return grp->memory;
+}
+
+
+/*
+ * NAME
+ *      graph_pool_admit
+ *
+ * SYNOPSIS
+ *      int graph_pool_admit(graph_pool_ty *gpp, graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The graph_pool_admit function is used to determine whether a
+ *      recipe may be started now: every pool it names must have room
+ *      for its claim, and its expected memory must fit in what is left
+ *      of the budget.  A recipe is always admitted if no memory is
+ *      claimed by the recipes running, however much it expects to use,
+ *      so that it does eventually run.
+ *
+ * RETURNS
+ *      int; non-zero if the recipe may be started, zero if not.
+ */
+
+int
+graph_pool_admit(graph_pool_ty *gpp, graph_recipe_ty *grp)
+{
+    size_t          j;
+
+    if (grp->single_thread)
+    {
+        for (j = 0; j < grp->single_thread->nstrings; ++j)
+        {
+            pool_ty         *pp;
+            long            amount;
+
+            amount = claim(gpp, grp->single_thread, j, &pp);
+            if (pp->used + amount > pp->capacity)
+                return 0;
+        }
+    }
+    if
+    (
+        gpp->memory
+    &&
+        gpp->memory_used
+    &&
+        gpp->memory_used + estimate(grp) > gpp->memory
+    )
+        return 0;
+    return 1;
+}
+
+
+/*
+ * NAME
+ *      graph_pool_claim
+ *
+ * SYNOPSIS
+ *      void graph_pool_claim(graph_pool_ty *gpp, graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The graph_pool_claim function is used to take a recipe's claims
+ *      from the pools and the memory budget, as it is started.
+ *
+ * CAVEAT
+ *      Use graph_pool_release when the recipe has finished.
+ */
+
+void
+graph_pool_claim(graph_pool_ty *gpp, graph_recipe_ty *grp)
+{
+    size_t          j;
+
+    if (grp->single_thread)
+    {
+        for (j = 0; j < grp->single_thread->nstrings; ++j)
+        {
+            pool_ty         *pp;
+            long            amount;
+
+            amount = claim(gpp, grp->single_thread, j, &pp);
+            pp->used += amount;
+        }
+    }
+    if (gpp->memory)
+        gpp->memory_used += estimate(grp);
+}
+
+
+/*
+ * NAME
+ *      graph_pool_release
+ *
+ * SYNOPSIS
+ *      void graph_pool_release(graph_pool_ty *gpp, graph_recipe_ty *grp,
+ *              int failed);
+ *
+ * DESCRIPTION
+ *      The graph_pool_release function is used to return a recipe's
+ *      claims to the pools and the memory budget, as it finishes.
+ *
+ *      When there is a memory budget, the peak memory measured while
+ *      the recipe ran is recorded for each of its targets, for next
+ *      time.  If the recipe failed, the figure may be short (it may
+ *      have been killed for using too much) so it is only recorded if
+ *      it is larger than before.  Without a budget nothing is recorded,
+ *      so the fingerprint cache stays readable by older versions of
+ *      cook.
+ */
+
+void
+graph_pool_release(graph_pool_ty *gpp, graph_recipe_ty *grp, int failed)
+{
+    size_t          j;
+
+    if (grp->single_thread)
+    {
+        for (j = 0; j < grp->single_thread->nstrings; ++j)
+        {
+            pool_ty         *pp;
+            long            amount;
+
+            amount = claim(gpp, grp->single_thread, j, &pp);
+            pp->used -= amount;
+            assert(pp->used >= 0);
+        }
+    }
+    if (gpp->memory)
+    {
+        gpp->memory_used -= estimate(grp);
+        assert(gpp->memory_used >= 0);
+    }
+
+    if
+    (
+        gpp->memory
+    &&
+        grp->memory_peak > 0
+    &&
+        option_test(OPTION_FINGERPRINT)
+    )
+    {
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            string_ty       *path;
+
+            path = grp->output->item[j].file->filename;
+            if (!failed || fp_memory(path) < grp->memory_peak)
+                fp_memory_set(path, grp->memory_peak);
+        }
+    }
+}
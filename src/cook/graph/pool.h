@@ -0,0 +1,37 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_GRAPH_POOL_H
+#define COOK_GRAPH_POOL_H
+
+#include <common/main.h>
+
+typedef struct graph_pool_ty graph_pool_ty;
+
+struct graph_recipe_ty; /* existence */
+struct string_ty; /* existence */
+graph_pool_ty *graph_pool_new(void);
+void graph_pool_delete(graph_pool_ty *);
+int graph_pool_admit(graph_pool_ty *, struct graph_recipe_ty *);
+void graph_pool_claim(graph_pool_ty *, struct graph_recipe_ty *);
+void graph_pool_release(graph_pool_ty *, struct graph_recipe_ty *, int);
+struct string_ty *graph_pool_word(struct string_ty *, long *);
+long graph_pool_capacity(graph_pool_ty *, struct string_ty *);
+
+#endif /* COOK_GRAPH_POOL_H */
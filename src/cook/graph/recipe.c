@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2000, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 1999, 2000, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,16 +17,18 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <common/arena.h>
 #include <cook/cook.h>
 #include <cook/dir_part.h>
 #include <common/error_intl.h>
 #include <cook/graph/file.h>
 #include <cook/graph/file_list.h>
 #include <cook/graph/recipe.h>
+#include <cook/graph/stream.h>
 #include <cook/id.h>
 #include <cook/opcode/context.h>
 #include <cook/match.h>
-#include <common/mem.h>
+#include <cook/meter.h>
 #include <cook/option.h>
 #include <cook/os_interface.h>
 #include <cook/recipe.h>
@@ -40,39 +42,49 @@
  *      graph_recipe_new
  *
  * SYNOPSIS
- *      graph_recipe_ty *graph_recipe_new(recipe_ty *);
+ *      graph_recipe_ty *graph_recipe_new(arena_ty *, recipe_ty *);
  *
  * DESCRIPTION
  *      The graph_recipe_new function is used to allocate a new graph
- *      recipe instance in dynamic memory.
+ *      recipe instance from the graph's arena.  Its edge lists are
+ *      allocated from the same arena.
  *
  * RETURNS
  *      graph_recipe_ty *
  *
  * CAVEAT
- *      Use graph_recipe_delete when you are done with it.
+ *      Use graph_recipe_delete when you are done with it.  The memory
+ *      is not released until the arena is deleted.
  */
 
 graph_recipe_ty *
-graph_recipe_new(recipe_ty *rp)
+graph_recipe_new(arena_ty *ap, recipe_ty *rp)
 {
     graph_recipe_ty *grp;
     static int      id;
 
     trace(("graph_recipe_new()\n{\n"));
-    grp = mem_alloc(sizeof(graph_recipe_ty));
+    grp = arena_alloc(ap, sizeof(graph_recipe_ty));
     grp->reference_count = 1;
     grp->id = ++id;
     grp->rp = recipe_copy(rp);
     grp->mp = 0;
-    grp->input = graph_file_list_nrc_new();
-    grp->output = graph_file_list_nrc_new();
+    grp->input = graph_file_list_nrc_new(ap);
+    grp->output = graph_file_list_nrc_new(ap);
     grp->input_satisfied = 0;
     grp->input_uptodate = 0;
     grp->ocp = 0;
     grp->single_thread = 0;
     grp->host_binding = 0;
     grp->multi_forced = 0;
+    grp->verify_pid = 0;
+    grp->verify_fd = -1;
+    grp->host = 0;
+    grp->host_start = 0;
+    grp->stream_state = graph_stream_state_idle;
+    grp->stream_status = 0;
+    grp->memory = -1;
+    grp->memory_peak = 0;
     trace(("return %p;\n", grp));
     trace(("}\n"));
     return grp;
@@ -88,7 +100,8 @@ graph_recipe_new(recipe_ty *rp)
  *
  * DESCRIPTION
  *      The graph_recipe_delete function is used to release the
- *      resources held by a graph recipe instance in dynamic memory.
+ *      resources held by a graph recipe instance.  The node itself
+ *      belongs to the graph's arena.
  */
 
 void
@@ -116,7 +129,6 @@ graph_recipe_delete(graph_recipe_ty *grp)
         string_list_delete(grp->single_thread);
     if (grp->host_binding)
         string_list_delete(grp->host_binding);
-    mem_free(grp);
     trace(("}\n"));
 }
 
@@ -151,7 +163,8 @@ graph_recipe_copy(graph_recipe_ty *grp)
  *
  * DESCRIPTION
  *      The graph_recipe_getpid function is used to get the process-id
- *      of the process to wait for.
+ *      of the process to wait for.  This is either the recipe body's
+ *      command, or the process verifying its outputs.
  *
  * CAVEAT
  *      Must only be used when graph_recipe_run returns
@@ -163,6 +176,8 @@ graph_recipe_getpid(graph_recipe_ty *grp)
 {
     assert(grp);
     assert(grp->ocp);
+    if (grp->verify_pid > 0)
+        return grp->verify_pid;
     return opcode_context_getpid(grp->ocp);
 }
 
@@ -186,3 +201,33 @@ graph_recipe_waited(graph_recipe_ty *grp, int status)
     assert(grp->ocp);
     opcode_context_waited(grp->ocp, status);
 }
+
+
+#ifdef HAVE_WAIT3
+
+/*
+ * NAME
+ *      graph_recipe_rusage
+ *
+ * SYNOPSIS
+ *      void graph_recipe_rusage(graph_recipe_ty *, struct rusage *);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_rusage function is used to pass on the resource
+ *      usage of a child process, as it is reaped.  It is given to the
+ *      meter, if any, and the peak memory of the recipe's commands is
+ *      noted (the process verifying the outputs is not counted).
+ */
+
+void
+graph_recipe_rusage(graph_recipe_ty *grp, struct rusage *ru)
+{
+    assert(grp);
+    assert(grp->ocp);
+    if (grp->ocp->meter_p)
+        grp->ocp->meter_p->ru = *ru;
+    if (grp->verify_pid <= 0 && grp->memory_peak < ru->ru_maxrss)
+        grp->memory_peak = ru->ru_maxrss;
+}
+
+#endif /* HAVE_WAIT3 */
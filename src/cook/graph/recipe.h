@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 1999, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -38,13 +38,24 @@ struct graph_recipe_ty
         struct string_list_ty *single_thread;
         struct string_list_ty *host_binding;
         int             multi_forced; /* used by graph_walk */
+        int             verify_pid;     /* used by graph_run */
+        int             verify_fd;      /* used by graph_run */
+        struct graph_host_ty *host;     /* used by graph_run */
+        double          host_start;     /* used by graph_run */
+        int             stream_state;   /* used by graph_stream */
+        int             stream_status;  /* used by graph_stream */
+        long            memory;         /* used by graph_pool */
+        long            memory_peak;    /* used by graph_pool */
 };
 
-graph_recipe_ty *graph_recipe_new(struct recipe_ty *);
+struct arena_ty; /* existence */
+graph_recipe_ty *graph_recipe_new(struct arena_ty *, struct recipe_ty *);
 void graph_recipe_delete(graph_recipe_ty *);
 graph_recipe_ty *graph_recipe_copy(graph_recipe_ty *);
 
 int graph_recipe_getpid(graph_recipe_ty *);
 void graph_recipe_waited(graph_recipe_ty *, int);
+struct rusage; /* existence */
+void graph_recipe_rusage(graph_recipe_ty *, struct rusage *);
 
 #endif /* COOK_GRAPH_RECIPE_H */
@@ -19,6 +19,7 @@
 
 #include <cook/graph/recipe.h>
 #include <cook/graph/recipe_list.h>
+#include <common/arena.h>
 #include <common/mem.h>
 #include <common/trace.h>
 
@@ -218,6 +219,7 @@ graph_recipe_list_nrc_constructor(graph_recipe_list_nrc_ty *grlp)
     grlp->nrecipes = 0;
     grlp->nrecipes_max = 0;
     grlp->recipe = 0;
+    grlp->arena = 0;
     trace(("}\n"));
 }
 
@@ -239,7 +241,7 @@ void
 graph_recipe_list_nrc_destructor(graph_recipe_list_nrc_ty *grlp)
 {
     trace(("graph_recipe_list_nrc_destructor(grlp = %p)\n{\n", grlp));
-    if (grlp->recipe)
+    if (grlp->recipe && !grlp->arena)
         mem_free(grlp->recipe);
     grlp->nrecipes = 0;
     grlp->nrecipes_max = 0;
@@ -280,11 +282,25 @@ graph_recipe_list_nrc_append(graph_recipe_list_nrc_ty *grlp,
     }
     if (grlp->nrecipes >= grlp->nrecipes_max)
     {
+        size_t          old_nbytes;
         size_t          nbytes;
 
+        old_nbytes = grlp->nrecipes_max * sizeof(grlp->recipe[0]);
         grlp->nrecipes_max = grlp->nrecipes_max * 2 + 4;
         nbytes = grlp->nrecipes_max * sizeof(grlp->recipe[0]);
-        grlp->recipe = mem_change_size(grlp->recipe, nbytes);
+        if (grlp->arena)
+        {
+            grlp->recipe =
+                arena_change_size
+                (
+                    grlp->arena,
+                    grlp->recipe,
+                    old_nbytes,
+                    nbytes
+                );
+        }
+        else
+            grlp->recipe = mem_change_size(grlp->recipe, nbytes);
     }
     grlp->recipe[grlp->nrecipes++] = grp;
     trace(("}\n"));
@@ -325,11 +341,13 @@ graph_recipe_list_nrc_append_list(graph_recipe_list_nrc_ty *to,
  *      graph_recipe_list_nrc_new
  *
  * SYNOPSIS
- *      graph_recipe_list_nrc_ty *graph_recipe_list_nrc_new(void);
+ *      graph_recipe_list_nrc_ty *graph_recipe_list_nrc_new(arena_ty *);
  *
  * DESCRIPTION
  *      The graph_recipe_list_nrc_new function is used to allocate a nre
  *      graph recipe list is dynamic memory.  It is initially empty.
+ *      If an arena is given, the list and its items are allocated from
+ *      the arena.
  *
  * RETURNS
  *      graph_recipe_list_nrc_ty *; pointer to list is dynamic memory.
@@ -338,13 +356,17 @@ graph_recipe_list_nrc_append_list(graph_recipe_list_nrc_ty *to,
  */
 
 graph_recipe_list_nrc_ty *
-graph_recipe_list_nrc_new(void)
+graph_recipe_list_nrc_new(arena_ty *ap)
 {
     graph_recipe_list_nrc_ty *grlp;
 
     trace(("graph_recipe_list_nrc_new()\n{\n"));
-    grlp = mem_alloc(sizeof(graph_recipe_list_nrc_ty));
+    if (ap)
+        grlp = arena_alloc(ap, sizeof(graph_recipe_list_nrc_ty));
+    else
+        grlp = mem_alloc(sizeof(graph_recipe_list_nrc_ty));
     graph_recipe_list_nrc_constructor(grlp);
+    grlp->arena = ap;
     trace(("return %p;\n", grlp));
     trace(("}\n"));
     return grlp;
@@ -368,6 +390,7 @@ graph_recipe_list_nrc_delete(graph_recipe_list_nrc_ty *grlp)
 {
     trace(("graph_recipe_list_nrc_delete(grlp = %p)\n{\n", grlp));
     graph_recipe_list_nrc_destructor(grlp);
-    mem_free(grlp);
+    if (!grlp->arena)
+        mem_free(grlp);
     trace(("}\n"));
 }
@@ -44,6 +44,7 @@ void graph_recipe_list_delete(graph_recipe_list_ty *);
 
 /*
  * again, this time ignoring reference counts
+ * When the arena is set, the list lives in the graph's arena.
  */
 typedef struct graph_recipe_list_nrc_ty graph_recipe_list_nrc_ty;
 struct graph_recipe_list_nrc_ty
@@ -51,6 +52,7 @@ struct graph_recipe_list_nrc_ty
         size_t          nrecipes;
         size_t          nrecipes_max;
         struct graph_recipe_ty **recipe;
+        struct arena_ty *arena;
 };
 
 void graph_recipe_list_nrc_constructor(graph_recipe_list_nrc_ty *);
@@ -61,7 +63,8 @@ void graph_recipe_list_nrc_append(graph_recipe_list_nrc_ty *,
 void graph_recipe_list_nrc_append_list(graph_recipe_list_nrc_ty *,
         struct graph_recipe_list_nrc_ty *);
 
-graph_recipe_list_nrc_ty *graph_recipe_list_nrc_new(void);
+struct arena_ty; /* existence */
+graph_recipe_list_nrc_ty *graph_recipe_list_nrc_new(struct arena_ty *);
 void graph_recipe_list_nrc_delete(graph_recipe_list_nrc_ty *);
 
 #endif /* COOK_GRAPH_RECIPE_LIST_H */
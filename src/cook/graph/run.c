@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2001, 2003, 2004, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2001, 2003, 2004, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,13 +18,13 @@
  */
 
 #include <common/ac/string.h>
-#include <common/ac/unistd.h>   /* for getpid */
 
 #include <common/error_intl.h>
 #include <common/os_path_cat.h>
 #include <common/str_list.h>
 #include <common/trace.h>
 #include <cook/cook.h>
+#include <cook/deps/depfile.h>
 #include <cook/dir_part.h>
 #include <cook/fingerprint.h>
 #include <common/ts.h>
@@ -32,8 +32,10 @@
 #include <cook/graph/file.h>
 #include <cook/graph/file_list.h>
 #include <cook/graph/file_pair.h>
+#include <cook/graph/host.h>
 #include <cook/graph/recipe.h>
 #include <cook/graph/run.h>
+#include <cook/graph/verify.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
 #include <cook/match.h>
@@ -76,31 +78,6 @@ make_target_directories(graph_file_list_nrc_ty *gflp)
 }
 
 
-static string_ty *
-host_binding_round_robin(opcode_context_ty *ocp, string_list_ty *slp)
-{
-    static int      j;
-
-    if (!j)
-        j = getpid();
-    if (!slp || !slp->nstrings)
-    {
-        static string_ty *key;
-        id_ty           *idp;
-
-        if (!key)
-            key = str_from_c("parallel_hosts");
-        idp = opcode_context_id_search(ocp, key);
-        if (!idp)
-            return 0;
-        slp = id_variable_query2(idp);
-        if (!slp || !slp->nstrings)
-            return 0;
-    }
-    return slp->string[j++ % slp->nstrings];
-}
-
-
 /**
   * The relevate funtion is used to make a symbolic link relative to its
   * destintion, rather than relative to dot (the current directory).
@@ -188,6 +165,8 @@ graph_recipe_run(graph_recipe_ty *grp, graph_ty *gp)
         need_age = grp->ocp->need_age;
         opcode_context_resume(grp->ocp);
         status = graph_walk_status_done;
+        if (grp->verify_fd >= 0)
+            goto ret;
         goto resume;
     }
     need_age = 0;
@@ -825,29 +804,49 @@ graph_recipe_run(graph_recipe_ty *grp, graph_ty *gp)
             else
             {
                 opcode_status_ty result;
-                string_ty       *hostname;
 
                 /*
                  * run the recipe body
                  */
                 trace(("doing it now\n"));
                 opcode_context_call(grp->ocp, grp->rp->out_of_date);
-                hostname =
-                    host_binding_round_robin(grp->ocp, grp->host_binding);
-                if (hostname)
+                grp->host =
+                    graph_host_acquire(grp->ocp, grp->host_binding, grp->rp);
+                if (grp->host)
                 {
-                    opcode_context_host_binding_set(grp->ocp, hostname);
+                    opcode_context_host_binding_set
+                    (
+                        grp->ocp,
+                        graph_host_name(grp->host)
+                    );
+                    grp->host_start = graph_host_now();
                 }
               resume:
                 result = opcode_context_execute(grp->ocp);
-                switch (result)
+                if (result == opcode_status_wait)
                 {
-                case opcode_status_wait:
                     grp->ocp->need_age = need_age;
                     opcode_context_suspend(grp->ocp);
                     trace(("wait...\n"));
                     trace(("}\n"));
                     return graph_walk_status_wait;
+                }
+                if (grp->host)
+                {
+                    graph_host_release
+                    (
+                        grp->host,
+                        grp->rp,
+                        graph_host_now() - grp->host_start
+                    );
+                    grp->host = 0;
+                }
+                switch (result)
+                {
+                case opcode_status_wait:
+                    /* handled above */
+                    assert(0);
+                    break;
 
                 case opcode_status_success:
                     status = graph_walk_status_done;
@@ -1011,6 +1010,59 @@ graph_recipe_run(graph_recipe_ty *grp, graph_ty *gp)
          * stamp to be mtime-consistent with the inputs.
          */
         mtime = need_age + timestamp_granularity;
+
+        if (grp->verify_fd >= 0)
+        {
+            /*
+             * The outputs have been fingerprinted in the
+             * background, carry on from there.
+             */
+            graph_recipe_verify_finish(grp);
+        }
+        else
+        {
+            /*
+             * Pick up the ingredients the compiler discovered,
+             * for next time.
+             */
+            if
+            (
+                option_test(OPTION_DEPFILE)
+            &&
+                option_test(OPTION_ACTION)
+            &&
+                !option_test(OPTION_TOUCH)
+            )
+                depfile_ingest(grp->output->item[0].file->filename);
+
+            /*
+             * Reading large outputs to fingerprint them takes
+             * a while.  (Without the update option their times
+             * are not adjusted, and they are not read until the
+             * next run.)  Do it in the background, so that the
+             * walk can get on with other recipes.
+             */
+            if
+            (
+                option_test(OPTION_FINGERPRINT)
+            &&
+                option_test(OPTION_UPDATE)
+            &&
+                option_test(OPTION_ACTION)
+            &&
+                !option_test(OPTION_TOUCH)
+            &&
+                graph_recipe_verify_start(grp, gp) > 0
+            )
+            {
+                grp->ocp->need_age = need_age;
+                opcode_context_suspend(grp->ocp);
+                trace(("wait...\n"));
+                trace(("}\n"));
+                return graph_walk_status_wait;
+            }
+        }
+
         if (option_test(OPTION_FINGERPRINT))
         {
             /*
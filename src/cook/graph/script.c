@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2001, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 1999, 2001, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -40,33 +40,26 @@
 
 /*
  * NAME
- *      graph_recipe_script
+ *      graph_recipe_script_context
  *
  * SYNOPSIS
- *      graph_walk_status_ty graph_recipe_script(graph_recipe_ty *);
+ *      void graph_recipe_script_context(graph_recipe_ty *, graph_ty *);
  *
  * DESCRIPTION
- *      The graph_recipe_script function is used to print a shell script
- *      fragment on the standard output which approximates this recipe
- *      instance.
+ *      The graph_recipe_script_context function is used to create the
+ *      opcode context for scripting a recipe instance, and to set the
+ *      ``target'', ``targets'', ``need'' and ``younger'' variables.
+ *      Because nothing has been built, every ingredient is younger.
  *
- * RETURNS
- *      graph_walk_status_ty
- *              error           something went wrong
- *              uptodate        sucecss
+ * CAVEAT
+ *      The caller must delete grp->ocp when finished with it.
  */
 
-graph_walk_status_ty
-graph_recipe_script(graph_recipe_ty *grp, struct graph_ty *gp)
+void
+graph_recipe_script_context(graph_recipe_ty *grp, struct graph_ty *gp)
 {
-    graph_walk_status_ty status;
     size_t          j;
     string_list_ty  wl;
-    int             forced;
-    long            file_pos = 0;
-
-    trace(("graph_recipe_script(grp = %p)\n{\n", grp));
-    status = graph_walk_status_done;
 
     grp->ocp = opcode_context_new(0, grp->mp);
     grp->ocp->gp = gp;
@@ -103,6 +96,145 @@ graph_recipe_script(graph_recipe_ty *grp, struct graph_ty *gp)
     opcode_context_id_assign(grp->ocp, id_need, id_variable_new(&wl), -1);
     opcode_context_id_assign(grp->ocp, id_younger, id_variable_new(&wl), -1);
     string_list_destructor(&wl);
+}
+
+
+/*
+ * NAME
+ *      graph_recipe_script_body
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_recipe_script_body(graph_recipe_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_script_body function is used to print, on the
+ *      standard output, the shell commands which perform the out-of-date
+ *      actions of this recipe instance.  The recipe's opcode context
+ *      and flags must already be set up by the caller.
+ *
+ * RETURNS
+ *      graph_walk_status_ty
+ *              error           something went wrong
+ *              done            success
+ */
+
+graph_walk_status_ty
+graph_recipe_script_body(graph_recipe_ty *grp)
+{
+    graph_walk_status_ty status;
+    size_t          j;
+    int             echo;
+
+    status = graph_walk_status_done;
+    echo = !option_test(OPTION_SILENT);
+    if (option_test(OPTION_MKDIR))
+    {
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            graph_file_ty   *gfp;
+            string_ty       *s;
+            string_ty       *tmp;
+
+            gfp = grp->output->item[j].file;
+            s = dir_part(gfp->filename);
+            if (!s)
+                continue;
+            tmp = str_quote_shell(s);
+            str_free(s);
+            printf("if test ! -d %s; then\n", tmp->str_text);
+            if (echo)
+            {
+                printf("echo mkdir -p %s\n", tmp->str_text);
+            }
+            printf("mkdir -p %s", tmp->str_text);
+            if (!option_test(OPTION_ERROK))
+                printf(" || exit 1");
+            printf("\nfi\n");
+            str_free(tmp);
+        }
+    }
+    if (option_test(OPTION_UNLINK))
+    {
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            graph_file_ty   *gfp;
+            string_ty       *tmp;
+
+            gfp = grp->output->item[j].file;
+            tmp = str_quote_shell(gfp->filename);
+            if (echo)
+                printf("echo rm %s\n", tmp->str_text);
+            printf("rm %s", tmp->str_text);
+            if (!option_test(OPTION_ERROK))
+                printf(" || exit 1");
+            printf("\n");
+            str_free(tmp);
+        }
+    }
+    if (option_test(OPTION_TOUCH))
+    {
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            graph_file_ty   *gfp;
+            string_ty       *tmp;
+
+            gfp = grp->output->item[j].file;
+            tmp = str_quote_shell(gfp->filename);
+            if (echo)
+            {
+                printf("echo touch %s\n", tmp->str_text);
+            }
+            printf("touch %s", tmp->str_text);
+            if (!option_test(OPTION_ERROK))
+                printf(" || exit 1");
+            printf("\n");
+            str_free(tmp);
+        }
+    }
+    else
+    {
+        opcode_status_ty status2;
+
+        trace(("doing it now\n"));
+        opcode_context_call(grp->ocp, grp->rp->out_of_date);
+        status2 = opcode_context_script(grp->ocp);
+        if (status2 != opcode_status_success)
+            status = graph_walk_status_error;
+    }
+    return status;
+}
+
+
+/*
+ * NAME
+ *      graph_recipe_script
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_recipe_script(graph_recipe_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_script function is used to print a shell script
+ *      fragment on the standard output which approximates this recipe
+ *      instance.
+ *
+ * RETURNS
+ *      graph_walk_status_ty
+ *              error           something went wrong
+ *              uptodate        sucecss
+ */
+
+graph_walk_status_ty
+graph_recipe_script(graph_recipe_ty *grp, struct graph_ty *gp)
+{
+    graph_walk_status_ty status;
+    size_t          j;
+    int             forced;
+    long            file_pos = 0;
+
+    trace(("graph_recipe_script(grp = %p)\n{\n", grp));
+    status = graph_walk_status_done;
+
+    graph_recipe_script_context(grp, gp);
 
     /*
      * Flags apply to the precondition and to the ingredients
@@ -203,84 +335,9 @@ graph_recipe_script(graph_recipe_ty *grp, struct graph_ty *gp)
      */
     if (grp->rp->out_of_date)
     {
-        int             echo;
-
         trace(("do recipe body\n"));
-        echo = !option_test(OPTION_SILENT);
-        if (option_test(OPTION_MKDIR))
-        {
-            for (j = 0; j < grp->output->nfiles; ++j)
-            {
-                graph_file_ty   *gfp;
-                string_ty       *s;
-                string_ty       *tmp;
-
-                gfp = grp->output->item[j].file;
-                s = dir_part(gfp->filename);
-                if (!s)
-                    continue;
-                tmp = str_quote_shell(s);
-                str_free(s);
-                printf("if test ! -d %s; then\n", tmp->str_text);
-                if (echo)
-                {
-                    printf("echo mkdir -p %s\n", tmp->str_text);
-                }
-                printf("mkdir -p %s", tmp->str_text);
-                if (!option_test(OPTION_ERROK))
-                    printf(" || exit 1");
-                printf("\nfi\n");
-                str_free(tmp);
-            }
-        }
-        if (option_test(OPTION_UNLINK))
-        {
-            for (j = 0; j < grp->output->nfiles; ++j)
-            {
-                graph_file_ty   *gfp;
-                string_ty       *tmp;
-
-                gfp = grp->output->item[j].file;
-                tmp = str_quote_shell(gfp->filename);
-                if (echo)
-                    printf("echo rm %s\n", tmp->str_text);
-                printf("rm %s", tmp->str_text);
-                if (!option_test(OPTION_ERROK))
-                    printf(" || exit 1");
-                printf("\n");
-                str_free(tmp);
-            }
-        }
-        if (option_test(OPTION_TOUCH))
-        {
-            for (j = 0; j < grp->output->nfiles; ++j)
-            {
-                graph_file_ty   *gfp;
-                string_ty       *tmp;
-
-                gfp = grp->output->item[j].file;
-                tmp = str_quote_shell(gfp->filename);
-                if (echo)
-                {
-                    printf("echo touch %s\n", tmp->str_text);
-                }
-                printf("touch %s", tmp->str_text);
-                if (!option_test(OPTION_ERROK))
-                    printf(" || exit 1");
-                printf("\n");
-                str_free(tmp);
-            }
-        }
-        else
-        {
-            opcode_status_ty status2;
-
-            trace(("doing it now\n"));
-            opcode_context_call(grp->ocp, grp->rp->out_of_date);
-            status2 = opcode_context_script(grp->ocp);
-            if (status2 != opcode_status_success)
-                status = graph_walk_status_error;
-        }
+        if (graph_recipe_script_body(grp) != graph_walk_status_done)
+            status = graph_walk_status_error;
     }
 
     /*
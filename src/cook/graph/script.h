@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -27,5 +27,7 @@ struct graph_recipe_ty; /* existence */
 
 graph_walk_status_ty graph_recipe_script(struct graph_recipe_ty *,
         struct graph_ty *);
+void graph_recipe_script_context(struct graph_recipe_ty *, struct graph_ty *);
+graph_walk_status_ty graph_recipe_script_body(struct graph_recipe_ty *);
 
 #endif /* COOK_GRAPH_SCRIPT_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,10 +18,27 @@
  */
 
 #include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
 
+#include <common/error_intl.h>
 #include <cook/graph.h>
+#include <cook/graph/host.h>
 #include <cook/graph/stats.h>
+#include <common/mem.h>
+#include <cook/option.h>
+#include <cook/recipe.h>
+#include <cook/recipe/list.h>
 #include <common/star.h>
+#include <common/str.h>
+#include <common/trace.h>
+
+/*
+ * The recipes which have been profiled, in the order they were first
+ * considered, and the innermost recipe application being profiled.
+ */
+static recipe_list_ty profile_list;
+static graph_profile_ty *profile_current;
 
 
 static void
@@ -64,3 +81,302 @@ graph_print_statistics(graph_ty *gp)
     statistic("success", gp->statistic.success);
     statistic("success_reuse", gp->statistic.success_reuse);
 }
+
+
+static void
+profile_list_append(recipe_ty *rp)
+{
+    if (rp->profile.listed)
+        return;
+    rp->profile.listed = 1;
+    recipe_list_append(&profile_list, rp);
+}
+
+
+/*
+ * NAME
+ *      graph_profile_match_attempt
+ *
+ * SYNOPSIS
+ *      void graph_profile_match_attempt(recipe_ty *rp);
+ *
+ * DESCRIPTION
+ *      The graph_profile_match_attempt function is used to count an
+ *      attempt to match a file name against the targets of an implicit
+ *      recipe, whether or not it matched.
+ */
+
+void
+graph_profile_match_attempt(recipe_ty *rp)
+{
+    profile_list_append(rp);
+    rp->profile.match_attempt++;
+}
+
+
+/*
+ * NAME
+ *      graph_profile_begin
+ *
+ * SYNOPSIS
+ *      void graph_profile_begin(graph_profile_ty *pp, recipe_ty *rp);
+ *
+ * DESCRIPTION
+ *      The graph_profile_begin function is used to note the start of an
+ *      attempt to apply a recipe while deriving the graph.  The clock
+ *      is only read when the profile option is set.
+ *
+ * CAVEAT
+ *      Each call must be matched by a call to graph_profile_end, in
+ *      reverse order.
+ */
+
+void
+graph_profile_begin(graph_profile_ty *pp, recipe_ty *rp)
+{
+    profile_list_append(rp);
+    pp->recipe = rp;
+    pp->start = 0;
+    pp->child = 0;
+    pp->prev = profile_current;
+    profile_current = pp;
+    if (option_test(OPTION_PROFILE))
+        pp->start = graph_host_now();
+}
+
+
+/*
+ * NAME
+ *      graph_profile_end
+ *
+ * SYNOPSIS
+ *      void graph_profile_end(graph_profile_ty *pp,
+ *              graph_build_status_ty status);
+ *
+ * DESCRIPTION
+ *      The graph_profile_end function is used to note the end of an
+ *      attempt to apply a recipe, and its outcome.
+ *
+ *      The elapsed time is charged to the recipe's total, and less the
+ *      time of the applications nested within it, to its self time.
+ *      When a recipe is nested within itself only the outermost
+ *      application counts towards its total.
+ */
+
+void
+graph_profile_end(graph_profile_ty *pp, graph_build_status_ty status)
+{
+    recipe_ty       *rp;
+    graph_profile_ty *up;
+    double          elapsed;
+
+    rp = pp->recipe;
+    switch (status)
+    {
+    case graph_build_status_success:
+        rp->profile.applicable++;
+        break;
+
+    case graph_build_status_backtrack:
+        rp->profile.backtrack++;
+        break;
+
+    case graph_build_status_error:
+        rp->profile.failed++;
+        break;
+    }
+    profile_current = pp->prev;
+    if (!pp->start)
+        return;
+
+    elapsed = graph_host_now() - pp->start;
+    rp->profile.self += elapsed - pp->child;
+    if (pp->prev)
+        pp->prev->child += elapsed;
+    for (up = pp->prev; up; up = up->prev)
+    {
+        if (up->recipe == rp)
+            return;
+    }
+    rp->profile.time += elapsed;
+}
+
+
+static int
+position_cmp(const void *va, const void *vb)
+{
+    const recipe_ty *a;
+    const recipe_ty *b;
+    int             n;
+
+    a = *(const recipe_ty **)va;
+    b = *(const recipe_ty **)vb;
+    n = strcmp(a->pos.pos_name->str_text, b->pos.pos_name->str_text);
+    if (n)
+        return n;
+    return (a->pos.pos_line - b->pos.pos_line);
+}
+
+
+static int
+cost_cmp(const void *va, const void *vb)
+{
+    const recipe_ty *a;
+    const recipe_ty *b;
+
+    a = *(const recipe_ty **)va;
+    b = *(const recipe_ty **)vb;
+    if (a->profile.self != b->profile.self)
+        return (a->profile.self < b->profile.self ? 1 : -1);
+    if (a->profile.time != b->profile.time)
+        return (a->profile.time < b->profile.time ? 1 : -1);
+    if (a->profile.match_attempt != b->profile.match_attempt)
+        return (a->profile.match_attempt < b->profile.match_attempt ? 1 : -1);
+    return position_cmp(va, vb);
+}
+
+
+static void
+profile_write(FILE *fp, const recipe_ty *rp)
+{
+    const char      *cp;
+
+    fprintf
+    (
+        fp,
+        "%.6f %.6f %ld %ld %ld %ld %ld %ld \"",
+        rp->profile.self,
+        rp->profile.time,
+        rp->profile.match_attempt,
+        rp->profile.applicable,
+        rp->profile.backtrack,
+        rp->profile.failed,
+        rp->profile.precondition,
+        rp->profile.precondition_rejection
+    );
+    for (cp = rp->pos.pos_name->str_text; *cp; ++cp)
+    {
+        if (*cp == '"' || *cp == '\\')
+            putc('\\', fp);
+        putc(*cp, fp);
+    }
+    fprintf(fp, "\" %d\n", rp->pos.pos_line);
+}
+
+
+/*
+ * NAME
+ *      graph_profile_print
+ *
+ * SYNOPSIS
+ *      void graph_profile_print(void);
+ *
+ * DESCRIPTION
+ *      The graph_profile_print function is used to print the cost of
+ *      each recipe considered while deriving the graph, most expensive
+ *      first, on the standard error.  If a profile file was named on
+ *      the command line, the same figures are also written there, one
+ *      recipe per line, for other programs to read.
+ *
+ *      Recipes are identified by their position in the cookbook.  The
+ *      cookbook may be read more than once (for include-cooked files),
+ *      so recipes at the same position are added together.
+ */
+
+void
+graph_profile_print(void)
+{
+    recipe_ty       **list;
+    size_t          n;
+    size_t          j;
+    size_t          k;
+
+    trace(("graph_profile_print()\n{\n"));
+    n = profile_list.nrecipes;
+    list = mem_alloc((n + 1) * sizeof(list[0]));
+    memcpy(list, profile_list.recipe, n * sizeof(list[0]));
+    qsort(list, n, sizeof(list[0]), position_cmp);
+    for (j = 0, k = 0; j < n; ++j)
+    {
+        recipe_ty       *rp;
+        recipe_ty       *kp;
+
+        rp = list[j];
+        if (k && !position_cmp(&list[k - 1], &rp))
+        {
+            kp = list[k - 1];
+            kp->profile.match_attempt += rp->profile.match_attempt;
+            kp->profile.applicable += rp->profile.applicable;
+            kp->profile.backtrack += rp->profile.backtrack;
+            kp->profile.failed += rp->profile.failed;
+            kp->profile.precondition += rp->profile.precondition;
+            kp->profile.precondition_rejection +=
+                rp->profile.precondition_rejection;
+            kp->profile.time += rp->profile.time;
+            kp->profile.self += rp->profile.self;
+            continue;
+        }
+        list[k++] = rp;
+    }
+    n = k;
+    qsort(list, n, sizeof(list[0]), cost_cmp);
+
+    star_eoln();
+    fprintf
+    (
+        stderr,
+        "%10s %10s %7s %7s %7s %7s %7s %7s %s\n",
+        "self",
+        "total",
+        "match",
+        "apply",
+        "back",
+        "failed",
+        "precond",
+        "reject",
+        "recipe"
+    );
+    for (j = 0; j < n; ++j)
+    {
+        recipe_ty       *rp;
+
+        rp = list[j];
+        fprintf
+        (
+            stderr,
+            "%10.6f %10.6f %7ld %7ld %7ld %7ld %7ld %7ld %s: %d\n",
+            rp->profile.self,
+            rp->profile.time,
+            rp->profile.match_attempt,
+            rp->profile.applicable,
+            rp->profile.backtrack,
+            rp->profile.failed,
+            rp->profile.precondition,
+            rp->profile.precondition_rejection,
+            rp->pos.pos_name->str_text,
+            rp->pos.pos_line
+        );
+    }
+
+    if (option.o_profile)
+    {
+        FILE            *fp;
+        const char      *fn;
+
+        fn = option.o_profile->str_text;
+        fp = fopen(fn, "w");
+        if (!fp)
+            fatal_intl_open(fn);
+        fprintf
+        (
+            fp,
+            "# self total match_attempt applicable backtrack failed "
+            "precondition precondition_rejection file line\n"
+        );
+        for (j = 0; j < n; ++j)
+            profile_write(fp, list[j]);
+        fclose_and_check(fp, fn);
+    }
+    mem_free(list);
+    trace(("}\n"));
+}
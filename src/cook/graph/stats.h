@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -21,9 +21,31 @@
 #define COOK_GRAPH_STATS_H
 
 #include <common/main.h>
+#include <cook/graph/build.h>
 
 struct graph_ty; /* existence */
 
 void graph_print_statistics(struct graph_ty *);
 
+struct recipe_ty; /* existence */
+
+/*
+ * One of these lives on the stack for each recipe application being
+ * profiled, so that time spent deriving ingredients can be charged to
+ * the recipes which derived them.
+ */
+typedef struct graph_profile_ty graph_profile_ty;
+struct graph_profile_ty
+{
+        struct recipe_ty *recipe;
+        double          start;
+        double          child;
+        graph_profile_ty *prev;
+};
+
+void graph_profile_match_attempt(struct recipe_ty *);
+void graph_profile_begin(graph_profile_ty *, struct recipe_ty *);
+void graph_profile_end(graph_profile_ty *, graph_build_status_ty);
+void graph_profile_print(void);
+
 #endif /* COOK_GRAPH_STATS_H */
@@ -0,0 +1,621 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * When the pipeline option is set, recipes are queued while the graph
+ * is still being built, as soon as their targets and all of the
+ * ingredients below them are fully derived, and can no longer change.
+ * Nothing is started until graph_build_list has succeeded, so that a
+ * graph which cannot be derived runs nothing, exactly as without the
+ * pipeline.  The queue is then run, in the order the recipes became
+ * ready, each recipe once the recipes which make its ingredients have
+ * finished.  The walk which follows replays the results of these
+ * recipes, in its usual order, rather than running them again, so
+ * that it makes exactly the same decisions as it would have made
+ * without the pipeline.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/time.h>
+#include <sys/wait.h>
+
+#include <common/error_intl.h>
+#include <common/itab.h>
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/trace.h>
+#include <cook/cook.h>
+#include <cook/desist.h>
+#include <cook/graph.h>
+#include <cook/graph/file.h>
+#include <cook/graph/file_list.h>
+#include <cook/graph/pool.h>
+#include <cook/graph/recipe.h>
+#include <cook/graph/recipe_list.h>
+#include <cook/graph/run.h>
+#include <cook/graph/stream.h>
+#include <cook/match.h>
+#include <cook/match/new_by_recip.h>
+#include <cook/meter.h>
+#include <cook/opcode/context.h>
+#include <cook/opcode/list.h>
+#include <cook/option.h>
+#include <cook/os/wait.h>
+#include <cook/recipe.h>
+#include <cook/recipe/list.h>
+#include <cook/stat.cache.h>
+
+typedef struct graph_stream_ty graph_stream_ty;
+struct graph_stream_ty
+{
+    /*
+     * The recipes whose ingredients are ready, in the order they
+     * became ready.  Those before ready_pos have been started.
+     */
+    graph_recipe_list_nrc_ty ready;
+    size_t          ready_pos;
+
+    /*
+     * The recipes waiting for a child process, by process id.
+     */
+    itab_ty         *itp;
+    graph_pool_ty   *pool;
+    int             nproc;
+
+    /*
+     * Set when no more recipes are to be started: after an error
+     * (unless the persevere option is set) or an interrupt.
+     */
+    int             stopped;
+
+    /*
+     * The implicit recipes with more than one target, and a matcher
+     * for each.  A file which one of these could make might still
+     * gain another recipe after it has been derived.
+     */
+    recipe_ty       **multi;
+    match_ty        **multi_mp;
+    size_t          nmulti;
+};
+
+
+/*
+ * NAME
+ *      graph_stream_begin
+ *
+ * SYNOPSIS
+ *      void graph_stream_begin(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_stream_begin function is used to arrange for recipes
+ *      to be run while the graph is being built.  It must be called
+ *      before graph_build_list.
+ */
+
+void
+graph_stream_begin(graph_ty *gp)
+{
+    graph_stream_ty *sp;
+    recipe_ty       *rp;
+    long            j;
+
+    trace(("graph_stream_begin(gp = %p)\n{\n", gp));
+    assert(!gp->stream);
+    sp = mem_alloc(sizeof(graph_stream_ty));
+    graph_recipe_list_nrc_constructor(&sp->ready);
+    sp->ready_pos = 0;
+    sp->nproc = graph_walk_jobs();
+    sp->itp = itab_alloc(sp->nproc);
+    sp->pool = graph_pool_new();
+    sp->stopped = 0;
+    sp->nmulti = 0;
+    for (j = 0; cook_implicit_nth(j); ++j)
+    {
+        if (cook_implicit_nth(j)->target->nstrings > 1)
+            ++sp->nmulti;
+    }
+    sp->multi = mem_alloc((sp->nmulti + 1) * sizeof(recipe_ty *));
+    sp->multi_mp = mem_alloc((sp->nmulti + 1) * sizeof(match_ty *));
+    sp->nmulti = 0;
+    for (j = 0; ; ++j)
+    {
+        rp = cook_implicit_nth(j);
+        if (!rp)
+            break;
+        if (rp->target->nstrings > 1)
+        {
+            sp->multi[sp->nmulti] = rp;
+            sp->multi_mp[sp->nmulti] = match_new_by_recipe(rp);
+            ++sp->nmulti;
+        }
+    }
+    gp->parallel_jobs = sp->nproc;
+    gp->stream = sp;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      settled
+ *
+ * SYNOPSIS
+ *      int settled(graph_stream_ty *sp, graph_file_ty *gfp);
+ *
+ * DESCRIPTION
+ *      The settled function is used to decide whether a file, which
+ *      has just been derived, can be relied upon not to change for the
+ *      rest of the build.
+ *
+ *      A file is only derived once, but a recipe with several targets,
+ *      derived for one of its other targets, may add itself to the
+ *      file later.  Such files, and files made by more than one recipe
+ *      (which the walk forces to run together), are left to the walk.
+ *
+ * RETURNS
+ *      int; non-zero if settled, zero if not.
+ */
+
+static int
+settled(graph_stream_ty *sp, graph_file_ty *gfp)
+{
+    const recipe_list_ty *rlp;
+    size_t          j;
+    size_t          k;
+
+    if (gfp->input->nrecipes > 1)
+        return 0;
+    if
+    (
+        gfp->input->nrecipes == 1
+    &&
+        gfp->input->recipe[0]->output->nfiles != 1
+    )
+        return 0;
+    rlp = cook_explicit_by_name(gfp->filename);
+    for (j = 0; j < rlp->nrecipes; ++j)
+    {
+        if (rlp->recipe[j]->target->nstrings > 1)
+            return 0;
+    }
+    for (j = 0; j < sp->nmulti; ++j)
+    {
+        recipe_ty       *rp;
+
+        rp = sp->multi[j];
+        for (k = 0; k < rp->target->nstrings; ++k)
+        {
+            if
+            (
+                match_attempt
+                (
+                    sp->multi_mp[j],
+                    rp->target->string[k],
+                    gfp->filename,
+                    &rp->pos
+                )
+            !=
+                0
+            )
+                return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * NAME
+ *      consider
+ *
+ * SYNOPSIS
+ *      void consider(graph_stream_ty *sp, graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The consider function is used to queue a recipe to be run, if
+ *      its targets are settled and its ingredients are ready.
+ *
+ *      Recipes whose bodies assign variables, or set options or the
+ *      environment, are left to the walk, because the rest of the
+ *      graph must be built without seeing their effects.
+ */
+
+static void
+consider(graph_stream_ty *sp, graph_recipe_ty *grp)
+{
+    size_t          j;
+
+    if (grp->stream_state != graph_stream_state_idle)
+        return;
+    for (j = 0; j < grp->output->nfiles; ++j)
+    {
+        if (!grp->output->item[j].file->stream_released)
+            return;
+    }
+    for (j = 0; j < grp->input->nfiles; ++j)
+    {
+        if (!grp->input->item[j].file->stream_ready)
+            return;
+    }
+    if
+    (
+        opcode_list_global(grp->rp->out_of_date)
+    ||
+        opcode_list_global(grp->rp->up_to_date)
+    )
+        return;
+    trace(("queue %p\n", grp));
+    grp->stream_state = graph_stream_state_queued;
+    graph_recipe_list_nrc_append(&sp->ready, grp);
+}
+
+
+/*
+ * NAME
+ *      finished
+ *
+ * SYNOPSIS
+ *      void finished(graph_stream_ty *sp, graph_recipe_ty *grp,
+ *              graph_walk_status_ty status);
+ *
+ * DESCRIPTION
+ *      The finished function is used to remember the result of a
+ *      recipe, for the walk to replay, and to queue the recipes which
+ *      use its targets.
+ */
+
+static void
+finished(graph_stream_ty *sp, graph_recipe_ty *grp,
+    graph_walk_status_ty status)
+{
+    size_t          j;
+    size_t          k;
+
+    trace(("finished(grp = %p, status = %s)\n{\n", grp,
+        graph_walk_status_name(status)));
+    grp->stream_state = graph_stream_state_finished;
+    grp->stream_status = status;
+    graph_pool_release(sp->pool, grp, status == graph_walk_status_error);
+    switch (status)
+    {
+    case graph_walk_status_wait:
+    case graph_walk_status_done_stop:
+        assert(0);
+        /* fall through... */
+
+    case graph_walk_status_error:
+        if (!option_test(OPTION_PERSEVERE))
+            sp->stopped = 1;
+        break;
+
+    case graph_walk_status_done:
+        /*
+         * The commands may have made files which the rest of the
+         * graph will be asked about.
+         */
+        stat_cache_prefetch_discard();
+        /* fall through... */
+
+    case graph_walk_status_uptodate:
+    case graph_walk_status_uptodate_done:
+        for (j = 0; j < grp->output->nfiles; ++j)
+        {
+            graph_file_ty   *gfp;
+
+            gfp = grp->output->item[j].file;
+            gfp->stream_ready = 1;
+            for (k = 0; k < gfp->output->nrecipes; ++k)
+                consider(sp, gfp->output->recipe[k]);
+        }
+        break;
+    }
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      run
+ *
+ * SYNOPSIS
+ *      void run(graph_ty *gp, graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The run function is used to start (or resume) a recipe, and
+ *      look at what happened.
+ */
+
+static void
+run(graph_ty *gp, graph_recipe_ty *grp)
+{
+    graph_stream_ty *sp;
+    graph_walk_status_ty status;
+
+    sp = gp->stream;
+    status = graph_recipe_run(grp, gp);
+    if (status == graph_walk_status_wait)
+    {
+        itab_assign(sp->itp, graph_recipe_getpid(grp), grp);
+        return;
+    }
+    finished(sp, grp, status);
+}
+
+
+/*
+ * NAME
+ *      reap
+ *
+ * SYNOPSIS
+ *      int reap(graph_ty *gp, int options);
+ *
+ * DESCRIPTION
+ *      The reap function is used to collect one finished child
+ *      process, and resume the recipe which was waiting for it.
+ *
+ * RETURNS
+ *      int; zero if there was nothing to collect, non-zero otherwise.
+ */
+
+static int
+reap(graph_ty *gp, int options)
+{
+    graph_stream_ty *sp;
+    graph_recipe_ty *grp;
+    int             pid;
+    int             exit_status;
+#ifdef HAVE_WAIT3
+    struct rusage   ru;
+#endif
+
+    sp = gp->stream;
+    if (sp->itp->load <= 0)
+        return 0;
+#ifdef HAVE_WAIT3
+    pid = os_wait3(&exit_status, options, &ru);
+#else
+    if (options & WNOHANG)
+        return 0;
+    pid = os_wait(&exit_status);
+#endif
+    trace(("pid = %d\n", pid));
+    if (pid == 0)
+        return 0;
+    if (pid < 0)
+    {
+        sub_context_ty  *scp;
+
+        if (errno == EINTR)
+            return 1;
+        scp = sub_context_new();
+        sub_errno_set(scp);
+        fatal_intl(scp, i18n("wait(): $errno"));
+        /* NOTREACHED */
+    }
+    grp = itab_query(sp->itp, pid);
+    if (grp)
+    {
+        assert(pid == graph_recipe_getpid(grp));
+#ifdef HAVE_WAIT3
+        graph_recipe_rusage(grp, &ru);
+#endif
+        graph_recipe_waited(grp, exit_status);
+        itab_delete(sp->itp, pid);
+        run(gp, grp);
+    }
+    return 1;
+}
+
+
+/*
+ * NAME
+ *      pump
+ *
+ * SYNOPSIS
+ *      void pump(graph_ty *gp);
+ *
+ * DESCRIPTION
+ *      The pump function is used to start as many of the ready recipes
+ *      as there are free jobs for, and to collect any which have
+ *      finished, without blocking.  Single thread restrictions are
+ *      honoured as they are by the walk.
+ */
+
+static void
+pump(graph_ty *gp)
+{
+    graph_stream_ty *sp;
+
+    sp = gp->stream;
+    for (;;)
+    {
+        if (desist_requested())
+            sp->stopped = 1;
+        while
+        (
+            !sp->stopped
+        &&
+            sp->itp->load < sp->nproc
+        &&
+            sp->ready_pos < sp->ready.nrecipes
+        )
+        {
+            graph_recipe_ty *grp;
+            size_t          k;
+
+            /*
+             * Take the first recipe which fits in the pools (single
+             * thread flags) and the memory budget.
+             */
+            for (k = sp->ready_pos; k < sp->ready.nrecipes; ++k)
+            {
+                grp = sp->ready.recipe[k];
+                if (graph_pool_admit(sp->pool, grp))
+                    break;
+            }
+            if (k >= sp->ready.nrecipes)
+                break;
+            grp = sp->ready.recipe[k];
+            sp->ready.recipe[k] = sp->ready.recipe[sp->ready_pos];
+            sp->ready.recipe[sp->ready_pos++] = grp;
+
+            graph_pool_claim(sp->pool, grp);
+            run(gp, grp);
+        }
+        if (!reap(gp, WNOHANG))
+            break;
+    }
+}
+
+
+/*
+ * NAME
+ *      graph_stream_release
+ *
+ * SYNOPSIS
+ *      void graph_stream_release(graph_ty *gp, graph_file_ty *gfp);
+ *
+ * DESCRIPTION
+ *      The graph_stream_release function is called by the graph
+ *      builder each time a file has been successfully derived, to
+ *      queue any recipes which it has made ready.  They are not
+ *      started until the whole graph has been built; see
+ *      graph_stream_flush.
+ */
+
+void
+graph_stream_release(graph_ty *gp, graph_file_ty *gfp)
+{
+    graph_stream_ty *sp;
+    size_t          j;
+
+    sp = gp->stream;
+    assert(sp);
+    trace(("graph_stream_release(\"%s\")\n{\n", gfp->filename->str_text));
+    if (settled(sp, gfp))
+    {
+        gfp->stream_released = 1;
+        if (gfp->input->nrecipes == 0)
+        {
+            gfp->stream_ready = 1;
+            for (j = 0; j < gfp->output->nrecipes; ++j)
+                consider(sp, gfp->output->recipe[j]);
+        }
+        else
+            consider(sp, gfp->input->recipe[0]);
+    }
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      graph_stream_flush
+ *
+ * SYNOPSIS
+ *      void graph_stream_flush(graph_ty *gp);
+ *
+ * DESCRIPTION
+ *      The graph_stream_flush function is used, once the graph has
+ *      been built successfully, to run the recipes queued while it was
+ *      being built, and the recipes they make ready in turn.  It
+ *      returns when they have all finished, or when no more are to be
+ *      started and the running ones have finished.
+ */
+
+void
+graph_stream_flush(graph_ty *gp)
+{
+    graph_stream_ty *sp;
+
+    sp = gp->stream;
+    assert(sp);
+    trace(("graph_stream_flush(gp = %p)\n{\n", gp));
+    for (;;)
+    {
+        pump(gp);
+        if (sp->itp->load <= 0)
+            break;
+        reap(gp, 0);
+    }
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      graph_stream_end
+ *
+ * SYNOPSIS
+ *      void graph_stream_end(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_stream_end function is used to wait for any recipes
+ *      still running, and to release the resources used to run them.
+ *      No more recipes are started; whatever is left is up to the walk.
+ */
+
+void
+graph_stream_end(graph_ty *gp)
+{
+    graph_stream_ty *sp;
+    size_t          j;
+
+    sp = gp->stream;
+    if (!sp)
+        return;
+    trace(("graph_stream_end(gp = %p)\n{\n", gp));
+    while (sp->itp->load > 0)
+        reap(gp, 0);
+    for (j = 0; j < sp->nmulti; ++j)
+        match_delete(sp->multi_mp[j]);
+    mem_free(sp->multi);
+    mem_free(sp->multi_mp);
+    itab_free(sp->itp);
+    graph_pool_delete(sp->pool);
+    graph_recipe_list_nrc_destructor(&sp->ready);
+    mem_free(sp);
+    gp->stream = 0;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      graph_stream_run
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_stream_run(graph_recipe_ty *,
+ *              graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_stream_run function is used by the walk, in place of
+ *      graph_recipe_run, after a pipelined build.  Recipes which have
+ *      already been run return the same result again; the rest are run
+ *      as usual.
+ */
+
+graph_walk_status_ty
+graph_stream_run(graph_recipe_ty *grp, graph_ty *gp)
+{
+    if (grp->stream_state == graph_stream_state_finished)
+    {
+        grp->stream_state = graph_stream_state_replayed;
+        return (graph_walk_status_ty)grp->stream_status;
+    }
+    return graph_recipe_run(grp, gp);
+}
@@ -0,0 +1,46 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_GRAPH_STREAM_H
+#define COOK_GRAPH_STREAM_H
+
+#include <cook/graph/walk.h>
+
+/*
+ * The stream_state of a graph recipe.
+ */
+enum graph_stream_state_ty
+{
+        graph_stream_state_idle,
+        graph_stream_state_queued,
+        graph_stream_state_finished,
+        graph_stream_state_replayed
+};
+typedef enum graph_stream_state_ty graph_stream_state_ty;
+
+struct graph_file_ty; /* existence */
+struct graph_recipe_ty; /* existence */
+void graph_stream_begin(struct graph_ty *);
+void graph_stream_release(struct graph_ty *, struct graph_file_ty *);
+void graph_stream_flush(struct graph_ty *);
+void graph_stream_end(struct graph_ty *);
+graph_walk_status_ty graph_stream_run(struct graph_recipe_ty *,
+        struct graph_ty *);
+
+#endif /* COOK_GRAPH_STREAM_H */
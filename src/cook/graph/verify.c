@@ -0,0 +1,304 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * When fingerprints are in use, every output of a recipe is read in
+ * full to fingerprint it once the recipe body finishes.  For a large
+ * output this takes long enough that the rest of a parallel build
+ * stalls behind it, because the walk cannot reap or start other jobs
+ * meanwhile.  Cook is not threaded, so the reading is given to a child
+ * process, which the walk waits for like any other; the recipe is
+ * finished (and its implications published) once it exits.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <common/error.h> /* for assert */
+#include <common/fp.h>
+#include <common/fp/combined.h>
+#include <common/mem.h>
+#include <common/str.h>
+#include <common/trace.h>
+#include <cook/fingerprint.h>
+#include <cook/graph/file.h>
+#include <cook/graph/file_list.h>
+#include <cook/graph/verify.h>
+#include <cook/opcode/context.h>
+#include <cook/tempfilename.h>
+
+/*
+ * Outputs smaller than this (in total) are cheaper to fingerprint
+ * directly than to fork for.
+ */
+#define VERIFY_ASYNC_MIN (1L << 20)
+
+typedef struct verify_record_ty verify_record_ty;
+struct verify_record_ty
+{
+    int             ok;
+    struct stat     st;
+    char            fingerprint[1000];
+};
+
+
+/*
+ * NAME
+ *      verify_worker
+ *
+ * SYNOPSIS
+ *      void verify_worker(graph_recipe_ty *grp, int fd);
+ *
+ * DESCRIPTION
+ *      The verify_worker function is run in a child process.  It
+ *      fingerprints each output of the recipe, and writes one record
+ *      per output to the file.  A file which changes while it is being
+ *      read is not recorded, and is left for the parent.
+ *
+ *      Nothing here may report errors or exit normally, because the
+ *      parent's exit handlers must not run in the child.
+ */
+
+static void
+verify_worker(graph_recipe_ty *grp, int fd)
+{
+    verify_record_ty *buf;
+    size_t          nfiles;
+    size_t          j;
+    char            *cp;
+    size_t          nbytes;
+
+    nfiles = grp->output->nfiles;
+    buf = mem_alloc(nfiles * sizeof(verify_record_ty));
+    memset(buf, 0, nfiles * sizeof(verify_record_ty));
+    for (j = 0; j < nfiles; ++j)
+    {
+        verify_record_ty *rp;
+        fingerprint_ty  *fp;
+        struct stat     st;
+        const char      *path;
+
+        rp = &buf[j];
+        path = grp->output->item[j].file->filename->str_text;
+        if (stat(path, &rp->st) || !S_ISREG(rp->st.st_mode))
+            continue;
+        fp = fingerprint_new(&fp_combined);
+        if
+        (
+            !fingerprint_file_sum
+            (
+                fp,
+                path,
+                rp->fingerprint,
+                sizeof(rp->fingerprint)
+            )
+        &&
+            !stat(path, &st)
+        &&
+            st.st_ino == rp->st.st_ino
+        &&
+            st.st_size == rp->st.st_size
+        &&
+            st.st_mtime == rp->st.st_mtime
+        &&
+            st.st_ctime == rp->st.st_ctime
+        )
+            rp->ok = 1;
+        fingerprint_delete(fp);
+    }
+
+    cp = (char *)buf;
+    nbytes = nfiles * sizeof(verify_record_ty);
+    while (nbytes > 0)
+    {
+        ssize_t         n;
+
+        n = write(fd, cp, nbytes);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        cp += n;
+        nbytes -= n;
+    }
+    _exit(0);
+}
+
+
+/*
+ * NAME
+ *      graph_recipe_verify_start
+ *
+ * SYNOPSIS
+ *      int graph_recipe_verify_start(graph_recipe_ty *grp, graph_ty *gp);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_verify_start function is used to start
+ *      fingerprinting the outputs of a recipe in the background.  It
+ *      is only worth doing when there are other jobs which could run
+ *      meanwhile, and enough to read.
+ *
+ * RETURNS
+ *      int; the process id of the worker, which the caller must wait
+ *      for, or zero if the outputs should be dealt with directly.
+ */
+
+int
+graph_recipe_verify_start(graph_recipe_ty *grp, graph_ty *gp)
+{
+    size_t          j;
+    long            total;
+    string_ty       *fn;
+    int             fd;
+    int             pid;
+
+    trace(("graph_recipe_verify_start(grp = %p)\n{\n", grp));
+    assert(grp->verify_fd < 0);
+    if (gp->parallel_jobs < 2)
+    {
+        trace(("return 0;\n"));
+        trace(("}\n"));
+        return 0;
+    }
+    total = 0;
+    for (j = 0; j < grp->output->nfiles; ++j)
+    {
+        struct stat     st;
+
+        if
+        (
+            !stat(grp->output->item[j].file->filename->str_text, &st)
+        &&
+            S_ISREG(st.st_mode)
+        )
+            total += st.st_size;
+    }
+    trace(("total = %ld;\n", total));
+    if (total < VERIFY_ASYNC_MIN)
+    {
+        trace(("return 0;\n"));
+        trace(("}\n"));
+        return 0;
+    }
+
+    fn = temporary_filename();
+    fd = open(fn->str_text, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        str_free(fn);
+        trace(("return 0;\n"));
+        trace(("}\n"));
+        return 0;
+    }
+    unlink(fn->str_text);
+    str_free(fn);
+    pid = fork();
+    if (pid < 0)
+    {
+        close(fd);
+        trace(("return 0;\n"));
+        trace(("}\n"));
+        return 0;
+    }
+    if (pid == 0)
+        verify_worker(grp, fd);
+    grp->verify_pid = pid;
+    grp->verify_fd = fd;
+    trace(("return %d;\n", pid));
+    trace(("}\n"));
+    return pid;
+}
+
+
+/*
+ * NAME
+ *      graph_recipe_verify_finish
+ *
+ * SYNOPSIS
+ *      void graph_recipe_verify_finish(graph_recipe_ty *grp);
+ *
+ * DESCRIPTION
+ *      The graph_recipe_verify_finish function is used, once the
+ *      worker has been waited for, to hand its fingerprints to
+ *      fp_fingerprint.  If the worker failed, nothing is handed over,
+ *      and the outputs are fingerprinted directly as usual.
+ */
+
+void
+graph_recipe_verify_finish(graph_recipe_ty *grp)
+{
+    verify_record_ty *buf;
+    size_t          nfiles;
+    char            *cp;
+    size_t          nbytes;
+    size_t          j;
+
+    trace(("graph_recipe_verify_finish(grp = %p)\n{\n", grp));
+    assert(grp->verify_fd >= 0);
+    nfiles = grp->output->nfiles;
+    buf = mem_alloc(nfiles * sizeof(verify_record_ty));
+    cp = (char *)buf;
+    nbytes = nfiles * sizeof(verify_record_ty);
+    if
+    (
+        grp->ocp->exit_status != 0
+    ||
+        lseek(grp->verify_fd, (off_t)0, SEEK_SET) != 0
+    )
+        nbytes = 1;
+    while (nbytes > 0)
+    {
+        ssize_t         n;
+
+        n = read(grp->verify_fd, cp, nbytes);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        cp += n;
+        nbytes -= n;
+    }
+    if (nbytes == 0)
+    {
+        for (j = 0; j < nfiles; ++j)
+        {
+            string_ty       *s;
+
+            if (!buf[j].ok)
+                continue;
+            s = str_from_c(buf[j].fingerprint);
+            fp_fingerprint_precomputed
+            (
+                grp->output->item[j].file->filename,
+                &buf[j].st,
+                s
+            );
+            str_free(s);
+        }
+    }
+    mem_free(buf);
+    close(grp->verify_fd);
+    grp->verify_fd = -1;
+    grp->verify_pid = 0;
+    trace(("}\n"));
+}
@@ -0,0 +1,29 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_GRAPH_VERIFY_H
+#define COOK_GRAPH_VERIFY_H
+
+#include <cook/graph.h>
+#include <cook/graph/recipe.h>
+
+int graph_recipe_verify_start(graph_recipe_ty *, graph_ty *);
+void graph_recipe_verify_finish(graph_recipe_ty *);
+
+#endif /* COOK_GRAPH_VERIFY_H */
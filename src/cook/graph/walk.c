@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-2001, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-2001, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -31,11 +31,15 @@
 #include <cook/graph/check.h>
 #include <cook/graph/file.h>
 #include <cook/graph/file_list.h>
+#include <cook/graph/host.h>
+#include <cook/graph/ninja.h>
 #include <cook/graph/pairs.h>
+#include <cook/graph/pool.h>
 #include <cook/graph/recipe.h>
 #include <cook/graph/recipe_list.h>
 #include <cook/graph/run.h>
 #include <cook/graph/script.h>
+#include <cook/graph/stream.h>
 #include <cook/graph/walk.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
@@ -290,7 +294,8 @@ is_it_a_leaf(symtab_ty *stp, string_ty *filename, void *data, void *aux)
     (void)stp;
     (void)filename;
     gfp = data;
-    gfp->done = 0;
+    if (!gfp->stream_released)
+        gfp->done = 0;
     gfp->input_satisfied = 0;
     gfp->input_uptodate = 0;
 
@@ -396,7 +401,7 @@ graph_walk_inner(graph_ty *gp,
     size_t          j;
     size_t          walk_pos;
     itab_ty         *itp;
-    string_list_ty  single_thread;
+    graph_pool_ty   *pool;
 
     trace(("graph_walk(gp = %p, nproc = %d)\n{\n", gp, nproc));
     status = graph_walk_status_uptodate;
@@ -433,7 +438,7 @@ graph_walk_inner(graph_ty *gp,
      * Keep chewing up graph recipe nodes until no more are left to
      * be processed.
      */
-    string_list_constructor(&single_thread);
+    pool = graph_pool_new();
     walk_pos = 0;
     while (walk_pos < walk.nrecipes || itp->load > 0)
     {
@@ -493,17 +498,12 @@ graph_walk_inner(graph_ty *gp,
             grp = walk.recipe[walk_pos++];
 
             /*
-             * Make sure there is no conflict with existing
-             * single thread flags.  Go hunting for a recipe
-             * not in conflict.  Come back later if we can't
-             * find one.
+             * Make sure the pools (single thread flags) and
+             * the memory budget have room for this recipe.
+             * Go hunting for a recipe which fits.  Come back
+             * later if we can't find one.
              */
-            if
-            (
-                grp->single_thread
-            &&
-                string_list_intersect(grp->single_thread, &single_thread)
-            )
+            if (!graph_pool_admit(pool, grp))
             {
                 size_t          k;
                 graph_recipe_ty *kp;
@@ -514,16 +514,7 @@ graph_walk_inner(graph_ty *gp,
                 for (k = walk_pos; k < walk.nrecipes; ++k)
                 {
                     kp = walk.recipe[k];
-                    if
-                    (
-                        !kp->single_thread
-                    ||
-                        !string_list_intersect
-                        (
-                            kp->single_thread,
-                            &single_thread
-                        )
-                    )
+                    if (graph_pool_admit(pool, kp))
                         break;
                 }
 
@@ -552,13 +543,10 @@ graph_walk_inner(graph_ty *gp,
             trace(("grp->output->nfiles = %ld;\n", (long)grp->output->nfiles));
 
             /*
-             * Remember the single threading, so other
-             * recipes avoid conflicting with *this* one.
+             * Take this recipe's claims, so other recipes
+             * avoid conflicting with *this* one.
              */
-            if (grp->single_thread)
-            {
-                string_list_append_list(&single_thread, grp->single_thread);
-            }
+            graph_pool_claim(pool, grp);
 
             /*
              * run the recipe body
@@ -569,9 +557,14 @@ graph_walk_inner(graph_ty *gp,
             /*
              * Look at what happened.
              */
-            if (grp->single_thread && status2 != graph_walk_status_wait)
+            if (status2 != graph_walk_status_wait)
             {
-                string_list_remove_list(&single_thread, grp->single_thread);
+                graph_pool_release
+                (
+                    pool,
+                    grp,
+                    status2 == graph_walk_status_error
+                );
             }
             switch (status2)
             {
@@ -666,8 +659,7 @@ graph_walk_inner(graph_ty *gp,
                         /* if it's one of ours... */
                         trace(("...waited\n"));
                         assert(pid == graph_recipe_getpid(grp));
-                        if (grp->ocp->meter_p)
-                            grp->ocp->meter_p->ru = ru;
+                        graph_recipe_rusage(grp, &ru);
                         graph_recipe_waited(grp, exit_status);
                         itab_delete(itp, pid);
                         trace(("itp->load = %ld;\n", (long)itp->load));
@@ -719,8 +711,7 @@ graph_walk_inner(graph_ty *gp,
                 trace(("...waited\n"));
                 assert(pid == graph_recipe_getpid(grp));
 #ifdef HAVE_WAIT3
-                if (grp->ocp->meter_p)
-                    grp->ocp->meter_p->ru = ru;
+                graph_recipe_rusage(grp, &ru);
 #endif
                 graph_recipe_waited(grp, exit_status);
                 itab_delete(itp, pid);
@@ -743,7 +734,7 @@ graph_walk_inner(graph_ty *gp,
      * Free up the list of recipes (which have been) / (to be) walked.
      */
     graph_recipe_list_nrc_destructor(&walk);
-    string_list_destructor(&single_thread);
+    graph_pool_delete(pool);
 
     trace(("return %s;\n", graph_walk_status_name(status)));
     trace(("}\n"));
@@ -753,26 +744,23 @@ graph_walk_inner(graph_ty *gp,
 
 /*
  * NAME
- *      graph_walk
+ *      graph_walk_jobs
  *
  * SYNOPSIS
- *      graph_walk_status_ty graph_walk(graph_ty *);
+ *      int graph_walk_jobs(void);
  *
  * DESCRIPTION
- *      The graph_walk function is used to walk a graph re-building any
- *      out-of-date files.
+ *      The graph_walk_jobs function is used to find how many recipes
+ *      may be run at once, from the parallel_jobs variable.  The
+ *      variable is set to precisely reflect what we are going to do,
+ *      should the recipes use it in some way.
  *
  * RETURNS
- *      graph_walk_status_ty
- *              error           something went wrong
- *              uptodate        no action required
- *              uptodate_done   fingerprints indicate the file did not change
- *              done            targets are out of date, because the
- *                              recipe body was run
+ *      int; the number of jobs, at least one.
  */
 
-graph_walk_status_ty
-graph_walk(graph_ty *gp)
+int
+graph_walk_jobs(void)
 {
     int             nproc;
     string_ty       *key;
@@ -816,11 +804,68 @@ graph_walk(graph_ty *gp)
     string_list_destructor(&wl);
     str_free(key);
     opcode_context_delete(ocp);
+    return nproc;
+}
+
+
+/*
+ * NAME
+ *      graph_walk
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_walk(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_walk function is used to walk a graph re-building any
+ *      out-of-date files.
+ *
+ *      After a pipelined build (see graph_stream_begin) the recipes
+ *      queued while the graph was built are run first.  They are not
+ *      run again; the walk is given their results.
+ *
+ * RETURNS
+ *      graph_walk_status_ty
+ *              error           something went wrong
+ *              uptodate        no action required
+ *              uptodate_done   fingerprints indicate the file did not change
+ *              done            targets are out of date, because the
+ *                              recipe body was run
+ */
+
+graph_walk_status_ty
+graph_walk(graph_ty *gp)
+{
+    int             nproc;
+    graph_walk_status_ty status;
+    graph_walk_status_ty (*func)(graph_recipe_ty *, graph_ty *);
+
+    func = graph_recipe_run;
+    if (gp->stream)
+    {
+        graph_stream_flush(gp);
+        graph_stream_end(gp);
+        func = graph_stream_run;
+    }
+    nproc = graph_walk_jobs();
+
+    /*
+     * Ask about all of the leaves at once, rather than one at a time
+     * as the walk reaches them.
+     */
+    graph_prefetch(gp);
 
     /*
      * walk the graph
      */
-    return graph_walk_inner(gp, graph_recipe_run, nproc);
+    gp->parallel_jobs = nproc;
+    status = graph_walk_inner(gp, func, nproc);
+
+    /*
+     * Say how busy the remote hosts were, if any.
+     */
+    if (option_test(OPTION_METER) && !option_test(OPTION_SILENT))
+        graph_host_report();
+    return status;
 }
 
 
@@ -891,6 +936,38 @@ graph_walk_script(graph_ty *gp)
 }
 
 
+/*
+ * NAME
+ *      graph_walk_ninja
+ *
+ * SYNOPSIS
+ *      graph_walk_status_ty graph_walk_ninja(graph_ty *);
+ *
+ * DESCRIPTION
+ *      The graph_walk_ninja function is used to walk a file dependency
+ *      graph printing a ninja build file on the standard output.  Unlike
+ *      the shell script, the build file keeps the parallelism of the
+ *      graph, so an external executor can replay the build without
+ *      reading the cookbook or building the graph.
+ *
+ * RETURNS
+ *      graph_walk_status_ty
+ *              error           something went wrong
+ *              done            success
+ */
+
+graph_walk_status_ty
+graph_walk_ninja(graph_ty *gp)
+{
+    graph_walk_status_ty status;
+
+    graph_ninja_begin(gp);
+    status = graph_walk_inner(gp, graph_recipe_ninja, 1);
+    graph_ninja_end();
+    return status;
+}
+
+
 /*
  * NAME
  *      graph_isit_uptodate
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -37,9 +37,11 @@ typedef enum graph_walk_status_ty graph_walk_status_ty;
 
 char *graph_walk_status_name(graph_walk_status_ty);
 
+int graph_walk_jobs(void);
 graph_walk_status_ty graph_walk(struct graph_ty *);
 graph_walk_status_ty graph_walk_pairs(struct graph_ty *);
 graph_walk_status_ty graph_walk_script(struct graph_ty *);
+graph_walk_status_ty graph_walk_ninja(struct graph_ty *);
 int graph_isit_uptodate(struct graph_ty *);
 
 #endif /* COOK_GRAPH_WALK_H */
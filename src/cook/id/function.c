@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 1999, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -141,3 +141,28 @@ id_function_new(opcode_list_ty *olp)
     trace(("}\n"));
     return idp;
 }
+
+
+/*
+ * NAME
+ *      id_function_query
+ *
+ * SYNOPSIS
+ *      opcode_list_ty *id_function_query(id_ty *idp);
+ *
+ * DESCRIPTION
+ *      The id_function_query function is used to get the body of a
+ *      user defined function.
+ *
+ * RETURNS
+ *      opcode_list_ty *; the function body, or NULL if the ID is not
+ *      a user defined function.
+ */
+
+opcode_list_ty *
+id_function_query(id_ty *idp)
+{
+    if (idp->method != &method)
+        return 0;
+    return ((id_function_ty *)idp)->value;
+}
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -25,5 +25,6 @@
 struct opcode_list_ty; /* existence */
 
 struct id_ty *id_function_new(struct opcode_list_ty *);
+struct opcode_list_ty *id_function_query(struct id_ty *);
 
 #endif /* COOK_ID_FUNCTION_H */
@@ -0,0 +1,614 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains the functions used to capture the output of each
+ * command cook runs on a pipe of its own, and write it out as one
+ * contiguous block when the command finishes, so that the output of
+ * parallel jobs is not interleaved line by line.
+ *
+ * There is no separate writer process or thread.  The pipes are
+ * drained whenever cook waits for a child (see cook/os/wait.c), which
+ * is where it spends its time while jobs run, using epoll(7) where
+ * available, and poll(2) elsewhere.
+ *
+ * When listing to both a file and the terminal, cook's own output and
+ * the job blocks are written straight into the list file, and the
+ * file is copied to the terminal as it grows.  This replaces the
+ * tee(1) process every job used to write through.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/stdio.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/trace.h>
+#include <common/whole_file.h>
+#include <cook/job_output.h>
+
+
+typedef struct job_ty job_ty;
+struct job_ty
+{
+    int             pid;
+    int             fd;
+    int             reaped;
+    char            *buf;
+    size_t          len;
+    size_t          max;
+};
+
+static int      capturing;
+static int      terminal_fd = -1;
+static int      log_fd = -1;
+static job_ty   **job;
+static size_t   njobs;
+static size_t   njobs_max;
+static job_ty   *pending;
+static int      pending_fd = -1;
+#ifdef HAVE_EPOLL
+static int      epoll_fd = -1;
+#endif
+
+
+static void
+close_on_exec(int fd)
+{
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+
+/*
+ * NAME
+ *      tail
+ *
+ * SYNOPSIS
+ *      void tail(void);
+ *
+ * DESCRIPTION
+ *      The tail function is used to copy whatever has been added to
+ *      the list file since last time to the terminal, when listing to
+ *      both.
+ */
+
+static void
+tail(void)
+{
+    char            buf[8192];
+    ssize_t         n;
+
+    if (terminal_fd < 0)
+        return;
+    fflush(stdout);
+    for (;;)
+    {
+        n = read(log_fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        write_all(terminal_fd, buf, n);
+    }
+}
+
+
+/*
+ * NAME
+ *      job_output_enable
+ *
+ * SYNOPSIS
+ *      void job_output_enable(int capture, int terminal, const char *log);
+ *
+ * DESCRIPTION
+ *      The job_output_enable function is used by log_open to say how
+ *      the output of the session is to be handled.  If capture is
+ *      true, the output of each command is grouped.  If terminal is
+ *      not negative, it is the file descriptor of the terminal, and
+ *      log is the name of the list file, which has already been
+ *      opened as the standard output; it will be copied to the
+ *      terminal.
+ */
+
+void
+job_output_enable(int capture, int terminal, const char *log)
+{
+    trace(("job_output_enable(capture = %d, terminal = %d)\n{\n", capture,
+        terminal));
+    capturing = capture;
+    if (terminal >= 0 && log)
+    {
+        log_fd = open(log, O_RDONLY);
+        if (log_fd < 0)
+            fatal_intl_open(log);
+        close_on_exec(log_fd);
+        terminal_fd = terminal;
+    }
+#ifdef HAVE_EPOLL
+    if (capturing || terminal_fd >= 0)
+    {
+        epoll_fd = epoll_create(64);
+        if (epoll_fd < 0)
+        {
+            sub_context_ty  *scp;
+
+            scp = sub_context_new();
+            sub_errno_set(scp);
+            fatal_intl(scp, i18n("epoll_create(): $errno"));
+            /* NOTREACHED */
+        }
+        close_on_exec(epoll_fd);
+    }
+#endif
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      job_output_active
+ *
+ * SYNOPSIS
+ *      int job_output_active(void);
+ *
+ * DESCRIPTION
+ *      The job_output_active function is used to find out whether
+ *      there is output which must be dealt with while waiting for
+ *      children: a job pipe which is still open, or a list file which
+ *      commands write straight into and which must be copied to the
+ *      terminal as it grows.  When there is not, the wait can block.
+ */
+
+int
+job_output_active(void)
+{
+    size_t          j;
+
+    if (terminal_fd >= 0 && !capturing)
+        return 1;
+    for (j = 0; j < njobs; ++j)
+        if (job[j]->fd >= 0)
+            return 1;
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      job_output_pipe
+ *
+ * SYNOPSIS
+ *      int job_output_pipe(void);
+ *
+ * DESCRIPTION
+ *      The job_output_pipe function is used by spawn, just before it
+ *      forks a command, to make the pipe the command's output is to
+ *      be captured on.  It must be followed by job_output_start once
+ *      the child exists, or job_output_forget if the fork fails.
+ *
+ * RETURNS
+ *      int; the file descriptor the child is to use as its standard
+ *      output and standard error, or -1 if output is not captured.
+ */
+
+int
+job_output_pipe(void)
+{
+    int             fd[2];
+
+    if (!capturing)
+        return -1;
+    assert(!pending);
+    if (pipe(fd))
+    {
+        sub_context_ty  *scp;
+
+        scp = sub_context_new();
+        sub_errno_set(scp);
+        fatal_intl(scp, i18n("pipe(): $errno"));
+        /* NOTREACHED */
+    }
+
+    /*
+     * Neither end may leak into other commands, or the end of file
+     * would not be seen until they, too, had finished.
+     */
+    close_on_exec(fd[0]);
+    close_on_exec(fd[1]);
+    fcntl(fd[0], F_SETFL, O_NONBLOCK);
+
+    pending = mem_alloc(sizeof(job_ty));
+    pending->pid = 0;
+    pending->fd = fd[0];
+    pending->reaped = 0;
+    pending->buf = 0;
+    pending->len = 0;
+    pending->max = 0;
+    pending_fd = fd[1];
+    return fd[1];
+}
+
+
+/*
+ * NAME
+ *      job_output_start
+ *
+ * SYNOPSIS
+ *      void job_output_start(int pid);
+ *
+ * DESCRIPTION
+ *      The job_output_start function is used by spawn, in the parent,
+ *      once the command has been forked, to start watching the pipe
+ *      from job_output_pipe.
+ */
+
+void
+job_output_start(int pid)
+{
+    job_ty          *jp;
+
+    tail();
+    jp = pending;
+    if (!jp)
+        return;
+    pending = 0;
+    close(pending_fd);
+    pending_fd = -1;
+    jp->pid = pid;
+
+    if (njobs >= njobs_max)
+    {
+        njobs_max = njobs_max * 2 + 16;
+        job = mem_change_size(job, njobs_max * sizeof(job[0]));
+    }
+    job[njobs++] = jp;
+#ifdef HAVE_EPOLL
+    {
+        struct epoll_event ev;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = jp;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, jp->fd, &ev);
+    }
+#endif
+}
+
+
+/*
+ * NAME
+ *      job_output_forget
+ *
+ * SYNOPSIS
+ *      void job_output_forget(void);
+ *
+ * DESCRIPTION
+ *      The job_output_forget function is used by spawn to discard the
+ *      pipe from job_output_pipe when the fork fails.
+ */
+
+void
+job_output_forget(void)
+{
+    if (!pending)
+        return;
+    close(pending->fd);
+    close(pending_fd);
+    mem_free(pending);
+    pending = 0;
+    pending_fd = -1;
+}
+
+
+/*
+ * NAME
+ *      emit
+ *
+ * SYNOPSIS
+ *      void emit(job_ty *jp);
+ *
+ * DESCRIPTION
+ *      The emit function is used to write out the output collected
+ *      from a job, in one piece, after anything cook has already
+ *      written.  Write errors are ignored, the same as they would have
+ *      been by tee(1).
+ */
+
+static void
+emit(job_ty *jp)
+{
+    if (jp->len == 0)
+        return;
+    fflush(stdout);
+    write_all(fileno(stdout), jp->buf, jp->len);
+    jp->len = 0;
+}
+
+
+/*
+ * NAME
+ *      drain
+ *
+ * SYNOPSIS
+ *      void drain(job_ty *jp);
+ *
+ * DESCRIPTION
+ *      The drain function is used to read everything a job's pipe has
+ *      to offer right now, without blocking.  At end of file the pipe
+ *      is closed.  A job which has already been reaped, but whose pipe
+ *      is still held open (by a background process, usually) has its
+ *      output written out as it arrives.
+ */
+
+static void
+drain(job_ty *jp)
+{
+    ssize_t         n;
+
+    while (jp->fd >= 0)
+    {
+        if (jp->max - jp->len < 4096)
+        {
+            jp->max = jp->max * 2 + 8192;
+            jp->buf = mem_change_size(jp->buf, jp->max);
+        }
+        n = read(jp->fd, jp->buf + jp->len, jp->max - jp->len);
+        if (n > 0)
+        {
+            jp->len += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && errno == EAGAIN)
+            break;
+
+        /*
+         * End of file, or an error which means the same thing.
+         */
+#ifdef HAVE_EPOLL
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, jp->fd, (struct epoll_event *)0);
+#endif
+        close(jp->fd);
+        jp->fd = -1;
+    }
+    if (jp->reaped)
+        emit(jp);
+}
+
+
+/*
+ * NAME
+ *      sweep
+ *
+ * SYNOPSIS
+ *      void sweep(void);
+ *
+ * DESCRIPTION
+ *      The sweep function is used to forget jobs which have been
+ *      reaped and whose pipes are closed.
+ *
+ * RETURNS
+ *      int; the number of jobs whose pipes are closed but which have
+ *      not yet been reaped.
+ */
+
+static int
+sweep(void)
+{
+    size_t          j;
+    size_t          k;
+    int             exiting;
+
+    exiting = 0;
+    k = 0;
+    for (j = 0; j < njobs; ++j)
+    {
+        job_ty          *jp;
+
+        jp = job[j];
+        if (jp->reaped && jp->fd < 0)
+        {
+            if (jp->buf)
+                mem_free(jp->buf);
+            mem_free(jp);
+            continue;
+        }
+        if (jp->fd < 0)
+            ++exiting;
+        job[k++] = jp;
+    }
+    njobs = k;
+    return exiting;
+}
+
+
+/*
+ * NAME
+ *      job_output_service
+ *
+ * SYNOPSIS
+ *      int job_output_service(int msec);
+ *
+ * DESCRIPTION
+ *      The job_output_service function is used to read from the job
+ *      pipes which have something to say, waiting up to the given
+ *      number of milliseconds for one of them to become ready.  A
+ *      pipe reaching end of file usually means a job has finished,
+ *      so the caller should look for exited children when this
+ *      returns.
+ *
+ * RETURNS
+ *      int; the number of jobs whose pipes have closed but which have
+ *      not yet been reaped.  The kernel closes a process's files a
+ *      moment before it may be waited for, so the caller should not
+ *      sleep long when this is non-zero.
+ */
+
+int
+job_output_service(int msec)
+{
+    int             exiting;
+
+#ifdef HAVE_EPOLL
+    struct epoll_event ev[64];
+    int             n;
+    int             j;
+
+    if (epoll_fd >= 0)
+    {
+        n = epoll_wait(epoll_fd, ev, SIZEOF(ev), msec);
+        for (j = 0; j < n; ++j)
+            drain(ev[j].data.ptr);
+    }
+#else
+    static struct pollfd *pfd;
+    static size_t   pfd_max;
+    size_t          npfd;
+    size_t          j;
+
+    if (pfd_max < njobs)
+    {
+        pfd_max = njobs;
+        pfd = mem_change_size(pfd, pfd_max * sizeof(pfd[0]));
+    }
+    npfd = 0;
+    for (j = 0; j < njobs; ++j)
+    {
+        if (job[j]->fd < 0)
+            continue;
+        pfd[npfd].fd = job[j]->fd;
+        pfd[npfd].events = POLLIN;
+        pfd[npfd].revents = 0;
+        ++npfd;
+    }
+    if (poll(pfd, npfd, msec) > 0)
+    {
+        size_t          k;
+
+        for (j = 0; j < npfd; ++j)
+        {
+            if (!pfd[j].revents)
+                continue;
+            for (k = 0; k < njobs; ++k)
+            {
+                if (job[k]->fd == pfd[j].fd)
+                {
+                    drain(job[k]);
+                    break;
+                }
+            }
+        }
+    }
+#endif
+    exiting = sweep();
+    tail();
+    return exiting;
+}
+
+
+/*
+ * NAME
+ *      job_output_finished
+ *
+ * SYNOPSIS
+ *      void job_output_finished(int pid);
+ *
+ * DESCRIPTION
+ *      The job_output_finished function is used by os_wait4 whenever
+ *      a child is reaped.  If it was a job whose output was captured,
+ *      the output is written out now, before cook says anything about
+ *      the exit status.
+ */
+
+void
+job_output_finished(int pid)
+{
+    size_t          j;
+
+    for (j = 0; j < njobs; ++j)
+    {
+        job_ty          *jp;
+
+        jp = job[j];
+        if (jp->pid == pid && !jp->reaped)
+        {
+            jp->reaped = 1;
+            drain(jp);
+            sweep();
+            break;
+        }
+    }
+    tail();
+}
+
+
+/*
+ * NAME
+ *      job_output_close
+ *
+ * SYNOPSIS
+ *      void job_output_close(void);
+ *
+ * DESCRIPTION
+ *      The job_output_close function is used by log_close to write out
+ *      any output still held, and to stop capturing.
+ *
+ * CAVEAT
+ *      Do not call any of the fatal error functions from this function.
+ */
+
+void
+job_output_close(void)
+{
+    size_t          j;
+
+    for (j = 0; j < njobs; ++j)
+    {
+        job[j]->reaped = 1;
+        drain(job[j]);
+        if (job[j]->fd >= 0)
+        {
+            close(job[j]->fd);
+            job[j]->fd = -1;
+        }
+    }
+    sweep();
+    tail();
+    capturing = 0;
+    if (log_fd >= 0)
+    {
+        close(log_fd);
+        log_fd = -1;
+    }
+    terminal_fd = -1;
+#ifdef HAVE_EPOLL
+    if (epoll_fd >= 0)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+#endif
+}
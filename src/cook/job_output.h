@@ -0,0 +1,34 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_JOB_OUTPUT_H
+#define COOK_JOB_OUTPUT_H
+
+#include <common/main.h>
+
+void job_output_enable(int capture, int terminal, const char *log);
+int job_output_pipe(void);
+void job_output_start(int pid);
+void job_output_forget(void);
+void job_output_finished(int pid);
+int job_output_active(void);
+int job_output_service(int msec);
+void job_output_close(void);
+
+#endif /* COOK_JOB_OUTPUT_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-2007, 2009, 2010 Peter Miller
+ *      Copyright (C) 1993-2007, 2009, 2010, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -365,7 +365,7 @@ lex_close(void)
     }
     lex_filename_destructor(&old->filename);
     lex_filename_list_destructor(&old->pending_include_list);
-    free(old);
+    mem_free(old);
     trace(("}\n"));
 }
 
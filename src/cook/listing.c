@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993, 1994, 1997-2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1993, 1994, 1997-2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -19,6 +19,7 @@
 
 #include <common/ac/stddef.h>
 #include <common/ac/stdio.h>
+#include <common/ac/fcntl.h>
 #include <common/ac/string.h>
 #include <common/ac/time.h>
 #include <common/ac/signal.h>
@@ -27,6 +28,7 @@
 #include <sys/wait.h>
 
 #include <common/error_intl.h>
+#include <cook/job_output.h>
 #include <cook/listing.h>
 #include <cook/os_interface.h>
 #include <cook/os/wait.h>
@@ -35,7 +37,8 @@
 #include <common/trace.h>
 
 
-static int      pid;
+static int      terminal = -1;
+static string_ty *compress;
 
 
 #ifdef HAVE_GETPGRP
@@ -116,6 +119,54 @@ background(void)
 }
 
 
+/*
+ * NAME
+ *      log_compress - compress the list file
+ *
+ * SYNOPSIS
+ *      void log_compress(void);
+ *
+ * DESCRIPTION
+ *      The log_compress function is used to compress the list file
+ *      with gzip(1), when the list file name given ended in ".gz".
+ *      The list is written uncompressed while cook runs, so that it
+ *      can be copied to the terminal and read with tail(1).
+ */
+
+static void
+log_compress(void)
+{
+    int             child;
+    int             status;
+    char            *cmd[4];
+
+    cmd[0] = "gzip";
+    cmd[1] = "-f";
+    cmd[2] = compress->str_text;
+    cmd[3] = 0;
+    switch (child = fork())
+    {
+    case -1:
+        return;
+
+    case 0:
+        execvp(cmd[0], cmd);
+        _exit(127);
+
+    default:
+        for (;;)
+        {
+            int             who;
+
+            who = os_waitpid(child, &status);
+            if (who < 0 || who == child)
+                break;
+        }
+        break;
+    }
+}
+
+
 /*
  * NAME
  *      log_close - terminate logging
@@ -127,6 +178,9 @@ background(void)
  *      Log_close is used to terminate logging this session,
  *      and to close any como or comi files opened.
  *
+ *      Anything written after this goes to the terminal, if the
+ *      session was also being listed there.
+ *
  * CAVEAT
  *      Do not call any of the fatal error functions
  *      from this function.
@@ -135,20 +189,21 @@ background(void)
 static void
 log_close(void)
 {
-    if (pid)
+    job_output_close();
+    fflush(stdout);
+    fflush(stderr);
+    if (terminal >= 0)
     {
-        fclose(stdout);
-        fclose(stderr);
-        for (;;)
-        {
-            int             who;
-            int             status;
-
-            who = os_waitpid(pid, &status);
-            if (who < 0 || who == pid)
-                break;
-        }
-        pid = 0;
+        dup2(terminal, 1);
+        dup2(terminal, 2);
+        close(terminal);
+        terminal = -1;
+    }
+    if (compress)
+    {
+        log_compress();
+        str_free(compress);
+        compress = 0;
     }
 }
 
@@ -168,6 +223,7 @@ void
 log_open(void)
 {
     string_ty       *fullpath;
+    string_ty       *logfile;
     sub_context_ty  *scp;
 
     trace(("log_open()\n{\n"));
@@ -187,65 +243,39 @@ log_open(void)
     {
         if (!option.o_logfile)
             fatal_intl(0, i18n("no list file specified"));
-        if (option_test(OPTION_TERMINAL))
+        logfile = option.o_logfile;
+        if
+        (
+            logfile->str_length > 3
+        &&
+            !strcmp(logfile->str_text + logfile->str_length - 3, ".gz")
+        )
         {
-            int             fd[2];
-            char            *cmd[3];
+            compress =
+                str_n_from_c(logfile->str_text, logfile->str_length - 3);
+            logfile = compress;
+        }
 
+        if (option_test(OPTION_TERMINAL))
+        {
             /*
-             * list both to a file and to the terminal
+             * list both to a file and to the terminal: keep the
+             * terminal, the list file is copied to it as it grows
+             * (see cook/job_output.c)
              */
-            if (pipe(fd))
+            terminal = dup(1);
+            if (terminal < 0)
             {
                 scp = sub_context_new();
                 sub_errno_set(scp);
-                fatal_intl(scp, i18n("pipe(): $errno"));
-                /* NOTREACHED */
-            }
-            switch (pid = fork())
-            {
-            case 0:
-                cmd[0] = "tee";
-                cmd[1] = option.o_logfile->str_text;
-                cmd[2] = 0;
-                close(fd[1]);
-                close(0);
-                if (dup(fd[0]) != 0)
-                    fatal_intl(0, i18n("dup was wrong"));
-                close(fd[0]);
-                signal(SIGINT, SIG_IGN);
-                signal(SIGHUP, SIG_IGN);
-                signal(SIGTERM, SIG_IGN);
-                execvp(cmd[0], cmd);
-                scp = sub_context_new();
-                sub_errno_set(scp);
-                sub_var_set_charstar(scp, "File_Name", cmd[0]);
-                fatal_intl(scp, i18n("exec $filename: $errno"));
-                /* NOTREACHED */
-
-            case -1:
-                scp = sub_context_new();
-                sub_errno_set(scp);
-                fatal_intl(scp, i18n("fork(): $errno"));
+                fatal_intl(scp, i18n("dup(): $errno"));
                 /* NOTREACHED */
-
-            default:
-                close(fd[0]);
-                close(1);
-                if (dup(fd[1]) != 1)
-                    fatal_intl(0, i18n("dup was wrong"));
-                close(fd[1]);
-                break;
             }
+            fcntl(terminal, F_SETFD, FD_CLOEXEC);
         }
-        else
-        {
-            /*
-             * list only to a file
-             */
-            if (!freopen(option.o_logfile->str_text, "w", stdout))
-                fatal_intl_open(option.o_logfile->str_text);
-        }
+        if (!freopen(logfile->str_text, "w", stdout))
+            fatal_intl_open(logfile->str_text);
+
         /*
          * make sterr go to the same place as stdout
          *      [will this work if stdout is already closed?]
@@ -283,6 +313,18 @@ log_open(void)
             str_free(fullpath);
             str_free(s);
         }
+
+        /*
+         * The output of commands is grouped by default when listing,
+         * because otherwise parallel jobs are interleaved in the list.
+         */
+        option_set(OPTION_GROUP_OUTPUT, OPTION_LEVEL_DEFAULT, 1);
+        job_output_enable
+        (
+            option_test(OPTION_GROUP_OUTPUT),
+            terminal,
+            logfile->str_text
+        );
     }
     else
     {
@@ -291,6 +333,7 @@ log_open(void)
             /*
              * list only to the terminal
              */
+            job_output_enable(option_test(OPTION_GROUP_OUTPUT), -1, 0);
         }
         else
         {
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994-1999, 2001, 2003, 2004, 2006-2008 Peter Miller
+ *      Copyright (C) 1994-1999, 2001, 2003, 2004, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -61,6 +61,7 @@
 #include <common/error_intl.h>
 #include <common/fflush_slow.h>
 #include <common/help.h>
+#include <common/mem.h>
 #include <common/progname.h>
 #include <common/quit.h>
 #include <common/star.h>
@@ -69,6 +70,7 @@
 #include <cook/builtin.h>
 #include <cook/cook.h>
 #include <cook/fingerprint.h>
+#include <cook/graph/stats.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
 #include <cook/lex.h>
@@ -97,6 +99,8 @@ enum
     arglex_token_fingerprint_update,
     arglex_token_force,
     arglex_token_force_not,
+    arglex_token_group_output,
+    arglex_token_group_output_not,
     arglex_token_include,
     arglex_token_include_cooked,
     arglex_token_include_cooked_not,
@@ -104,8 +108,10 @@ enum
     arglex_token_include_cooked_warning_not,
     arglex_token_log,
     arglex_token_log_not,
+    arglex_token_memory_report,
     arglex_token_metering,
     arglex_token_metering_not,
+    arglex_token_ninja,
     arglex_token_pairs,
     arglex_token_parallel,
     arglex_token_parallel_not,
@@ -113,8 +119,12 @@ enum
     arglex_token_pedantic_not,
     arglex_token_persevere,
     arglex_token_persevere_not,
+    arglex_token_pipeline,
+    arglex_token_pipeline_not,
     arglex_token_precious,
     arglex_token_precious_not,
+    arglex_token_profile,
+    arglex_token_profile_not,
     arglex_token_reason,
     arglex_token_reason_not,
     arglex_token_script,
@@ -165,6 +175,8 @@ static arglex_table_ty argtab[] =
         (arglex_token_ty) arglex_token_fingerprint_update },
     { "-Forced", (arglex_token_ty) arglex_token_force },
     { "-No_Forced", (arglex_token_ty) arglex_token_force_not },
+    { "-Group_Output", (arglex_token_ty) arglex_token_group_output },
+    { "-No_Group_Output", (arglex_token_ty) arglex_token_group_output_not },
     { "-HyperText_Markup_Language", (arglex_token_ty) arglex_token_web },
     { "-Include", (arglex_token_ty) arglex_token_include },
     { "-\\I*", (arglex_token_ty) arglex_token_include },
@@ -179,13 +191,19 @@ static arglex_table_ty argtab[] =
     { "-List", (arglex_token_ty) arglex_token_log },
     { "-No_LOg", (arglex_token_ty) arglex_token_log_not },
     { "-No_List", (arglex_token_ty) arglex_token_log_not },
+    { "-MEMory_Report", (arglex_token_ty) arglex_token_memory_report },
     { "-Meter", (arglex_token_ty) arglex_token_metering },
     { "-No_Meter", (arglex_token_ty) arglex_token_metering_not },
+    { "-NINja", (arglex_token_ty) arglex_token_ninja },
     { "-PAirs", (arglex_token_ty) arglex_token_pairs },
     { "-PARallel", (arglex_token_ty) arglex_token_parallel },
     { "-No_PARallel", (arglex_token_ty) arglex_token_parallel_not },
+    { "-PIPEline", (arglex_token_ty) arglex_token_pipeline },
+    { "-No_PIPEline", (arglex_token_ty) arglex_token_pipeline_not },
     { "-Precious", (arglex_token_ty) arglex_token_precious },
     { "-No_Precious", (arglex_token_ty) arglex_token_precious_not },
+    { "-PROFile", (arglex_token_ty) arglex_token_profile },
+    { "-No_PROFile", (arglex_token_ty) arglex_token_profile_not },
     { "-Reason", (arglex_token_ty) arglex_token_reason },
     { "-No_Reason", (arglex_token_ty) arglex_token_reason_not },
     { "-SCript", (arglex_token_ty) arglex_token_script },
@@ -357,6 +375,14 @@ argparse(option_level_ty level)
             type = OPTION_DISASSEMBLE;
             goto normal_off;
 
+        case arglex_token_group_output:
+            type = OPTION_GROUP_OUTPUT;
+            goto normal_on;
+
+        case arglex_token_group_output_not:
+            type = OPTION_GROUP_OUTPUT;
+            goto normal_off;
+
         case arglex_token_tty:
             type = OPTION_TERMINAL;
             goto normal_on;
@@ -388,6 +414,21 @@ argparse(option_level_ty level)
             type = OPTION_LOGGING;
             goto normal_off;
 
+        case arglex_token_profile:
+            if (option_already(OPTION_PROFILE, level))
+                goto too_many;
+            option_set(OPTION_PROFILE, level, 1);
+            if (arglex() != arglex_token_string)
+                continue;
+            if (option.o_profile)
+                str_free(option.o_profile);
+            option.o_profile = str_from_c(arglex_value.alv_string);
+            break;
+
+        case arglex_token_profile_not:
+            type = OPTION_PROFILE;
+            goto normal_off;
+
         case arglex_token_book:
             if (option_already(OPTION_BOOK, level))
                 goto too_many;
@@ -467,6 +508,14 @@ argparse(option_level_ty level)
             type = OPTION_PERSEVERE;
             goto normal_off;
 
+        case arglex_token_pipeline:
+            type = OPTION_PIPELINE;
+            goto normal_on;
+
+        case arglex_token_pipeline_not:
+            type = OPTION_PIPELINE;
+            goto normal_off;
+
         case arglex_token_errok:
             type = OPTION_ERROK;
             goto normal_on;
@@ -515,6 +564,23 @@ argparse(option_level_ty level)
             option.script++;
             break;
 
+        case arglex_token_memory_report:
+            /*
+             * This was acted upon by main, before anything was
+             * allocated.
+             */
+            if (level != OPTION_LEVEL_COMMAND_LINE)
+                goto not_in_env;
+            break;
+
+        case arglex_token_ninja:
+            if (level != OPTION_LEVEL_COMMAND_LINE)
+                goto not_in_env;
+            if (option.ninja)
+                goto too_many;
+            option.ninja++;
+            break;
+
         case arglex_token_web:
             if (level != OPTION_LEVEL_COMMAND_LINE)
                 goto not_in_env;
@@ -660,6 +726,22 @@ int
 main(int argc, char **argv)
 {
     int             retval;
+    int             j;
+
+    /*
+     * Memory accounting must be turned on before anything is
+     * allocated, so look for the option before doing anything else.
+     * The report is the last of the quit handlers to run.
+     */
+    for (j = 1; j < argc; ++j)
+    {
+        if (arglex_compare("-MEMory_Report", argv[j]))
+        {
+            mem_report_enable();
+            quit_handler(mem_report);
+            break;
+        }
+    }
 
     /*
      * Some versions of cron(8) and at(1) set SIGCHLD to SIG_IGN.
@@ -787,10 +869,14 @@ main(int argc, char **argv)
         retval = cook_pairs(&option.o_target);
     else if (option.script)
         retval = cook_script(&option.o_target);
+    else if (option.ninja)
+        retval = cook_ninja(&option.o_target);
     else if (option.web)
         retval = cook_web(&option.o_target);
     else
         retval = cook(&option.o_target);
+    if (option_test(OPTION_PROFILE))
+        graph_profile_print();
 
 #ifdef DEBUG
     fflush_slowly_report();
@@ -0,0 +1,339 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * A pattern list (such as the graph_leaf_pattern variable) is usually
+ * tried one pattern at a time against each file name.  With a long
+ * list most of those attempts fail on the literal text at the ends of
+ * the pattern, so the list is indexed once: patterns with no wildcards
+ * go into a hash table, and the rest are bucketed by the last
+ * character of their literal suffix.  Classifying a name then only
+ * runs the full matcher on the patterns whose literal prefix and suffix
+ * agree with it, in list order, so the first matching pattern is
+ * still the one reported.
+ */
+
+#include <common/ac/string.h>
+
+#include <common/error.h> /* for assert */
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/symtab.h>
+#include <common/trace.h>
+#include <cook/expr/position.h>
+#include <cook/match/list.h>
+#include <cook/match/private.h>
+
+#define MATCH_CHAR '%'
+#define NO_INDEX ((size_t)-1)
+
+typedef struct match_list_entry_ty match_list_entry_ty;
+struct match_list_entry_ty
+{
+    string_ty       *formal;
+    size_t          prefix_len;
+    size_t          suffix_len;
+};
+
+typedef struct match_list_bucket_ty match_list_bucket_ty;
+struct match_list_bucket_ty
+{
+    size_t          *item;
+    size_t          nitems;
+    size_t          nitems_max;
+};
+
+struct match_list_ty
+{
+    match_ty        *matcher;
+    match_list_entry_ty *entry;
+    size_t          nentries;
+    symtab_ty       *exact;
+    match_list_bucket_ty wild;
+    match_list_bucket_ty bucket[256];
+};
+
+
+static void
+bucket_append(match_list_bucket_ty *bp, size_t n)
+{
+    if (bp->nitems >= bp->nitems_max)
+    {
+        bp->nitems_max = bp->nitems_max * 2 + 4;
+        bp->item =
+            mem_change_size(bp->item, bp->nitems_max * sizeof(bp->item[0]));
+    }
+    bp->item[bp->nitems++] = n;
+}
+
+
+/*
+ * NAME
+ *      literal_ends
+ *
+ * SYNOPSIS
+ *      int literal_ends(match_list_entry_ty *ep);
+ *
+ * DESCRIPTION
+ *      The literal_ends function is used to measure the constant text
+ *      at each end of a cook pattern.  The suffix is found the same
+ *      way attempt_inner in cook/match/cook.c strips it, stopping at
+ *      anything which could be part of a % sequence.
+ *
+ * RETURNS
+ *      int; zero if the pattern has wildcards, non-zero if it is a
+ *      plain string which can only match itself.
+ */
+
+static int
+literal_ends(match_list_entry_ty *ep)
+{
+    const char      *begin;
+    const char      *end;
+    const char      *cp;
+
+    begin = ep->formal->str_text;
+    end = begin + ep->formal->str_length;
+    cp = memchr(begin, MATCH_CHAR, end - begin);
+    if (!cp)
+        return 1;
+    ep->prefix_len = cp - begin;
+
+    cp = end;
+    while (cp > begin)
+    {
+        if (cp[-1] == MATCH_CHAR)
+            break;
+        if (cp - 1 > begin && cp[-2] == MATCH_CHAR && cp[-1] >= '0' &&
+            cp[-1] <= '9')
+            break;
+        --cp;
+    }
+    ep->suffix_len = end - cp;
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      match_list_new
+ *
+ * SYNOPSIS
+ *      match_list_ty *match_list_new(match_ty *mp,
+ *              const string_list_ty *formal);
+ *
+ * DESCRIPTION
+ *      The match_list_new function is used to build an index over a
+ *      list of patterns.  The matcher given is used for the attempts,
+ *      and becomes the property of the list; its kind decides how the
+ *      patterns are read.  Regular expressions are not indexed (their
+ *      literal text is not simply at the ends), and are tried in turn,
+ *      using the compiled pattern cache.
+ *
+ * RETURNS
+ *      match_list_ty *; use match_list_delete when you are done with it.
+ */
+
+match_list_ty *
+match_list_new(match_ty *mp, const string_list_ty *formal)
+{
+    match_list_ty   *mlp;
+    size_t          j;
+    int             cook_patterns;
+
+    trace(("match_list_new(mp = %p, formal = %p)\n{\n", mp, formal));
+    mlp = mem_alloc(sizeof(match_list_ty));
+    memset(mlp, 0, sizeof(*mlp));
+    mlp->matcher = mp;
+    mlp->nentries = formal ? formal->nstrings : 0;
+    mlp->entry =
+        mem_alloc((mlp->nentries ? mlp->nentries : 1) * sizeof(mlp->entry[0]));
+    mlp->exact = symtab_alloc(mlp->nentries);
+    cook_patterns = !strcmp(mp->vptr->name, "cook");
+    for (j = 0; j < mlp->nentries; ++j)
+    {
+        match_list_entry_ty *ep;
+
+        ep = &mlp->entry[j];
+        ep->formal = str_copy(formal->string[j]);
+        ep->prefix_len = 0;
+        ep->suffix_len = 0;
+        if (cook_patterns && literal_ends(ep))
+        {
+            /*
+             * Only the first of duplicate patterns can ever be
+             * reported.
+             */
+            if (!symtab_query(mlp->exact, ep->formal))
+                symtab_assign(mlp->exact, ep->formal, ep);
+            continue;
+        }
+        if (ep->suffix_len)
+        {
+            unsigned char   c;
+
+            c = ep->formal->str_text[ep->formal->str_length - 1];
+            bucket_append(&mlp->bucket[c], j);
+        }
+        else
+            bucket_append(&mlp->wild, j);
+    }
+    trace(("return %p;\n", mlp));
+    trace(("}\n"));
+    return mlp;
+}
+
+
+/*
+ * NAME
+ *      match_list_delete
+ *
+ * SYNOPSIS
+ *      void match_list_delete(match_list_ty *);
+ *
+ * DESCRIPTION
+ *      The match_list_delete function is used to release a pattern
+ *      list index, and its matcher.
+ */
+
+void
+match_list_delete(match_list_ty *mlp)
+{
+    size_t          j;
+
+    trace(("match_list_delete(mlp = %p)\n{\n", mlp));
+    for (j = 0; j < mlp->nentries; ++j)
+        str_free(mlp->entry[j].formal);
+    mem_free(mlp->entry);
+    symtab_free(mlp->exact);
+    if (mlp->wild.item)
+        mem_free(mlp->wild.item);
+    for (j = 0; j < SIZEOF(mlp->bucket); ++j)
+        if (mlp->bucket[j].item)
+            mem_free(mlp->bucket[j].item);
+    match_delete(mlp->matcher);
+    mem_free(mlp);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      match_list_execute
+ *
+ * SYNOPSIS
+ *      int match_list_execute(match_list_ty *mlp, string_ty *actual,
+ *              const expr_position_ty *pp, size_t *which);
+ *
+ * DESCRIPTION
+ *      The match_list_execute function is used to find the first
+ *      pattern in the list which matches the actual string.  This
+ *      gives the same answer as trying each pattern in turn.
+ *
+ * RETURNS
+ *      int; -1 on error (already reported), 0 if no pattern matches,
+ *      1 if a pattern matches, in which case its index is returned
+ *      via the which pointer (if not NULL).
+ */
+
+int
+match_list_execute(match_list_ty *mlp, string_ty *actual,
+    const expr_position_ty *pp, size_t *which)
+{
+    match_list_entry_ty *ep;
+    match_list_bucket_ty *bp;
+    size_t          exact;
+    size_t          i;
+    size_t          k;
+    size_t          n;
+    int             result;
+
+    trace(("match_list_execute(mlp = %p, actual = \"%s\")\n{\n", mlp,
+        actual->str_text));
+    ep = symtab_query(mlp->exact, actual);
+    exact = ep ? (size_t)(ep - mlp->entry) : NO_INDEX;
+
+    /*
+     * Walk the bucket for the last character and the patterns with
+     * no literal suffix together, in list order.
+     */
+    bp = 0;
+    if (actual->str_length)
+    {
+        unsigned char   c;
+
+        c = actual->str_text[actual->str_length - 1];
+        bp = &mlp->bucket[c];
+    }
+    i = 0;
+    k = 0;
+    result = 0;
+    for (;;)
+    {
+        if
+        (
+            bp
+        &&
+            i < bp->nitems
+        &&
+            (k >= mlp->wild.nitems || bp->item[i] < mlp->wild.item[k])
+        )
+            n = bp->item[i++];
+        else if (k < mlp->wild.nitems)
+            n = mlp->wild.item[k++];
+        else
+            break;
+        if (n > exact)
+            break;
+
+        ep = &mlp->entry[n];
+        if
+        (
+            actual->str_length < ep->prefix_len + ep->suffix_len
+        ||
+            memcmp(actual->str_text, ep->formal->str_text, ep->prefix_len)
+        ||
+            memcmp
+            (
+                actual->str_text + actual->str_length - ep->suffix_len,
+                ep->formal->str_text + ep->formal->str_length - ep->suffix_len,
+                ep->suffix_len
+            )
+        )
+            continue;
+
+        /* result can be -1 (error), 0 (false), or 1 (true) */
+        result = match_attempt(mlp->matcher, ep->formal, actual, pp);
+        if (result)
+        {
+            if (result > 0 && which)
+                *which = n;
+            goto ret;
+        }
+    }
+    if (exact != NO_INDEX)
+    {
+        if (which)
+            *which = exact;
+        result = 1;
+    }
+
+    ret:
+    trace(("return %d;\n", result));
+    trace(("}\n"));
+    return result;
+}
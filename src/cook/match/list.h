@@ -0,0 +1,35 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_MATCH_LIST_H
+#define COOK_MATCH_LIST_H
+
+#include <common/ac/stddef.h>
+#include <cook/match.h>
+
+struct string_list_ty; /* existence */
+
+typedef struct match_list_ty match_list_ty;
+
+match_list_ty *match_list_new(match_ty *, const struct string_list_ty *);
+void match_list_delete(match_list_ty *);
+int match_list_execute(match_list_ty *, struct string_ty *,
+        const struct expr_position_ty *, size_t *);
+
+#endif /* COOK_MATCH_LIST_H */
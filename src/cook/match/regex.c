@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -22,11 +22,13 @@
 #include <common/ac/regex.h>
 
 #include <common/error_intl.h>
+#include <common/mem.h>
 #include <cook/expr/position.h>
 #include <cook/match/private.h>
 #include <cook/match/regex.h>
 #include <common/str.h>
 #include <common/stracc.h>
+#include <common/symtab.h>
 #include <common/trace.h>
 
 
@@ -36,10 +38,11 @@ struct match_regex_ty
     match_ty        inherited;
 
     /*
-     * This holds the compiled regular expression.
+     * This points to the compiled regular expression.
      * It is internal to the regex implementation.
+     * It belongs to the cache (see below), not to this matcher.
      */
-    regex_t         preg;
+    regex_t         *preg;
 
     /*
      * The ``actual'' string points to the string which was matched.
@@ -72,6 +75,25 @@ report_regex_error(const expr_position_ty *pp, int err, regex_t *preg,
 }
 
 
+/*
+ * Compiled regular expressions, indexed by the formal pattern, as
+ * written.  The same few recipe patterns are tried against every file
+ * cook considers, and regcomp is far too expensive to repeat each time.
+ */
+static symtab_ty *cache;
+
+
+static void
+cache_reap(void *p)
+{
+    regex_t         *preg;
+
+    preg = p;
+    regfree(preg);
+    mem_free(preg);
+}
+
+
 static void
 destructor(match_ty *mp)
 {
@@ -81,7 +103,7 @@ destructor(match_ty *mp)
     this = (match_regex_ty *)mp;
     if (this->actual)
         str_free(this->actual);
-    regfree(&this->preg);
+    this->preg = 0;
     trace(("}\n"));
 }
 
@@ -94,8 +116,7 @@ constructor(match_ty *mp)
     trace(("match_regex::constructor(mp = %p)\n{\n", mp));
     this = (match_regex_ty *)mp;
     this->actual = 0;
-    /* this is not 100% portable */
-    memset(&this->preg, 0, sizeof(this->preg));
+    this->preg = 0;
     trace(("}\n"));
 }
 
@@ -108,16 +129,31 @@ compile(match_ty *mp, string_ty *formal, const expr_position_ty *pp)
     int             err;
     size_t          formal_start;
     size_t          formal_end;
+    string_ty       *anchored;
+    regex_t         *preg;
 
     trace(("match_regex::complie(mp = %p, formal = %p)\n{\n", mp, formal));
     trace(("formal = \"%s\";\n", formal->str_text));
     this = (match_regex_ty *)mp;
-    result = -1;
 
     /*
-     * Release resources held by previous compiles.
+     * See if this pattern has been compiled before.
      */
-    regfree(&this->preg);
+    if (!cache)
+    {
+        cache = symtab_alloc(10);
+        cache->reap = cache_reap;
+    }
+    preg = symtab_query(cache, formal);
+    if (preg)
+    {
+        this->preg = preg;
+        trace(("cached\n"));
+        trace(("return 0;\n"));
+        trace(("}\n"));
+        return 0;
+    }
+    this->preg = 0;
 
     /*
      * Work formal over so that it has ^ at the beginning, and $
@@ -148,7 +184,7 @@ compile(match_ty *mp, string_ty *formal, const expr_position_ty *pp)
         --formal_end
     )
         ;
-    formal =
+    anchored =
         str_format
         (
             "^%.*s$",
@@ -158,20 +194,29 @@ compile(match_ty *mp, string_ty *formal, const expr_position_ty *pp)
 
     /*
      * compile the regular expression
+     *
+     * Failures are not cached, so the error will be reported
+     * again, with the position of each use.
      */
-    err = regcomp(&this->preg, formal->str_text, REG_BASIC);
+    preg = mem_alloc(sizeof(regex_t));
+    err = regcomp(preg, anchored->str_text, REG_BASIC);
     if (err != 0)
     {
-        report_regex_error(pp, err, &this->preg, formal);
+        report_regex_error(pp, err, preg, anchored);
+        mem_free(preg);
         result = -1;
     }
     else
+    {
+        symtab_assign(cache, formal, preg);
+        this->preg = preg;
         result = 0;
+    }
 
     /*
      * release our worked-over formal expression
      */
-    str_free(formal);
+    str_free(anchored);
 
     /*
      * return result
@@ -206,10 +251,17 @@ execute(match_ty *mp, string_ty *actual, const expr_position_ty *pp)
     /*
      * execute the regular expression
      */
+    assert(this->preg);
+    if (!this->preg)
+    {
+        trace(("return -1;\n"));
+        trace(("}\n"));
+        return -1;
+    }
     err =
         regexec
         (
-            &this->preg,
+            this->preg,
             actual->str_text,
             SIZEOF(this->match),
             this->match,
@@ -227,7 +279,7 @@ execute(match_ty *mp, string_ty *actual, const expr_position_ty *pp)
         break;
 
     default:
-        report_regex_error(pp, err, &this->preg, actual);
+        report_regex_error(pp, err, this->preg, actual);
         result = -1;
         break;
     }
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2001, 2003, 2004, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2001, 2003, 2004, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -35,6 +35,7 @@
 #include <cook/flag.h>
 #include <cook/id.h>
 #include <cook/id/variable.h>
+#include <cook/job_output.h>
 #include <common/mem.h>
 #include <cook/meter.h>
 #include <cook/opcode/context.h>
@@ -164,6 +165,7 @@ spawn(string_list_ty *args, string_ty *input, int *pid_p,
 {
     size_t          j;
     int             fd;
+    int             out_fd;
     string_ty       *iname;
     int             pid;
     opcode_status_ty status;
@@ -437,11 +439,14 @@ spawn(string_list_ty *args, string_ty *input, int *pid_p,
     argv[cmd.nstrings] = 0;
 
     /*
-     * spawn the child process
+     * spawn the child process, with its output on a pipe of its own
+     * if the output of commands is being grouped
      */
+    out_fd = job_output_pipe();
     switch (pid = fork())
     {
     case -1:
+        job_output_forget();
         scp = sub_context_new();
         sub_errno_set(scp);
         error_intl(scp, i18n("fork(): $errno"));
@@ -452,6 +457,18 @@ spawn(string_list_ty *args, string_ty *input, int *pid_p,
         /*
          * child
          */
+        if (out_fd >= 0)
+        {
+            if (dup2(out_fd, 1) < 0 || dup2(out_fd, 2) < 0)
+            {
+                scp = sub_context_new();
+                sub_errno_set(scp);
+                fatal_intl(scp, i18n("dup(): $errno"));
+                /* NOTREACHED */
+                sub_context_delete(scp);
+            }
+            close(out_fd);
+        }
         if (fd >= 0)
         {
             if (close(0) && errno != EBADF)
@@ -499,6 +516,7 @@ spawn(string_list_ty *args, string_ty *input, int *pid_p,
         /*
          * parent
          */
+        job_output_start(pid);
         if (fd >= 0)
         {
             close(fd);
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2004, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 2004, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,14 +18,21 @@
  */
 
 #include <common/ac/stdio.h>
+#include <common/ac/string.h>
 
 #include <common/fflush_slow.h>
+#include <cook/id.h>
+#include <cook/id/function.h>
+#include <cook/id/global.h>
 #include <cook/match.h>
 #include <common/mem.h>
 #include <cook/opcode.h>
 #include <cook/opcode/context.h>
 #include <cook/opcode/list.h>
+#include <cook/opcode/private.h>
+#include <cook/opcode/string.h>
 #include <common/str_list.h>
+#include <common/symtab.h>
 #include <common/trace.h>
 
 
@@ -194,6 +201,112 @@ opcode_list_disassemble(opcode_list_ty *olp)
 }
 
 
+/*
+ * NAME
+ *      list_global
+ *
+ * SYNOPSIS
+ *      int list_global(const opcode_list_ty *olp, string_list_ty *seen);
+ *
+ * DESCRIPTION
+ *      The list_global function is used to implement opcode_list_global.
+ *      Any string in the list which names a user defined function is
+ *      taken to be a call of it, and the function's body is looked
+ *      into as well.  The seen list holds the functions already looked
+ *      into, so that recursive functions are only looked into once.
+ */
+
+static int
+list_global(const opcode_list_ty *olp, string_list_ty *seen)
+{
+    static const char *const name[] =
+    {
+        "assign",
+        "assign_append",
+        "set",
+        "setenv",
+        "setenv_append",
+        "unsetenv",
+    };
+    static const char *const graph_function[] =
+    {
+        "interior_files",
+        "leaf_files",
+    };
+    size_t          j;
+    size_t          k;
+
+    if (!olp)
+        return 0;
+    for (j = 0; j < olp->length; ++j)
+    {
+        string_ty       *s;
+
+        s = opcode_string_value(olp->list[j]);
+        if (s)
+        {
+            id_ty           *idp;
+            opcode_list_ty  *body;
+
+            for (k = 0; k < SIZEOF(graph_function); ++k)
+            {
+                if (!strcmp(s->str_text, graph_function[k]))
+                    return 1;
+            }
+            if (string_list_member(seen, s))
+                continue;
+            idp = symtab_query(id_global_stp(), s);
+            body = idp ? id_function_query(idp) : 0;
+            if (!body)
+                continue;
+            string_list_append(seen, s);
+            if (list_global(body, seen))
+                return 1;
+            continue;
+        }
+        for (k = 0; k < SIZEOF(name); ++k)
+        {
+            if (!strcmp(olp->list[j]->method->name, name[k]))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      opcode_list_global
+ *
+ * SYNOPSIS
+ *      int opcode_list_global(const opcode_list_ty *);
+ *
+ * DESCRIPTION
+ *      The opcode_list_global function is used to determine whether
+ *      executing an opcode list could change state seen by the rest of
+ *      the cookbook: variables, the environment, or options.  Local
+ *      variable assignments do not count.  Lists which ask for the
+ *      dependency graph's file lists are included too, because the
+ *      answer depends on when they are executed.  The bodies of the
+ *      user defined functions the list calls are looked into too.
+ *
+ * RETURNS
+ *      int; non-zero if it could, zero if not.
+ */
+
+int
+opcode_list_global(const opcode_list_ty *olp)
+{
+    string_list_ty  seen;
+    int             result;
+
+    string_list_constructor(&seen);
+    result = list_global(olp, &seen);
+    string_list_destructor(&seen);
+    return result;
+}
+
+
 /*
  * NAME
  *      opcode_list_run
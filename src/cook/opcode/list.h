@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -43,6 +43,7 @@ opcode_list_ty *opcode_list_copy(opcode_list_ty *);
 void opcode_list_delete(opcode_list_ty *);
 void opcode_list_append(opcode_list_ty *, struct opcode_ty *);
 void opcode_list_disassemble(opcode_list_ty *);
+int opcode_list_global(const opcode_list_ty *);
 
 struct string_list_ty *opcode_list_run(opcode_list_ty *,
         const struct match_ty *);
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 1999, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1997, 1999, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -195,3 +195,28 @@ opcode_string_new(string_ty *s, const expr_position_ty *pp)
     trace(("}\n"));
     return op;
 }
+
+
+/*
+ * NAME
+ *      opcode_string_value
+ *
+ * SYNOPSIS
+ *      string_ty *opcode_string_value(const opcode_ty *);
+ *
+ * DESCRIPTION
+ *      The opcode_string_value function is used to get the string
+ *      pushed by a string opcode.
+ *
+ * RETURNS
+ *      string_ty *; the string, or NULL if the opcode is not a string
+ *      opcode.  Do not free it.
+ */
+
+string_ty *
+opcode_string_value(const opcode_ty *op)
+{
+    if (op->method != &method)
+        return 0;
+    return ((const opcode_string_ty *)op)->value;
+}
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -27,5 +27,6 @@ struct expr_position_ty; /* existence */
 
 opcode_ty *opcode_string_new(struct string_ty *,
         const struct expr_position_ty *);
+struct string_ty *opcode_string_value(const opcode_ty *);
 
 #endif /* COOK_OPCODE_STRING_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-2009 Peter Miller
+ *      Copyright (C) 1993-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -495,6 +495,9 @@ option_number_name(option_number_ty o)
     case OPTION_CTIME:
         return "OPTION_CTIME";
 
+    case OPTION_DEPFILE:
+        return "OPTION_DEPFILE";
+
     case OPTION_DISASSEMBLE:
         return "OPTION_DISASSEMBLE";
 
@@ -516,6 +519,9 @@ option_number_name(option_number_ty o)
     case OPTION_GATEFIRST:
         return "OPTION_GATEFIRST";
 
+    case OPTION_GROUP_OUTPUT:
+        return "OPTION_GROUP_OUTPUT";
+
     case OPTION_IMPLICIT_ALLOWED:
         return "OPTION_IMPLICIT_ALLOWED";
 
@@ -543,9 +549,15 @@ option_number_name(option_number_ty o)
     case OPTION_PERSEVERE:
         return "OPTION_PERSEVERE";
 
+    case OPTION_PIPELINE:
+        return "OPTION_PIPELINE";
+
     case OPTION_PRECIOUS:
         return "OPTION_PRECIOUS";
 
+    case OPTION_PROFILE:
+        return "OPTION_PROFILE";
+
     case OPTION_REASON:
         return "OPTION_REASON";
 
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-1997, 1999, 2001, 2003, 2006-2009 Peter Miller
+ *      Copyright (C) 1993-1997, 1999, 2001, 2003, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -83,6 +83,7 @@ enum option_number_ty
         OPTION_CASCADE,         /* do (not) cascade ingredients */
         OPTION_CMDFILE,         /* generate a command file */
         OPTION_CTIME,           /* use both st_ctime and st_mtime */
+        OPTION_DEPFILE,         /* read the compiler's dependency file */
         OPTION_DISASSEMBLE,     /* undocumented: disassemble opcode lists after
                                    compilation */
         OPTION_ERROK,           /* ignore error returns from commands */
@@ -92,6 +93,8 @@ enum option_number_ty
         OPTION_FORCE,           /* always execute the commands */
         OPTION_GATEFIRST,       /* check the gate conditions on a recipe before
                                    evaluating the ingredients */
+        OPTION_GROUP_OUTPUT,    /* capture each command's output, and write
+                                   it in one piece when it finishes */
         OPTION_IMPLICIT_ALLOWED, /* implicit recipes may be used */
         OPTION_INCLUDE_COOKED,  /* cook the include-cooked include files */
         OPTION_INCLUDE_COOKED_WARNING,  /* warn of include-cooked problems */
@@ -101,7 +104,9 @@ enum option_number_ty
         OPTION_METER,           /* meter each command */
         OPTION_MKDIR,           /* make directories of targets */
         OPTION_PERSEVERE,       /* keep trying if have errors */
+        OPTION_PIPELINE,        /* queue recipes while the graph is built */
         OPTION_PRECIOUS,        /* do not delete failed targets */
+        OPTION_PROFILE,         /* profile recipes while deriving the graph */
         OPTION_REASON,          /* emit inference debugging commentary */
         OPTION_RECURSE,         /* allow target recursion loops */
         OPTION_SHALLOW,         /* recipe targets are to be shallow on
@@ -132,10 +137,12 @@ struct option_ty
         string_list_ty  o_target;
         string_ty       *o_book;
         string_ty       *o_logfile;
+        string_ty       *o_profile;
         string_list_ty  o_search_path;
         string_list_ty  o_vardef;
         int             pairs;
         int             script;
+        int             ninja;
         int             web;
         int             fingerprint_update;
 };
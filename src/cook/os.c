@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1995-2001, 2004, 2006-2009 Peter Miller
+ *      Copyright (C) 1995-2001, 2004, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -771,6 +771,7 @@ os_execute(string_list_ty *args, string_ty *input, int errok)
 
     assert(args);
     assert(args->nstrings > 0);
+    stat_cache_prefetch_discard();
 
     fd = -1;
     if (input)
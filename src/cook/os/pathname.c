@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1999, 2006-2009 Peter Miller
+ *      Copyright (C) 1999, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -32,9 +32,24 @@
 #include <common/str.h>
 #include <common/str_list.h>
 #include <common/sub.h>
+#include <common/symtab.h>
 #include <common/trace.h>
 #include <cook/os_interface.h>
 
+/*
+ * The results of readlink for each path prefix examined so far.  Paths
+ * which exist but are not symbolic links map to the empty string.
+ * Paths which do not exist are not remembered, because they may yet be
+ * created.
+ */
+static symtab_ty *link_cache;
+
+/*
+ * Set when os_pathname had to ask the operating system about a path
+ * prefix, and so may have caused something to be automounted.
+ */
+static int      link_cache_missed;
+
 
 /*
  * NAME
@@ -282,7 +297,9 @@ get_prefix_list(void)
  *      the mount table (obtained through the getmntent api) will be
  *      up-to-date, and contain mount entries with auto mount point prefixes.
  *
- *      We cache, and re-read if this the MOUNTED file changes.
+ *      We cache, and re-read if this the MOUNTED file changes.  The
+ *      MOUNTED file is not even looked at unless os_pathname had to
+ *      look past its own cache.
  *
  * RETURNS
  *      String list of actual automounted mount points.
@@ -303,6 +320,14 @@ get_auto_mount_dirs(string_list_ty *prefix)
     string_ty       *p2;
     struct stat     st2;
 
+    /*
+     * If every prefix of the path was found in the link cache, the
+     * path was resolved before and anything it caused to be
+     * automounted was already in the mount table then.
+     */
+    if (dirs && !link_cache_missed)
+        return dirs;
+
     fp = setmntent(MOUNTED, "r");
     if (!fp)
     {
@@ -477,6 +502,124 @@ remove_automounter_prefix(string_ty *path)
 }
 
 
+/*
+ * NAME
+ *      read_link
+ *
+ * SYNOPSIS
+ *      string_ty *read_link(string_ty *path);
+ *
+ * DESCRIPTION
+ *      The read_link function is used to read the value of a symbolic
+ *      link.  The answer is remembered, so that each directory is only
+ *      asked about once, no matter how many file names it appears in.
+ *
+ * RETURNS
+ *      string_ty *; the content of the symbolic link, or NULL if the
+ *      path is not a symbolic link.  Use str_free when done with it.
+ */
+
+#if defined(S_IFLNK) || defined(S_ISLNK)
+
+static void
+link_cache_reap(void *p)
+{
+    str_free(p);
+}
+
+
+static string_ty *
+read_link(string_ty *path)
+{
+    string_ty       *result;
+    char            pointer[2000];
+    int             nbytes;
+
+    if (link_cache)
+    {
+        result = symtab_query(link_cache, path);
+        if (result)
+            return (result->str_length ? str_copy(result) : 0);
+    }
+    else
+    {
+        link_cache = symtab_alloc(100);
+        link_cache->reap = link_cache_reap;
+    }
+    link_cache_missed = 1;
+
+    nbytes = readlink(path->str_text, pointer, sizeof(pointer) - 1);
+    if (nbytes == 0)
+    {
+        sub_context_ty  *scp;
+
+        scp = sub_context_new();
+        sub_errno_set(scp);
+        sub_var_set_string(scp, "File_Name", path);
+        fatal_intl(scp, i18n("readlink \"$filename\" returned \"\""));
+        /* NOTREACHED */
+    }
+    if (nbytes < 0)
+    {
+        switch (errno)
+        {
+        case EINVAL:
+            /*
+             * exists, but is not a symbolic link
+             */
+            symtab_assign(link_cache, path, str_from_c(""));
+            return 0;
+
+        case ENXIO:
+        case ENOENT:
+        case ENOTDIR:
+            return 0;
+
+        default:
+            {
+                sub_context_ty  *scp;
+
+                scp = sub_context_new();
+                sub_errno_set(scp);
+                sub_var_set_string(scp, "File_Name", path);
+                fatal_intl(scp, i18n("readlink $filename: $errno"));
+                /* NOTREACHED */
+            }
+        }
+    }
+    result = str_n_from_c(pointer, nbytes);
+    symtab_assign(link_cache, path, str_copy(result));
+    return result;
+}
+
+#endif
+
+
+/*
+ * NAME
+ *      os_pathname_cache_clear
+ *
+ * SYNOPSIS
+ *      void os_pathname_cache_clear(void);
+ *
+ * DESCRIPTION
+ *      The os_pathname_cache_clear function is used to forget what
+ *      os_pathname knows about symbolic links.  It must be called
+ *      whenever something (cook itself, or any command it runs) may
+ *      have created a symbolic link or directory.
+ */
+
+void
+os_pathname_cache_clear(void)
+{
+    if (link_cache)
+    {
+        symtab_free(link_cache);
+        link_cache = 0;
+    }
+}
+
+
 /*
  * NAME
  *      os_pathname - determine full file name
@@ -509,8 +652,7 @@ os_pathname(string_ty *path)
     int             found;
 #if defined(S_IFLNK) || defined(S_ISLNK)
     string_list_ty  loop;
-    char            pointer[2000];
-    int             nbytes;
+    string_ty       *content;
     string_ty       *s;
 #endif
     string_ty       *result;
@@ -534,7 +676,10 @@ os_pathname(string_ty *path)
     opos = 0;
     found = 0;
 #if defined(S_IFLNK) || defined(S_ISLNK)
+    link_cache_missed = 0;
     string_list_constructor(&loop);
+#else
+    link_cache_missed = 1;
 #endif
     while (!found)
     {
@@ -613,51 +758,12 @@ os_pathname(string_ty *path)
          */
 #if defined(S_IFLNK) || defined(S_ISLNK)
         s = str_n_from_c(tmp, opos);
-        nbytes = readlink(s->str_text, pointer, sizeof(pointer) - 1);
-        if (nbytes == 0)
-        {
-            sub_context_ty  *scp;
-
-            scp = sub_context_new();
-            sub_errno_set(scp);
-            sub_var_set_string(scp, "File_Name", s);
-            fatal_intl(scp, i18n("readlink \"$filename\" returned \"\""));
-            /* NOTREACHED */
-        }
-        else if (nbytes < 0)
-        {
-            /*
-             * probably not a symbolic link
-             */
-            if
-            (
-                errno != ENXIO
-            &&
-                errno != EINVAL
-            &&
-                errno != ENOENT
-            &&
-                errno != ENOTDIR
-            )
-            {
-                sub_context_ty  *scp;
-
-                scp = sub_context_new();
-                sub_errno_set(scp);
-                sub_var_set_string(scp, "File_Name", s);
-                fatal_intl(scp, i18n("readlink $filename: $errno"));
-                /* NOTREACHED */
-            }
-            str_free(s);
-        }
-        else
+        content = read_link(s);
+        if (content)
         {
             string_ty       *newpath;
 
-            pointer[nbytes] = 0;
-
-            str_free(s);
-            if (pointer[0] == '/')
+            if (content->str_text[0] == '/')
                 tmp[1] = 0;
             else
             {
@@ -666,7 +772,9 @@ os_pathname(string_ty *path)
                 tmp[opos] = 0;
             }
             newpath =
-                str_format("%s/%s/%s", tmp, pointer, path->str_text + ipos);
+                str_format("%s/%s/%s", tmp, content->str_text,
+                    path->str_text + ipos);
+            str_free(content);
             str_free(path);
             path = newpath;
             if (string_list_member(&loop, path))
@@ -682,6 +790,7 @@ os_pathname(string_ty *path)
                 );
                 /* NOTREACHED */
             }
+            str_free(s);
             string_list_append(&loop, path);
             path = newpath;
             ipos = 0;
@@ -689,6 +798,7 @@ os_pathname(string_ty *path)
             found = 0;
             continue;
         }
+        str_free(s);
 #endif
 
         /*
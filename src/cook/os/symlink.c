@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 2007, 2008 Peter Miller
+ *      Copyright (C) 2007, 2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -29,6 +29,11 @@ os_symlink(string_ty *from, string_ty *to, int echo)
 {
     int             err;
 
+    /*
+     * What os_pathname knows about this path is about to be wrong.
+     */
+    os_pathname_cache_clear();
+
     err = symlink(from->str_text, to->str_text);
     if (err)
     {
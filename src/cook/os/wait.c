@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 2000, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 2000, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -26,7 +26,9 @@
 #include <sys/wait.h>
 
 #include <common/mem.h>
+#include <cook/job_output.h>
 #include <cook/os/wait.h>
+#include <cook/os_interface.h>
 #include <common/trace.h>
 
 
@@ -45,6 +47,81 @@ static size_t   length_max;
 static cache_ty *cache;
 
 
+/*
+ * NAME
+ *      system_wait
+ *
+ * SYNOPSIS
+ *      int system_wait(int *status, int options, struct rusage *rusage);
+ *
+ * DESCRIPTION
+ *      The system_wait function is used to ask the system for any
+ *      child which has exited.  While any job's output pipe is open,
+ *      a blocking wait becomes a loop which drains the job pipes
+ *      between non-blocking waits, so that no job can block writing
+ *      to a full pipe while cook waits for it to exit.  Once every
+ *      pipe has closed, the wait blocks in the system as usual.  The
+ *      captured output of a reaped job is written out here, before
+ *      the caller has a chance to say anything about it.
+ *
+ * RETURNS
+ *      As for the system wait4 function.
+ */
+
+static int
+system_wait(int *status, int options, struct rusage *rusage)
+{
+    int             pid;
+
+    for (;;)
+    {
+        int             opt;
+        int             exiting;
+
+        opt = options;
+        exiting = 0;
+        if (job_output_active())
+        {
+            exiting = job_output_service(0);
+            opt |= WNOHANG;
+        }
+#ifdef HAVE_WAIT4
+        pid = wait4(-1, status, opt, rusage);
+#else  /* !HAVE_WAIT4 */
+#ifdef HAVE_WAIT3
+        pid = wait3(status, opt, rusage);
+#else  /* !HAVE_WAIT3 */
+        assert(rusage == 0);
+        pid = waitpid(-1, status, opt);
+#endif /* !HAVE_WAIT3 */
+#endif /* !HAVE_WAIT4 */
+        if (pid != 0 || opt == options)
+            break;
+
+        /*
+         * Nothing has exited yet.  If every pipe has now closed, go
+         * round again and block in the system.  Otherwise wait for a
+         * job to say something, or to close its pipe (usually because
+         * it has exited), but not for long, in case the child has no
+         * pipe.  A job whose pipe has closed is about to be reapable;
+         * check again soon.
+         */
+        if (!job_output_active())
+            continue;
+        job_output_service(exiting ? 1 : 100);
+    }
+    if (pid > 0)
+    {
+        /*
+         * The child may have created symbolic links.
+         */
+        os_pathname_cache_clear();
+        job_output_finished(pid);
+    }
+    return pid;
+}
+
+
 /*
  * NAME
  *      os_wait4
@@ -60,6 +137,10 @@ static cache_ty *cache;
  *
  *      Other os_wait* functions are implemented using os_wait4().
  *
+ *      Whenever a child is reaped, the symbolic links remembered by
+ *      os_pathname are forgotten, because the child may have changed
+ *      them, and any output captured from it is written out.
+ *
  * ARGUMENTS
  *      The pid parameter specifies the set of child processes for which
  *      to wait.  If pid is -1, the call waits for any child process.
@@ -111,17 +192,7 @@ os_wait4(int pid, int *status, int options, struct rusage *rusage)
         else
         {
             trace(("ask the system...\n"));
-#ifdef HAVE_WAIT4
-            pid2 = wait4(-1, status, options, rusage);
-#else  /* !HAVE_WAIT4 */
-#ifdef HAVE_WAIT3
-            pid2 = wait3(status, options, rusage);
-#else  /* !HAVE_WAIT3 */
-            assert(options == 0);
-            assert(rusage == 0);
-            pid2 = wait(status);
-#endif /* !HAVE_WAIT3 */
-#endif /* !HAVE_WAIT4 */
+            pid2 = system_wait(status, options, rusage);
             trace(("return %d;\n", pid2));
             trace(("}\n"));
             return pid2;
@@ -170,17 +241,11 @@ os_wait4(int pid, int *status, int options, struct rusage *rusage)
              * ask the operating system to tell us what happened
              */
             trace(("ask the system...\n"));
-#ifdef HAVE_WAIT4
-            pid2 = wait4(-1, &status2, options, &rusage2);
-#else  /* !HAVE_WAIT4 */
-#ifdef HAVE_WAIT3
-            pid2 = wait3(&status2, options, &rusage2);
-#else  /* !HAVE_WAIT3 */
-            assert(options == 0);
-            assert(rusage == 0);
-            pid2 = wait(&status2);
-#endif /* !HAVE_WAIT3 */
-#endif /* !HAVE_WAIT4 */
+#if defined(HAVE_WAIT3) || defined(HAVE_WAIT4)
+            pid2 = system_wait(&status2, options, &rusage2);
+#else
+            pid2 = system_wait(&status2, options, (struct rusage *)0);
+#endif
             /*
              * Return on -1, for all errors.
              * Return on 0, for the WNOHANG option.
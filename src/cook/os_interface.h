@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1993-1995, 1997-1999, 2001, 2004, 2006-2008 Peter Miller
+ *      Copyright (C) 1993-1995, 1997-1999, 2001, 2004, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -75,6 +75,7 @@ string_ty *os_dirname(string_ty *);
 string_ty *os_dirname_relative(string_ty *);
 string_ty *os_entryname(string_ty *);
 string_ty *os_pathname(string_ty *);
+void os_pathname_cache_clear(void);
 int os_legal_path(string_ty *);
 int os_delete(string_ty *path, int echo);
 int os_clear_stat(string_ty *);
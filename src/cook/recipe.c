@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997-1999, 2006-2009 Peter Miller
+ *      Copyright (C) 1997-1999, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -169,6 +169,7 @@ recipe_constructor(recipe_ty *rp, string_list_ty *target, opcode_list_ty *need1,
 
     strip_dot_list(rp->target);
     rp->inhibit = 0;
+    memset(&rp->profile, 0, sizeof(rp->profile));
 
     /*
      * is it implicit or explicit?
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -39,6 +39,24 @@ struct recipe_ty
         expr_position_ty pos;           /* for tracing and debugging */
         int             implicit;
         int             inhibit;        /* for graph generation */
+
+        /*
+         * What it cost to derive the graph with this recipe.
+         * See cook/graph/stats.c
+         */
+        struct
+        {
+                int     listed;
+                long    match_attempt;
+                long    applicable;
+                long    backtrack;
+                long    failed;
+                long    precondition;
+                long    precondition_rejection;
+                double  time;
+                double  self;
+        }
+                        profile;
 };
 
 recipe_ty *recipe_new(struct string_list_ty *, struct opcode_list_ty *,
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1992-1994, 1997-1999, 2001, 2002, 2006-2009 Peter Miller
+ *      Copyright (C) 1992-1994, 1997-1999, 2001, 2002, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -19,11 +19,14 @@
 
 #include <common/ac/string.h>
 #include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #include <common/error_intl.h>
 #include <common/mem.h>
+#include <common/str_list.h>
 #include <common/symtab.h>
 #include <common/trace.h>
 #include <cook/archive.h>
@@ -31,7 +34,9 @@
 #include <cook/fingerprint/value.h>
 #include <cook/option.h>
 #include <cook/option.h>
+#include <cook/os/wait.h>
 #include <cook/stat.cache.h>
+#include <cook/tempfilename.h>
 
 
 typedef struct cache_ty cache_ty;
@@ -44,6 +49,28 @@ struct cache_ty
 
 static symtab_ty *symtab[2];
 
+/*
+ * The raw results of stat_cache_prefetch are held here until
+ * stat_cache asks for them.  Only the system call is done ahead of
+ * time; the fingerprint processing still happens on demand.
+ */
+typedef struct prefetch_ty prefetch_ty;
+struct prefetch_ty
+{
+    int             errno_value;        /* 0 if the file exists */
+    time_t          mtime;
+    time_t          ctime;
+};
+
+static symtab_ty *prefetch[2];
+
+/*
+ * Prefetching is not worth the cost of the fork()s unless there
+ * is a reasonable number of files per worker.
+ */
+#define PREFETCH_CHUNK 128
+#define PREFETCH_WORKERS_MAX 8
+
 
 /*
  * NAME
@@ -301,6 +328,54 @@ stat_cache_fingerprint(string_ty *path, cache_ty *cp)
 }
 
 
+/*
+ * NAME
+ *      prefetch_take
+ *
+ * SYNOPSIS
+ *      int prefetch_take(string_ty *path, int follow_links,
+ *              struct stat *st, int *err_p);
+ *
+ * DESCRIPTION
+ *      The prefetch_take function is used to claim the result of a
+ *      stat_cache_prefetch for the given file, in place of calling
+ *      stat() or lstat().  The entry is removed once taken.  On success
+ *      the st_mtime and st_ctime members of *st are set, and *err_p is
+ *      set to zero; otherwise *err_p is set to -1 and errno is set.
+ *
+ * RETURNS
+ *      int; non-zero if a prefetched result was found, zero if the
+ *      caller must perform the system call itself.
+ */
+
+static int
+prefetch_take(string_ty *path, int follow_links, struct stat *st, int *err_p)
+{
+    prefetch_ty     *pp;
+    prefetch_ty     data;
+
+    if (!prefetch[follow_links])
+        return 0;
+    pp = symtab_query(prefetch[follow_links], path);
+    if (!pp)
+        return 0;
+    trace(("prefetched stat(\"%s\")\n", path->str_text));
+    data = *pp;
+    symtab_delete(prefetch[follow_links], path);
+    if (data.errno_value)
+    {
+        errno = data.errno_value;
+        *err_p = -1;
+        return 1;
+    }
+    memset(st, 0, sizeof(*st));
+    st->st_mtime = data.mtime;
+    st->st_ctime = data.ctime;
+    *err_p = 0;
+    return 1;
+}
+
+
 /*
  * NAME
  *      stat_cache - stat() with caching
@@ -349,13 +424,16 @@ stat_cache(string_ty *path, cache_ty *cp, int follow_links)
     /*
      * new file, perform stat() for the first time
      */
-    trace(("stat(\"%s\")\n", path->str_text));
+    if (!prefetch_take(path, follow_links, &st, &err))
+    {
+        trace(("stat(\"%s\")\n", path->str_text));
 #if defined(S_IFLNK) || defined(S_ISLNK)
-    if (!follow_links)
-        err = lstat(path->str_text, &st);
-    else
+        if (!follow_links)
+            err = lstat(path->str_text, &st);
+        else
 #endif
-        err = stat(path->str_text, &st);
+            err = stat(path->str_text, &st);
+    }
     if (err && errno == ENOENT)
         err = archive_stat(path, &st);
     if (err)
@@ -724,6 +802,37 @@ stat_cache_set(string_ty *path, time_t when, int fp2)
 }
 
 
+/*
+ * NAME
+ *      stat_cache_prefetch_discard
+ *
+ * SYNOPSIS
+ *      void stat_cache_prefetch_discard(void);
+ *
+ * DESCRIPTION
+ *      The stat_cache_prefetch_discard function is used to forget the
+ *      prefetched results which have not been used yet.  It is called
+ *      before running a command from an expression, which could create
+ *      or remove any file.
+ */
+
+void
+stat_cache_prefetch_discard(void)
+{
+    trace(("stat_cache_prefetch_discard()\n"));
+    if (prefetch[0])
+    {
+        symtab_free(prefetch[0]);
+        prefetch[0] = 0;
+    }
+    if (prefetch[1])
+    {
+        symtab_free(prefetch[1]);
+        prefetch[1] = 0;
+    }
+}
+
+
 void
 stat_cache_clear(string_ty *path)
 {
@@ -732,6 +841,291 @@ stat_cache_clear(string_ty *path)
         symtab_delete(symtab[0], path);
     if (symtab[1])
         symtab_delete(symtab[1], path);
+    if (prefetch[0])
+        symtab_delete(prefetch[0], path);
+    if (prefetch[1])
+        symtab_delete(prefetch[1], path);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      prefetch_worker
+ *
+ * SYNOPSIS
+ *      void prefetch_worker(string_list_ty *slp, size_t lo, size_t hi,
+ *              int fd, int follow_links);
+ *
+ * DESCRIPTION
+ *      The prefetch_worker function is run in a child process.  It
+ *      calls stat() or lstat() for the files slp->string[lo..hi-1] and
+ *      writes the results, in order, to the file descriptor.
+ *
+ *      Errors other than ENOENT and ENOTDIR are recorded as -1, so
+ *      that the parent will repeat the system call at the usual time,
+ *      and issue the usual error message.
+ *
+ * CAVEAT
+ *      This function does not return.  It uses _exit so that the
+ *      parent's stdio buffers and exit handlers are left alone.
+ */
+
+static void
+prefetch_worker(string_list_ty *slp, size_t lo, size_t hi, int fd,
+    int follow_links)
+{
+    prefetch_ty     *buf;
+    size_t          j;
+    char            *cp;
+    size_t          nbytes;
+    struct stat     st;
+    int             err;
+
+    buf = mem_alloc((hi - lo) * sizeof(prefetch_ty));
+    for (j = lo; j < hi; ++j)
+    {
+        prefetch_ty     *pp;
+
+        pp = &buf[j - lo];
+#if defined(S_IFLNK) || defined(S_ISLNK)
+        if (!follow_links)
+            err = lstat(slp->string[j]->str_text, &st);
+        else
+#endif
+            err = stat(slp->string[j]->str_text, &st);
+        if (!err)
+        {
+            pp->errno_value = 0;
+            pp->mtime = st.st_mtime;
+            pp->ctime = st.st_ctime;
+        }
+        else
+        {
+            pp->errno_value =
+                (errno == ENOENT || errno == ENOTDIR ? errno : -1);
+            pp->mtime = 0;
+            pp->ctime = 0;
+        }
+    }
+
+    cp = (char *)buf;
+    nbytes = (hi - lo) * sizeof(prefetch_ty);
+    while (nbytes > 0)
+    {
+        ssize_t         n;
+
+        n = write(fd, cp, nbytes);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            _exit(1);
+        }
+        cp += n;
+        nbytes -= n;
+    }
+    _exit(0);
+}
+
+
+/*
+ * NAME
+ *      prefetch_collect
+ *
+ * SYNOPSIS
+ *      void prefetch_collect(string_list_ty *slp, size_t lo, size_t hi,
+ *              int fd, int follow_links);
+ *
+ * DESCRIPTION
+ *      The prefetch_collect function is used to read back the results
+ *      written by a prefetch_worker, once it has exited successfully,
+ *      and remember them for stat_cache.  A short file means the worker
+ *      failed part way, and all of its results are discarded.
+ */
+
+static void
+prefetch_collect(string_list_ty *slp, size_t lo, size_t hi, int fd,
+    int follow_links)
+{
+    prefetch_ty     *buf;
+    char            *cp;
+    size_t          nbytes;
+    size_t          j;
+
+    buf = mem_alloc((hi - lo) * sizeof(prefetch_ty));
+    cp = (char *)buf;
+    nbytes = (hi - lo) * sizeof(prefetch_ty);
+    if (lseek(fd, (off_t)0, SEEK_SET) != 0)
+        nbytes = 1;
+    while (nbytes > 0)
+    {
+        ssize_t         n;
+
+        n = read(fd, cp, nbytes);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        cp += n;
+        nbytes -= n;
+    }
+    if (nbytes == 0)
+    {
+        for (j = lo; j < hi; ++j)
+        {
+            prefetch_ty     *pp;
+
+            if (buf[j - lo].errno_value < 0)
+                continue;
+            pp = mem_alloc(sizeof(prefetch_ty));
+            *pp = buf[j - lo];
+            symtab_assign(prefetch[follow_links], slp->string[j], pp);
+        }
+    }
+    mem_free(buf);
+}
+
+
+/*
+ * NAME
+ *      stat_cache_prefetch
+ *
+ * SYNOPSIS
+ *      void stat_cache_prefetch(const string_list_ty *paths,
+ *              int follow_links);
+ *
+ * DESCRIPTION
+ *      The stat_cache_prefetch function is used to perform the stat()
+ *      system calls for a large number of files concurrently, ahead
+ *      of when stat_cache will need them.  On cold caches and network
+ *      file systems each stat() can cost a great deal, and doing them
+ *      one at a time makes the build latency bound.
+ *
+ *      Cook is not threaded, so the files are divided among a few
+ *      child processes, each of which writes its results to an
+ *      unlinked temporary file.  Only the raw results are kept;
+ *      fingerprinting and all other processing happen in stat_cache
+ *      when (and if) the file is asked for.
+ *
+ *      This is purely an optimization: if anything goes wrong, the
+ *      affected files are simply left for stat_cache to do the usual
+ *      way, and no error is reported.
+ */
+
+void
+stat_cache_prefetch(const string_list_ty *paths, int follow_links)
+{
+    string_list_ty  todo;
+    size_t          nworkers;
+    size_t          nstarted;
+    size_t          j;
+    int             fd[PREFETCH_WORKERS_MAX];
+    int             pid[PREFETCH_WORKERS_MAX];
+
+    trace(("stat_cache_prefetch(nstrings = %ld, lnk = %d)\n{\n",
+        (long)paths->nstrings, follow_links));
+    follow_links = !!follow_links;
+    if (!symtab[follow_links])
+        init(follow_links);
+    if (!prefetch[follow_links])
+    {
+        prefetch[follow_links] = symtab_alloc(paths->nstrings);
+        prefetch[follow_links]->reap = mem_free;
+    }
+
+    /*
+     * Only ask about files we don't already know about.
+     */
+    string_list_constructor(&todo);
+    for (j = 0; j < paths->nstrings; ++j)
+    {
+        string_ty       *s;
+
+        s = paths->string[j];
+        if (symtab_query(symtab[follow_links], s))
+            continue;
+        if (symtab_query(prefetch[follow_links], s))
+            continue;
+        string_list_append(&todo, s);
+    }
+    nworkers = todo.nstrings / PREFETCH_CHUNK;
+    if (nworkers > PREFETCH_WORKERS_MAX)
+        nworkers = PREFETCH_WORKERS_MAX;
+    trace(("%ld files, %ld workers\n", (long)todo.nstrings, (long)nworkers));
+    if (nworkers < 2)
+    {
+        string_list_destructor(&todo);
+        trace(("}\n"));
+        return;
+    }
+
+    /*
+     * Start the workers.  Each one is given a contiguous slice of
+     * the list, so that files in the same directory tend to be
+     * looked at by the same process.
+     */
+    for (nstarted = 0; nstarted < nworkers; ++nstarted)
+    {
+        string_ty       *fn;
+        size_t          lo;
+        size_t          hi;
+
+        lo = todo.nstrings * nstarted / nworkers;
+        hi = todo.nstrings * (nstarted + 1) / nworkers;
+        fn = temporary_filename();
+        fd[nstarted] = open(fn->str_text, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd[nstarted] < 0)
+        {
+            str_free(fn);
+            break;
+        }
+        unlink(fn->str_text);
+        str_free(fn);
+        pid[nstarted] = fork();
+        if (pid[nstarted] < 0)
+        {
+            close(fd[nstarted]);
+            break;
+        }
+        if (pid[nstarted] == 0)
+            prefetch_worker(&todo, lo, hi, fd[nstarted], follow_links);
+    }
+
+    /*
+     * Wait for the workers, and gather their results.
+     */
+    for (j = 0; j < nstarted; ++j)
+    {
+        int             status;
+
+        for (;;)
+        {
+            int             who;
+
+            who = os_waitpid(pid[j], &status);
+            if (who == pid[j])
+                break;
+            if (who < 0 && errno != EINTR)
+            {
+                status = -1;
+                break;
+            }
+        }
+        if (status == 0)
+        {
+            prefetch_collect
+            (
+                &todo,
+                todo.nstrings * j / nworkers,
+                todo.nstrings * (j + 1) / nworkers,
+                fd[j],
+                follow_links
+            );
+        }
+        close(fd[j]);
+    }
+    string_list_destructor(&todo);
     trace(("}\n"));
 }
 
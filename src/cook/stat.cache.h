@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2006-2009 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -35,4 +35,18 @@ void stat_cache_clear(string_ty *);
   */
 void stat_cache_dump(void);
 
+/**
+  * The stat_cache_prefetch function is used to stat() many files
+  * concurrently, ahead of the stat_cache needing them.  Files which
+  * are already cached are ignored.
+  */
+struct string_list_ty; /* existence */
+void stat_cache_prefetch(const struct string_list_ty *, int follow_links);
+
+/**
+  * The stat_cache_prefetch_discard function is used to forget prefetched
+  * results which have not yet been asked for.
+  */
+void stat_cache_prefetch_discard(void);
+
 #endif /* COOK_STAT_CACHE_H */
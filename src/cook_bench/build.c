@@ -0,0 +1,642 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains the functions used to time cook building a
+ * synthetic project (see cook_bench/project.c).
+ *
+ * Each scenario runs cook as a child process, in the project
+ * directory, with its output going to the bench.log file there.  The
+ * wall clock time is measured here, and the peak resident set size
+ * comes from the child's resource usage.  System call counts come from
+ * strace(1), when the -STRAce option names it, because there is no
+ * portable way to count them from outside the process.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/fcntl.h>
+#include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
+#include <common/ac/time.h>
+#include <common/ac/unistd.h>
+#include <common/ac/utime.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <common/error.h>
+#include <common/mem.h>
+#include <cook_bench/build.h>
+#include <cook_bench/project.h>
+#include <cook_bench/timer.h>
+
+#define LOG_FILE "bench.log"
+#define STRACE_FILE "bench.strace"
+
+typedef struct run_ty run_ty;
+struct run_ty
+{
+    double          elapsed;
+    long            maxrss;
+    int             status;
+};
+
+static FILE     *output;
+
+
+/*
+ * NAME
+ *      build_default
+ *
+ * SYNOPSIS
+ *      void build_default(build_ty *bp);
+ *
+ * DESCRIPTION
+ *      The build_default function is used to fill in the default
+ *      build benchmark options.
+ */
+
+void
+build_default(build_ty *bp)
+{
+    bp->cook = "cook";
+    bp->c_incl = "c_incl";
+    bp->strace = 0;
+    bp->output = 0;
+    bp->parallel = 4;
+    bp->repeat = 3;
+}
+
+
+/*
+ * NAME
+ *      result
+ *
+ * SYNOPSIS
+ *      void result(const char *name, double value, const char *unit);
+ *
+ * DESCRIPTION
+ *      The result function is used to report one measurement, both to
+ *      the standard output for people and to the -Output file, if any,
+ *      as a name, value and unit separated by tabs, for programs.
+ */
+
+static void
+result(const char *name, double value, const char *unit)
+{
+    printf("%-32s %14.3f %s\n", name, value, unit);
+    if (output)
+        fprintf(output, "%s\t%.6f\t%s\n", name, value, unit);
+}
+
+
+/*
+ * NAME
+ *      run
+ *
+ * SYNOPSIS
+ *      void run(const char *dir, char **argv, run_ty *rp);
+ *
+ * DESCRIPTION
+ *      The run function is used to run the command in argv, in the
+ *      given directory, and wait for it to finish.  Its output is
+ *      appended to the log file in that directory.
+ */
+
+static void
+run(const char *dir, char **argv, run_ty *rp)
+{
+    int             pid;
+    int             status;
+    double          start;
+#ifdef HAVE_WAIT4
+    struct rusage   ru;
+#endif
+
+    fflush(stdout);
+    if (output)
+        fflush(output);
+    start = timer_now();
+    pid = fork();
+    if (pid < 0)
+        nfatal_raw("fork");
+    if (pid == 0)
+    {
+        int             fd;
+
+        if (chdir(dir))
+            nfatal_raw("chdir \"%s\"", dir);
+        fd = open(LOG_FILE, O_WRONLY | O_CREAT | O_APPEND, 0666);
+        if (fd < 0)
+            nfatal_raw("open \"%s/%s\"", dir, LOG_FILE);
+        dup2(fd, 1);
+        dup2(fd, 2);
+        close(fd);
+        execvp(argv[0], argv);
+        nfatal_raw("exec \"%s\"", argv[0]);
+    }
+    for (;;)
+    {
+#ifdef HAVE_WAIT4
+        if (wait4(pid, &status, 0, &ru) == pid)
+            break;
+#else
+        if (waitpid(pid, &status, 0) == pid)
+            break;
+#endif
+        if (errno != EINTR)
+            nfatal_raw("wait");
+    }
+    rp->elapsed = timer_now() - start;
+#ifdef HAVE_WAIT4
+    rp->maxrss = ru.ru_maxrss;
+#else
+    rp->maxrss = 0;
+#endif
+    rp->status = status;
+}
+
+
+/*
+ * NAME
+ *      cook_run
+ *
+ * SYNOPSIS
+ *      void cook_run(const char *dir, const build_ty *bp,
+ *              const char *flag, const char *name, int repeat);
+ *
+ * DESCRIPTION
+ *      The cook_run function is used to run cook in the project
+ *      directory, with an optional extra flag, and report the best
+ *      time of several runs, and the peak resident set size.  It is a
+ *      fatal error for cook to fail, because the following scenarios
+ *      would measure nonsense.
+ */
+
+static void
+cook_run(const char *dir, const build_ty *bp, const char *flag,
+    const char *name, int repeat)
+{
+    char            *argv[9];
+    char            jobs[20];
+    char            c_incl[1000];
+    char            buf[100];
+    int             argc;
+    int             j;
+    run_ty          r;
+    double          best;
+    long            maxrss;
+
+    snprintf(jobs, sizeof(jobs), "%ld", bp->parallel);
+    snprintf(c_incl, sizeof(c_incl), "c_incl=%s", bp->c_incl);
+    argc = 0;
+    argv[argc++] = (char *)bp->cook;
+    argv[argc++] = "-No_LOg";
+
+    /*
+     * The fake compiler is fast, so targets are often written in the
+     * same second as their ingredients, which cook's strict edges
+     * would see as out of date next time.  Have cook adjust the time
+     * stamps, so that a finished build stays finished.
+     */
+    argv[argc++] = "-Update";
+    argv[argc++] = "-Jobs";
+    argv[argc++] = jobs;
+    argv[argc++] = c_incl;
+    if (flag)
+        argv[argc++] = (char *)flag;
+    argv[argc] = 0;
+
+    best = 0;
+    maxrss = 0;
+    for (j = 0; j < repeat; ++j)
+    {
+        run(dir, argv, &r);
+        if (r.status)
+        {
+            fatal_raw
+            (
+                "%s: %s failed (exit status 0x%04X), see %s/%s",
+                name,
+                bp->cook,
+                r.status,
+                dir,
+                LOG_FILE
+            );
+        }
+        if (j == 0 || r.elapsed < best)
+            best = r.elapsed;
+        if (r.maxrss > maxrss)
+            maxrss = r.maxrss;
+    }
+    snprintf(buf, sizeof(buf), "%s.time", name);
+    result(buf, best, "sec");
+    snprintf(buf, sizeof(buf), "%s.maxrss", name);
+    result(buf, maxrss, "KiB");
+}
+
+
+/*
+ * NAME
+ *      touch
+ *
+ * SYNOPSIS
+ *      void touch(const char *dir, const char *file);
+ *
+ * DESCRIPTION
+ *      The touch function is used to make a project file newer than
+ *      everything built from it.  Cook's time stamps have a one second
+ *      resolution, so it waits until the clock moves first.
+ */
+
+static void
+touch(const char *dir, const char *file)
+{
+    char            path[1000];
+    FILE            *fp;
+
+    sleep(1);
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    fp = fopen(path, "a");
+    if (!fp)
+        nfatal_raw("open \"%s\"", path);
+    fprintf(fp, "/* touched */\n");
+    if (fclose(fp))
+        nfatal_raw("close \"%s\"", path);
+}
+
+
+/*
+ * NAME
+ *      strace_count
+ *
+ * SYNOPSIS
+ *      void strace_count(const char *dir, const build_ty *bp);
+ *
+ * DESCRIPTION
+ *      The strace_count function is used to run cook under strace(1)
+ *      for a full build, and report the number of system calls made by
+ *      cook itself and by c_incl.  Each line of the trace names the
+ *      process; the program a process is running is the last one it
+ *      execve'd.  Lines for calls resumed after another process's line,
+ *      and signal and exit notices, are not calls.
+ */
+
+static void
+strace_count(const char *dir, const build_ty *bp)
+{
+    typedef struct pid_ty pid_ty;
+    struct pid_ty
+    {
+        long            pid;
+        char            name[64];
+        long            count;
+    };
+
+    char            *argv[13];
+    char            jobs[20];
+    char            c_incl[1000];
+    char            path[1000];
+    char            line[4096];
+    int             argc;
+    run_ty          r;
+    FILE            *fp;
+    pid_ty          *table;
+    size_t          table_length;
+    size_t          table_max;
+    size_t          j;
+    long            n_cook;
+    long            n_c_incl;
+    long            n_total;
+    const char      *cook_base;
+    const char      *c_incl_base;
+
+    project_clean(dir);
+    snprintf(jobs, sizeof(jobs), "%ld", bp->parallel);
+    snprintf(c_incl, sizeof(c_incl), "c_incl=%s", bp->c_incl);
+    argc = 0;
+    argv[argc++] = (char *)bp->strace;
+    argv[argc++] = "-f";
+    argv[argc++] = "-qq";
+    argv[argc++] = "-o";
+    argv[argc++] = STRACE_FILE;
+    argv[argc++] = (char *)bp->cook;
+    argv[argc++] = "-No_LOg";
+    argv[argc++] = "-Jobs";
+    argv[argc++] = jobs;
+    argv[argc++] = c_incl;
+    argv[argc] = 0;
+    run(dir, argv, &r);
+    if (r.status)
+    {
+        fatal_raw
+        (
+            "strace: %s failed (exit status 0x%04X), see %s/%s",
+            bp->strace,
+            r.status,
+            dir,
+            LOG_FILE
+        );
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", dir, STRACE_FILE);
+    fp = fopen(path, "r");
+    if (!fp)
+        nfatal_raw("open \"%s\"", path);
+    table = 0;
+    table_length = 0;
+    table_max = 0;
+    n_total = 0;
+    while (fgets(line, sizeof(line), fp))
+    {
+        char            *cp;
+        long            pid;
+        pid_ty          *pp;
+
+        pid = strtol(line, &cp, 10);
+        while (*cp == ' ')
+            ++cp;
+        if
+        (
+            !strncmp(cp, "<...", 4)
+        ||
+            !strncmp(cp, "+++", 3)
+        ||
+            !strncmp(cp, "---", 3)
+        )
+            continue;
+        ++n_total;
+
+        pp = 0;
+        for (j = 0; j < table_length; ++j)
+        {
+            if (table[j].pid == pid)
+            {
+                pp = &table[j];
+                break;
+            }
+        }
+        if (!pp)
+        {
+            if (table_length >= table_max)
+            {
+                table_max = table_max * 2 + 16;
+                table =
+                    mem_change_size(table, table_max * sizeof(table[0]));
+            }
+            pp = &table[table_length++];
+            pp->pid = pid;
+            pp->name[0] = 0;
+            pp->count = 0;
+
+            /*
+             * The first process is cook itself, once strace has
+             * exec'd it; the others start as forks of their parent,
+             * so count them as nothing in particular until they exec.
+             */
+            if (table_length == 1)
+                snprintf(pp->name, sizeof(pp->name), "%s", bp->cook);
+        }
+        if (!strncmp(cp, "execve(\"", 8))
+        {
+            char            *name;
+            char            *end;
+
+            name = cp + 8;
+            end = strchr(name, '"');
+            if (end)
+            {
+                *end = 0;
+                snprintf(pp->name, sizeof(pp->name), "%s", name);
+            }
+        }
+        ++pp->count;
+    }
+    fclose(fp);
+    unlink(path);
+
+    cook_base = strrchr(bp->cook, '/');
+    cook_base = cook_base ? cook_base + 1 : bp->cook;
+    c_incl_base = strrchr(bp->c_incl, '/');
+    c_incl_base = c_incl_base ? c_incl_base + 1 : bp->c_incl;
+    n_cook = 0;
+    n_c_incl = 0;
+    for (j = 0; j < table_length; ++j)
+    {
+        const char      *base;
+
+        base = strrchr(table[j].name, '/');
+        base = base ? base + 1 : table[j].name;
+        if (!strcmp(base, cook_base))
+            n_cook += table[j].count;
+        else if (!strcmp(base, c_incl_base))
+            n_c_incl += table[j].count;
+    }
+    if (table)
+        mem_free(table);
+    result("full.syscalls.cook", n_cook, "calls");
+    result("full.syscalls.c_incl", n_c_incl, "calls");
+    result("full.syscalls.total", n_total, "calls");
+}
+
+
+/*
+ * NAME
+ *      c_incl_run
+ *
+ * SYNOPSIS
+ *      void c_incl_run(const char *dir, const build_ty *bp);
+ *
+ * DESCRIPTION
+ *      The c_incl_run function is used to time c_incl on its own,
+ *      finding the dependencies of one source file, the same way the
+ *      cookbook does.
+ */
+
+static void
+c_incl_run(const char *dir, const build_ty *bp)
+{
+    char            *argv[8];
+    run_ty          r;
+    double          best;
+    long            maxrss;
+    int             j;
+
+    argv[0] = (char *)bp->c_incl;
+    argv[1] = "-nc";
+    argv[2] = "-ns";
+    argv[3] = "-Iinclude";
+    argv[4] = "d000/s00000.c";
+    argv[5] = "-o";
+    argv[6] = "/dev/null";
+    argv[7] = 0;
+    best = 0;
+    maxrss = 0;
+    for (j = 0; j < bp->repeat; ++j)
+    {
+        run(dir, argv, &r);
+        if (r.status)
+        {
+            fatal_raw
+            (
+                "%s failed (exit status 0x%04X), see %s/%s",
+                bp->c_incl,
+                r.status,
+                dir,
+                LOG_FILE
+            );
+        }
+        if (j == 0 || r.elapsed < best)
+            best = r.elapsed;
+        if (r.maxrss > maxrss)
+            maxrss = r.maxrss;
+    }
+    result("c_incl.time", best, "sec");
+    result("c_incl.maxrss", maxrss, "KiB");
+}
+
+
+/*
+ * NAME
+ *      touch_all
+ *
+ * SYNOPSIS
+ *      void touch_all(const char *dir);
+ *
+ * DESCRIPTION
+ *      The touch_all function is used to make every source file in the
+ *      project out of date, by changing its modification time only.
+ */
+
+static void
+touch_all(const char *dir)
+{
+    char            path[1000];
+    long            ndirs;
+    long            n;
+    struct stat     st;
+    struct utimbuf  ut;
+
+    for (ndirs = 0; ; ++ndirs)
+    {
+        snprintf(path, sizeof(path), "%s/d%03ld", dir, ndirs);
+        if (stat(path, &st))
+            break;
+    }
+    if (ndirs < 1)
+        return;
+
+    sleep(1);
+    ut.actime = time((time_t *)0);
+    ut.modtime = ut.actime;
+    for (n = 0; ; ++n)
+    {
+        snprintf
+        (
+            path,
+            sizeof(path),
+            "%s/d%03ld/s%05ld.c",
+            dir,
+            n % ndirs,
+            n
+        );
+        if (stat(path, &st))
+            break;
+        if (utime(path, &ut))
+            nfatal_raw("utime \"%s\"", path);
+    }
+}
+
+
+/*
+ * NAME
+ *      bench_build
+ *
+ * SYNOPSIS
+ *      void bench_build(const char *dir, const build_ty *bp);
+ *
+ * DESCRIPTION
+ *      The bench_build function is used to time cook building the
+ *      synthetic project in the given directory, in each of the
+ *      scenarios people care about:
+ *
+ *      full            a full parallel build, from clean
+ *      noop            nothing to do (best of -Repeat runs)
+ *      touch_source    one source file changed
+ *      touch_header    the header every other header includes changed
+ *      graph           deriving the graph, with everything out of
+ *                      date, but not running any recipes
+ *
+ *      and then the c_incl and system call measurements.
+ */
+
+void
+bench_build(const char *dir, const build_ty *bp)
+{
+    char            path[1000];
+    time_t          newest;
+
+    if (bp->output)
+    {
+        output = fopen(bp->output, "w");
+        if (!output)
+            nfatal_raw("open \"%s\"", bp->output);
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, LOG_FILE);
+    unlink(path);
+
+    project_clean(dir);
+    cook_run(dir, bp, (char *)0, "full", 1);
+
+    /*
+     * Cook's time stamps have a one second resolution.  Wait for
+     * the clock to move, so that the noop runs cannot start in the
+     * same second the full build finished in, and check that they
+     * really did find nothing to do.
+     */
+    sleep(1);
+    newest = project_newest(dir);
+    cook_run(dir, bp, (char *)0, "noop", bp->repeat);
+    if (project_newest(dir) != newest)
+    {
+        fatal_raw
+        (
+            "noop: %s ran recipes when there was nothing to do, see %s/%s",
+            bp->cook,
+            dir,
+            LOG_FILE
+        );
+    }
+    touch(dir, "d000/s00000.c");
+    cook_run(dir, bp, (char *)0, "touch_source", 1);
+    touch(dir, "include/h00000.h");
+    cook_run(dir, bp, (char *)0, "touch_header", 1);
+    touch_all(dir);
+    cook_run(dir, bp, "-No_Action", "graph", 1);
+    c_incl_run(dir, bp);
+    if (bp->strace)
+        strace_count(dir, bp);
+
+    if (output)
+    {
+        if (fflush(output) || ferror(output))
+            nfatal_raw("write \"%s\"", bp->output);
+        fclose(output);
+        output = 0;
+    }
+}
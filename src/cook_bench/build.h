@@ -0,0 +1,39 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_BENCH_BUILD_H
+#define COOK_BENCH_BUILD_H
+
+#include <common/main.h>
+
+typedef struct build_ty build_ty;
+struct build_ty
+{
+    const char      *cook;
+    const char      *c_incl;
+    const char      *strace;
+    const char      *output;
+    long            parallel;
+    long            repeat;
+};
+
+void build_default(build_ty *);
+void bench_build(const char *dir, const build_ty *);
+
+#endif /* COOK_BENCH_BUILD_H */
@@ -0,0 +1,105 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/stdio.h>
+#include <common/ac/string.h>
+
+#include <common/error.h>
+#include <common/mem.h>
+#include <cook_bench/corpus.h>
+
+
+/*
+ * NAME
+ *      corpus_read
+ *
+ * SYNOPSIS
+ *      corpus_ty *corpus_read(const char *filename);
+ *
+ * DESCRIPTION
+ *      The corpus_read function is used to read a benchmark corpus, one
+ *      item per line.  Typically this is a list of path names produced
+ *      by find(1), so that the benchmark sees the same shape of data as
+ *      cook does on a real tree.  The file name "-" means the standard
+ *      input.  Empty lines are ignored.
+ *
+ * RETURNS
+ *      corpus_ty *; use corpus_delete when you are done with it.
+ */
+
+corpus_ty *
+corpus_read(const char *filename)
+{
+    corpus_ty       *cp;
+    FILE            *fp;
+    char            buffer[4096];
+
+    if (!filename || !strcmp(filename, "-"))
+        fp = stdin;
+    else
+    {
+        fp = fopen(filename, "r");
+        if (!fp)
+            nfatal_raw("open \"%s\"", filename);
+    }
+
+    cp = mem_alloc(sizeof(corpus_ty));
+    cp->nlines = 0;
+    cp->nlines_max = 0;
+    cp->line = 0;
+    cp->nbytes = 0;
+    while (fgets(buffer, sizeof(buffer), fp))
+    {
+        size_t          len;
+
+        len = strlen(buffer);
+        while (len > 0 && buffer[len - 1] == '\n')
+            buffer[--len] = 0;
+        if (!len)
+            continue;
+        if (cp->nlines >= cp->nlines_max)
+        {
+            cp->nlines_max = cp->nlines_max * 2 + 1024;
+            cp->line =
+                mem_change_size(cp->line, cp->nlines_max * sizeof(char *));
+        }
+        cp->line[cp->nlines++] = mem_copy_string(buffer);
+        cp->nbytes += len;
+    }
+    if (ferror(fp))
+        nfatal_raw("read \"%s\"", filename ? filename : "-");
+    if (fp != stdin)
+        fclose(fp);
+    if (!cp->nlines)
+        fatal_raw("corpus \"%s\" is empty", filename ? filename : "-");
+    return cp;
+}
+
+
+void
+corpus_delete(corpus_ty *cp)
+{
+    size_t          j;
+
+    for (j = 0; j < cp->nlines; ++j)
+        mem_free(cp->line[j]);
+    if (cp->line)
+        mem_free(cp->line);
+    mem_free(cp);
+}
@@ -0,0 +1,38 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_BENCH_CORPUS_H
+#define COOK_BENCH_CORPUS_H
+
+#include <common/ac/stddef.h>
+#include <common/main.h>
+
+typedef struct corpus_ty corpus_ty;
+struct corpus_ty
+{
+        size_t          nlines;
+        size_t          nlines_max;
+        char            **line;
+        size_t          nbytes;
+};
+
+corpus_ty *corpus_read(const char *filename);
+void corpus_delete(corpus_ty *);
+
+#endif /* COOK_BENCH_CORPUS_H */
@@ -0,0 +1,234 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/ctype.h>
+#include <common/ac/stdio.h>
+
+#include <common/input/file_text.h>
+#include <common/input/lines.h>
+#include <common/mem.h>
+#include <common/str.h>
+#include <cook_bench/corpus.h>
+#include <cook_bench/lines.h>
+#include <cook_bench/timer.h>
+
+
+/*
+ * NAME
+ *      scan_by_char
+ *
+ * SYNOPSIS
+ *      long scan_by_char(input_ty *fp);
+ *
+ * DESCRIPTION
+ *      The scan_by_char function is used to count the C preprocessor
+ *      directives in a file, reading it a character at a time and
+ *      collecting every line, the way the c_incl scanners used to.
+ *      It is the baseline for comparison.
+ */
+
+static long
+scan_by_char(input_ty *fp)
+{
+    size_t          pos;
+    size_t          max;
+    char            *line;
+    char            *cp;
+    long            count;
+    int             c;
+
+    pos = 0;
+    max = 100;
+    line = mem_alloc(max);
+    count = 0;
+    for (;;)
+    {
+        if (pos >= max)
+        {
+            max += 80;
+            line = mem_change_size(line, max);
+        }
+        c = input_getc(fp);
+        if (c == INPUT_EOF && !pos)
+            break;
+        if (c == INPUT_EOF || c == '\n')
+        {
+            line[pos] = 0;
+            pos = 0;
+            for (cp = line; isspace((unsigned char)*cp); ++cp)
+                ;
+            if (*cp == '#')
+                ++count;
+            continue;
+        }
+        line[pos++] = c;
+    }
+    mem_free(line);
+    return count;
+}
+
+
+/*
+ * NAME
+ *      scan_by_block
+ *
+ * SYNOPSIS
+ *      long scan_by_block(input_ty *fp);
+ *
+ * DESCRIPTION
+ *      The scan_by_block function is used to count the C preprocessor
+ *      directives in a file, using input_lines, the way the c_incl
+ *      scanners do now.
+ */
+
+static long
+scan_by_block(input_ty *fp)
+{
+    input_lines_ty  *ilp;
+    long            count;
+
+    ilp = input_lines_new(fp, "#", 1);
+    count = 0;
+    while (input_lines_next(ilp))
+        ++count;
+    input_lines_delete(ilp);
+    return count;
+}
+
+
+/*
+ * NAME
+ *      scan_corpus
+ *
+ * SYNOPSIS
+ *      long scan_corpus(corpus_ty *cp, long (*scan)(input_ty *),
+ *              long repeat);
+ *
+ * DESCRIPTION
+ *      The scan_corpus function is used to apply a scanner to every
+ *      file named in the corpus, repeat times over.
+ *
+ * RETURNS
+ *      long; the number of directives found on a single pass
+ */
+
+static long
+scan_corpus(corpus_ty *cp, long (*scan)(input_ty *), long repeat)
+{
+    long            r;
+    size_t          j;
+    long            count;
+
+    count = 0;
+    for (r = 0; r < repeat; ++r)
+    {
+        count = 0;
+        for (j = 0; j < cp->nlines; ++j)
+        {
+            string_ty       *fn;
+            input_ty        *fp;
+
+            fn = str_from_c(cp->line[j]);
+            fp = input_file_text_open(fn);
+            count += scan(fp);
+            input_delete(fp);
+            str_free(fn);
+        }
+    }
+    return count;
+}
+
+
+/*
+ * NAME
+ *      bench_lines
+ *
+ * SYNOPSIS
+ *      void bench_lines(const char *corpus, long repeat);
+ *
+ * DESCRIPTION
+ *      The bench_lines function is used to measure the throughput of
+ *      the c_incl line scanning, on a corpus of file names (typically
+ *      C source and header files).  The character at a time scanner
+ *      and the block scanner are both run, and must agree on the
+ *      number of directives found.
+ */
+
+void
+bench_lines(const char *corpus, long repeat)
+{
+    corpus_ty       *cp;
+    size_t          j;
+    double          nbytes;
+    double          start;
+    long            by_char;
+    long            by_block;
+
+    cp = corpus_read(corpus);
+    nbytes = 0;
+    for (j = 0; j < cp->nlines; ++j)
+    {
+        FILE            *fp;
+
+        fp = fopen(cp->line[j], "rb");
+        if (!fp)
+            continue;
+        fseek(fp, 0L, SEEK_END);
+        nbytes += ftell(fp);
+        fclose(fp);
+    }
+    printf
+    (
+        "corpus: %ld files, %.0f bytes\n",
+        (long)cp->nlines,
+        nbytes
+    );
+
+    /*
+     * Run each once before timing, so that both see a warm
+     * buffer cache.
+     */
+    by_char = scan_corpus(cp, scan_by_char, 1);
+    by_block = scan_corpus(cp, scan_by_block, 1);
+    printf("directives: %ld by char, %ld by block\n", by_char, by_block);
+    if (by_char != by_block)
+        printf("WARNING: the scanners disagree\n");
+
+    start = timer_now();
+    scan_corpus(cp, scan_by_char, repeat);
+    timer_report
+    (
+        "scan by char",
+        timer_now() - start,
+        repeat * nbytes,
+        "byte"
+    );
+
+    start = timer_now();
+    scan_corpus(cp, scan_by_block, repeat);
+    timer_report
+    (
+        "scan by block",
+        timer_now() - start,
+        repeat * nbytes,
+        "byte"
+    );
+
+    corpus_delete(cp);
+}
@@ -0,0 +1,386 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+
+#include <common/arglex.h>
+#include <common/error.h>
+#include <common/error_intl.h>
+#include <common/help.h>
+#include <common/progname.h>
+#include <common/str.h>
+#include <common/str_list.h>
+#include <common/version.h>
+#include <cook_bench/build.h>
+#include <cook_bench/lines.h>
+#include <cook_bench/match.h>
+#include <cook_bench/project.h>
+#include <cook_bench/str.h>
+
+
+enum
+{
+    arglex_token_build,
+    arglex_token_c_incl,
+    arglex_token_cook,
+    arglex_token_depfiles,
+    arglex_token_depfiles_not,
+    arglex_token_directories,
+    arglex_token_fake_compiler,
+    arglex_token_fan_out,
+    arglex_token_generate,
+    arglex_token_headers,
+    arglex_token_line_scan,
+    arglex_token_output,
+    arglex_token_parallel,
+    arglex_token_pattern_match,
+    arglex_token_recipes,
+    arglex_token_repeat,
+    arglex_token_sleep,
+    arglex_token_sources,
+    arglex_token_strace,
+    arglex_token_string_pool
+};
+
+static arglex_table_ty argtab[] =
+{
+    { "-Build", arglex_token_build },
+    { "-C_Incl", arglex_token_c_incl },
+    { "-COOK", arglex_token_cook },
+    { "-Depfiles", arglex_token_depfiles },
+    { "-No_Depfiles", arglex_token_depfiles_not },
+    { "-DIRectories", arglex_token_directories },
+    { "-Fake_Compiler", arglex_token_fake_compiler },
+    { "-Fan_Out", arglex_token_fan_out },
+    { "-Generate", arglex_token_generate },
+    { "-HEADers", arglex_token_headers },
+    { "-Line_Scan", arglex_token_line_scan },
+    { "-Output", arglex_token_output },
+    { "-PARallel", arglex_token_parallel },
+    { "-Pattern_Match", arglex_token_pattern_match },
+    { "-RECipes", arglex_token_recipes },
+    { "-Repeat", arglex_token_repeat },
+    { "-SLeep", arglex_token_sleep },
+    { "-SOurces", arglex_token_sources },
+    { "-STRAce", arglex_token_strace },
+    { "-STRing_Pool", arglex_token_string_pool },
+    { 0, 0 } /* end marker */
+};
+
+
+static void
+usage(void)
+{
+    char            *prog;
+
+    prog = progname_get();
+    fprintf(stderr, "Usage: %s [ -Repeat <n> ] <benchmark>...\n", prog);
+    fprintf(stderr, "where <benchmark> is one of\n");
+    fprintf(stderr, "       -Line_Scan <corpus>\n");
+    fprintf(stderr, "       -Pattern_Match <corpus>\n");
+    fprintf(stderr, "       -STRing_Pool <corpus>\n");
+    fprintf(stderr, "       [ <shape>... ] -Generate <directory>\n");
+    fprintf(stderr, "       [ <build>... ] -Build <directory>\n");
+    fprintf(stderr, "where <shape> is one of\n");
+    fprintf(stderr, "       -SOurces <n>\n");
+    fprintf(stderr, "       -HEADers <n>\n");
+    fprintf(stderr, "       -Fan_Out <n>\n");
+    fprintf(stderr, "       -DIRectories <n>\n");
+    fprintf(stderr, "       -RECipes <n>\n");
+    fprintf(stderr, "       -SLeep <msec>\n");
+    fprintf(stderr, "       -[No_]Depfiles\n");
+    fprintf(stderr, "and <build> is one of\n");
+    fprintf(stderr, "       -COOK <program>\n");
+    fprintf(stderr, "       -C_Incl <program>\n");
+    fprintf(stderr, "       -PARallel <n>\n");
+    fprintf(stderr, "       -STRAce <program>\n");
+    fprintf(stderr, "       -Output <file>\n");
+    fprintf(stderr, "       %s -Help\n", prog);
+    fprintf(stderr, "       %s -VERSion\n", prog);
+    exit(1);
+}
+
+
+/*
+ * NAME
+ *      absolute
+ *
+ * SYNOPSIS
+ *      const char *absolute(const char *path);
+ *
+ * DESCRIPTION
+ *      The absolute function is used to turn a relative program path
+ *      into an absolute one, because the build benchmark runs its
+ *      programs in the project directory.  Names without a slash are
+ *      left alone, to be found on the search path.
+ */
+
+static const char *
+absolute(const char *path)
+{
+    char            cwd[1000];
+    string_ty       *s;
+
+    if (!strchr(path, '/') || path[0] == '/')
+        return path;
+    if (!getcwd(cwd, sizeof(cwd)))
+        nfatal_raw("getcwd");
+    s = str_format("%s/%s", cwd, path);
+    return s->str_text;
+}
+
+
+static long
+number_argument(int token)
+{
+    if (arglex() != arglex_token_number)
+        arg_needs_number(token, usage);
+    return arglex_value.alv_number;
+}
+
+
+static const char *
+string_argument(int token)
+{
+    if (arglex() != arglex_token_string)
+        arg_needs_string(token, usage);
+    return arglex_value.alv_string;
+}
+
+
+/*
+ * NAME
+ *      fake_compiler
+ *
+ * SYNOPSIS
+ *      void fake_compiler(void);
+ *
+ * DESCRIPTION
+ *      The fake_compiler function is used to parse the rest of the
+ *      command line when the synthetic project's cookbook runs this
+ *      program as its compiler.
+ */
+
+static void
+fake_compiler(void)
+{
+    long            msec;
+    string_list_ty  args;
+    string_ty       *s;
+
+    msec = number_argument(arglex_token_fake_compiler);
+    string_list_constructor(&args);
+    while (arglex() != arglex_token_eoln)
+    {
+        if (arglex_token != arglex_token_string)
+            usage();
+        s = str_from_c(arglex_value.alv_string);
+        string_list_append(&args, s);
+        str_free(s);
+    }
+    project_fake_compiler(msec, &args);
+    string_list_destructor(&args);
+}
+
+
+int
+main(int argc, char **argv)
+{
+    long            repeat;
+    int             nbench;
+    project_ty      shape;
+    build_ty        build;
+
+    arglex_init(argc, argv, argtab);
+    str_initialize();
+    switch (arglex())
+    {
+    case arglex_token_help:
+        help((char *)0, usage);
+        exit(0);
+
+    case arglex_token_version:
+        version();
+        exit(0);
+
+    case arglex_token_fake_compiler:
+        fake_compiler();
+        exit(0);
+
+    default:
+        break;
+    }
+
+    /*
+     * The benchmarks are run in the order they are named on the
+     * command line, so the -Repeat option must come first, and the
+     * project shape and build options must come before -Generate and
+     * -Build.
+     */
+    repeat = 10;
+    nbench = 0;
+    project_default(&shape);
+    shape.bench = absolute(argv[0]);
+    build_default(&build);
+    while (arglex_token != arglex_token_eoln)
+    {
+        switch (arglex_token)
+        {
+        default:
+            generic_argument(usage);
+            continue;
+
+        case arglex_token_repeat:
+            if (arglex() != arglex_token_number)
+                arg_needs_number(arglex_token_repeat, usage);
+            repeat = arglex_value.alv_number;
+            if (repeat < 1)
+                repeat = 1;
+            build.repeat = repeat;
+            break;
+
+        case arglex_token_sources:
+            shape.sources = number_argument(arglex_token_sources);
+            break;
+
+        case arglex_token_headers:
+            shape.headers = number_argument(arglex_token_headers);
+            break;
+
+        case arglex_token_fan_out:
+            shape.fan_out = number_argument(arglex_token_fan_out);
+            break;
+
+        case arglex_token_directories:
+            shape.directories = number_argument(arglex_token_directories);
+            break;
+
+        case arglex_token_recipes:
+            shape.recipes = number_argument(arglex_token_recipes);
+            break;
+
+        case arglex_token_sleep:
+            shape.sleep = number_argument(arglex_token_sleep);
+            break;
+
+        case arglex_token_depfiles:
+            shape.depfiles = 1;
+            break;
+
+        case arglex_token_depfiles_not:
+            shape.depfiles = 0;
+            break;
+
+        case arglex_token_cook:
+            build.cook = absolute(string_argument(arglex_token_cook));
+            break;
+
+        case arglex_token_c_incl:
+            build.c_incl = absolute(string_argument(arglex_token_c_incl));
+            shape.c_incl = build.c_incl;
+            break;
+
+        case arglex_token_parallel:
+            build.parallel = number_argument(arglex_token_parallel);
+            if (build.parallel < 1)
+                build.parallel = 1;
+            break;
+
+        case arglex_token_strace:
+            build.strace = string_argument(arglex_token_strace);
+            break;
+
+        case arglex_token_output:
+            build.output = string_argument(arglex_token_output);
+            break;
+
+        case arglex_token_generate:
+            project_generate(&shape, string_argument(arglex_token_generate));
+            ++nbench;
+            break;
+
+        case arglex_token_build:
+            bench_build(string_argument(arglex_token_build), &build);
+            ++nbench;
+            break;
+
+        case arglex_token_line_scan:
+            switch (arglex())
+            {
+            default:
+                arg_needs_string(arglex_token_line_scan, usage);
+                /* NOTREACHED */
+
+            case arglex_token_string:
+                bench_lines(arglex_value.alv_string, repeat);
+                break;
+
+            case arglex_token_stdio:
+                bench_lines("-", repeat);
+                break;
+            }
+            ++nbench;
+            break;
+
+        case arglex_token_pattern_match:
+            switch (arglex())
+            {
+            default:
+                arg_needs_string(arglex_token_pattern_match, usage);
+                /* NOTREACHED */
+
+            case arglex_token_string:
+                bench_match(arglex_value.alv_string, repeat);
+                break;
+
+            case arglex_token_stdio:
+                bench_match("-", repeat);
+                break;
+            }
+            ++nbench;
+            break;
+
+        case arglex_token_string_pool:
+            switch (arglex())
+            {
+            default:
+                arg_needs_string(arglex_token_string_pool, usage);
+                /* NOTREACHED */
+
+            case arglex_token_string:
+                bench_str(arglex_value.alv_string, repeat);
+                break;
+
+            case arglex_token_stdio:
+                bench_str("-", repeat);
+                break;
+            }
+            ++nbench;
+            break;
+        }
+        arglex();
+    }
+    if (!nbench)
+        usage();
+    exit(0);
+    return 0;
+}
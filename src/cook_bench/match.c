@@ -0,0 +1,370 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/regex.h>
+#include <common/ac/stdio.h>
+
+#include <common/mem.h>
+#include <common/str.h>
+#include <common/str_list.h>
+#include <cook/expr/position.h>
+#include <cook/match/cook.h>
+#include <cook/match/list.h>
+#include <cook/match/regex.h>
+#include <cook_bench/corpus.h>
+#include <cook_bench/match.h>
+#include <cook_bench/timer.h>
+
+
+/*
+ * The targets and ingredients of a typical set of implicit recipes,
+ * in both pattern flavours.  Each corpus line is offered to each
+ * target pattern in turn, just as graph_build_file does when looking
+ * for an implicit recipe, and the ingredient is reconstructed when
+ * it matches.
+ */
+typedef struct recipe_ty recipe_ty;
+struct recipe_ty
+{
+    const char      *target;
+    const char      *ingredient;
+};
+
+static recipe_ty regex_recipe[] =
+{
+    { "\\(.*\\)\\.o", "\\1.c" },
+    { "\\(.*\\)\\.a", "\\1.list" },
+    { "\\(.*\\)/lib\\([^/]*\\)\\.so", "\\1/\\2.a" },
+    { "\\(.*\\)\\.gen\\.c", "\\1.y" },
+    { "\\(.*\\)\\.h", "\\1.h.in" },
+    { "\\(.*\\)\\.c", "\\1.c.in" },
+};
+
+static recipe_ty cook_recipe[] =
+{
+    { "%0%.o", "%0%.c" },
+    { "%0%.a", "%0%.list" },
+    { "%0lib%.so", "%0%.a" },
+    { "%0%.gen.c", "%0%.y" },
+    { "%0%.h", "%0%.h.in" },
+    { "%0%.c", "%0%.c.in" },
+};
+
+
+/*
+ * A long graph_exterior_pattern style list, of the sort which is
+ * consulted for every file the graph builder looks at.  Most names
+ * match nothing, or something near the end.
+ */
+static const char *classify_pattern[] =
+{
+    "%0%.orig", "%0%.rej", "%0%~", "%0#%#", "%0.#%", "%0CVS/%",
+    "%0.git/%0%", "%0%.bak", "%0%.swp", "%0%.tmp", "%0core", "%0%.log",
+    "%0%.pyc", "%0%.class", "%0%.jar", "%0%.zip", "%0%.tar", "%0%.gz",
+    "%0%.bz2", "%0%.xz", "%0%.png", "%0%.gif", "%0%.jpg", "%0%.pdf",
+    "%0%.ps", "%0%.dvi", "%0%.html", "%0%.css", "%0%.js", "%0%.po",
+    "%0%.mo", "%0%.sh", "%0%.pl", "%0%.py", "%0%.awk", "%0%.sed",
+    "%0%.in", "%0%.m4", "%0%.mk", "%0%.cook", "%0%.1", "%0%.3", "%0%.5",
+    "%0%.8", "%0%.so", "Makefile", "configure", "%0%.y", "%0%.h",
+    "%0%.c",
+};
+
+
+/*
+ * NAME
+ *      classify
+ *
+ * SYNOPSIS
+ *      long classify(string_list_ty *formal, string_ty **actual,
+ *              size_t nactual, long repeat, int indexed);
+ *
+ * DESCRIPTION
+ *      The classify function is used to find the first pattern of a
+ *      list which matches each file, either trying the patterns in
+ *      turn, the way leaf_query used to, or with a match_list_ty
+ *      index.
+ *
+ * RETURNS
+ *      long; the sum of the matching pattern numbers, as a check.
+ */
+
+static long
+classify(string_list_ty *formal, string_ty **actual, size_t nactual,
+    long repeat, int indexed)
+{
+    match_list_ty   *mlp;
+    match_ty        *mp;
+    size_t          j;
+    size_t          k;
+    size_t          which;
+    long            count;
+
+    count = 0;
+    mlp = indexed ? match_list_new(match_cook_new(), formal) : 0;
+    mp = indexed ? 0 : match_cook_new();
+    while (repeat-- > 0)
+    {
+        for (j = 0; j < nactual; ++j)
+        {
+            if (mlp)
+            {
+                if (match_list_execute(mlp, actual[j], 0, &which) > 0)
+                    count += which + 1;
+                continue;
+            }
+            for (k = 0; k < formal->nstrings; ++k)
+            {
+                if (match_attempt(mp, formal->string[k], actual[j], 0) > 0)
+                {
+                    count += k + 1;
+                    break;
+                }
+            }
+        }
+    }
+    if (mlp)
+        match_list_delete(mlp);
+    if (mp)
+        match_delete(mp);
+    return count;
+}
+
+
+/*
+ * NAME
+ *      derive
+ *
+ * SYNOPSIS
+ *      long derive(match_ty *(*new)(void), recipe_ty *, size_t nrecipes,
+ *              string_ty **actual, size_t nactual, long repeat);
+ *
+ * DESCRIPTION
+ *      The derive function is used to try every recipe against every
+ *      file, using a new matcher for each file, the way the graph
+ *      builder does.
+ *
+ * RETURNS
+ *      long; the number of matches, so the work is not optimized away.
+ */
+
+static long
+derive(match_ty *(*new)(void), recipe_ty *rp, size_t nrecipes,
+    string_ty **actual, size_t nactual, long repeat)
+{
+    string_ty       **target;
+    string_ty       **ingredient;
+    expr_position_ty pos;
+    long            count;
+    long            r;
+    size_t          j;
+    size_t          k;
+
+    target = mem_alloc(nrecipes * sizeof(string_ty *));
+    ingredient = mem_alloc(nrecipes * sizeof(string_ty *));
+    for (k = 0; k < nrecipes; ++k)
+    {
+        target[k] = str_from_c(rp[k].target);
+        ingredient[k] = str_from_c(rp[k].ingredient);
+    }
+    expr_position_constructorC(&pos, "bench", 1);
+
+    count = 0;
+    for (r = 0; r < repeat; ++r)
+    {
+        for (j = 0; j < nactual; ++j)
+        {
+            match_ty        *mp;
+
+            mp = new();
+            for (k = 0; k < nrecipes; ++k)
+            {
+                string_ty       *s;
+
+                if (match_attempt(mp, target[k], actual[j], &pos) <= 0)
+                    continue;
+                s = match_reconstruct_lhs(mp, ingredient[k], &pos);
+                if (s)
+                {
+                    ++count;
+                    str_free(s);
+                }
+            }
+            match_delete(mp);
+        }
+    }
+
+    expr_position_destructor(&pos);
+    for (k = 0; k < nrecipes; ++k)
+    {
+        str_free(target[k]);
+        str_free(ingredient[k]);
+    }
+    mem_free(target);
+    mem_free(ingredient);
+    return count;
+}
+
+
+/*
+ * NAME
+ *      derive_uncached
+ *
+ * SYNOPSIS
+ *      long derive_uncached(char **actual, size_t nactual, long repeat);
+ *
+ * DESCRIPTION
+ *      The derive_uncached function is used to try every regex recipe
+ *      against every file, calling regcomp for every attempt.  This is
+ *      what the regex matcher did before it cached compiled patterns,
+ *      and is the baseline for comparison.
+ */
+
+static long
+derive_uncached(char **actual, size_t nactual, long repeat)
+{
+    long            count;
+    long            r;
+    size_t          j;
+    size_t          k;
+
+    count = 0;
+    for (r = 0; r < repeat; ++r)
+    {
+        for (j = 0; j < nactual; ++j)
+        {
+            for (k = 0; k < SIZEOF(regex_recipe); ++k)
+            {
+                regex_t         preg;
+                regmatch_t      match[10];
+                string_ty       *s;
+
+                s = str_format("^%s$", regex_recipe[k].target);
+                if (regcomp(&preg, s->str_text, REG_BASIC) == 0)
+                {
+                    if (!regexec(&preg, actual[j], SIZEOF(match), match, 0))
+                        ++count;
+                    regfree(&preg);
+                }
+                str_free(s);
+            }
+        }
+    }
+    return count;
+}
+
+
+/*
+ * NAME
+ *      bench_match
+ *
+ * SYNOPSIS
+ *      void bench_match(const char *corpus, long repeat);
+ *
+ * DESCRIPTION
+ *      The bench_match function is used to measure the cost of
+ *      implicit recipe derivation: matching file names against the
+ *      target patterns of implicit recipes, and reconstructing the
+ *      ingredient names of those which match.
+ *
+ *      The regex matcher is measured with and without compiling each
+ *      pattern once, and the cook (%) matcher is measured for
+ *      comparison.  Rates are per pattern tried.  Last, the files
+ *      are classified against a long pattern list, one pattern at a
+ *      time and with a match_list_ty index; rates are per name.
+ */
+
+void
+bench_match(const char *corpus, long repeat)
+{
+    corpus_ty       *cp;
+    string_ty       **actual;
+    size_t          j;
+    double          start;
+    double          nattempts;
+    long            count;
+    string_list_ty  formal;
+
+    cp = corpus_read(corpus);
+    printf("corpus: %ld lines\n", (long)cp->nlines);
+    actual = mem_alloc(cp->nlines * sizeof(string_ty *));
+    for (j = 0; j < cp->nlines; ++j)
+        actual[j] = str_from_c(cp->line[j]);
+
+    nattempts = (double)repeat * cp->nlines * SIZEOF(regex_recipe);
+    start = timer_now();
+    count = derive_uncached(cp->line, cp->nlines, repeat);
+    timer_report("regex uncached", timer_now() - start, nattempts, "attempt");
+
+    start = timer_now();
+    if
+    (
+        derive
+        (
+            match_regex_new,
+            regex_recipe,
+            SIZEOF(regex_recipe),
+            actual,
+            cp->nlines,
+            repeat
+        )
+    !=
+        count
+    )
+        printf("regex matcher disagrees with regcomp\n");
+    timer_report("regex matcher", timer_now() - start, nattempts, "attempt");
+
+    nattempts = (double)repeat * cp->nlines * SIZEOF(cook_recipe);
+    start = timer_now();
+    derive
+    (
+        match_cook_new,
+        cook_recipe,
+        SIZEOF(cook_recipe),
+        actual,
+        cp->nlines,
+        repeat
+    );
+    timer_report("cook matcher", timer_now() - start, nattempts, "attempt");
+
+    string_list_constructor(&formal);
+    for (j = 0; j < SIZEOF(classify_pattern); ++j)
+    {
+        string_ty       *s;
+
+        s = str_from_c(classify_pattern[j]);
+        string_list_append(&formal, s);
+        str_free(s);
+    }
+    nattempts = (double)repeat * cp->nlines;
+    start = timer_now();
+    count = classify(&formal, actual, cp->nlines, repeat, 0);
+    timer_report("pattern list in turn", timer_now() - start, nattempts,
+        "name");
+    start = timer_now();
+    if (classify(&formal, actual, cp->nlines, repeat, 1) != count)
+        printf("pattern list index disagrees with matcher\n");
+    timer_report("pattern list indexed", timer_now() - start, nattempts,
+        "name");
+    string_list_destructor(&formal);
+
+    for (j = 0; j < cp->nlines; ++j)
+        str_free(actual[j]);
+    mem_free(actual);
+    corpus_delete(cp);
+}
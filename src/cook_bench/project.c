@@ -0,0 +1,484 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains the functions used to generate synthetic projects
+ * for the cook_bench -Build benchmark.
+ *
+ * The project is a number of C source files, spread over a number of
+ * directories, each including a number of headers from a common
+ * include directory.  The headers include each other as a binary tree,
+ * so touching the first header makes everything out of date.  The
+ * cookbook compiles each source with a fake compiler (this program,
+ * see project_fake_compiler) and links the results.  Optionally, the
+ * include dependencies are found by c_incl and read with
+ * #include-cooked, the way the lib/c cookbook does it.  Implicit
+ * recipes which never apply may be added, to make cook work harder to
+ * find the ones which do.
+ */
+
+#include <common/ac/errno.h>
+#include <common/ac/dirent.h>
+#include <common/ac/stdio.h>
+#include <common/ac/string.h>
+#include <common/ac/time.h>
+#include <common/ac/unistd.h>
+#include <sys/stat.h>
+
+#include <common/error.h>
+#include <common/str_list.h>
+#include <cook_bench/project.h>
+
+
+/*
+ * NAME
+ *      project_default
+ *
+ * SYNOPSIS
+ *      void project_default(project_ty *pp);
+ *
+ * DESCRIPTION
+ *      The project_default function is used to fill in the default
+ *      shape of a synthetic project.
+ */
+
+void
+project_default(project_ty *pp)
+{
+    pp->sources = 1000;
+    pp->headers = 200;
+    pp->fan_out = 10;
+    pp->directories = 20;
+    pp->recipes = 20;
+    pp->depfiles = 1;
+    pp->sleep = 0;
+    pp->bench = "cook_bench";
+    pp->c_incl = "c_incl";
+}
+
+
+static void
+make_directory(const char *path)
+{
+    if (mkdir(path, 0777) && errno != EEXIST)
+        nfatal_raw("mkdir \"%s\"", path);
+}
+
+
+static FILE *
+create(const char *path)
+{
+    FILE            *fp;
+
+    fp = fopen(path, "w");
+    if (!fp)
+        nfatal_raw("open \"%s\"", path);
+    return fp;
+}
+
+
+static void
+finish(FILE *fp, const char *path)
+{
+    if (fflush(fp) || ferror(fp))
+        nfatal_raw("write \"%s\"", path);
+    if (fclose(fp))
+        nfatal_raw("close \"%s\"", path);
+}
+
+
+static void
+write_header(const char *dir, long n)
+{
+    char            path[1000];
+    FILE            *fp;
+
+    snprintf(path, sizeof(path), "%s/include/h%05ld.h", dir, n);
+    fp = create(path);
+    fprintf(fp, "#ifndef H%05ld_H\n#define H%05ld_H\n", n, n);
+    if (n > 0)
+        fprintf(fp, "#include \"h%05ld.h\"\n", (n - 1) / 2);
+    fprintf(fp, "extern int h%05ld(int);\n#endif\n", n);
+    finish(fp, path);
+}
+
+
+static void
+write_source(const project_ty *pp, const char *dir, long n)
+{
+    char            path[1000];
+    FILE            *fp;
+    long            k;
+
+    snprintf
+    (
+        path,
+        sizeof(path),
+        "%s/d%03ld/s%05ld.c",
+        dir,
+        n % pp->directories,
+        n
+    );
+    fp = create(path);
+    if (pp->headers > 0)
+    {
+        for (k = 0; k < pp->fan_out; ++k)
+        {
+            fprintf
+            (
+                fp,
+                "#include \"h%05ld.h\"\n",
+                (n * 7919 + k * 104729) % pp->headers
+            );
+        }
+    }
+    fprintf(fp, "int s%05ld(int x) { return x + %ld; }\n", n, n);
+    finish(fp, path);
+}
+
+
+static void
+write_cookbook(const project_ty *pp, const char *dir)
+{
+    char            path[1000];
+    FILE            *fp;
+    long            k;
+
+    snprintf(path, sizeof(path), "%s/Howto.cook", dir);
+    fp = create(path);
+    fprintf
+    (
+        fp,
+        "/*\n"
+        " * Generated by cook_bench -Generate; do not edit.\n"
+        " * %ld sources in %ld directories, %ld headers, %ld included by\n"
+        " * each source, %ld extra implicit recipes.\n"
+        " */\n\n",
+        pp->sources,
+        pp->directories,
+        pp->headers,
+        pp->fan_out,
+        pp->recipes
+    );
+    fprintf(fp, "fake_cc = %s -Fake_Compiler %ld;\n", pp->bench, pp->sleep);
+    fprintf(fp, "if [not [defined c_incl]] then\n");
+    fprintf(fp, "\tc_incl = %s;\n", pp->c_incl);
+    fprintf(fp, "cc_src = [glob \"d*/s*.c\"];\n\n");
+
+    fprintf(fp, "all: prog;\n\n");
+    fprintf(fp, "prog: [fromto %%0%%.c %%0%%.o [cc_src]]\n");
+    fprintf(fp, "{\n\t[fake_cc] [target] [need];\n}\n\n");
+    fprintf(fp, "%%0%%.o: %%0%%.c\n");
+    fprintf(fp, "{\n\t[fake_cc] [target] [resolve [need]];\n}\n");
+
+    for (k = 0; k < pp->recipes; ++k)
+    {
+        fprintf(fp, "\n%%0%%.x%ld: %%0%%.y%ld\n", k, k);
+        fprintf(fp, "{\n\t[fake_cc] [target] [need];\n}\n");
+    }
+
+    if (pp->depfiles)
+    {
+        static const char *const suffix[] = { "c", "h" };
+
+        for (k = 0; k < 2; ++k)
+        {
+            fprintf
+            (
+                fp,
+                "\n%%0%%.%s.d: %%0%%.%s\n"
+                "{\n"
+                "\t[c_incl] -nc -ns -nrec -Iinclude [resolve %%0%%.%s]\n"
+                "\t\t-prefix \"'cascade %%0%%.%s ='\" -suffix \"';'\"\n"
+                "\t\t-o [target];\n"
+                "}\n",
+                suffix[k],
+                suffix[k],
+                suffix[k],
+                suffix[k]
+            );
+        }
+        fprintf
+        (
+            fp,
+            "\ncc_dep_files =\n"
+            "\t[addsuffix .d [cc_src] [glob \"include/h*.h\"]];\n"
+            "#include-cooked [cc_dep_files]\n"
+        );
+    }
+    finish(fp, path);
+}
+
+
+/*
+ * NAME
+ *      project_generate
+ *
+ * SYNOPSIS
+ *      void project_generate(const project_ty *pp, const char *dir);
+ *
+ * DESCRIPTION
+ *      The project_generate function is used to write a synthetic
+ *      project of the given shape into the named directory, which is
+ *      created if necessary.
+ */
+
+void
+project_generate(const project_ty *pp, const char *dir)
+{
+    char            path[1000];
+    long            j;
+    project_ty      shape;
+
+    shape = *pp;
+    if (shape.directories < 1)
+        shape.directories = 1;
+    if (shape.sources < 1)
+        shape.sources = 1;
+    if (shape.fan_out < 0)
+        shape.fan_out = 0;
+    if (shape.sleep < 0)
+        shape.sleep = 0;
+
+    make_directory(dir);
+    snprintf(path, sizeof(path), "%s/include", dir);
+    make_directory(path);
+    for (j = 0; j < shape.directories; ++j)
+    {
+        snprintf(path, sizeof(path), "%s/d%03ld", dir, j);
+        make_directory(path);
+    }
+    for (j = 0; j < shape.headers; ++j)
+        write_header(dir, j);
+    for (j = 0; j < shape.sources; ++j)
+        write_source(&shape, dir, j);
+    write_cookbook(&shape, dir);
+    printf
+    (
+        "generated %s: %ld sources, %ld directories, %ld headers\n",
+        dir,
+        shape.sources,
+        shape.directories,
+        shape.headers
+    );
+}
+
+
+static int
+ends_with(const char *name, const char *suffix)
+{
+    size_t          len1;
+    size_t          len2;
+
+    len1 = strlen(name);
+    len2 = strlen(suffix);
+    return (len1 >= len2 && !strcmp(name + len1 - len2, suffix));
+}
+
+
+/*
+ * NAME
+ *      is_built
+ *
+ * SYNOPSIS
+ *      int is_built(const char *name);
+ *
+ * DESCRIPTION
+ *      The is_built function is used to tell whether a file in a
+ *      synthetic project is written by one of the cookbook's recipes.
+ */
+
+static int
+is_built(const char *name)
+{
+    return
+        (
+            ends_with(name, ".o")
+        ||
+            ends_with(name, ".d")
+        ||
+            !strcmp(name, "prog")
+        );
+}
+
+
+/*
+ * NAME
+ *      project_clean
+ *
+ * SYNOPSIS
+ *      void project_clean(const char *dir);
+ *
+ * DESCRIPTION
+ *      The project_clean function is used to remove everything built
+ *      in a synthetic project, and cook's own files, so that the next
+ *      build starts from scratch.
+ */
+
+void
+project_clean(const char *dir)
+{
+    DIR             *dp;
+    struct dirent   *ep;
+    char            path[1000];
+    struct stat     st;
+
+    dp = opendir(dir);
+    if (!dp)
+        nfatal_raw("opendir \"%s\"", dir);
+    for (;;)
+    {
+        ep = readdir(dp);
+        if (!ep)
+            break;
+        if (!strcmp(ep->d_name, ".") || !strcmp(ep->d_name, ".."))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ep->d_name);
+        if (lstat(path, &st))
+            nfatal_raw("stat \"%s\"", path);
+        if (S_ISDIR(st.st_mode))
+        {
+            project_clean(path);
+            continue;
+        }
+        if (is_built(ep->d_name) || !strncmp(ep->d_name, ".cook", 5))
+        {
+            if (unlink(path))
+                nfatal_raw("unlink \"%s\"", path);
+        }
+    }
+    closedir(dp);
+}
+
+
+/*
+ * NAME
+ *      project_newest
+ *
+ * SYNOPSIS
+ *      time_t project_newest(const char *dir);
+ *
+ * DESCRIPTION
+ *      The project_newest function is used to find the modification
+ *      time of the most recently written file built in a synthetic
+ *      project.  It is used to check that a run of cook which should
+ *      have had nothing to do did not run any recipes.
+ *
+ * RETURNS
+ *      time_t; zero if nothing has been built.
+ */
+
+time_t
+project_newest(const char *dir)
+{
+    DIR             *dp;
+    struct dirent   *ep;
+    char            path[1000];
+    struct stat     st;
+    time_t          result;
+    time_t          t;
+
+    result = 0;
+    dp = opendir(dir);
+    if (!dp)
+        nfatal_raw("opendir \"%s\"", dir);
+    for (;;)
+    {
+        ep = readdir(dp);
+        if (!ep)
+            break;
+        if (!strcmp(ep->d_name, ".") || !strcmp(ep->d_name, ".."))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ep->d_name);
+        if (lstat(path, &st))
+            nfatal_raw("stat \"%s\"", path);
+        if (S_ISDIR(st.st_mode))
+            t = project_newest(path);
+        else if (is_built(ep->d_name))
+            t = st.st_mtime;
+        else
+            continue;
+        if (t > result)
+            result = t;
+    }
+    closedir(dp);
+    return result;
+}
+
+
+/*
+ * NAME
+ *      project_fake_compiler
+ *
+ * SYNOPSIS
+ *      void project_fake_compiler(long msec,
+ *              const string_list_ty *args);
+ *
+ * DESCRIPTION
+ *      The project_fake_compiler function is used to stand in for a
+ *      compiler or linker in the synthetic project.  The first
+ *      argument is the output file; the rest are read, and a line with
+ *      the name and a checksum of each is written to the output.  It
+ *      sleeps for the given number of milliseconds first, to simulate
+ *      the work.
+ */
+
+void
+project_fake_compiler(long msec, const string_list_ty *args)
+{
+    FILE            *ofp;
+    FILE            *ifp;
+    size_t          j;
+    unsigned long   sum;
+    int             c;
+    const char      *output;
+
+    if (args->nstrings < 1)
+        fatal_raw("-Fake_Compiler needs an output file");
+    if (msec > 0)
+    {
+        struct timeval  tv;
+
+        tv.tv_sec = msec / 1000;
+        tv.tv_usec = (msec % 1000) * 1000;
+        select(0, 0, 0, 0, &tv);
+    }
+    output = args->string[0]->str_text;
+    ofp = create(output);
+    for (j = 1; j < args->nstrings; ++j)
+    {
+        const char      *input;
+
+        input = args->string[j]->str_text;
+        ifp = fopen(input, "r");
+        if (!ifp)
+            nfatal_raw("open \"%s\"", input);
+        sum = 0;
+        for (;;)
+        {
+            c = getc(ifp);
+            if (c == EOF)
+                break;
+            sum = sum * 31 + c;
+        }
+        if (ferror(ifp))
+            nfatal_raw("read \"%s\"", input);
+        fclose(ifp);
+        fprintf(ofp, "%s %lu\n", input, sum);
+    }
+    finish(ofp, output);
+}
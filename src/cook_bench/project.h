@@ -0,0 +1,50 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COOK_BENCH_PROJECT_H
+#define COOK_BENCH_PROJECT_H
+
+#include <common/ac/time.h>
+#include <common/main.h>
+
+/*
+ * The shape of a synthetic project.
+ */
+typedef struct project_ty project_ty;
+struct project_ty
+{
+    long            sources;        /* number of C source files */
+    long            headers;        /* number of header files */
+    long            fan_out;        /* headers included by each source */
+    long            directories;    /* the sources are spread over these */
+    long            recipes;        /* implicit recipes which never apply */
+    int             depfiles;       /* use c_incl and #include-cooked */
+    long            sleep;          /* milliseconds per fake compile */
+    const char      *bench;         /* this program, for -Fake_Compiler */
+    const char      *c_incl;
+};
+
+void project_default(project_ty *);
+void project_generate(const project_ty *, const char *dir);
+void project_clean(const char *dir);
+time_t project_newest(const char *dir);
+struct string_list_ty; /* existence */
+void project_fake_compiler(long msec, const struct string_list_ty *args);
+
+#endif /* COOK_BENCH_PROJECT_H */
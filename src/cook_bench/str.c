@@ -0,0 +1,142 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/stdio.h>
+
+#include <common/mem.h>
+#include <common/str.h>
+#include <cook_bench/corpus.h>
+#include <cook_bench/str.h>
+#include <cook_bench/timer.h>
+
+
+/*
+ * NAME
+ *      bench_str
+ *
+ * SYNOPSIS
+ *      void bench_str(const char *corpus, long repeat);
+ *
+ * DESCRIPTION
+ *      The bench_str function is used to measure the throughput of the
+ *      string pool: str_from_c and str_free, on a corpus of path names.
+ *
+ *      Three things are measured.  "insert" interns every line of the
+ *      corpus into an empty pool and then frees them all again, the
+ *      way a short lived graph does.  "lookup" repeatedly interns
+ *      strings which are already in the pool, the way the symbol table
+ *      queries during graph construction do.  "miss" looks up strings
+ *      which are not in the pool, but which share the corpus' prefixes
+ *      and suffixes.
+ */
+
+void
+bench_str(const char *corpus, long repeat)
+{
+    corpus_ty       *cp;
+    string_ty       **held;
+    char            **miss;
+    size_t          j;
+    long            r;
+    double          start;
+
+    cp = corpus_read(corpus);
+    printf
+    (
+        "corpus: %ld lines, %ld bytes, mean length %.1f\n",
+        (long)cp->nlines,
+        (long)cp->nbytes,
+        (double)cp->nbytes / cp->nlines
+    );
+    held = mem_alloc(cp->nlines * sizeof(string_ty *));
+
+    /*
+     * insert and delete
+     */
+    start = timer_now();
+    for (r = 0; r < repeat; ++r)
+    {
+        for (j = 0; j < cp->nlines; ++j)
+            held[j] = str_from_c(cp->line[j]);
+        for (j = 0; j < cp->nlines; ++j)
+            str_free(held[j]);
+    }
+    timer_report
+    (
+        "insert+free",
+        timer_now() - start,
+        2. * repeat * cp->nlines,
+        "op"
+    );
+
+    /*
+     * lookup of strings already present
+     */
+    for (j = 0; j < cp->nlines; ++j)
+        held[j] = str_from_c(cp->line[j]);
+    start = timer_now();
+    for (r = 0; r < repeat; ++r)
+    {
+        for (j = 0; j < cp->nlines; ++j)
+            str_free(str_from_c(cp->line[j]));
+    }
+    timer_report
+    (
+        "lookup+free (hit)",
+        timer_now() - start,
+        2. * repeat * cp->nlines,
+        "op"
+    );
+
+    /*
+     * lookup of strings not present (the new string is immediately
+     * freed again, so the pool does not grow)
+     */
+    miss = mem_alloc(cp->nlines * sizeof(char *));
+    for (j = 0; j < cp->nlines; ++j)
+    {
+        string_ty       *s;
+
+        s = str_format("%s,v", cp->line[j]);
+        miss[j] = mem_copy_string(s->str_text);
+        str_free(s);
+    }
+    start = timer_now();
+    for (r = 0; r < repeat; ++r)
+    {
+        for (j = 0; j < cp->nlines; ++j)
+            str_free(str_from_c(miss[j]));
+    }
+    timer_report
+    (
+        "lookup+free (miss)",
+        timer_now() - start,
+        2. * repeat * cp->nlines,
+        "op"
+    );
+
+    for (j = 0; j < cp->nlines; ++j)
+    {
+        str_free(held[j]);
+        mem_free(miss[j]);
+    }
+    mem_free(held);
+    mem_free(miss);
+    corpus_delete(cp);
+}
@@ -0,0 +1,79 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/ac/stdio.h>
+#include <common/ac/time.h>
+
+#include <cook_bench/timer.h>
+
+
+/*
+ * NAME
+ *      timer_now
+ *
+ * SYNOPSIS
+ *      double timer_now(void);
+ *
+ * DESCRIPTION
+ *      The timer_now function is used to read the wall clock, in
+ *      seconds, with as much resolution as the system provides.
+ */
+
+double
+timer_now(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+    struct timeval  tv;
+
+    gettimeofday(&tv, 0);
+    return (tv.tv_sec + tv.tv_usec * 1.0e-6);
+#else
+    return (clock() * (1. / CLOCKS_PER_SEC));
+#endif
+}
+
+
+/*
+ * NAME
+ *      timer_report
+ *
+ * SYNOPSIS
+ *      void timer_report(const char *name, double elapsed, double nops,
+ *              const char *unit);
+ *
+ * DESCRIPTION
+ *      The timer_report function is used to print one line of
+ *      benchmark results: the number of operations, the elapsed time,
+ *      and the time per operation.
+ */
+
+void
+timer_report(const char *name, double elapsed, double nops, const char *unit)
+{
+    printf
+    (
+        "%-24s %12.0f %-4s %9.3f sec %10.1f ns/%s\n",
+        name,
+        nops,
+        unit,
+        elapsed,
+        (nops > 0 ? elapsed * 1e9 / nops : 0.),
+        unit
+    );
+}
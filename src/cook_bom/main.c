@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1998, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1998, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -34,7 +34,9 @@ enum
     arglex_token_directory,
     arglex_token_ignore,
     arglex_token_output,
+    arglex_token_parallel,
     arglex_token_prefix,
+    arglex_token_recursive,
     arglex_token_suffix
 };
 
@@ -42,8 +44,11 @@ static arglex_table_ty argtab[] =
 {
     { "-DIRectory", arglex_token_directory },
     { "-IGnore", arglex_token_ignore },
+    { "-Jobs", arglex_token_parallel },
     { "-Output", arglex_token_output },
+    { "-PARallel", arglex_token_parallel },
     { "-Prefix", arglex_token_prefix },
+    { "-Recursive", arglex_token_recursive },
     { "-Suffix", arglex_token_suffix },
     { 0, 0 } /* end marker */
 };
@@ -66,6 +71,7 @@ main(int argc, char **argv)
 {
     char            *infile;
     char            *outfile;
+    int             recursive;
 
     arglex_init(argc, argv, argtab);
     str_initialize();
@@ -85,6 +91,7 @@ main(int argc, char **argv)
 
     infile = 0;
     outfile = 0;
+    recursive = 0;
     while (arglex_token != arglex_token_eoln)
     {
         switch (arglex_token)
@@ -131,6 +138,21 @@ main(int argc, char **argv)
                 arg_duplicate_cur(usage);
             break;
 
+        case arglex_token_recursive:
+            if (recursive)
+                arg_duplicate_cur(usage);
+            recursive = 1;
+            break;
+
+        case arglex_token_parallel:
+            if (arglex() != arglex_token_number)
+            {
+                sniff_parallel(4);
+                continue;
+            }
+            sniff_parallel((int)arglex_value.alv_number);
+            break;
+
         case arglex_token_string:
             if (!infile)
                 infile = arglex_value.alv_string;
@@ -178,7 +200,10 @@ main(int argc, char **argv)
     /*
      * read the directory and write the manifest
      */
-    sniff(infile, outfile);
+    if (recursive)
+        sniff_recursive(infile, outfile);
+    else
+        sniff(infile, outfile);
     exit(0);
     return 0;
 }
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1998, 1999, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1998, 1999, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -18,16 +18,21 @@
  */
 
 #include <common/ac/ctype.h>
+#include <common/ac/stdarg.h>
 #include <common/ac/stdio.h>
+#include <common/ac/stdlib.h>
 #include <common/ac/string.h>
 #include <common/ac/errno.h>
+#include <common/ac/unistd.h>
 
 #include <common/ac/dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 #include <common/error_intl.h>
 #include <common/gmatch.h>
+#include <common/mem.h>
 #include <common/os_path_cat.h>
 #include <common/str.h>
 #include <common/str_list.h>
@@ -40,6 +45,18 @@ static string_list_ty ignore_list;
 static char     cook_chars[] = "#\"'():;=[\\]{}";
 static string_ty *prefix;
 static string_ty *suffix;
+static string_ty *prefix_raw;
+static string_ty *suffix_raw;
+static int      jobs = 1;
+
+/*
+ * The type of each directory entry, as far as readdir can tell us.
+ * Only the addresses are used.
+ */
+static char     type_file;
+static char     type_directory;
+static char     type_special;
+static char     type_unknown;
 
 
 void
@@ -118,14 +135,73 @@ ignore(char *s)
 }
 
 
+/*
+ * NAME
+ *      entry_type - type of a directory entry
+ *
+ * SYNOPSIS
+ *      char *entry_type(struct dirent *dep);
+ *
+ * DESCRIPTION
+ *      The entry_type function is used to find the type of a directory
+ *      entry without a stat call, on systems and file systems which
+ *      return the type from readdir.
+ */
+
+static char *
+entry_type(struct dirent *dep)
+{
+#ifdef DT_UNKNOWN
+    switch (dep->d_type)
+    {
+    case DT_UNKNOWN:
+        return &type_unknown;
+
+    case DT_REG:
+        return &type_file;
+
+    case DT_DIR:
+        return &type_directory;
+
+    default:
+        return &type_special;
+    }
+#else
+    (void)dep;
+    return &type_unknown;
+#endif
+}
+
+
+/*
+ * NAME
+ *      scan - read a directory
+ *
+ * SYNOPSIS
+ *      int scan(string_ty *filename, symtab_ty *seen,
+ *              string_list_ty *result);
+ *
+ * DESCRIPTION
+ *      The scan function is used to add the names in a directory to
+ *      the result, along with their types.  Names already seen, in a
+ *      directory earlier in the search path, are not added again.
+ *
+ * RETURNS
+ *      int; 1 if the directory was read, 0 if it does not exist.
+ */
+
 static int
-scan(string_ty *filename, string_list_ty *result)
+scan(string_ty *filename, symtab_ty *seen, string_list_ty *result)
 {
     DIR             *dp;
 
     dp = opendir(filename->str_text);
     if (!dp)
+    {
+        if (errno == ENOENT || errno == ENOTDIR)
+            return 0;
         fatal_intl_opendir(filename->str_text);
+    }
     for (;;)
     {
         struct dirent   *dep;
@@ -138,7 +214,11 @@ scan(string_ty *filename, string_list_ty *result)
             string_ty       *s;
 
             s = str_from_c(dep->d_name);
-            string_list_append_unique(result, s);
+            if (!symtab_query(seen, s))
+            {
+                symtab_assign(seen, s, entry_type(dep));
+                string_list_append(result, s);
+            }
             str_free(s);
         }
     }
@@ -148,7 +228,7 @@ scan(string_ty *filename, string_list_ty *result)
 
 
 static void
-scan_path(string_ty *filename, string_list_ty *result)
+scan_path(string_ty *filename, symtab_ty *seen, string_list_ty *result)
 {
     size_t          j;
     size_t          ndirs;
@@ -161,8 +241,9 @@ scan_path(string_ty *filename, string_list_ty *result)
         filename2 = dir_path_nth(j, filename);
         if (!filename2)
             break;
-        if (scan(filename2, result))
+        if (scan(filename2, seen, result))
             ++ndirs;
+        str_free(filename2);
     }
     if (ndirs == 0)
     {
@@ -307,156 +388,203 @@ quote_cook_chars(string_ty *s)
 }
 
 
-void
-sniff(char *ifn, char *ofn)
+/*
+ * NAME
+ *      out - formatted output
+ *
+ * SYNOPSIS
+ *      void out(stracc *sap, const char *fmt, ...);
+ *
+ * DESCRIPTION
+ *      The out function is used to append formatted text to the bill
+ *      of materials being built.
+ */
+
+static void
+out(stracc *sap, const char *fmt, ...)
+{
+    va_list         ap;
+    string_ty       *s;
+
+    va_start(ap, fmt);
+    s = str_vformat(fmt, ap);
+    va_end(ap);
+    sa_chars(sap, s->str_text, s->str_length);
+    str_free(s);
+}
+
+
+/*
+ * NAME
+ *      read_dir - read and classify a directory
+ *
+ * SYNOPSIS
+ *      void read_dir(string_ty *dirname, string_list_ty *files,
+ *              string_list_ty *directories, string_list_ty *specials);
+ *
+ * DESCRIPTION
+ *      The read_dir function is used to read the contents of a
+ *      directory (unioned over the directory search path) and split
+ *      them by type.  Each list is sorted, so the output is consistent
+ *      even if files are deleted and recreated, changing the directory
+ *      order.
+ *
+ *      The names are not classified during the scan so that files
+ *      earlier in the directory search path can "occlude" files later
+ *      in the search path, even if they are of different types.  Only
+ *      names of unknown type are stat()ed.
+ */
+
+static void
+read_dir(string_ty *dirname, string_list_ty *files,
+    string_list_ty *directories, string_list_ty *specials)
 {
-    string_ty       *dirname;
     string_list_ty  contents;
-    string_list_ty  files;
-    string_list_ty  directories;
-    string_list_ty  specials;
+    symtab_ty       *seen;
     size_t          j;
-    FILE            *ofp;
-    string_ty       *filename;
 
-    /*
-     * Read the directory contents
-     * (unioned over the directory search path).
-     *
-     * Sort it, so the output is consistent even if files are
-     * deleted and recreated, changing the directory order.
-     */
-    if (!ifn)
-        ifn = ".";
-    dirname = str_from_c(ifn);
     string_list_constructor(&contents);
-    scan_path(dirname, &contents);
+    seen = symtab_alloc(100);
+    scan_path(dirname, seen, &contents);
     string_list_sort(&contents);
 
-    /*
-     * Split the directory contents by type.
-     *
-     * We don't do this during the scan so that files earlier in
-     * the directory search path can "occlude" files later in the
-     * search path, even if they are of different types.
-     */
-    string_list_constructor(&files);
-    string_list_constructor(&directories);
-    string_list_constructor(&specials);
     for (j = 0; j < contents.nstrings; ++j)
     {
-        struct stat     st;
+        string_ty       *name;
+        char            *type;
 
-        filename = os_path_cat(dirname, contents.string[j]);
-        stat_path(filename, &st);
-        str_free(filename);
-        filename = quote_cook_chars(contents.string[j]);
-        if (S_ISREG(st.st_mode))
-            string_list_append(&files, filename);
-        else if (S_ISDIR(st.st_mode))
-            string_list_append(&directories, filename);
+        name = contents.string[j];
+        type = symtab_query(seen, name);
+        if (type == &type_unknown)
+        {
+            struct stat     st;
+            string_ty       *filename;
+
+            filename = os_path_cat(dirname, name);
+            stat_path(filename, &st);
+            str_free(filename);
+            if (S_ISREG(st.st_mode))
+                type = &type_file;
+            else if (S_ISDIR(st.st_mode))
+                type = &type_directory;
+            else
+                type = &type_special;
+        }
+        if (type == &type_file)
+            string_list_append(files, name);
+        else if (type == &type_directory)
+            string_list_append(directories, name);
         else
-            string_list_append(&specials, filename);
-        str_free(filename);
+            string_list_append(specials, name);
     }
+    symtab_free(seen);
     string_list_destructor(&contents);
+}
 
-    /*
-     * Open the output file.
-     */
-    if (ofn)
-    {
-        ofp = fopen_and_check(ofn, "w");
-    }
-    else
-    {
-        ofn = "standard output";
-        ofp = stdout;
-    }
 
-    fprintf(ofp, ".cook.bom.dir = [relative_dirname [__FILE__]];\n");
-    fprintf(ofp, "if [in [.cook.bom.dir] \".\"] then\n");
-    fprintf(ofp, "    .cook.bom/dir = '';\n");
-    fprintf(ofp, "else\n");
-    fprintf(ofp, "    .cook.bom/dir = [.cook.bom.dir]/;\n");
+/*
+ * NAME
+ *      generate - build a bill of materials
+ *
+ * SYNOPSIS
+ *      void generate(stracc *sap, string_list_ty *files,
+ *              string_list_ty *directories, string_list_ty *specials);
+ *
+ * DESCRIPTION
+ *      The generate function is used to build the text of the bill of
+ *      materials for a directory with the given contents.
+ */
+
+static void
+generate(stracc *sap, string_list_ty *files, string_list_ty *directories,
+    string_list_ty *specials)
+{
+    size_t          j;
+    string_ty       *filename;
+
+    if (!prefix)
+        prefix = str_from_c("");
+    if (!suffix)
+        suffix = str_from_c("/manifest.cook");
+    out(sap, ".cook.bom.dir = [relative_dirname [__FILE__]];\n");
+    out(sap, "if [in [.cook.bom.dir] \".\"] then\n");
+    out(sap, "    .cook.bom/dir = '';\n");
+    out(sap, "else\n");
+    out(sap, "    .cook.bom/dir = [.cook.bom.dir]/;\n");
 
     /*
      * Output the normal files.
      */
-    fprintf(ofp, "\n");
-    fprintf(ofp, "files_in_[.cook.bom.dir] =\n");
-    for (j = 0; j < files.nstrings; ++j)
+    out(sap, "\n");
+    out(sap, "files_in_[.cook.bom.dir] =\n");
+    for (j = 0; j < files->nstrings; ++j)
     {
-        filename = files.string[j];
-        fprintf(ofp, "    %s\n", filename->str_text);
+        filename = quote_cook_chars(files->string[j]);
+        out(sap, "    %s\n", filename->str_text);
+        str_free(filename);
     }
-    fprintf(ofp, "    ;\n");
-    fprintf
+    out(sap, "    ;\n");
+    out
     (
-        ofp,
+        sap,
         "all_files_in_[.cook.bom.dir] = [files_in_[.cook.bom.dir]];\n"
     );
-    fflush_and_check(ofp, ofn);
 
     /*
      * Output the special files.
      */
-    fprintf(ofp, "\n");
-    fprintf(ofp, "specials_in_[.cook.bom.dir] =\n");
-    for (j = 0; j < specials.nstrings; ++j)
+    out(sap, "\n");
+    out(sap, "specials_in_[.cook.bom.dir] =\n");
+    for (j = 0; j < specials->nstrings; ++j)
     {
-        filename = specials.string[j];
-        fprintf(ofp, "    %s\n", filename->str_text);
+        filename = quote_cook_chars(specials->string[j]);
+        out(sap, "    %s\n", filename->str_text);
+        str_free(filename);
     }
-    fprintf(ofp, "    ;\n");
-    fprintf
+    out(sap, "    ;\n");
+    out
     (
-        ofp,
+        sap,
         "all_specials_in_[.cook.bom.dir] = [specials_in_[.cook.bom.dir]];\n"
     );
-    fflush_and_check(ofp, ofn);
 
     /*
      * Output the directories.
      */
-    fprintf(ofp, "\n");
-    fprintf(ofp, "directories_in_[.cook.bom.dir] =\n");
-    for (j = 0; j < directories.nstrings; ++j)
+    out(sap, "\n");
+    out(sap, "directories_in_[.cook.bom.dir] =\n");
+    for (j = 0; j < directories->nstrings; ++j)
     {
-        filename = directories.string[j];
-        fprintf(ofp, "    %s\n", filename->str_text);
+        filename = quote_cook_chars(directories->string[j]);
+        out(sap, "    %s\n", filename->str_text);
+        str_free(filename);
     }
-    fprintf(ofp, "    ;\n");
-    fprintf
+    out(sap, "    ;\n");
+    out
     (
-        ofp,
+        sap,
         "all_directories_in_[.cook.bom.dir] = "
             "[directories_in_[.cook.bom.dir]];\n"
     );
-    fflush_and_check(ofp, ofn);
 
     /*
      * Output the reference to the next level of the manifest.
      */
-    if (!prefix)
-        prefix = str_from_c("");
-    if (!suffix)
-        suffix = str_from_c("/manifest.cook");
-    if (directories.nstrings > 0)
+    if (directories->nstrings > 0)
     {
-        fprintf(ofp, "\n");
-        fprintf
+        out(sap, "\n");
+        out
         (
-            ofp,
+            sap,
             "#include-cooked-nowarn [prepost %s[.cook.bom/dir] %s \\\n"
                 "    [directories_in_[.cook.bom.dir]]]\n",
             prefix->str_text,
             suffix->str_text
         );
 
-        fprintf
+        out
         (
-            ofp,
+            sap,
             "\n"
             "/*\n"
             " * These variables must be calculated again, as the above "
@@ -464,24 +592,24 @@ sniff(char *ifn, char *ofn)
             " * have over-written them, and they all use the same variables.\n"
             " */\n"
         );
-        fprintf(ofp, ".cook.bom.dir = [relative_dirname [__FILE__]];\n");
-        fprintf(ofp, "if [in [.cook.bom.dir] \".\"] then\n");
-        fprintf(ofp, "    .cook.bom/dir = '';\n");
-        fprintf(ofp, "else\n");
-        fprintf(ofp, "    .cook.bom/dir = [.cook.bom.dir]/;\n");
+        out(sap, ".cook.bom.dir = [relative_dirname [__FILE__]];\n");
+        out(sap, "if [in [.cook.bom.dir] \".\"] then\n");
+        out(sap, "    .cook.bom/dir = '';\n");
+        out(sap, "else\n");
+        out(sap, "    .cook.bom/dir = [.cook.bom.dir]/;\n");
     }
 
     /*
      * work over each reference
      */
-    for (j = 0; j < directories.nstrings; ++j)
+    for (j = 0; j < directories->nstrings; ++j)
     {
-        filename = directories.string[j];
-        fprintf(ofp, "\n");
+        filename = quote_cook_chars(directories->string[j]);
+        out(sap, "\n");
 
-        fprintf
+        out
         (
-            ofp,
+            sap,
             "if [defined all_files_in_[.cook.bom/dir]%s] then\n"
                 "    all_files_in_[.cook.bom.dir] +=\n"
                 "        [addprefix %s/ [all_files_in_[.cook.bom/dir]%s]];\n",
@@ -490,9 +618,9 @@ sniff(char *ifn, char *ofn)
             filename->str_text
         );
 
-        fprintf
+        out
         (
-            ofp,
+            sap,
             "if [defined all_specials_in_[.cook.bom/dir]%s] then\n"
             "    all_specials_in_[.cook.bom.dir] +=\n"
             "        [addprefix %s/ [all_specials_in_[.cook.bom/dir]%s]];\n",
@@ -501,9 +629,9 @@ sniff(char *ifn, char *ofn)
             filename->str_text
         );
 
-        fprintf
+        out
         (
-            ofp,
+            sap,
             "if [defined all_directories_in_[.cook.bom/dir]%s] then\n"
             "    all_directories_in_[.cook.bom.dir] +=\n"
             "        [addprefix %s/ [all_directories_in_[.cook.bom/dir]%s]];\n",
@@ -511,18 +639,329 @@ sniff(char *ifn, char *ofn)
             filename->str_text,
             filename->str_text
         );
+        str_free(filename);
+    }
+    out(sap, "\n.cook.bom.dir = ;\n.cook.bom/dir = ;\n");
+
+}
+
+
+/*
+ * NAME
+ *      write_if_changed - write a file
+ *
+ * SYNOPSIS
+ *      void write_if_changed(char *filename, stracc *sap);
+ *
+ * DESCRIPTION
+ *      The write_if_changed function is used to write the bill of
+ *      materials to a file, but only if the file does not already have
+ *      exactly those contents.  This keeps the file's modification time
+ *      stable, so that things which depend on it are not rebuilt for
+ *      no reason.
+ */
+
+static void
+write_if_changed(char *filename, stracc *sap)
+{
+    FILE            *fp;
+
+    fp = fopen(filename, "rb");
+    if (fp)
+    {
+        char            *buf;
+        size_t          n;
+        int             c;
+
+        buf = mem_alloc(sap->sa_len + 1);
+        n = fread(buf, 1, sap->sa_len, fp);
+        c = getc(fp);
+        if (ferror(fp))
+            fatal_intl_read(filename);
+        fclose_and_check(fp, filename);
+        if
+        (
+            n == sap->sa_len
+        &&
+            c == EOF
+        &&
+            !memcmp(buf, sap->sa_buf, n)
+        )
+        {
+            mem_free(buf);
+            return;
+        }
+        mem_free(buf);
+    }
+    else if (errno != ENOENT)
+        fatal_intl_open(filename);
+
+    fp = fopen_and_check(filename, "w");
+    fwrite(sap->sa_buf, 1, sap->sa_len, fp);
+    fflush_and_check(fp, filename);
+    fclose_and_check(fp, filename);
+}
 
+
+/*
+ * NAME
+ *      bom_one - bill of materials for one directory
+ *
+ * SYNOPSIS
+ *      void bom_one(string_ty *dirname, char *ofn, int only_if_changed,
+ *              string_list_ty *subdirs);
+ *
+ * DESCRIPTION
+ *      The bom_one function is used to write the bill of materials for
+ *      a directory to the named file, or to the standard output if no
+ *      file is named.  If subdirs is not NULL, the paths of the
+ *      directory's sub-directories are appended to it.
+ */
+
+static void
+bom_one(string_ty *dirname, char *ofn, int only_if_changed,
+    string_list_ty *subdirs)
+{
+    string_list_ty  files;
+    string_list_ty  directories;
+    string_list_ty  specials;
+    stracc          sa;
+    size_t          j;
+
+    string_list_constructor(&files);
+    string_list_constructor(&directories);
+    string_list_constructor(&specials);
+    read_dir(dirname, &files, &directories, &specials);
+
+    stracc_constructor(&sa);
+    sa_open(&sa);
+    generate(&sa, &files, &directories, &specials);
+    if (!ofn)
+    {
+        fwrite(sa.sa_buf, 1, sa.sa_len, stdout);
+        fflush_and_check(stdout, "standard output");
+    }
+    else if (only_if_changed)
+        write_if_changed(ofn, &sa);
+    else
+    {
+        FILE            *ofp;
+
+        ofp = fopen_and_check(ofn, "w");
+        fwrite(sa.sa_buf, 1, sa.sa_len, ofp);
         fflush_and_check(ofp, ofn);
+        fclose_and_check(ofp, ofn);
+    }
+    sa_goto(&sa, 0);
+    str_free(sa_close(&sa));
+    stracc_destructor(&sa);
+
+    if (subdirs)
+    {
+        for (j = 0; j < directories.nstrings; ++j)
+        {
+            string_ty       *s;
+
+            s = os_path_cat(dirname, directories.string[j]);
+            string_list_append(subdirs, s);
+            str_free(s);
+        }
+    }
+    string_list_destructor(&files);
+    string_list_destructor(&directories);
+    string_list_destructor(&specials);
+}
+
+
+void
+sniff(char *ifn, char *ofn)
+{
+    string_ty       *dirname;
+
+    if (!ifn)
+        ifn = ".";
+    dirname = str_from_c(ifn);
+    bom_one(dirname, ofn, 0, (string_list_ty *)0);
+    str_free(dirname);
+}
+
+
+/*
+ * NAME
+ *      bom_name - name of a bill of materials file
+ *
+ * SYNOPSIS
+ *      string_ty *bom_name(string_ty *dirname);
+ *
+ * DESCRIPTION
+ *      The bom_name function is used to work out the file name of the
+ *      bill of materials for a nested directory; the same name the
+ *      #include-cooked-nowarn line in its parent will ask for.
+ */
+
+static string_ty *
+bom_name(string_ty *dirname)
+{
+    return
+        str_format
+        (
+            "%s%s%s",
+            (prefix_raw ? prefix_raw->str_text : ""),
+            dirname->str_text,
+            (suffix_raw ? suffix_raw->str_text : "/manifest.cook")
+        );
+}
+
+
+/*
+ * NAME
+ *      bom_tree - bill of materials for a directory tree
+ *
+ * SYNOPSIS
+ *      void bom_tree(string_ty *dirname);
+ *
+ * DESCRIPTION
+ *      The bom_tree function is used to write the bills of materials
+ *      for a nested directory and everything below it.
+ */
+
+static void
+bom_tree(string_ty *dirname)
+{
+    string_list_ty  subdirs;
+    string_ty       *ofn;
+    size_t          j;
+
+    string_list_constructor(&subdirs);
+    ofn = bom_name(dirname);
+    bom_one(dirname, ofn->str_text, 1, &subdirs);
+    str_free(ofn);
+    for (j = 0; j < subdirs.nstrings; ++j)
+        bom_tree(subdirs.string[j]);
+    string_list_destructor(&subdirs);
+}
+
+
+/*
+ * NAME
+ *      sniff_recursive - bills of materials for a whole tree
+ *
+ * SYNOPSIS
+ *      void sniff_recursive(char *ifn, char *ofn);
+ *
+ * DESCRIPTION
+ *      The sniff_recursive function is used to write the bills of
+ *      materials for a directory and every directory below it, in a
+ *      single run.  The top directory's goes to the named output file
+ *      (or the standard output), the others go to the files their
+ *      parents include.  Files are only written when their contents
+ *      change.
+ *
+ *      When more than one job is allowed, the tree is walked breadth
+ *      first until there are several sub-trees per job, and then the
+ *      sub-trees are shared out between that many child processes.
+ */
+
+void
+sniff_recursive(char *ifn, char *ofn)
+{
+    string_ty       *dirname;
+    string_list_ty  pending;
+    size_t          head;
+    int             k;
+    int             nchildren;
+    int             failed;
+
+    if (!ifn)
+        ifn = ".";
+    dirname = str_from_c(ifn);
+    string_list_constructor(&pending);
+    if (ofn)
+        bom_one(dirname, ofn, 1, &pending);
+    else
+        bom_one(dirname, (char *)0, 0, &pending);
+    str_free(dirname);
+
+    head = 0;
+    if (jobs > 1)
+    {
+        while
+        (
+            head < pending.nstrings
+        &&
+            pending.nstrings - head < (size_t)4 * jobs
+        )
+        {
+            string_ty       *ofn2;
+
+            ofn2 = bom_name(pending.string[head]);
+            bom_one(pending.string[head], ofn2->str_text, 1, &pending);
+            str_free(ofn2);
+            ++head;
+        }
+    }
+    if (jobs <= 1 || pending.nstrings - head < 2)
+    {
+        for (; head < pending.nstrings; ++head)
+            bom_tree(pending.string[head]);
+        string_list_destructor(&pending);
+        return;
     }
-    fprintf(ofp, "\n.cook.bom.dir = ;\n.cook.bom/dir = ;\n");
 
     /*
-     * close the output file
+     * Share the sub-trees out between the children.
      */
-    fflush_and_check(ofp, ofn);
-    if (ofp != stdout)
-        fclose_and_check(ofp, ofn);
-    str_free(dirname);
+    fflush(stdout);
+    nchildren = 0;
+    for (k = 0; k < jobs; ++k)
+    {
+        size_t          j;
+
+        switch (fork())
+        {
+        case -1:
+            {
+                sub_context_ty  *scp;
+
+                scp = sub_context_new();
+                sub_errno_set(scp);
+                fatal_intl(scp, i18n("fork(): $errno"));
+                /* NOTREACHED */
+            }
+
+        case 0:
+            for (j = head + k; j < pending.nstrings; j += jobs)
+                bom_tree(pending.string[j]);
+            exit(0);
+
+        default:
+            ++nchildren;
+            break;
+        }
+    }
+
+    /*
+     * The children report their own errors,
+     * all that is needed here is the exit status.
+     */
+    failed = 0;
+    while (nchildren > 0)
+    {
+        int             status;
+
+        if (wait(&status) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        --nchildren;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = 1;
+    }
+    string_list_destructor(&pending);
+    if (failed)
+        exit(1);
 }
 
 
@@ -535,7 +974,7 @@ sniff_prefix(char *s)
         return -1;
     tmp = str_from_c(s);
     prefix = quote_cook_chars(tmp);
-    str_free(tmp);
+    prefix_raw = tmp;
     return 0;
 }
 
@@ -549,6 +988,15 @@ sniff_suffix(char *s)
         return -1;
     tmp = str_from_c(s);
     suffix = quote_cook_chars(tmp);
-    str_free(tmp);
+    suffix_raw = tmp;
     return 0;
 }
+
+
+void
+sniff_parallel(int n)
+{
+    if (n < 1)
+        n = 1;
+    jobs = n;
+}
@@ -26,7 +26,9 @@ void sniff_directory(char *);
 void sniff_ignore(char *);
 int sniff_prefix(char *);
 int sniff_suffix(char *);
+void sniff_parallel(int);
 
 void sniff(char *, char *);
+void sniff_recursive(char *, char *);
 
 #endif /* COOK_MANIFEST_SNIFF_H */
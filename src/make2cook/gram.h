@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -27,4 +27,8 @@ extern int no_internal_rules;
 
 void gram(char *);
 
+struct stmt_ty; /* existence */
+struct stmt_ty *gram_read(char *);
+void gram_emit(struct stmt_ty *);
+
 #endif /* MAKE2COOK_GRAM_H */
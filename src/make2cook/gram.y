@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -50,21 +50,105 @@ extern int yydebug;
 #endif
 
 static stmt_ty *rule_context;
+static stmt_ty *makefile_result;
 int no_internal_rules;
 
 
-void
-gram(char *filename)
+/*
+ * NAME
+ *      gram_read - read a makefile
+ *
+ * SYNOPSIS
+ *      stmt_ty *gram_read(char *filename);
+ *
+ * DESCRIPTION
+ *      The gram_read function is used to read a makefile, and
+ *      translate it into statements.
+ *
+ * RETURNS
+ *      stmt_ty *; the statements, use gram_emit or stmt_free when
+ *      finished with them.
+ */
+
+stmt_ty *
+gram_read(char *filename)
 {
     int yyparse(void);
+    stmt_ty         *result;
 
-    trace(("gram(filename = %p)\n{\n", filename));
+    trace(("gram_read(filename = %p)\n{\n", filename));
     lex_open(filename);
 #if YYDEBUG
     yydebug = trace_pretest_;
 #endif
+    makefile_result = 0;
     yyparse();
     lex_close();
+    result = makefile_result;
+    makefile_result = 0;
+    if (!result)
+        result = stmt_compound_alloc();
+    trace(("return %p;\n", result));
+    trace(("}\n"));
+    return result;
+}
+
+
+/*
+ * NAME
+ *      gram_emit - write a cookbook
+ *
+ * SYNOPSIS
+ *      void gram_emit(stmt_ty *);
+ *
+ * DESCRIPTION
+ *      The gram_emit function is used to add the default rules and
+ *      variables to the statements read by gram_read, and write them
+ *      out as a cookbook.  The statements are then freed.
+ */
+
+void
+gram_emit(stmt_ty *sp)
+{
+    int             j;
+    stmt_ty         *s;
+
+    trace(("gram_emit(sp = %p)\n{\n", sp));
+    s = stmt_vpath_default();
+    if (s)
+        stmt_compound_append(sp, s);
+
+    if (!no_internal_rules)
+    {
+        for (j = 0; ; ++j)
+        {
+            s = stmt_rule_default(j);
+            if (!s)
+                break;
+            stmt_compound_append(sp, s);
+        }
+    }
+
+    for (j = 0; ; ++j)
+    {
+        s = stmt_assign_default(sp);
+        if (!s)
+            break;
+        stmt_compound_prepend(sp, s);
+    }
+
+    stmt_sort(sp);
+    stmt_emit(sp);
+    stmt_free(sp);
+    trace(("}\n"));
+}
+
+
+void
+gram(char *filename)
+{
+    trace(("gram(filename = %p)\n{\n", filename));
+    gram_emit(gram_read(filename));
     trace(("}\n"));
 }
 
@@ -121,37 +205,8 @@ gram(char *filename)
 makefile
     : stmts
         {
-            int             j;
-            stmt_ty         *s;
-
             stmt_regroup($1);
-
-            s = stmt_vpath_default();
-            if (s)
-                stmt_compound_append($1, s);
-
-            if (!no_internal_rules)
-            {
-                for (j = 0; ; ++j)
-                {
-                    s = stmt_rule_default(j);
-                    if (!s)
-                        break;
-                    stmt_compound_append($1, s);
-                }
-            }
-
-            for (j = 0; ; ++j)
-            {
-                s = stmt_assign_default($1);
-                if (!s)
-                    break;
-                stmt_compound_prepend($1, s);
-            }
-
-            stmt_sort($1);
-            stmt_emit($1);
-            stmt_free($1);
+            makefile_result = $1;
         }
     ;
 
@@ -304,6 +359,8 @@ command
             if (rule_context)
                 stmt_rule_context(rule_context);
             $$ = stmt_command_alloc($1);
+            if (rule_context)
+                stmt_rule_submake(rule_context, $$);
         }
     | conditional_commands
         { $$ = $1; }
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -29,6 +29,7 @@
 #include <make2cook/gram.h>
 #include <make2cook/stmt/assign.h>
 #include <make2cook/stmt/rule.h>
+#include <make2cook/tree.h>
 
 
 enum
@@ -40,7 +41,9 @@ enum
     arglex_token_internal_rules,
     arglex_token_internal_rules_not,
     arglex_token_line_numbers,
-    arglex_token_line_numbers_not
+    arglex_token_line_numbers_not,
+    arglex_token_recursive,
+    arglex_token_recursive_not
 };
 
 static arglex_table_ty argtab[] =
@@ -53,6 +56,8 @@ static arglex_table_ty argtab[] =
     { "-No_History_Commands", arglex_token_history_commands_not, },
     { "-No_Internal_Rules", arglex_token_internal_rules_not, },
     { "-No_Line_Numbers", arglex_token_line_numbers_not, },
+    { "-No_Recursive", arglex_token_recursive_not, },
+    { "-Recursive", arglex_token_recursive, },
     { 0, 0, },  /* end marker */
 };
 
@@ -153,6 +158,14 @@ main(int argc, char **argv)
         case arglex_token_internal_rules_not:
             no_internal_rules = 1;
             break;
+
+        case arglex_token_recursive:
+            tree_recursive = 1;
+            break;
+
+        case arglex_token_recursive_not:
+            tree_recursive = 0;
+            break;
         }
         arglex();
     }
@@ -162,7 +175,10 @@ main(int argc, char **argv)
         outfile = 0;
 
     emit_open(outfile);
-    gram(infile);
+    if (tree_recursive)
+        tree_gram(infile);
+    else
+        gram(infile);
     emit_close();
 
     exit(0);
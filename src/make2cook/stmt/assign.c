@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 2001, 2006-2009 Peter Miller
+ *      Copyright (C) 1994, 1997, 2001, 2006-2009, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -17,10 +17,13 @@
  *      <http://www.gnu.org/licenses/>.
  */
 
+#include <common/ac/string.h>
+
 #include <make2cook/emit.h>
 #include <make2cook/stmt/assign.h>
 #include <common/symtab.h>
 #include <common/trace.h>
+#include <make2cook/tree.h>
 #include <make2cook/variable.h>
 
 typedef struct stmt_assign_ty stmt_assign_ty;
@@ -168,6 +171,18 @@ stmt_assign_alloc(int override, blob_ty * lhs, int op, blob_list_ty * rhs)
         variable_rename(lhs, lhs2, &this->ref, VAREN_QUOTE_SPACES);
         blob_free(lhs);
         this->check_env = 0;
+
+        /*
+         * variables of makefiles in subdirectories have their own names
+         */
+        for (j = 0; j < lhs2->length; ++j)
+        {
+            string_ty       *s;
+
+            s = tree_variable(lhs2->list[j]->text);
+            str_free(lhs2->list[j]->text);
+            lhs2->list[j]->text = s;
+        }
     }
 
     /*
@@ -203,185 +218,194 @@ stmt_assign_alloc(int override, blob_ty * lhs, int op, blob_list_ty * rhs)
 }
 
 
-static stmt_ty *
-default_setting(string_ty *name)
+typedef struct table_ty table_ty;
+struct table_ty
 {
-    typedef struct table_ty table_ty;
-    struct table_ty
-    {
-        char            *name;
-        char            *value;
-    };
+    char            *name;
+    char            *value;
+};
 
-    static table_ty table[] =
-    {
-        { ".CURDIR", "$(pathname .)", },
-        { "AR", "ar", },
-        { "ARFLAGS", "rv", },
-        { "AS", "as", },
-        { "CC", "cc", },
-        { "CXX", "g++", },
-        { "CHECKOUT,v", "$(CO) $(COFLAGS)", },
-        { "CO", "co", },
-        { "CPP", "$(CC) -E", },
+static table_ty default_table[] =
+{
+    { ".CURDIR", "$(pathname .)", },
+    { "AR", "ar", },
+    { "ARFLAGS", "rv", },
+    { "AS", "as", },
+    { "CC", "cc", },
+    { "CXX", "g++", },
+    { "CHECKOUT,v", "$(CO) $(COFLAGS)", },
+    { "CO", "co", },
+    { "CPP", "$(CC) -E", },
 #ifdef  CRAY
-        { "CF77PPFLAGS", "-P", },
-        { "CF77PP", "/lib/cpp", },
-        { "CFT", "cft77", },
-        { "CF", "cf77", },
-        { "FC", "$(CF)", },
+    { "CF77PPFLAGS", "-P", },
+    { "CF77PP", "/lib/cpp", },
+    { "CFT", "cft77", },
+    { "CF", "cf77", },
+    { "FC", "$(CF)", },
 #else  /* Not CRAY.  */
 #ifdef  _IBMR2
-        { "FC", "xlf", },
+    { "FC", "xlf", },
 #else
 #ifdef  __convex__
-        { "FC", "fc", },
+    { "FC", "fc", },
 #else
-        { "FC", "f77", },
+    { "FC", "f77", },
 #endif /* __convex__ */
 #endif /* _IBMR2 */
-        /*
-         * System V uses these, so explicit rules using them
-         * should work.  However, there is no way to make
-         * implicit rules use them and FC.
-         */
-        { "F77", "$(FC)", },
-        { "F77FLAGS", "$(FFLAGS)", },
+    /*
+     * System V uses these, so explicit rules using them
+     * should work.  However, there is no way to make
+     * implicit rules use them and FC.
+     */
+    { "F77", "$(FC)", },
+    { "F77FLAGS", "$(FFLAGS)", },
 #endif /* Cray.  */
-        { "GET", SCCS_GET, },
-        { "LD", "ld", },
-        { "LEX", "lex", },
-        { "LINT", "lint", },
-        { "M2C", "m2c", },
+    { "GET", SCCS_GET, },
+    { "LD", "ld", },
+    { "LEX", "lex", },
+    { "LINT", "lint", },
+    { "M2C", "m2c", },
 #ifdef  pyr
-        { "PC", "pascal", },
+    { "PC", "pascal", },
 #else
 #ifdef  CRAY
-        { "PC", "PASCAL", },
-        { "SEGLDR", "segldr", },
+    { "PC", "PASCAL", },
+    { "SEGLDR", "segldr", },
 #else
-        { "PC", "pc", },
+    { "PC", "pc", },
 #endif /* CRAY.  */
 #endif /* pyr.  */
-        { "YACC", "yacc", },
-        { "MAKEINFO", "makeinfo", },
-        { "TEX", "tex", },
-        { "TEXI2DVI", "texi2dvi", },
-        { "WEAVE", "weave", },
-        { "CWEAVE", "cweave", },
-        { "TANGLE", "tangle", },
-        { "CTANGLE", "ctangle", },
-        { "RM", "rm -f", },
-        { "LINK.o", "$(CC) $(LDFLAGS) $(TARGET_ARCH)", },
-        {
-            "COMPILE.c",
-            "$(CC) $(CFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
-        },
-        {
-            "LINK.c",
-            "$(CC) $(CFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
-        },
-        {
-            "COMPILE.cc",
-            "$(CXX) $(CXXFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
-        },
-        { "COMPILE.C", "$(COMPILE.cc)", },
-        {
-            "LINK.cc",
-            "$(CXX) $(CXXFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
-        },
-        { "LINK.C", "$(LINK.cc)", },
-        { "YACC.y", "$(YACC) $(YFLAGS)", },
-        { "LEX.l", "$(LEX) $(LFLAGS) -t", },
-        { "COMPILE.f", "$(FC) $(FFLAGS) $(TARGET_ARCH) -c", },
-        { "LINK.f", "$(FC) $(FFLAGS) $(LDFLAGS) $(TARGET_ARCH)", },
-        {
-            "COMPILE.F",
-            "$(FC) $(FFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
-        },
-        {
-            "LINK.F",
-            "$(FC) $(FFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
-        },
-        { "COMPILE.r", "$(FC) $(FFLAGS) $(RFLAGS) $(TARGET_ARCH) -c", },
-        {
-            "LINK.r",
-            "$(FC) $(FFLAGS) $(RFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
-        },
-        {
-            "COMPILE.def",
-            "$(M2C) $(M2FLAGS) $(DEFFLAGS) $(TARGET_ARCH)",
-        },
-        {
-            "COMPILE.mod",
-            "$(M2C) $(M2FLAGS) $(MODFLAGS) $(TARGET_ARCH)",
-        },
-        {
-            "COMPILE.p",
-            "$(PC) $(PFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
-        },
-        {
-            "LINK.p",
-            "$(PC) $(PFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
-        },
-        { "LINK.s", "$(CC) $(ASFLAGS) $(LDFLAGS) $(TARGET_MACH)", },
-        { "COMPILE.s", "$(AS) $(ASFLAGS) $(TARGET_MACH)", },
-        {
-            "LINK.S",
-            "$(CC) $(ASFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_MACH)",
-        },
-        {
-            "COMPILE.S",
-            "$(CC) $(ASFLAGS) $(CPPFLAGS) $(TARGET_MACH) -c",
-        },
+    { "YACC", "yacc", },
+    { "MAKEINFO", "makeinfo", },
+    { "TEX", "tex", },
+    { "TEXI2DVI", "texi2dvi", },
+    { "WEAVE", "weave", },
+    { "CWEAVE", "cweave", },
+    { "TANGLE", "tangle", },
+    { "CTANGLE", "ctangle", },
+    { "RM", "rm -f", },
+    { "LINK.o", "$(CC) $(LDFLAGS) $(TARGET_ARCH)", },
+    {
+        "COMPILE.c",
+        "$(CC) $(CFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
+    },
+    {
+        "LINK.c",
+        "$(CC) $(CFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
+    },
+    {
+        "COMPILE.cc",
+        "$(CXX) $(CXXFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
+    },
+    { "COMPILE.C", "$(COMPILE.cc)", },
+    {
+        "LINK.cc",
+        "$(CXX) $(CXXFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
+    },
+    { "LINK.C", "$(LINK.cc)", },
+    { "YACC.y", "$(YACC) $(YFLAGS)", },
+    { "LEX.l", "$(LEX) $(LFLAGS) -t", },
+    { "COMPILE.f", "$(FC) $(FFLAGS) $(TARGET_ARCH) -c", },
+    { "LINK.f", "$(FC) $(FFLAGS) $(LDFLAGS) $(TARGET_ARCH)", },
+    {
+        "COMPILE.F",
+        "$(FC) $(FFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
+    },
+    {
+        "LINK.F",
+        "$(FC) $(FFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
+    },
+    { "COMPILE.r", "$(FC) $(FFLAGS) $(RFLAGS) $(TARGET_ARCH) -c", },
+    {
+        "LINK.r",
+        "$(FC) $(FFLAGS) $(RFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
+    },
+    {
+        "COMPILE.def",
+        "$(M2C) $(M2FLAGS) $(DEFFLAGS) $(TARGET_ARCH)",
+    },
+    {
+        "COMPILE.mod",
+        "$(M2C) $(M2FLAGS) $(MODFLAGS) $(TARGET_ARCH)",
+    },
+    {
+        "COMPILE.p",
+        "$(PC) $(PFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -c",
+    },
+    {
+        "LINK.p",
+        "$(PC) $(PFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_ARCH)",
+    },
+    { "LINK.s", "$(CC) $(ASFLAGS) $(LDFLAGS) $(TARGET_MACH)", },
+    { "COMPILE.s", "$(AS) $(ASFLAGS) $(TARGET_MACH)", },
+    {
+        "LINK.S",
+        "$(CC) $(ASFLAGS) $(CPPFLAGS) $(LDFLAGS) $(TARGET_MACH)",
+    },
+    {
+        "COMPILE.S",
+        "$(CC) $(ASFLAGS) $(CPPFLAGS) $(TARGET_MACH) -c",
+    },
 #if !defined(M_XENIX) || defined(__GNUC__)
-        { "PREPROCESS.S", "$(CC) -E $(CPPFLAGS)", },
+    { "PREPROCESS.S", "$(CC) -E $(CPPFLAGS)", },
 #else  /* Xenix.  */
-        { "PREPROCESS.S", "$(CC) -EP $(CPPFLAGS)", },
+    { "PREPROCESS.S", "$(CC) -EP $(CPPFLAGS)", },
 #endif /* Not Xenix.  */
-        {
-            "PREPROCESS.F",
-            "$(FC) $(FFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -F",
-        },
-        {
-            "PREPROCESS.r",
-            "$(FC) $(FFLAGS) $(RFLAGS) $(TARGET_ARCH) -F",
-        },
-        {
-            "LINT.c",
-            "$(LINT) $(LINTFLAGS) $(CPPFLAGS) $(TARGET_ARCH)",
-        },
-    };
+    {
+        "PREPROCESS.F",
+        "$(FC) $(FFLAGS) $(CPPFLAGS) $(TARGET_ARCH) -F",
+    },
+    {
+        "PREPROCESS.r",
+        "$(FC) $(FFLAGS) $(RFLAGS) $(TARGET_ARCH) -F",
+    },
+    {
+        "LINT.c",
+        "$(LINT) $(LINTFLAGS) $(CPPFLAGS) $(TARGET_ARCH)",
+    },
+};
 
-    static symtab_ty *stp;
-    static string_ty *builtin;
-    string_ty       *data;
-    blob_ty         *lhs;
-    blob_list_ty    *rhs;
-    static long     linum;
-    stmt_ty         *result;
+static symtab_ty *default_stp;
 
-    trace(("default_setting()\n{\n"));
-    if (!stp)
+
+static string_ty *
+default_value(string_ty *name)
+{
+    if (!default_stp)
     {
         table_ty        *tp;
 
-        stp = symtab_alloc(SIZEOF(table));
-        for (tp = table; tp < ENDOF(table); ++tp)
+        default_stp = symtab_alloc(SIZEOF(default_table));
+        for (tp = default_table; tp < ENDOF(default_table); ++tp)
         {
             string_ty       *s;
 
             s = str_from_c(tp->name);
-            symtab_assign(stp, s, str_from_c(tp->value));
+            symtab_assign(default_stp, s, str_from_c(tp->value));
             str_free(s);
         }
     }
+    return symtab_query(default_stp, name);
+}
+
+
+static stmt_ty *
+default_setting(string_ty *name)
+{
+    static string_ty *builtin;
+    string_ty       *data;
+    blob_ty         *lhs;
+    blob_list_ty    *rhs;
+    static long     linum;
+    stmt_ty         *result;
+
+    trace(("default_setting()\n{\n"));
     ++linum;
     if (!builtin)
         builtin = str_from_c("builtin");
-    lhs = blob_alloc(str_copy(name), builtin, linum);
+    lhs = blob_alloc(tree_variable(name), builtin, linum);
     rhs = blob_list_alloc();
-    data = symtab_query(stp, name);
+    data = default_value(name);
     if (data)
     {
         string_list_ty  wl;
@@ -455,3 +479,109 @@ stmt_assign_default(stmt_ty *sp)
     trace(("}\n"));
     return 0;
 }
+
+
+/*
+ * NAME
+ *      refers_to - does a default value use some variables
+ *
+ * SYNOPSIS
+ *      int refers_to(const char *value, const string_list_ty *names);
+ *
+ * DESCRIPTION
+ *      The refers_to function is used to tell whether the (make
+ *      syntax) default value of a variable refers to any of the named
+ *      variables.
+ */
+
+static int
+refers_to(const char *value, const string_list_ty *names)
+{
+    const char      *cp;
+    const char      *end;
+    string_ty       *s;
+    int             result;
+
+    result = 0;
+    for (cp = strstr(value, "$("); !result && cp; cp = strstr(end, "$("))
+    {
+        cp += 2;
+        end = strchr(cp, ')');
+        if (!end)
+            break;
+        s = str_n_from_c(cp, end - cp);
+        result = string_list_member(names, s);
+        str_free(s);
+    }
+    return result;
+}
+
+
+/*
+ * NAME
+ *      stmt_assign_default_depends - default variables using others
+ *
+ * SYNOPSIS
+ *      void stmt_assign_default_depends(string_list_ty *names);
+ *
+ * DESCRIPTION
+ *      The stmt_assign_default_depends function is used to add to the
+ *      list the names of the default variables whose values refer,
+ *      directly or indirectly, to any of the variables in the list.
+ *      For example, COMPILE.c is added if CFLAGS is in the list.
+ */
+
+void
+stmt_assign_default_depends(string_list_ty *names)
+{
+    table_ty        *tp;
+    string_ty       *name;
+    int             changed;
+
+    trace(("stmt_assign_default_depends()\n{\n"));
+    do
+    {
+        changed = 0;
+        for (tp = default_table; tp < ENDOF(default_table); ++tp)
+        {
+            name = str_from_c(tp->name);
+            if
+            (
+                !string_list_member(names, name)
+            &&
+                refers_to(tp->value, names)
+            )
+            {
+                trace(("%s\n", name->str_text));
+                string_list_append(names, name);
+                changed = 1;
+            }
+            str_free(name);
+        }
+    }
+    while (changed);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      stmt_assign_default_setting - default value of a variable
+ *
+ * SYNOPSIS
+ *      stmt_ty *stmt_assign_default_setting(string_ty *name);
+ *
+ * DESCRIPTION
+ *      The stmt_assign_default_setting function is used to build the
+ *      statement which gives the named variable its default value, if
+ *      it has not been given one already.
+ *
+ * RETURNS
+ *      stmt_ty *; use stmt_free when finished with it.
+ */
+
+stmt_ty *
+stmt_assign_default_setting(string_ty *name)
+{
+    return default_setting(name);
+}
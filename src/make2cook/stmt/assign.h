@@ -36,5 +36,7 @@ extern int stmt_assign_environment_variables;
 stmt_ty *stmt_assign_alloc(int override, blob_ty *lhs, int op,
         blob_list_ty *rhs);
 stmt_ty *stmt_assign_default(stmt_ty *);
+void stmt_assign_default_depends(string_list_ty *);
+stmt_ty *stmt_assign_default_setting(string_ty *);
 
 #endif /* MAKE2COOK_STMT_ASSIGN_H */
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -21,6 +21,7 @@
 #include <make2cook/emit.h>
 #include <make2cook/stmt/command.h>
 #include <common/trace.h>
+#include <make2cook/tree.h>
 #include <make2cook/variable.h>
 #include <common/str_list.h>
 
@@ -30,6 +31,8 @@ struct stmt_command_ty
 {
     STMT
     blob_ty        *text;
+    string_ty      *directory;
+    struct tree_submake_ty *submake;
 };
 
 
@@ -41,6 +44,8 @@ constructor(stmt_ty *that)
     trace(("command::constructor()\n{\n"));
     this = (stmt_command_ty *)that;
     this->text = 0;
+    this->directory = 0;
+    this->submake = 0;
     trace(("}\n"));
 }
 
@@ -54,6 +59,10 @@ destructor(stmt_ty *that)
     this = (stmt_command_ty *) that;
     if (this->text)
         blob_free(this->text);
+    if (this->directory)
+        str_free(this->directory);
+    if (this->submake)
+        tree_submake_free(this->submake);
     trace(("}\n"));
 }
 
@@ -71,6 +80,12 @@ emit(stmt_ty *that)
 
     trace(("command::emit()\n{\n"));
     this = (stmt_command_ty *)that;
+    if (this->submake)
+    {
+        /* the recipe has the targets as ingredients instead */
+        trace(("}\n"));
+        return;
+    }
     bp = this->text;
     if (!empty_quotes)
         empty_quotes = str_from_c("\"\"");
@@ -114,6 +129,12 @@ emit(stmt_ty *that)
         break;
     }
     emit_line_number(bp->line_number, bp->file_name);
+    if (this->directory)
+    {
+        emit_str("cd ");
+        emit_string(this->directory);
+        emit_str(" && ");
+    }
     emit_str(cp);
 
     if (flag.nstrings)
@@ -184,9 +205,27 @@ stmt_command_alloc(blob_ty *bp)
     this->text = blob_alloc(s, bp->file_name, bp->line_number);
     blob_free(bp);
 
+    /*
+     * Commands of makefiles in subdirectories are run there, unless
+     * they run make, when the makefile is read instead.
+     */
+    this->submake = tree_submake(s);
+    if (tree_directory())
+        this->directory = str_copy(tree_directory());
+
     /*
      * all done
      */
     trace(("}\n"));
     return result;
 }
+
+
+struct tree_submake_ty *
+stmt_command_submake(stmt_ty *that)
+{
+    stmt_command_ty *this;
+
+    this = (stmt_command_ty *)that;
+    return this->submake;
+}
@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -23,7 +23,9 @@
 #include <make2cook/stmt.h>
 
 struct blob_ty;
+struct tree_submake_ty; /* existence */
 
 stmt_ty *stmt_command_alloc(struct blob_ty *);
+struct tree_submake_ty *stmt_command_submake(stmt_ty *);
 
 #endif /* MAKE2COOK_STMT_COMMAND_H */
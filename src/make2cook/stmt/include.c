@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -23,6 +23,7 @@
 #include <make2cook/emit.h>
 #include <common/mem.h>
 #include <make2cook/stmt/include.h>
+#include <make2cook/tree.h>
 #include <make2cook/variable.h>
 
 typedef struct stmt_include_ty stmt_include_ty;
@@ -124,11 +125,20 @@ stmt_include_alloc(blob_list_ty *body, int type)
 {
     stmt_include_ty *result;
     blob_list_ty    *body2;
+    size_t          j;
 
     result = (stmt_include_ty *) stmt_alloc(&method);
     body2 = blob_list_alloc();
     variable_rename_list(body, body2, &result->ref, VAREN_QUOTE_SPACES);
     blob_list_free(body);
+    for (j = 0; j < body2->length; ++j)
+    {
+        string_ty       *s;
+
+        s = tree_file_name(body2->list[j]->text);
+        str_free(body2->list[j]->text);
+        body2->list[j]->text = s;
+    }
     result->body = body2;
     result->type = type;
     return (stmt_ty *)result;
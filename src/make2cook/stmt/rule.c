@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2001, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -26,6 +26,7 @@
 #include <make2cook/stmt/compound.h>
 #include <make2cook/stmt/rule.h>
 #include <common/trace.h>
+#include <make2cook/tree.h>
 #include <make2cook/variable.h>
 #include <common/str_list.h>
 
@@ -53,6 +54,9 @@ struct stmt_rule_ty
     int             fake;
     string_ty       *archive_target;
     string_ty       *archive_member;
+    size_t          nsubmakes;
+    size_t          nsubmakes_max;
+    struct tree_submake_ty **submake;
 };
 
 static string_list_ty phony;
@@ -93,6 +97,59 @@ suffix_init(void)
 }
 
 
+/*
+ * NAME
+ *      implicit_rule_name - name of an implicit rule
+ *
+ * SYNOPSIS
+ *      string_ty *implicit_rule_name(string_ty *name);
+ *
+ * DESCRIPTION
+ *      The implicit_rule_name function is used to name an implicit
+ *      rule in the list of those already done.  The makefile of each
+ *      subdirectory has its own implicit rules (see tree_gram), so
+ *      those names have the directory as a prefix.
+ *
+ * RETURNS
+ *      string_ty *; the name, use str_free when finished with it.
+ */
+
+static string_ty *
+implicit_rule_name(string_ty *name)
+{
+    string_ty       *dir;
+
+    dir = tree_directory();
+    if (!dir)
+        return str_copy(name);
+    return str_format("%s/%s", dir->str_text, name->str_text);
+}
+
+
+static void
+implicit_rule_done(string_ty *name)
+{
+    string_ty       *s;
+
+    s = implicit_rule_name(name);
+    string_list_append(&implict_rules_done, s);
+    str_free(s);
+}
+
+
+static int
+implicit_rule_is_done(string_ty *name)
+{
+    string_ty       *s;
+    int             result;
+
+    s = implicit_rule_name(name);
+    result = string_list_member(&implict_rules_done, s);
+    str_free(s);
+    return result;
+}
+
+
 static void
 check_for_default(stmt_rule_ty *this)
 {
@@ -177,7 +234,11 @@ check_for_phony(stmt_rule_ty *this)
         this->fake = fake_phony;
         for (j = 0; j < this->ingredient->length; ++j)
         {
-            string_list_append_unique(&phony, this->ingredient->list[j]->text);
+            string_ty       *s;
+
+            s = tree_file_name(this->ingredient->list[j]->text);
+            string_list_append_unique(&phony, s);
+            str_free(s);
         }
     }
     trace(("}\n"));
@@ -204,11 +265,11 @@ check_for_precious(stmt_rule_ty *this)
         this->fake = fake_precious;
         for (j = 0; j < this->ingredient->length; ++j)
         {
-            string_list_append_unique
-            (
-                &precious,
-                this->ingredient->list[j]->text
-            );
+            string_ty       *s;
+
+            s = tree_file_name(this->ingredient->list[j]->text);
+            string_list_append_unique(&precious, s);
+            str_free(s);
         }
     }
     trace(("}\n"));
@@ -315,6 +376,9 @@ constructor(stmt_ty *that)
     this->fake = 0;
     this->archive_target = 0;
     this->archive_member = 0;
+    this->nsubmakes = 0;
+    this->nsubmakes_max = 0;
+    this->submake = 0;
     trace(("}\n"));
 }
 
@@ -342,6 +406,8 @@ destructor(stmt_ty *that)
         str_free(this->archive_target);
     if (this->archive_member)
         str_free(this->archive_member);
+    if (this->submake)
+        mem_free(this->submake);
     trace(("}\n"));
 }
 
@@ -404,6 +470,8 @@ emit(stmt_ty *that)
         emit_char(' ');
         blob_emit(this->ingredient->list[j]);
     }
+    for (j = 0; j < this->nsubmakes; ++j)
+        tree_submake_emit(this->submake[j]);
 
     /*
      * see if the recipe should have any flags
@@ -576,7 +644,7 @@ stmt_rule_alloc(blob_list_ty *lhs, int op, blob_list_ty *rhs, blob_list_ty *set,
     if (lhs->length == 1 && single_suffix(lhs->list[0]->text))
     {
         trace(("mark\n"));
-        string_list_append(&implict_rules_done, lhs->list[0]->text);
+        implicit_rule_done(lhs->list[0]->text);
         blob_list_prepend
         (
             rhs,
@@ -598,7 +666,7 @@ stmt_rule_alloc(blob_list_ty *lhs, int op, blob_list_ty *rhs, blob_list_ty *set,
             archive_target = str_format("%%0%%1%s", s2->str_text);
             archive_member = str_format("%%%s", s1->str_text);
         }
-        string_list_append(&implict_rules_done, lhs->list[0]->text);
+        implicit_rule_done(lhs->list[0]->text);
         blob_list_append
         (
             lhs,
@@ -782,6 +850,29 @@ stmt_rule_alloc(blob_list_ty *lhs, int op, blob_list_ty *rhs, blob_list_ty *set,
     check_for_precious(result);
     check_for_silent(result);
     check_for_suffixes(result);
+
+    /*
+     * file names of makefiles in subdirectories are relative to the
+     * top directory
+     */
+    if (!result->fake && tree_directory())
+    {
+        size_t          j;
+
+        tree_target(lhs2->list[0]->text);
+        for (j = 0; j < lhs2->length; ++j)
+        {
+            s1 = tree_file_name(lhs2->list[j]->text);
+            str_free(lhs2->list[j]->text);
+            lhs2->list[j]->text = s1;
+        }
+        for (j = 0; j < rhs2->length; ++j)
+        {
+            s1 = tree_file_name(rhs2->list[j]->text);
+            str_free(rhs2->list[j]->text);
+            rhs2->list[j]->text = s1;
+        }
+    }
     trace(("}\n"));
     return (stmt_ty *) result;
 }
@@ -800,6 +891,45 @@ stmt_rule_body(stmt_ty *that, stmt_ty *body)
 }
 
 
+/*
+ * NAME
+ *      stmt_rule_submake - note a recursive make
+ *
+ * SYNOPSIS
+ *      void stmt_rule_submake(stmt_ty *rule, stmt_ty *command);
+ *
+ * DESCRIPTION
+ *      The stmt_rule_submake function is used to note a command of
+ *      the rule which runs make in another directory.  The targets it
+ *      would have made become ingredients of the rule.
+ */
+
+void
+stmt_rule_submake(stmt_ty *that, stmt_ty *command)
+{
+    stmt_rule_ty    *this;
+    struct tree_submake_ty *smp;
+
+    smp = stmt_command_submake(command);
+    if (!smp)
+        return;
+    trace(("stmt_rule_submake()\n{\n"));
+    this = (stmt_rule_ty *)that;
+    if (this->nsubmakes >= this->nsubmakes_max)
+    {
+        this->nsubmakes_max = this->nsubmakes_max * 2 + 4;
+        this->submake =
+            mem_change_size
+            (
+                this->submake,
+                this->nsubmakes_max * sizeof(this->submake[0])
+            );
+    }
+    this->submake[this->nsubmakes++] = smp;
+    trace(("}\n"));
+}
+
+
 void
 stmt_rule_context(stmt_ty *that)
 {
@@ -1408,7 +1538,7 @@ stmt_rule_default(int n)
         s = str_catenate(ingredient, target);
         str_free(ingredient);
         str_free(target);
-        if (string_list_member(&implict_rules_done, s))
+        if (implicit_rule_is_done(s))
         {
             str_free(s);
             continue;
@@ -1495,13 +1625,13 @@ stmt_rule_default(int n)
         s = str_format("%s:%s", ingredient->str_text, target->str_text);
         str_free(ingredient);
         str_free(target);
-        if (string_list_member(&implict_rules_done, s))
+        if (implicit_rule_is_done(s))
         {
             str_free(s);
             continue;
         }
         trace(("\"%s\"\n", s->str_text));
-        string_list_append(&implict_rules_done, s);
+        implicit_rule_done(s);
         str_free(s);
 
         /*
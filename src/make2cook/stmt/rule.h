@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 2006-2008 Peter Miller
+ *      Copyright (C) 1994, 1997, 2006-2008, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -30,6 +30,7 @@ stmt_ty *stmt_rule_alloc(blob_list_ty *lhs, int op, blob_list_ty *rhs,
         blob_list_ty *single_thread);
 void stmt_rule_body(stmt_ty *, stmt_ty *);
 void stmt_rule_context(stmt_ty *);
+void stmt_rule_submake(stmt_ty *rule, stmt_ty *command);
 stmt_ty *stmt_rule_default(int);
 
 #endif /* MAKE2COOK_STMT_RULE_H */
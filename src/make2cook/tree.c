@@ -0,0 +1,834 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ *
+ * This file contains the functions used to convert a tree of
+ * recursive makefiles into a single cookbook.
+ *
+ * A command which runs make in another directory (a literal "$(MAKE)
+ * -C dir" or "cd dir && $(MAKE)") is not copied into the cookbook.
+ * Instead, the makefile in that directory is also read, and the
+ * targets the command would have made become ingredients of the
+ * recipe.  All of the makefiles end up in a single cookbook, so cook
+ * sees the dependencies of the whole project at once and can work in
+ * several directories in parallel.
+ *
+ * The file names of a makefile in a subdirectory are rewritten to be
+ * relative to the top directory, and its commands are run in its own
+ * directory.  Variables it assigns are given the directory as a prefix
+ * (so that "CFLAGS" in "lib/Makefile" becomes "lib/CFLAGS"), so they
+ * do not collide with variables of the same name in other makefiles.
+ * The makefile is read twice, once to find which variables it assigns,
+ * and then again to translate it.  Internal rules which use any of
+ * those variables are copied for that directory, to use them.
+ */
+
+#include <common/ac/string.h>
+#include <common/ac/unistd.h>
+
+#include <common/error_intl.h>
+#include <common/mem.h>
+#include <common/str_list.h>
+#include <common/trace.h>
+#include <make2cook/emit.h>
+#include <make2cook/gram.h>
+#include <make2cook/stmt.h>
+#include <make2cook/stmt/assign.h>
+#include <make2cook/stmt/compound.h>
+#include <make2cook/stmt/rule.h>
+#include <make2cook/tree.h>
+
+typedef struct tree_dir_ty tree_dir_ty;
+struct tree_dir_ty
+{
+    string_ty       *path;          /* relative to the top directory */
+    string_ty       *makefile;      /* relative to path */
+    string_list_ty  scope;          /* variables the makefile assigns */
+    string_ty       *default_target;
+};
+
+typedef struct tree_submake_ty tree_submake_ty;
+struct tree_submake_ty
+{
+    tree_dir_ty     *dir;
+    string_list_ty  target;
+};
+
+int             tree_recursive;
+static string_ty *top_dir;
+static tree_dir_ty **dir;
+static size_t   ndirs;
+static size_t   ndirs_max;
+static tree_dir_ty *current;
+
+
+/*
+ * NAME
+ *      path_join - combine file names
+ *
+ * SYNOPSIS
+ *      string_ty *path_join(string_ty *dir, string_ty *rel);
+ *
+ * DESCRIPTION
+ *      The path_join function is used to combine a directory and a
+ *      relative file name, removing any "." and "name/.." parts.
+ *
+ * RETURNS
+ *      string_ty *; the file name, or NULL if it would be outside the
+ *      top directory.
+ */
+
+static string_ty *
+path_join(string_ty *dir_name, string_ty *rel)
+{
+    string_ty       *s;
+    string_ty       *result;
+    string_list_ty  wl;
+    string_list_ty  part;
+    size_t          j;
+
+    if (rel->str_text[0] == '/')
+        return 0;
+    s = str_format("%s/%s", dir_name->str_text, rel->str_text);
+    str2wl(&wl, s, "/", 0);
+    str_free(s);
+    string_list_constructor(&part);
+    result = 0;
+    for (j = 0; j < wl.nstrings; ++j)
+    {
+        s = wl.string[j];
+        if (!s->str_length || !strcmp(s->str_text, "."))
+            continue;
+        if (!strcmp(s->str_text, ".."))
+        {
+            if (!part.nstrings)
+                goto done;
+            str_free(part.string[--part.nstrings]);
+            continue;
+        }
+        string_list_append(&part, s);
+    }
+    if (part.nstrings)
+        result = wl2str(&part, 0, part.nstrings - 1, "/");
+    else
+        result = str_from_c(".");
+  done:
+    string_list_destructor(&part);
+    string_list_destructor(&wl);
+    return result;
+}
+
+
+static string_ty *
+dir_file_name(string_ty *path, string_ty *makefile)
+{
+    if (!strcmp(path->str_text, "."))
+    {
+        if (!strcmp(top_dir->str_text, "."))
+            return str_copy(makefile);
+        return str_format("%s/%s", top_dir->str_text, makefile->str_text);
+    }
+    if (!strcmp(top_dir->str_text, "."))
+        return str_format("%s/%s", path->str_text, makefile->str_text);
+    return
+        str_format
+        (
+            "%s/%s/%s",
+            top_dir->str_text,
+            path->str_text,
+            makefile->str_text
+        );
+}
+
+
+static tree_dir_ty *
+dir_find(string_ty *path, string_ty *makefile)
+{
+    size_t          j;
+    tree_dir_ty     *dp;
+
+    for (j = 0; j < ndirs; ++j)
+    {
+        dp = dir[j];
+        if (str_equal(dp->path, path) && str_equal(dp->makefile, makefile))
+            return dp;
+    }
+    trace(("queue \"%s\" \"%s\"\n", path->str_text, makefile->str_text));
+    dp = mem_alloc(sizeof(tree_dir_ty));
+    dp->path = str_copy(path);
+    dp->makefile = str_copy(makefile);
+    string_list_constructor(&dp->scope);
+    dp->default_target = 0;
+    if (ndirs >= ndirs_max)
+    {
+        ndirs_max = ndirs_max * 2 + 4;
+        dir = mem_change_size(dir, ndirs_max * sizeof(dir[0]));
+    }
+    dir[ndirs++] = dp;
+    return dp;
+}
+
+
+/*
+ * NAME
+ *      uses_scope - does a rule use scoped variables
+ *
+ * SYNOPSIS
+ *      int uses_scope(stmt_ty *sp, tree_dir_ty *dp);
+ *
+ * DESCRIPTION
+ *      The uses_scope function is used to tell whether a statement
+ *      refers to any of the variables assigned by the makefile of the
+ *      given directory.
+ */
+
+static int
+uses_scope(stmt_ty *sp, tree_dir_ty *dp)
+{
+    size_t          j;
+    string_ty       *s;
+    int             result;
+
+    result = 0;
+    for (j = 0; !result && j < dp->scope.nstrings; ++j)
+    {
+        s =
+            str_format
+            (
+                "%s/%s",
+                dp->path->str_text,
+                dp->scope.string[j]->str_text
+            );
+        result =
+            (
+                string_list_member(&sp->ref, s)
+            ||
+                string_list_member(&sp->rref, s)
+            );
+        str_free(s);
+    }
+    return result;
+}
+
+
+/*
+ * NAME
+ *      dir_implicit_rules - implicit rules of a subdirectory
+ *
+ * SYNOPSIS
+ *      void dir_implicit_rules(stmt_ty *result, tree_dir_ty *dp);
+ *
+ * DESCRIPTION
+ *      The dir_implicit_rules function is used to give a subdirectory
+ *      its own copy of each internal rule which uses a variable its
+ *      makefile assigns (such as CFLAGS, usually by way of a default
+ *      variable such as COMPILE.c), so that files in it are made with
+ *      its settings, and in it, as make would have done.  The copies
+ *      only match files below that directory, and come before the
+ *      ordinary internal rules, so cook tries them first.
+ */
+
+static void
+dir_implicit_rules(stmt_ty *result, tree_dir_ty *dp)
+{
+    int             j;
+    size_t          k;
+    size_t          nassigned;
+    stmt_ty         *sp;
+    string_list_ty  need;
+    string_list_ty  done;
+    string_ty       *s;
+    int             changed;
+
+    if (!dp->scope.nstrings)
+        return;
+    trace(("dir_implicit_rules(\"%s\")\n{\n", dp->path->str_text));
+    current = dp;
+
+    /*
+     * The default variables which use the makefile's variables need
+     * their own copies, too.
+     */
+    nassigned = dp->scope.nstrings;
+    stmt_assign_default_depends(&dp->scope);
+
+    string_list_constructor(&need);
+    for (j = 0; ; ++j)
+    {
+        sp = stmt_rule_default(j);
+        if (!sp)
+            break;
+        if (!uses_scope(sp, dp))
+        {
+            stmt_free(sp);
+            continue;
+        }
+        string_list_append_list_unique(&need, &sp->ref);
+        string_list_append_list_unique(&need, &sp->rref);
+        stmt_compound_append(result, sp);
+    }
+
+    /*
+     * Give the copies of the default variables their default values,
+     * as they are needed.
+     */
+    string_list_constructor(&done);
+    do
+    {
+        changed = 0;
+        for (k = nassigned; k < dp->scope.nstrings; ++k)
+        {
+            s = tree_variable(dp->scope.string[k]);
+            if
+            (
+                string_list_member(&need, s)
+            &&
+                !string_list_member(&done, s)
+            )
+            {
+                sp = stmt_assign_default_setting(dp->scope.string[k]);
+                string_list_append_list_unique(&need, &sp->ref);
+                stmt_compound_append(result, sp);
+                string_list_append(&done, s);
+                changed = 1;
+            }
+            str_free(s);
+        }
+    }
+    while (changed);
+    string_list_destructor(&done);
+    string_list_destructor(&need);
+
+    current = 0;
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      tree_gram - translate a tree of makefiles
+ *
+ * SYNOPSIS
+ *      void tree_gram(char *filename);
+ *
+ * DESCRIPTION
+ *      The tree_gram function is used to read the top makefile, and
+ *      then each makefile it (or they) run make on, and write them all
+ *      out as a single cookbook.
+ */
+
+void
+tree_gram(char *filename)
+{
+    stmt_ty         *result;
+    stmt_ty         *sp;
+    string_ty       *s;
+    string_ty       *path;
+    size_t          j;
+    tree_dir_ty     *dp;
+
+    trace(("tree_gram(filename = %p)\n{\n", filename));
+    if (filename)
+    {
+        char            *cp;
+
+        cp = strrchr(filename, '/');
+        if (cp)
+        {
+            top_dir = str_n_from_c(filename, cp - filename);
+            s = str_from_c(cp + 1);
+        }
+        else
+        {
+            top_dir = str_from_c(".");
+            s = str_from_c(filename);
+        }
+    }
+    else
+    {
+        top_dir = str_from_c(".");
+        s = str_from_c("");
+    }
+    path = str_from_c(".");
+    dir_find(path, s);
+    str_free(path);
+    str_free(s);
+
+    current = 0;
+    result = gram_read(filename);
+
+    /*
+     * The list of directories grows as each makefile is read.
+     */
+    for (j = 1; j < ndirs; ++j)
+    {
+        dp = dir[j];
+        s = dir_file_name(dp->path, dp->makefile);
+        current = dp;
+
+        /*
+         * The first pass is only to find the variables the makefile
+         * assigns.  The variables referenced by the second pass will be
+         * scoped accordingly.
+         */
+        sp = gram_read(s->str_text);
+        string_list_append_list_unique(&dp->scope, &sp->cdef);
+        stmt_free(sp);
+
+        sp = gram_read(s->str_text);
+        stmt_compound_append(result, sp);
+        str_free(s);
+    }
+    current = 0;
+
+    if (!no_internal_rules)
+    {
+        for (j = 1; j < ndirs; ++j)
+            dir_implicit_rules(result, dir[j]);
+    }
+
+    gram_emit(result);
+    trace(("}\n"));
+}
+
+
+/*
+ * NAME
+ *      tree_directory - current directory
+ *
+ * SYNOPSIS
+ *      string_ty *tree_directory(void);
+ *
+ * DESCRIPTION
+ *      The tree_directory function is used to find the directory of
+ *      the makefile being read, relative to the top directory.
+ *
+ * RETURNS
+ *      string_ty *; the directory, or NULL for the top directory.
+ *      Do not free it.
+ */
+
+string_ty *
+tree_directory(void)
+{
+    return (current ? current->path : 0);
+}
+
+
+/*
+ * NAME
+ *      tree_variable - scope a variable name
+ *
+ * SYNOPSIS
+ *      string_ty *tree_variable(string_ty *name);
+ *
+ * DESCRIPTION
+ *      The tree_variable function is used to give a variable its cook
+ *      name.  If the makefile being read assigns it, the name has the
+ *      directory as a prefix.  Otherwise, it is inherited from the
+ *      top-level makefile (or the defaults) unchanged.
+ *
+ * RETURNS
+ *      string_ty *; the name, use str_free when finished with it.
+ */
+
+string_ty *
+tree_variable(string_ty *name)
+{
+    if (current && string_list_member(&current->scope, name))
+    {
+        return
+            str_format("%s/%s", current->path->str_text, name->str_text);
+    }
+    return str_copy(name);
+}
+
+
+/*
+ * NAME
+ *      tree_file_name - file name relative to the top
+ *
+ * SYNOPSIS
+ *      string_ty *tree_file_name(string_ty *word);
+ *
+ * DESCRIPTION
+ *      The tree_file_name function is used to rewrite a (translated)
+ *      file name in the makefile being read so that it is relative to
+ *      the top directory.  Words containing variables or functions are
+ *      given a prefix when the cookbook is read.
+ *
+ * RETURNS
+ *      string_ty *; the name, use str_free when finished with it.
+ */
+
+string_ty *
+tree_file_name(string_ty *word)
+{
+    if (!current || word->str_text[0] == '/')
+        return str_copy(word);
+    if (strchr(word->str_text, '['))
+    {
+        return
+            str_format
+            (
+                "[addprefix %s/ %s]",
+                current->path->str_text,
+                word->str_text
+            );
+    }
+    return str_format("%s/%s", current->path->str_text, word->str_text);
+}
+
+
+/*
+ * NAME
+ *      tree_target - note a target
+ *
+ * SYNOPSIS
+ *      void tree_target(string_ty *target);
+ *
+ * DESCRIPTION
+ *      The tree_target function is used to note the target of each
+ *      rule as it is read.  The first one which is not a pattern or a
+ *      special target is the one make would build by default.
+ */
+
+void
+tree_target(string_ty *target)
+{
+    if (!current || current->default_target)
+        return;
+    if (target->str_text[0] == '.' || strpbrk(target->str_text, "%["))
+        return;
+    current->default_target = str_copy(target);
+}
+
+
+static string_ty *
+unquote(string_ty *s)
+{
+    char            *buf;
+    char            *cp;
+    char            *ip;
+    string_ty       *result;
+
+    buf = mem_alloc(s->str_length + 1);
+    cp = buf;
+    for (ip = s->str_text; *ip; ++ip)
+    {
+        if (*ip == '\\' && ip[1])
+            ++ip;
+        *cp++ = *ip;
+    }
+    result = str_n_from_c(buf, cp - buf);
+    mem_free(buf);
+    return result;
+}
+
+
+static int
+option_value(string_list_ty *wl, size_t *jp, char *name, char *long_name,
+    string_ty **result)
+{
+    string_ty       *w;
+    size_t          len;
+
+    w = wl->string[*jp];
+    if (!strcmp(w->str_text, name))
+    {
+        if (*jp + 1 >= wl->nstrings)
+            return -1;
+        ++*jp;
+        *result = str_copy(wl->string[*jp]);
+        return 1;
+    }
+    if (!strncmp(w->str_text, name, 2) && w->str_length > 2)
+    {
+        *result = str_from_c(w->str_text + 2);
+        return 1;
+    }
+    len = strlen(long_name);
+    if (!strncmp(w->str_text, long_name, len) && w->str_text[len] == '=')
+    {
+        *result = str_from_c(w->str_text + len + 1);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * NAME
+ *      tree_submake - recognize a recursive make
+ *
+ * SYNOPSIS
+ *      tree_submake_ty *tree_submake(string_ty *command);
+ *
+ * DESCRIPTION
+ *      The tree_submake function is used to see if a (translated)
+ *      command runs make on a makefile in another directory.  The
+ *      forms recognized are
+ *
+ *              $(MAKE) -C dir [ -f makefile ] [ target... ]
+ *              cd dir && $(MAKE) [ -f makefile ] [ target... ]
+ *
+ *      where the directory and targets are literal, and the makefile
+ *      exists.  Other options and variable assignments on the command
+ *      line are ignored.
+ *
+ * RETURNS
+ *      tree_submake_ty *; a pointer to the sub-make, or NULL if the
+ *      command must be left alone.
+ */
+
+tree_submake_ty *
+tree_submake(string_ty *command)
+{
+    string_ty       *s;
+    string_ty       *s2;
+    string_list_ty  wl;
+    size_t          j;
+    string_ty       *path;
+    string_ty       *makefile;
+    string_list_ty  target;
+    tree_submake_ty *result;
+    char            *cp;
+
+    if (!tree_recursive)
+        return 0;
+    trace(("tree_submake(\"%s\")\n{\n", command->str_text));
+
+    /*
+     * Break the command into words, with semicolons as words of
+     * their own.
+     */
+    for (cp = command->str_text; *cp && strchr("@-+ \t", *cp); ++cp)
+        ;
+    s = str_from_c(cp);
+    s2 = str_from_c("\\;");
+    path = str_from_c(" ; ");
+    command = str_substitute(s2, path, s);
+    str_free(s);
+    str_free(s2);
+    str_free(path);
+    str2wl(&wl, command, (char *)0, 0);
+    str_free(command);
+
+    result = 0;
+    makefile = 0;
+    string_list_constructor(&target);
+    if (current)
+        path = str_copy(current->path);
+    else
+        path = str_from_c(".");
+    j = 0;
+    if (wl.nstrings >= 3 && !strcmp(wl.string[0]->str_text, "cd"))
+    {
+        if
+        (
+            strcmp(wl.string[2]->str_text, "&&")
+        &&
+            strcmp(wl.string[2]->str_text, ";")
+        )
+            goto done;
+        s = unquote(wl.string[1]);
+        s2 = path_join(path, s);
+        str_free(s);
+        str_free(path);
+        path = s2;
+        if (!path || strchr(path->str_text, '['))
+            goto done;
+        j = 3;
+    }
+    if
+    (
+        j >= wl.nstrings
+    ||
+        (
+            strcmp(wl.string[j]->str_text, "[self]")
+        &&
+            strcmp(wl.string[j]->str_text, "make")
+        )
+    )
+        goto done;
+    for (++j; j < wl.nstrings; ++j)
+    {
+        s = unquote(wl.string[j]);
+        if (strpbrk(s->str_text, "[]|&;<>()`$\"'"))
+        {
+            /* something we can't follow */
+            str_free(s);
+            goto done;
+        }
+        str_free(s);
+        switch (option_value(&wl, &j, "-C", "--directory", &s))
+        {
+        case -1:
+            goto done;
+
+        case 0:
+            break;
+
+        default:
+            s2 = unquote(s);
+            str_free(s);
+            s = path_join(path, s2);
+            str_free(s2);
+            str_free(path);
+            path = s;
+            if (!path || strchr(path->str_text, '['))
+                goto done;
+            continue;
+        }
+        switch (option_value(&wl, &j, "-f", "--file", &s))
+        {
+        case -1:
+            goto done;
+
+        case 0:
+            break;
+
+        default:
+            if (makefile)
+                str_free(makefile);
+            makefile = unquote(s);
+            str_free(s);
+            if (strchr(makefile->str_text, '['))
+                goto done;
+            continue;
+        }
+        s = wl.string[j];
+        if (s->str_text[0] == '-')
+        {
+            /* skip the number of jobs or the load average */
+            if
+            (
+                (!strcmp(s->str_text, "-j") || !strcmp(s->str_text, "-l"))
+            &&
+                j + 1 < wl.nstrings
+            &&
+                strspn(wl.string[j + 1]->str_text, "0123456789.")
+            ==
+                wl.string[j + 1]->str_length
+            )
+                ++j;
+            continue;
+        }
+        if (strchr(s->str_text, '='))
+            continue;
+        s = unquote(s);
+        string_list_append(&target, s);
+        str_free(s);
+    }
+
+    /*
+     * It must be a different directory, and there must be a makefile
+     * there.
+     */
+    if (current ? str_equal(path, current->path) : !strcmp(path->str_text, "."))
+        goto done;
+    if (makefile)
+    {
+        s = dir_file_name(path, makefile);
+        if (access(s->str_text, F_OK))
+        {
+            str_free(s);
+            goto done;
+        }
+        str_free(s);
+    }
+    else
+    {
+        static char     *name[] = { "GNUmakefile", "makefile", "Makefile" };
+
+        for (j = 0; ; ++j)
+        {
+            if (j >= SIZEOF(name))
+                goto done;
+            makefile = str_from_c(name[j]);
+            s = dir_file_name(path, makefile);
+            if (!access(s->str_text, F_OK))
+            {
+                str_free(s);
+                break;
+            }
+            str_free(s);
+            str_free(makefile);
+            makefile = 0;
+        }
+    }
+
+    result = mem_alloc(sizeof(tree_submake_ty));
+    result->dir = dir_find(path, makefile);
+    string_list_copy_constructor(&result->target, &target);
+
+  done:
+    string_list_destructor(&target);
+    string_list_destructor(&wl);
+    if (path)
+        str_free(path);
+    if (makefile)
+        str_free(makefile);
+    trace(("return %p;\n", result));
+    trace(("}\n"));
+    return result;
+}
+
+
+/*
+ * NAME
+ *      tree_submake_emit - write sub-make ingredients
+ *
+ * SYNOPSIS
+ *      void tree_submake_emit(tree_submake_ty *);
+ *
+ * DESCRIPTION
+ *      The tree_submake_emit function is used to write the targets of
+ *      a sub-make as ingredients of a recipe.  By now every makefile
+ *      has been read, so the default target is known.
+ */
+
+void
+tree_submake_emit(tree_submake_ty *smp)
+{
+    size_t          j;
+    string_ty       *path;
+
+    path = smp->dir->path;
+    for (j = 0; j < smp->target.nstrings; ++j)
+    {
+        emit_char(' ');
+        emit_string(path);
+        emit_char('/');
+        emit_string(smp->target.string[j]);
+    }
+    if (!smp->target.nstrings && smp->dir->default_target)
+    {
+        emit_char(' ');
+        emit_string(path);
+        emit_char('/');
+        emit_string(smp->dir->default_target);
+    }
+}
+
+
+void
+tree_submake_free(tree_submake_ty *smp)
+{
+    string_list_destructor(&smp->target);
+    mem_free(smp);
+}
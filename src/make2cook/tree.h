@@ -0,0 +1,40 @@
+/*
+ *      cook - file construction tool
+ *      Copyright (C) 2026 Peter Miller
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 3 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program. If not, see
+ *      <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAKE2COOK_TREE_H
+#define MAKE2COOK_TREE_H
+
+#include <common/main.h>
+
+extern int tree_recursive;
+
+struct string_ty; /* existence */
+struct tree_submake_ty; /* existence */
+
+void tree_gram(char *);
+struct string_ty *tree_directory(void);
+struct string_ty *tree_variable(struct string_ty *);
+struct string_ty *tree_file_name(struct string_ty *);
+void tree_target(struct string_ty *);
+
+struct tree_submake_ty *tree_submake(struct string_ty *);
+void tree_submake_emit(struct tree_submake_ty *);
+void tree_submake_free(struct tree_submake_ty *);
+
+#endif /* MAKE2COOK_TREE_H */
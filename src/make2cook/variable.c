@@ -1,6 +1,6 @@
 /*
  *      cook - file construction tool
- *      Copyright (C) 1994, 1997, 1998, 2001, 2002, 2006-2010 Peter Miller
+ *      Copyright (C) 1994, 1997, 1998, 2001, 2002, 2006-2010, 2026 Peter Miller
  *
  *      This program is free software; you can redistribute it and/or modify
  *      it under the terms of the GNU General Public License as published by
@@ -24,6 +24,7 @@
 #include <common/error_intl.h>
 #include <common/symtab.h>
 #include <common/trace.h>
+#include <make2cook/tree.h>
 #include <make2cook/vargram.h>
 #include <make2cook/variable.h>
 #include <make2cook/vargram.yacc.h>      /* must be last */
@@ -38,6 +39,7 @@ static int      lex_quote_quotes;
 static string_list_ty *reference;
 static symtab_ty *symtab;
 static symtab_ty *special;
+static symtab_ty *subdirectory;
 static string_list_ty result;
 static int      allow_archive_parens;
 
@@ -80,6 +82,23 @@ init(void)
         { "VPATH", "[search_list]" },
     };
 
+    /*
+     * The commands of a makefile in a subdirectory are run in that
+     * directory, but the file names cook gives them are relative to
+     * the top directory.  Make them absolute.
+     */
+    static table_ty subdirectory_table[] =
+    {
+        { "<", "[pathname [resolve [head [need]]]]" },
+        { "<D", "[dirname [pathname [resolve [head [need]]]]]" },
+        { "?", "[pathname [resolve [younger]]]" },
+        { "?D", "[dirname [pathname [resolve [younger]]]]" },
+        { "@", "[pathname [target]]" },
+        { "@D", "[dirname [pathname [target]]]" },
+        { "^", "[pathname [resolve [need]]]" },
+        { "^D", "[dirname [pathname [resolve [need]]]]" },
+    };
+
     table_ty        *tp;
     string_ty       *name;
     string_ty       *value;
@@ -95,6 +114,19 @@ init(void)
         symtab_assign(symtab, name, value);
         str_free(name);
     }
+    subdirectory = symtab_alloc(SIZEOF(subdirectory_table));
+    for
+    (
+        tp = subdirectory_table;
+        tp < ENDOF(subdirectory_table);
+        ++tp
+    )
+    {
+        name = str_from_c(tp->name);
+        value = str_from_c(tp->value);
+        symtab_assign(subdirectory, name, value);
+        str_free(name);
+    }
     trace(("}\n"));
 }
 
@@ -110,14 +142,20 @@ variable_mangle_lookup(string_ty *name)
     data = 0;
     if (special)
         data = symtab_query(special, name);
+    if (!data && tree_directory())
+        data = symtab_query(subdirectory, name);
     if (!data)
         data = symtab_query(symtab, name);
     if (data)
         retval = str_copy(data);
     else
     {
-        string_list_append_unique(reference, name);
-        retval = str_format("[%s]", name->str_text);
+        string_ty       *s;
+
+        s = tree_variable(name);
+        string_list_append_unique(reference, s);
+        retval = str_format("[%s]", s->str_text);
+        str_free(s);
     }
     trace(("return \"%s\";\n", retval->str_text));
     trace(("}\n"));
@@ -128,7 +166,11 @@ variable_mangle_lookup(string_ty *name)
 void
 variable_mangle_forget(string_ty *name)
 {
-    string_list_remove(reference, name);
+    string_ty       *s;
+
+    s = tree_variable(name);
+    string_list_remove(reference, s);
+    str_free(s);
 }
 
 
@@ -0,0 +1,138 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+TZ=UTC
+export TZ
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 1; fi
+
+bin="$here/${1-.}/bin"
+
+fail()
+{
+    set +x
+    echo 'FAILED test of the c_incl include resolution cache' 1>&2
+    cd $here
+    rm -rf $work
+    exit 1
+}
+no_result()
+{
+    set +x
+    echo 'NO RESULT for test of the c_incl include resolution cache' 1>&2
+    cd $here
+    rm -rf $work
+    exit 2
+}
+pass()
+{
+    set +x
+    cd $here
+    rm -rf $work
+    exit 0
+}
+trap "no_result" 1 2 3 15
+
+mkdir $work $work/inc1 $work/inc2
+if test $? -ne 0 ; then exit 2; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+echo '/* second */' > inc2/foo.h
+test $? -eq 0 || no_result
+
+cat > main.c << 'fubar'
+#include <foo.h>
+#include <nonesuch.h>
+fubar
+test $? -eq 0 || no_result
+
+cat > ok << 'fubar'
+inc2/foo.h
+fubar
+test $? -eq 0 || no_result
+
+#
+# The first run finds the file in the second directory, and remembers
+# that it is absent from the first.
+#
+$bin/c_incl -cache -ns -Iinc1 -Iinc2 main.c > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+test -f .c_inclrc || fail
+
+#
+# Directories changed in the same second as they were examined are
+# not written to the cache file, so wait before running again.
+#
+sleep 2
+$bin/c_incl -cache -ns -Iinc1 -Iinc2 main.c > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+
+#
+# Adding a file to the first directory must invalidate the remembered
+# absence.  The includer is changed, too, so that its own cache entry
+# is re-scanned.
+#
+echo '/* first */' > inc1/foo.h
+test $? -eq 0 || no_result
+echo '/* changed */' >> main.c
+test $? -eq 0 || no_result
+
+cat > ok << 'fubar'
+inc1/foo.h
+fubar
+test $? -eq 0 || no_result
+
+$bin/c_incl -cache -ns -Iinc1 -Iinc2 main.c > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+
+#
+# The same again, without the cache file.
+#
+$bin/c_incl -no_cache -ns -Iinc1 -Iinc2 main.c > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+TZ=UTC
+export TZ
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 1; fi
+
+bin="$here/${1-.}/bin"
+
+fail()
+{
+    set +x
+    echo 'FAILED test of the c_incl block line scanning' 1>&2
+    cd $here
+    rm -rf $work
+    exit 1
+}
+no_result()
+{
+    set +x
+    echo 'NO RESULT for test of the c_incl block line scanning' 1>&2
+    cd $here
+    rm -rf $work
+    exit 2
+}
+pass()
+{
+    set +x
+    cd $here
+    rm -rf $work
+    exit 0
+}
+trap "no_result" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then exit 2; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+for f in a b c d e f g
+do
+    echo "/* $f */" > $f.h
+    test $? -eq 0 || no_result
+done
+
+#
+# Indented directives, directives after a very long line (longer than
+# the scanner's block), a '#' which does not start a line, CR LF line
+# endings, and a last line without a newline.
+#
+awk 'BEGIN {
+    print "#include \"a.h\"";
+    print "   #  include \"b.h\"";
+    s = "int x; /* #include \"nothere.h\" */";
+    for (i = 0; i < 12; ++i)
+        s = s s;
+    print s;
+    print "\t#include \"c.h\"\r";
+    printf "#include \"d.h\"\r\n";
+    print "x = 1; #include \"notthere.h\"";
+    printf "#include \"e.h\"";
+}' > main.c
+test $? -eq 0 || no_result
+
+cat > ok << 'fubar'
+a.h
+b.h
+c.h
+d.h
+e.h
+fubar
+test $? -eq 0 || no_result
+
+$bin/c_incl -no_cache -ns main.c > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+
+#
+# roff control lines must start in the first column.
+#
+cat > main.ms << 'fubar'
+.so f.h
+ .so nothere.h
+text .so nothere.h
+.so g.h
+fubar
+test $? -eq 0 || no_result
+
+cat > ok << 'fubar'
+f.h
+g.h
+fubar
+test $? -eq 0 || no_result
+
+$bin/c_incl -no_cache -lang=roff main.ms > test.out
+test $? -eq 0 || fail
+diff ok test.out
+test $? -eq 0 || fail
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,166 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+TZ=UTC
+export TZ
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 1; fi
+
+bin="$here/${1-.}/bin"
+
+fail()
+{
+    set +x
+    echo 'FAILED test of the c_incl cache log' 1>&2
+    cd $here
+    rm -rf $work
+    exit 1
+}
+no_result()
+{
+    set +x
+    echo 'NO RESULT for test of the c_incl cache log' 1>&2
+    cd $here
+    rm -rf $work
+    exit 2
+}
+pass()
+{
+    set +x
+    cd $here
+    rm -rf $work
+    exit 0
+}
+trap "no_result" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then exit 2; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+n=1
+while test $n -le 12
+do
+    echo "/* $n */" > h$n.h
+    test $? -eq 0 || no_result
+    echo "#include \"h$n.h\"" > f$n.c
+    test $? -eq 0 || no_result
+    echo "h$n.h" > f$n.ok
+    test $? -eq 0 || no_result
+    n=`expr $n + 1`
+done
+
+#
+# Many processes may share the cache file at once.  Each appends only
+# what it changed, so none of their entries may be lost or damaged.
+#
+n=1
+while test $n -le 12
+do
+    $bin/c_incl -cache -ns f$n.c > f$n.out &
+    n=`expr $n + 1`
+done
+wait
+
+n=1
+while test $n -le 12
+do
+    diff f$n.ok f$n.out
+    test $? -eq 0 || fail
+    $bin/c_incl -cache -ns f$n.c > f$n.out
+    test $? -eq 0 || fail
+    diff f$n.ok f$n.out
+    test $? -eq 0 || fail
+    n=`expr $n + 1`
+done
+
+#
+# A damaged record at the end of the file (say, from a crash) must be
+# ignored, not trusted.
+#
+echo "garbage" >> .c_inclrc
+test $? -eq 0 || no_result
+echo '#include "h2.h"' >> f1.c
+test $? -eq 0 || no_result
+cat > f1.ok << 'fubar'
+h1.h
+h2.h
+fubar
+test $? -eq 0 || no_result
+$bin/c_incl -cache -ns f1.c > f1.out
+test $? -eq 0 || fail
+diff f1.ok f1.out
+test $? -eq 0 || fail
+
+#
+# Changing the same file over and over again appends a record each
+# time, until the file is compacted.
+#
+size1=`wc -c < .c_inclrc`
+n=1
+while test $n -le 100
+do
+    echo "int x$n;" >> f1.c
+    test $? -eq 0 || no_result
+    $bin/c_incl -cache -ns f1.c > f1.out
+    test $? -eq 0 || fail
+    if test $n -eq 1
+    then
+        record=`wc -c < .c_inclrc`
+        record=`expr $record - $size1`
+    fi
+    n=`expr $n + 1`
+done
+diff f1.ok f1.out
+test $? -eq 0 || fail
+
+# without compaction it would be size1 + 100 * record
+size2=`wc -c < .c_inclrc`
+test $size2 -lt `expr $size1 + 80 \* $record` || fail
+
+n=1
+while test $n -le 12
+do
+    $bin/c_incl -cache -ns f$n.c > f$n.out
+    test $? -eq 0 || fail
+    diff f$n.ok f$n.out
+    test $? -eq 0 || fail
+    n=`expr $n + 1`
+done
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,173 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+TZ=UTC
+export TZ
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 1; fi
+
+bin="$here/${1-.}/bin"
+
+fail()
+{
+    set +x
+    echo 'FAILED test of c_incl include closures' 1>&2
+    cd $here
+    rm -rf $work
+    exit 1
+}
+no_result()
+{
+    set +x
+    echo 'NO RESULT for test of c_incl include closures' 1>&2
+    cd $here
+    rm -rf $work
+    exit 2
+}
+pass()
+{
+    set +x
+    cd $here
+    rm -rf $work
+    exit 0
+}
+trap "no_result" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then exit 2; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# set up an include tree, with a cycle in it
+#
+cat > main.c << 'fubar'
+#include "a.h"
+#include "d.h"
+fubar
+test $? -eq 0 || no_result
+echo '#include "b.h"' > a.h
+test $? -eq 0 || no_result
+echo '#include "c.h"' > b.h
+test $? -eq 0 || no_result
+echo '/* c */' > c.h
+test $? -eq 0 || no_result
+cat > d.h << 'fubar'
+#include "b.h"
+#include "e.h"
+fubar
+test $? -eq 0 || no_result
+echo '#include "d.h"' > e.h
+test $? -eq 0 || no_result
+echo '/* f */' > f.h
+test $? -eq 0 || no_result
+
+#
+# The remembered closures must give exactly the same answer as
+# walking the files, both when they are first worked out, and later
+# when they are trusted.  They are only trusted once they are older
+# than the files they describe, hence the sleeps.
+#
+check()
+{
+    $bin/c_incl -no-cache -rec main.c > expected
+    test $? -eq 0 || no_result
+    $bin/c_incl -cache -rec main.c > test.out
+    test $? -eq 0 || fail
+    diff expected test.out
+    test $? -eq 0 || fail
+    sleep 1
+    $bin/c_incl -cache -rec main.c > test.out
+    test $? -eq 0 || fail
+    diff expected test.out
+    test $? -eq 0 || fail
+}
+
+cat > test.ok << 'fubar'
+a.h
+b.h
+c.h
+d.h
+e.h
+fubar
+test $? -eq 0 || no_result
+check
+diff test.ok test.out
+test $? -eq 0 || fail
+
+#
+# a change deep in the tree must be noticed
+#
+echo '#include "f.h"' >> c.h
+test $? -eq 0 || no_result
+cat > test.ok << 'fubar'
+a.h
+b.h
+c.h
+f.h
+d.h
+e.h
+fubar
+test $? -eq 0 || no_result
+check
+diff test.ok test.out
+test $? -eq 0 || fail
+
+#
+# and so must breaking the cycle
+#
+echo '/* e */' > e.h
+test $? -eq 0 || no_result
+check
+diff test.ok test.out
+test $? -eq 0 || fail
+
+echo '/* b */' > b.h
+test $? -eq 0 || no_result
+cat > test.ok << 'fubar'
+a.h
+b.h
+d.h
+e.h
+fubar
+test $? -eq 0 || no_result
+check
+diff test.ok test.out
+test $? -eq 0 || fail
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the cook_bom -recursive functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the cook_bom -recursive functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# build a small tree
+#
+mkdir a a/b a/b/c d e e/f e/g
+if test $? -ne 0 ; then no_result; fi
+for f in x y a/x a/b/y a/b/c/z d/x e/y e/f/z e/g/x
+do
+  echo $f > $f
+  if test $? -ne 0 ; then no_result; fi
+done
+
+#
+# The first run adds manifest.cook files to the directories it writes,
+# so it takes a second run for the tree to settle.
+#
+$bin/cook_bom -recursive -jobs 2 . top.cook
+if test $? -ne 0 ; then fail; fi
+$bin/cook_bom -recursive -jobs 2 . top.cook
+if test $? -ne 0 ; then fail; fi
+
+#
+# each file must be what a separate run would have written
+#
+$bin/cook_bom . test.ok
+if test $? -ne 0 ; then fail; fi
+diff test.ok top.cook
+if test $? -ne 0 ; then fail; fi
+
+for d in a a/b a/b/c d e e/f e/g
+do
+  $bin/cook_bom $d test.ok
+  if test $? -ne 0 ; then fail; fi
+  diff test.ok $d/manifest.cook
+  if test $? -ne 0 ; then fail; fi
+done
+
+#
+# unchanged files must not be written again
+#
+date > stamp
+if test $? -ne 0 ; then no_result; fi
+sleep 1
+echo new > a/b/new
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook_bom -recursive . top.cook
+if test $? -ne 0 ; then fail; fi
+
+find . -name manifest.cook -newer stamp -print > test.out
+if test $? -ne 0 ; then no_result; fi
+echo ./a/b/manifest.cook > test.ok
+if test $? -ne 0 ; then no_result; fi
+diff test.ok test.out
+if test $? -ne 0 ; then fail; fi
+
+$bin/cook_bom a/b test.ok
+if test $? -ne 0 ; then fail; fi
+diff test.ok a/b/manifest.cook
+if test $? -ne 0 ; then fail; fi
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,177 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the depfile flag functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the depfile flag functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# A pretend compiler, which ``includes'' the files named on "inc"
+# lines, and writes a dependency file the way gcc -MD does.
+#
+cat > fakecc << 'fubar'
+deps=`sed -n 's/^inc //p' $1`
+cat $1 $deps > $2
+dfile=`echo $2 | sed 's/\.o$/.d/'`
+echo "$2: $1 \\" > $dfile
+for d in $deps
+do
+    echo "  $d \\" >> $dfile
+done
+echo "" >> $dfile
+echo "$deps:" >> $dfile
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+%.o: %.c
+    set depfile
+{
+    sh fakecc %.c [target];
+}
+gen.h: gen.in
+{
+    cp gen.in gen.h;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo 'inc h1.h' > foo.c
+if test $? -ne 0 ; then no_result; fi
+echo 'inc gen.h' >> foo.c
+if test $? -ne 0 ; then no_result; fi
+echo 'one' > h1.h
+if test $? -ne 0 ; then no_result; fi
+echo 'gen one' > gen.in
+if test $? -ne 0 ; then no_result; fi
+sleep 2
+cp gen.in gen.h
+if test $? -ne 0 ; then no_result; fi
+
+#
+# The first build can only know about the cookbook's ingredients.
+#
+sleep 2
+$bin/cook -nl foo.o > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f .cook.deps
+if test $? -ne 0 ; then fail; fi
+
+#
+# A header change must be noticed, from the log alone.
+#
+sleep 2
+echo 'two' > h1.h
+if test $? -ne 0 ; then no_result; fi
+sleep 2
+$bin/cook -nl foo.o > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep two foo.o > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Nothing changed, nothing to do.
+#
+$bin/cook -nl foo.o > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep fakecc LOG > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# A discovered ingredient which has a recipe of its own must be
+# brought up to date first.
+#
+sleep 2
+echo 'gen two' > gen.in
+if test $? -ne 0 ; then no_result; fi
+sleep 2
+$bin/cook -nl foo.o > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'gen two' foo.o > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# A header which has gone away must not stop the build.
+#
+sleep 2
+echo 'inc gen.h' > foo.c
+if test $? -ne 0 ; then no_result; fi
+rm h1.h
+if test $? -ne 0 ; then no_result; fi
+sleep 2
+$bin/cook -nl foo.o > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep two foo.o > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep one foo.o > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
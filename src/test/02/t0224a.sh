@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the stat prefetch functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the stat prefetch functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+#
+# Enough files, on two search list directories, for the stat prefetch
+# to divide them among several workers.
+#
+mkdir bl
+if test $? -ne 0 ; then no_result; fi
+n=0
+while test $n -lt 300
+do
+    echo "base $n" > bl/f$n.in
+    if test $? -ne 0 ; then no_result; fi
+    n=`expr $n + 1`
+done
+echo 'over 7' > f7.in
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+search_list = . bl;
+all: [fromto bl/%.in %.out [glob "bl/*.in"]];
+%.out: %.in
+{
+    cat [resolve %.in] > [target];
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+sleep 2
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `ls *.out | wc -l` -eq 300
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'base 299' f299.out > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'over 7' f7.out > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Nothing has changed, so nothing may be done.
+#
+sleep 2
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep cat LOG > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# One changed file, and one changed override, is precisely two rebuilds.
+#
+echo 'base 42 changed' > bl/f42.in
+if test $? -ne 0 ; then no_result; fi
+echo 'over 7 changed' > f7.in
+if test $? -ne 0 ; then no_result; fi
+sleep 2
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `grep -c cat LOG` -eq 2
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep changed f42.out > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'over 7 changed' f7.out > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,200 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the -ninja option functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the -ninja option functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+#
+# A pretend compiler, which writes a dependency file.
+#
+cat > fakecc << 'fubar'
+cat $1 > $2
+echo "$2: $1" > `echo $2 | sed 's/\.o$/.d/'`
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+all: prog doc;
+all: extra;
+prog: a.o b.o
+    single-thread link
+{
+    cat a.o b.o > prog;
+    cat >> prog;
+    data
+trailer line
+    dataend
+}
+%.o: %.c
+    set depfile
+{
+    sh fakecc %.c [target];
+}
+doc: prog(exists)
+{
+    echo "doc of prog" > doc;
+}
+extra: { echo '$HOME is not expanded' > extra; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo 'aaa' > a.c
+if test $? -ne 0 ; then no_result; fi
+echo 'bbb' > b.c
+if test $? -ne 0 ; then no_result; fi
+
+mkdir ref
+if test $? -ne 0 ; then no_result; fi
+cp fakecc Howto.cook a.c b.c ref
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Export the plan.
+#
+$bin/cook -nl -ninja > build.ninja 2> LOG
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f prog
+if test $? -eq 0 ; then fail; fi
+
+grep '^build all: phony prog doc extra$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+grep '^build doc: cook || prog$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+grep '^  depfile = a.d$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+grep '^  pool = single_thread_1$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+grep '^default all$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+
+#
+# Replay the plan.  Build statements are written in the order the
+# walk visited them, so running the commands in file order is enough
+# when there is no ninja to hand.
+#
+if ninja --version > /dev/null 2>&1
+then
+    ninja > LOG 2>&1
+    if test $? -ne 0 ; then cat LOG; fail; fi
+else
+    sed -n 's/^  cmd = //p' build.ninja | sed 's/\$\$/$/g' > commands
+    if test $? -ne 0 ; then no_result; fi
+    while read -r cmd
+    do
+        sh -c "$cmd" > LOG 2>&1
+        if test $? -ne 0 ; then cat LOG; fail; fi
+    done < commands
+fi
+
+#
+# The same build, done by cook itself.
+#
+cd ref
+if test $? -ne 0 ; then no_result; fi
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+cd ..
+if test $? -ne 0 ; then no_result; fi
+
+for f in a.o a.d b.o b.d prog doc extra
+do
+    cmp $f ref/$f
+    if test $? -ne 0 ; then fail; fi
+done
+
+#
+# Default targets are escaped the same way as build statements, and
+# a file name with a newline in it can not be written at all.
+#
+mkdir esc
+if test $? -ne 0 ; then no_result; fi
+cd esc
+if test $? -ne 0 ; then no_result; fi
+cat > Howto.cook << 'fubar'
+"a b$c:d": { date > [target]; }
+nl: [catenate x [unsplit "\n" y z]];
+[catenate x [unsplit "\n" y z]]: { date > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -ninja 'a b$c:d' > build.ninja 2> LOG
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^default a\$ b\$\$c\$:d$' build.ninja > /dev/null
+if test $? -ne 0 ; then cat build.ninja; fail; fi
+
+$bin/cook -nl -ninja nl > build.ninja 2> LOG
+if test $? -eq 0 ; then cat build.ninja; fail; fi
+grep 'newline not allowed in ninja file' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+cd ..
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Only definite negatives are possible.
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,144 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the pattern list functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the pattern list functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work $work/sub
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# The graph_exterior_pattern list mixes plain names, patterns with
+# literal prefixes and suffixes, and patterns with neither.  Files
+# which match any of them must not be used as ingredients.
+#
+cat > Howto.cook << 'fubar'
+graph_exterior_pattern = x%.q a.s sub/%.s %%.s %1.zz%2 b.s;
+test: a.o b.o sub/c.o d.o e.o;
+%0%.o: %0%.s { echo s > [target]; }
+%0%.o: %0%.c { echo c > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+for f in a b sub/c d e
+do
+        echo x > $f.s
+        if test $? -ne 0 ; then no_result; fi
+        echo x > $f.c
+        if test $? -ne 0 ; then no_result; fi
+done
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+cat > test.ok << 'fubar'
+a.o c
+b.o c
+sub/c.o c
+d.o s
+e.o s
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+for f in a.o b.o sub/c.o d.o e.o
+do
+        echo "$f `cat $f`"
+done > test.out
+if test $? -ne 0 ; then no_result; fi
+
+diff test.ok test.out
+if test $? -ne 0 ; then fail; fi
+
+#
+# The same, with regular expression patterns.
+#
+rm -f *.o sub/*.o
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+set match-mode-regex;
+graph_exterior_pattern = x.*\\.q a\\.s sub/.*\\.s b\\.s;
+test: a.o b.o sub/c.o d.o e.o;
+\\(.*\\)\\.o: \\1.s { echo s > [target]; }
+\\(.*\\)\\.o: \\1.c { echo c > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+for f in a.o b.o sub/c.o d.o e.o
+do
+        echo "$f `cat $f`"
+done > test.out
+if test $? -ne 0 ; then no_result; fi
+
+diff test.ok test.out
+if test $? -ne 0 ; then fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
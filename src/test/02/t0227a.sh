@@ -0,0 +1,146 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the background fingerprint functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the background fingerprint functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# With fingerprints, time adjustments and parallel jobs, a large output
+# is fingerprinted in the background.  Other jobs carry on meanwhile,
+# and the recipe must still be seen to have (or not have) changed its
+# output.
+#
+cat > gen.sh << 'fubar'
+head -1 $1 > $2
+dd if=/dev/zero bs=1024 count=2048 2> /dev/null >> $2
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+set fingerprint update;
+test: big.copy small;
+big.copy: big { cp big big.copy; }
+big: big.in { sh gen.sh big.in big; }
+small: small.in { sleep 1; cp small.in small; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo one > big.in
+if test $? -ne 0 ; then no_result; fi
+echo small > small.in
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=4 -reason > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+cmp big big.copy
+if test $? -ne 0 ; then fail; fi
+cmp small.in small
+if test $? -ne 0 ; then fail; fi
+
+#
+# The fingerprint must have come from the background worker, not from
+# reading the file again once it finished.
+#
+grep 'big fingerprinted in the background' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Rebuild big with the same contents.
+# The fingerprint must be seen to be unchanged.
+#
+sleep 2
+echo two >> big.in
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=4 -reason > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'big fingerprint unchanged' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'big fingerprinted in the background' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'cp big big.copy' LOG > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# Rebuild big with different contents.
+#
+sleep 2
+echo three > big.in
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=4 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'cp big big.copy' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+cmp big big.copy
+if test $? -ne 0 ; then fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
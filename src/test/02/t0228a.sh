@@ -0,0 +1,168 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the remote host scheduling functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the remote host scheduling functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+
+#
+# Stand in for the remote shell, running the command locally and
+# remembering which host it was meant for.  Each command takes a
+# while, so that the jobs overlap.
+#
+cat > fakersh << 'fubar'
+host=$1
+shift
+echo $host >> hosts.log
+sleep 1
+exec sh -c "$*"
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+#
+# Jobs go to the host with the most free slots, so four jobs at once
+# are split three and one.  (Round robin would split them two and two.)
+#
+cat > Howto.cook << 'fubar'
+parallel_rsh = sh fakersh;
+parallel_hosts = "fast:3" "slow:1";
+all: a.out b.out c.out d.out;
+%.out: { echo [target] > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=4 -meter > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+for f in a b c d
+do
+        echo $f.out > ok
+        if test $? -ne 0 ; then no_result; fi
+        cmp ok $f.out
+        if test $? -ne 0 ; then fail; fi
+done
+test `grep -c '^fast$' hosts.log` -eq 3
+if test $? -ne 0 ; then cat hosts.log; fail; fi
+test `grep -c '^slow$' hosts.log` -eq 1
+if test $? -ne 0 ; then cat hosts.log; fail; fi
+
+#
+# Each host's share of the work is reported when metering.
+#
+grep 'host fast, 3 jobs, 3 slots' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'host slow, 1 job, 1 slot' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# One job at a time, the host which has been faster for this recipe
+# is preferred once both have been tried.  (Round robin would give the
+# slow host three of the six.)
+#
+rm -f *.out hosts.log
+cat > fakersh << 'fubar'
+host=$1
+shift
+echo $host >> hosts.log
+if test "$host" = slow; then sleep 1; fi
+exec sh -c "$*"
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+parallel_rsh = sh fakersh;
+parallel_hosts = fast slow;
+all: a.out b.out c.out d.out e.out f.out;
+%.out: { echo [target] > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=1 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `grep -c '^slow$' hosts.log` -le 2
+if test $? -ne 0 ; then cat hosts.log; fail; fi
+
+#
+# IPv6 addresses have colons of their own.  A bare address is not
+# split, and a bracketed one may be given a number of slots.
+#
+rm -f *.out hosts.log
+cat > Howto.cook << 'fubar'
+parallel_rsh = sh fakersh;
+parallel_hosts = "fe80::1" "[::1]:2";
+all: a.out b.out c.out;
+%.out: { echo [target] > [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=3 -meter > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'host fe80::1, 1 job, 1 slot' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'host ::1, 2 jobs, 2 slots' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `grep -c '^::1$' hosts.log` -eq 2
+if test $? -ne 0 ; then cat hosts.log; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,118 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the fingerprint journal functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the fingerprint journal functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+
+#
+# Fingerprints are journaled as they are taken.  If cook is killed
+# before it writes the fingerprint cache, they are recovered from the
+# journal by the next run.
+#
+cat > Howto.cook << 'fubar'
+set fingerprint;
+crash: a b { kill -9 $PPID; }
+other: { echo other > other; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo aaa > a
+if test $? -ne 0 ; then no_result; fi
+echo bbb > b
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl crash > LOG 2>&1
+test -f .cook.fp
+if test $? -eq 0 ; then cat LOG; no_result; fi
+grep ' a$' .cook.fp.journal > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+$bin/cook -nl other > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^"a" = ' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^"b" = ' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Once the cache is written, the journal is not needed.
+#
+test -f .cook.fp.journal
+if test $? -eq 0 ; then fail; fi
+
+#
+# A torn last entry is ignored.
+#
+printf '= 1 1 1 3 abc -1 c\n= 2 2' > .cook.fp.journal
+if test $? -ne 0 ; then no_result; fi
+$bin/cook -nl other > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^"c" = { 1$' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat .cook.fp; fail; fi
+grep '^"a" = ' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,112 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the sibling prefetch functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the sibling prefetch functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+
+#
+# A long ingredient list has its files looked at all at once, before
+# each is derived.  Some of the siblings exist, some are derived, and
+# one is made by a command run while an earlier sibling is derived.
+#
+list=`awk 'BEGIN { for (j = 1; j <= 300; ++j) print j }'`
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+first: [collect echo late > late.c] { echo first > first; }
+%.o: %.c { cp %.c %.o; }
+%.c: %.in { cp %.in %.c; }
+all: first
+fubar
+if test $? -ne 0 ; then no_result; fi
+for n in $list
+do
+        echo "    $n.o" >> Howto.cook
+        if test `expr $n % 2` -eq 0
+        then
+                echo $n > $n.c
+        else
+                echo $n > $n.in
+        fi
+        if test $? -ne 0 ; then no_result; fi
+done
+echo '    late.c { cat late.c > all; }' >> Howto.cook
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl all > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `ls *.o | wc -l` -eq 300
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 299 > ok
+if test $? -ne 0 ; then no_result; fi
+cmp ok 299.o
+if test $? -ne 0 ; then fail; fi
+echo late > ok
+if test $? -ne 0 ; then no_result; fi
+cmp ok all
+if test $? -ne 0 ; then fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,181 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the pipelined build functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the pipelined build functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# With -pipeline, recipes whose ingredients are known are queued while
+# the rest of the graph is still being derived, but are not run until
+# all of it has been derived.  The probe is run while deriving "late";
+# it looks to see if b.o has been made yet.
+#
+cat > Howto.cook << 'fubar'
+all: a.o b.o late { cat a.o b.o late > all; }
+%.o: %.c { cp %.c %.o; }
+late: [collect sh probe.sh] { cp probe.out late; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > probe.sh << 'fubar'
+if test -f b.o; then echo yes > probe.out; else echo no > probe.out; fi
+echo probe.out
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo aaa > a.c
+if test $? -ne 0 ; then no_result; fi
+echo bbb > b.c
+if test $? -ne 0 ; then no_result; fi
+
+cat > test.ok << 'fubar'
+aaa
+bbb
+no
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -pipeline -par 2 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+diff test.ok all
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Recipes run early are not run again by the walk.
+#
+test `grep -c 'cp b.c b.o' LOG` -eq 1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Errors found by recipes run early are reported by the walk, in the
+# same way as without -pipeline.
+#
+rm all a.o b.o
+if test $? -ne 0 ; then no_result; fi
+cat > Howto.cook << 'fubar'
+all: a.o b.o { cat a.o b.o > all; }
+a.o: a.c { false; }
+b.o: b.c { cp b.c b.o; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -pipeline > LOG 2>&1
+if test $? -ne 1 ; then cat LOG; fail; fi
+grep 'all: not done because of errors' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f all
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# When a target cannot be derived, nothing is run, in the same way as
+# without -pipeline.
+#
+rm -f a
+if test $? -ne 0 ; then no_result; fi
+cat > Howto.cook << 'fubar'
+all: a c;
+a: { touch a; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 1 ; then cat LOG; fail; fi
+test -f a
+if test $? -eq 0 ; then cat LOG; fail; fi
+$bin/cook -nl -pipeline > LOG 2>&1
+if test $? -ne 1 ; then cat LOG; fail; fi
+test -f a
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# Recipes which call user-defined functions that set variables are
+# left for the walk, the variable may change the ingredients of later
+# recipes.
+#
+rm -f a b yes
+if test $? -ne 0 ; then no_result; fi
+cat > Howto.cook << 'fubar'
+x = ;
+function setx = { x = yes; }
+all: a b;
+a: { function setx; touch a; }
+b: [x] { touch b; }
+yes: { touch yes; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -pipeline > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f a -a -f b
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f yes
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,138 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the derivation profile functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the derivation profile functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+cat > Howto.cook << 'fubar'
+all: prog;
+prog: a.o b.o { cat a.o b.o > prog; }
+%.o: %.y { cp %.y %.o; }
+%.o: %.c
+    if [exists %.c]
+{ cp %.c %.o; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo aaa > a.c
+if test $? -ne 0 ; then no_result; fi
+echo bbb > b.c
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -profile prof.txt > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# The report is printed, and the dump has one line per recipe.
+#
+grep '^ *self  *total  *match .* recipe$' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'Howto.cook: 4$' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+test `grep -v '^#' prof.txt | wc -l` -eq 4
+if test $? -ne 0 ; then cat prof.txt; fail; fi
+
+#
+# The counts are attributed to the right recipes.  The fields are
+# self, total, match attempts, applied, backtracked, failed,
+# preconditions and rejections, then the position.
+#
+awk '$10 == 4 { print $4, $5, $6, $7, $8 }' prof.txt > test.out
+if test $? -ne 0 ; then no_result; fi
+echo '2 0 0 2 0' > test.ok
+if test $? -ne 0 ; then no_result; fi
+diff test.ok test.out
+if test $? -ne 0 ; then cat prof.txt; fail; fi
+
+awk '$10 == 3 { print $4, $5, $6 }' prof.txt > test.out
+if test $? -ne 0 ; then no_result; fi
+echo '0 2 0' > test.ok
+if test $? -ne 0 ; then no_result; fi
+diff test.ok test.out
+if test $? -ne 0 ; then cat prof.txt; fail; fi
+
+awk '$10 == 3 && $3 == 0 { print }' prof.txt > test.out
+if test $? -ne 0 ; then no_result; fi
+test -s test.out
+if test $? -eq 0 ; then cat prof.txt; fail; fi
+
+#
+# Without -profile there is no report.
+#
+rm prog prof.txt
+if test $? -ne 0 ; then no_result; fi
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'recipe$' LOG > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+test -f prof.txt
+if test $? -eq 0 ; then fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,150 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the pathname cache functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the pathname cache functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# The symbolic links seen by [pathname] are remembered, but they are
+# forgotten when a command may have changed them.  Here "x" is a
+# directory when the cookbook is read, and a symbolic link when the
+# second recipe is run.
+#
+mkdir x d
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+before = [pathname x/f];
+all: step2;
+step1:
+{
+    rm -r x;
+    ln -s d x;
+    echo [before] > step1;
+}
+step2: step1
+{
+    echo [pathname x/f] > step2;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+grep '/x/f$' step1 > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+sed 's|/x/f$|/d/f|' < step1 > test.ok
+if test $? -ne 0 ; then no_result; fi
+diff test.ok step2
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Commands run by [collect] may change symbolic links, too.
+#
+mkdir real
+if test $? -ne 0 ; then no_result; fi
+rm -rf d
+if test $? -ne 0 ; then no_result; fi
+mkdir d
+if test $? -ne 0 ; then no_result; fi
+
+cat > swap.sh << 'fubar'
+rm -r d
+ln -s real d
+echo swapped
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+a = [pathname d/x];
+b = [collect sh swap.sh];
+c = [pathname d/x];
+all:
+{
+    echo [a] > test.a;
+    echo [c] > test.c;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+grep '/d/x$' test.a > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+sed 's|/d/x$|/real/x|' < test.a > test.ok
+if test $? -ne 0 ; then no_result; fi
+diff test.ok test.c
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,196 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the collect_cached functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the collect_cached functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# The generator counts how many times it is run.  The count is not one
+# of the declared inputs, so the result only changes when it is run
+# again.
+#
+cat > gen.sh << 'fubar'
+n=`cat count`
+n=`expr $n + 1`
+echo $n > count
+cat in.txt
+echo "$FOO"
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+x = [collect_lines_cached in.txt $FOO -- sh gen.sh];
+all:
+{
+    echo [x] > out;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo 0 > count
+echo one > in.txt
+FOO=foo
+export FOO
+
+#
+# The first run runs the command.
+#
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo one foo > test.ok
+diff test.ok out
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 1 > test.ok
+diff test.ok count
+if test $? -ne 0 ; then fail; fi
+
+#
+# The second run uses the remembered output.
+#
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo one foo > test.ok
+diff test.ok out
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 1 > test.ok
+diff test.ok count
+if test $? -ne 0 ; then fail; fi
+
+#
+# Changing the input runs the command again.
+#
+echo two > in.txt
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo two foo > test.ok
+diff test.ok out
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 2 > test.ok
+diff test.ok count
+if test $? -ne 0 ; then fail; fi
+
+#
+# Rewriting the input with the same contents does not.
+#
+sleep 1
+echo two > in.txt
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 2 > test.ok
+diff test.ok count
+if test $? -ne 0 ; then fail; fi
+
+#
+# Changing the environment variable runs the command again.
+#
+FOO=bar
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo two bar > test.ok
+diff test.ok out
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 3 > test.ok
+diff test.ok count
+if test $? -ne 0 ; then fail; fi
+
+#
+# A missing separator is an error.
+#
+cat > Howto.cook << 'fubar'
+x = [collect_cached in.txt sh gen.sh];
+all:;
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 1 ; then cat LOG; fail; fi
+grep 'separator' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# The lines variant splits the output at newlines only.
+#
+cat > Howto.cook << 'fubar'
+w = [collect_cached -- echo a b];
+l = [collect_lines_cached -- echo a b];
+all:
+{
+    echo [count [w]] [count [l]] > out;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+echo 2 1 > test.ok
+diff test.ok out
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
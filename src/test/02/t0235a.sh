@@ -0,0 +1,219 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the make2cook -recursive functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the make2cook -recursive functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+#
+# A recursive tree of makefiles, both forms of sub-make, and a
+# variable of the same name in each sub-directory.
+#
+mkdir sub lib
+if test $? -ne 0 ; then no_result; fi
+
+cat > Makefile << 'fubar'
+all: top.out
+	$(MAKE) -C sub
+	cd lib && $(MAKE) lib.out
+top.out: top.in
+	cat top.in > $@
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > sub/Makefile << 'fubar'
+NAME = sub
+all: sub.out
+sub.out: sub.in
+	echo $(NAME) > $@
+	cat $< >> $@
+.PHONY: all
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > lib/Makefile << 'fubar'
+NAME = lib
+lib.out: lib.in
+	echo $(NAME) > $@
+	cat lib.in >> $@
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo top > top.in
+echo sub.in > sub/sub.in
+echo lib.in > lib/lib.in
+
+cat > test.ok << 'fubar'
+all: top.out sub/all lib/lib.out
+{
+}
+top.out: top.in
+{
+        cat top.in > [target];
+}
+
+if [not [defined sub/NAME]] then
+        sub/NAME = sub;
+sub/all: sub/sub.out
+        set force;
+sub/sub.out: sub/sub.in
+{
+        cd sub && echo [sub/NAME] > [pathname [target]];
+        cd sub && cat [pathname [resolve [head [need]]]] >> [pathname [target]];
+}
+
+if [not [defined lib/NAME]] then
+        lib/NAME = lib;
+lib/lib.out: lib/lib.in
+{
+        cd lib && echo [lib/NAME] > [pathname [target]];
+        cd lib && cat lib.in >> [pathname [target]];
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/make2cook -recursive -nir Makefile Howto.cook
+if test $? -ne 0 ; then fail; fi
+
+diff test.ok Howto.cook
+if test $? -ne 0 ; then fail; fi
+
+#
+# The one cookbook builds the whole tree.
+#
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+cat > test.ok << 'fubar'
+top
+sub
+sub.in
+lib
+lib.in
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat top.out sub/sub.out lib/lib.out > test.out
+if test $? -ne 0 ; then no_result; fi
+diff test.ok test.out
+if test $? -ne 0 ; then fail; fi
+
+#
+# Without the option, the sub-makes are left alone.
+#
+$bin/make2cook -nir Makefile test.out
+if test $? -ne 0 ; then fail; fi
+grep '\[self\] -C sub' test.out > /dev/null
+if test $? -ne 0 ; then fail; fi
+
+#
+# A sub-makefile which relies on the internal rules gets its own copy
+# of those using its variables, and they run in its directory.  The
+# cookbook is not run, because cook takes too long to search all of
+# make's internal rules.
+#
+mkdir imp imp/lib
+if test $? -ne 0 ; then no_result; fi
+
+cat > imp/Makefile << 'fubar'
+CFLAGS = -DTOP
+all:
+	$(MAKE) -C lib
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > imp/lib/Makefile << 'fubar'
+CFLAGS = -DLIB
+libx.a: foo.o
+	$(AR) rc $@ foo.o
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/make2cook -recursive imp/Makefile test.out
+if test $? -ne 0 ; then fail; fi
+
+cat > test.ok << 'fubar'
+lib/%0%.o: lib/%0%.c
+        cd lib && [lib/COMPILE.c] [pathname [resolve [head [need]]]];
+        COMPILE.c = [CC] [CFLAGS] [CPPFLAGS] [TARGET_ARCH] -c;
+        lib/COMPILE.c = [CC] [lib/CFLAGS] [CPPFLAGS] [TARGET_ARCH] -c;
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+grep -e '^lib/%0%\.o:' -e 'cd lib && \[lib/COMPILE\.c\]' \
+        -e '^ *COMPILE\.c =' -e '^ *lib/COMPILE\.c =' test.out > test.out2
+if test $? -ne 0 ; then fail; fi
+sort test.ok > test.ok2
+if test $? -ne 0 ; then no_result; fi
+sort test.out2 > test.out3
+if test $? -ne 0 ; then no_result; fi
+diff test.ok2 test.out3
+if test $? -ne 0 ; then fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
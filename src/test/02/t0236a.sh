@@ -0,0 +1,116 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the -MEMory_Report functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the -MEMory_Report functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+#
+COOK_MESSAGE_LIBRARY=$work/no-such-dir
+export COOK_MESSAGE_LIBRARY
+unset LANG
+unset LANGUAGE
+
+cat > Howto.cook << 'fubar'
+all: a.o b.o;
+%.o: %.c
+{
+        cp %.c %.o;
+}
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+echo a > a.c
+echo b > b.c
+
+#
+# No report unless asked for.
+#
+$bin/cook -nl > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep 'peak bytes' LOG > /dev/null
+if test $? -eq 0 ; then cat LOG; fail; fi
+
+#
+# The report has a line for the graph, and a total.
+#
+$bin/cook -nl -forced -memory-report > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^subsystem.*live bytes.*peak bytes' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^cook/graph ' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^common/str ' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^total ' LOG > /dev/null
+if test $? -ne 0 ; then cat LOG; fail; fi
+test -f a.o -a -f b.o
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# Not in the environment variable.
+#
+COOK=-memory-report $bin/cook -nl > LOG 2>&1
+if test $? -ne 1 ; then cat LOG; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
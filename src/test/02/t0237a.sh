@@ -0,0 +1,128 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the job output grouping functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the job output grouping functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+
+#
+# Three jobs run in parallel, each writing a line at a time with
+# pauses in between.  Grouped, each job's lines must appear together.
+#
+cat > loop.sh << 'fubar'
+for n in 1 2 3
+do
+    echo $1$n
+    sleep 1
+done
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+all: a b c;
+a: { sh loop.sh a; }
+b: { sh loop.sh b; }
+c: { sh loop.sh c 1>&2; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > check.sh << 'fubar'
+x=`grep '^[abc][123]$' $1 | cut -c1 | tr -d '\n'`
+y=`echo "$x" | sed -e 's/aaa//' -e 's/bbb//' -e 's/ccc//'`
+test "$x" != "" -a "$y" = ""
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+#
+# The list file groups output by default.
+#
+$bin/cook -par=3 -list x.log -no-terminal > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+sh check.sh x.log
+if test $? -ne 0 ; then cat x.log; fail; fi
+
+#
+# Without a list file, grouping must be asked for.
+#
+$bin/cook -nl -par=3 -group-output > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+sh check.sh LOG
+if test $? -ne 0 ; then cat LOG; fail; fi
+
+#
+# A compressed list file.
+#
+if gzip -c < /dev/null > /dev/null 2>&1
+then
+    $bin/cook -par=3 -list y.log.gz -no-terminal > LOG 2>&1
+    if test $? -ne 0 ; then cat LOG; fail; fi
+    test ! -f y.log
+    if test $? -ne 0 ; then fail; fi
+    gzip -dc < y.log.gz > y.log
+    if test $? -ne 0 ; then fail; fi
+    sh check.sh y.log
+    if test $? -ne 0 ; then cat y.log; fail; fi
+fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass
@@ -0,0 +1,202 @@
+#!/bin/sh
+#
+#       cook - file construction tool
+#       Copyright (C) 2026 Peter Miller
+#
+#       This program is free software; you can redistribute it and/or modify
+#       it under the terms of the GNU General Public License as published by
+#       the Free Software Foundation; either version 3 of the License, or
+#       (at your option) any later version.
+#
+#       This program is distributed in the hope that it will be useful,
+#       but WITHOUT ANY WARRANTY; without even the implied warranty of
+#       MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#       GNU General Public License for more details.
+#
+#       You should have received a copy of the GNU General Public License
+#       along with this program. If not, see
+#       <http://www.gnu.org/licenses/>.
+#
+work=${COOK_TMP:-/tmp}/$$
+PAGER=cat
+export PAGER
+umask 022
+unset COOK
+here=`pwd`
+if test $? -ne 0 ; then exit 2; fi
+SHELL=/bin/sh
+export SHELL
+
+bin="$here/${1-.}/bin"
+
+pass()
+{
+        set +x
+        cd $here
+        rm -rf $work
+        exit 0
+}
+fail()
+{
+        set +x
+        echo 'FAILED test of the resource pool functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 1
+}
+no_result()
+{
+        set +x
+        echo 'NO RESULT for test of the resource pool functionality' 1>&2
+        cd $here
+        rm -rf $work
+        exit 2
+}
+trap \"no_result\" 1 2 3 15
+
+mkdir $work
+if test $? -ne 0 ; then no_result; fi
+cd $work
+
+#
+# Use the default error messages.  There is no other way to get
+# predictable test behaviour on the unknown systems we will be tested on.
+
+#
+# Each job notes when it starts and finishes, so that the largest
+# number running at once can be found afterwards.
+#
+cat > job.sh << 'fubar'
+echo + >> trace
+sleep 1
+echo - >> trace
+cp ${2-$1.in} $1
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > most.sh << 'fubar'
+awk '/\+/ { n++; if (n > m) m = n } /-/ { n-- } END { print m }' trace
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+for f in a b c d e f
+do
+    echo $f > $f.in
+    if test $? -ne 0 ; then no_result; fi
+done
+
+#
+# A single-thread name still runs one recipe at a time by default.
+#
+cat > Howto.cook << 'fubar'
+all: a b c d e f;
+%: %.in single-thread link { sh job.sh [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=6 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test "`sh most.sh`" = 1
+if test $? -ne 0 ; then cat trace; fail; fi
+
+#
+# Give the pool more room.
+#
+rm -f trace a b c d e f
+cat > Howto.cook << 'fubar'
+parallel_pools = "link:3";
+all: a b c d e f;
+%: %.in single-thread link { sh job.sh [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=6 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test "`sh most.sh`" = 3
+if test $? -ne 0 ; then cat trace; fail; fi
+
+#
+# Claim more than one unit each.  A claim larger than the pool is
+# cut down to size.
+#
+rm -f trace a b c d e f
+mv e.in e.big
+if test $? -ne 0 ; then no_result; fi
+mv f.in f.big
+if test $? -ne 0 ; then no_result; fi
+cat > Howto.cook << 'fubar'
+parallel_pools = "link:4";
+all: a b c d e f;
+%: %.in single-thread "link:2" { sh job.sh [target] [need]; }
+%: %.big single-thread "link:9" { sh job.sh [target] [need]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=6 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test "`sh most.sh`" = 2
+if test $? -ne 0 ; then cat trace; fail; fi
+
+#
+# The memory each recipe used is remembered with the fingerprints,
+# and keeps the next run within the budget.
+#
+rm -f trace a b c d e f
+cat > job.sh << 'fubar'
+echo + >> trace
+awk 'BEGIN { s = "x"; while (length(s) < 100000000) s = s s; system("sleep 1") }'
+echo - >> trace
+cp $1.in $1
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+cat > Howto.cook << 'fubar'
+set fingerprint;
+parallel_memory = 300M;
+all: a b c;
+%: %.in { sh job.sh [target]; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=3 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^"a" = { [0-9]* }$' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat .cook.fp; fail; fi
+
+rm -f trace
+for f in a b c
+do
+    echo again >> $f.in
+    if test $? -ne 0 ; then no_result; fi
+done
+$bin/cook -nl -par=3 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+test "`sh most.sh`" = 1
+if test $? -ne 0 ; then cat trace; fail; fi
+
+#
+# Without a budget, no memory is recorded, and the fingerprint cache
+# stays in the form older versions of cook can read.
+#
+rm -f a b c .cook.fp .cook.fp.journal
+cat > Howto.cook << 'fubar'
+set fingerprint;
+all: a b c;
+%: %.in { cp %.in %; }
+fubar
+if test $? -ne 0 ; then no_result; fi
+
+$bin/cook -nl -par=3 > LOG 2>&1
+if test $? -ne 0 ; then cat LOG; fail; fi
+grep '^"a.in" = { ' .cook.fp > /dev/null
+if test $? -ne 0 ; then cat .cook.fp; fail; fi
+grep '^"[abc]" = { [0-9]* }$' .cook.fp > /dev/null
+if test $? -eq 0 ; then cat .cook.fp; fail; fi
+grep '^"[abc]" = { [0-9]* [0-9]* [0-9]* [0-9]*$' .cook.fp > /dev/null
+if test $? -eq 0 ; then cat .cook.fp; fail; fi
+
+#
+# The functionality exercised by this test appears to work,
+# no other guarantees are made.
+#
+pass